@@ -0,0 +1,40 @@
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+/**
+ * @file Bench.h
+ * @brief Wall-clock timing for the host benchmarks.
+ *
+ * Benchmarks are GoogleTest cases that print their numbers and only assert what holds on any
+ * machine (equal results, zero allocations), never a speed.
+ */
+
+#include <stdint.h>
+#include <chrono>
+
+/**
+ * @brief Keeps a computed value alive, so the optimizer cannot drop the work behind it.
+ */
+template <typename T>
+inline void keep(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief Times a call repeated many times.
+ * @return Mean nanoseconds per call.
+ */
+template <typename Function>
+double nanosPerCall(uint64_t calls, Function function)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < calls; i++)
+    {
+        function(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / calls;
+}
+
+#endif // HOST_BENCH_H
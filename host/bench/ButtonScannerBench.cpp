@@ -0,0 +1,190 @@
+/**
+ * @file ButtonScannerBench.cpp
+ * @brief Scan cost per tick for 32 inputs: vertical counters against one counter per pin.
+ *
+ * Both debouncers take the same port samples, a panel of 32 buttons pressed, held and released
+ * at random with contact bounce on every edge, and apply the same rule: four samples in a row
+ * that disagree with the debounced state flip it, and the same long-press and double-click
+ * thresholds. The per-pin loop is what a Button-per-input design does each tick; both must raise
+ * the same number of every gesture.
+ */
+
+#include "Bench.h"
+#include "ButtonScanner.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const uint8_t INPUTS = ButtonScanner::MAX_INPUTS;
+const uint32_t TICK_MS = ButtonScanner::TICK_US / 1000;
+
+struct GestureCounter : public EventHandler
+{
+    uint64_t counts[4] = {};
+
+    void on(Event event) override
+    {
+        ButtonGesture gesture;
+        uint8_t input;
+        if (ButtonScanner::decode(event, gesture, input))
+        {
+            counts[(int)gesture]++;
+        }
+    }
+};
+
+/**
+ * @brief One debounce counter and gesture state per pin, visited in turn every tick.
+ */
+struct PerPinDebouncer
+{
+    struct Pin
+    {
+        uint8_t counter;
+        bool consumed;  ///< This press already was a long press or double click.
+        bool clickOpen; ///< Released once, waiting for a second press.
+        uint32_t pressedAt;
+        uint32_t releasedAt;
+    };
+
+    Pin pins[INPUTS] = {};
+    uint32_t debounced = 0;
+    uint64_t counts[4] = {};
+
+    void scan(uint32_t levels, uint32_t nowMillis)
+    {
+        for (uint8_t input = 0; input < INPUTS; input++)
+        {
+            Pin &pin = pins[input];
+            bool pressed = !(levels & (1UL << input));
+            bool state = debounced & (1UL << input);
+            if (pressed == state)
+            {
+                pin.counter = 0;
+            }
+            else if (++pin.counter == 4)
+            {
+                pin.counter = 0;
+                debounced ^= 1UL << input;
+                state = pressed;
+                if (pressed)
+                {
+                    counts[(int)ButtonGesture::PRESS]++;
+                    pin.pressedAt = nowMillis;
+                    pin.consumed = pin.clickOpen && nowMillis - pin.releasedAt <= ButtonScanner::DOUBLE_CLICK_MS;
+                    counts[(int)ButtonGesture::DOUBLE_CLICK] += pin.consumed ? 1 : 0;
+                    pin.clickOpen = false;
+                }
+                else
+                {
+                    counts[(int)ButtonGesture::RELEASE]++;
+                    if (!pin.consumed)
+                    {
+                        pin.clickOpen = true;
+                        pin.releasedAt = nowMillis;
+                    }
+                }
+            }
+            if (state && !pin.consumed && nowMillis - pin.pressedAt >= ButtonScanner::LONG_PRESS_MS)
+            {
+                pin.consumed = true;
+                counts[(int)ButtonGesture::LONG_PRESS]++;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Port samples of a busy panel: every button cycles through random presses of 40 ms to
+ * 1.5 s, with up to 15 ms of bounce after each edge.
+ */
+std::vector<uint32_t> busyPanel(size_t ticks)
+{
+    std::mt19937 random(44);
+    std::uniform_int_distribution<uint32_t> holdTicks(8, 300);
+    std::uniform_int_distribution<uint32_t> bounceTicks(0, 3);
+    std::vector<uint32_t> samples(ticks, 0xFFFFFFFFUL);
+    for (uint8_t input = 0; input < INPUTS; input++)
+    {
+        bool pressed = false;
+        size_t tick = holdTicks(random);
+        size_t next = tick;
+        for (size_t t = 0; t < ticks; t++)
+        {
+            if (t == next)
+            {
+                pressed = !pressed;
+                tick = t;
+                next = t + holdTicks(random);
+            }
+            bool level = !pressed;
+            if (t - tick < bounceTicks(random))
+            {
+                level = random() & 1;
+            }
+            if (!level)
+            {
+                samples[t] &= ~(1UL << input);
+            }
+        }
+    }
+    return samples;
+}
+
+TEST(ButtonScannerBench, ScanCostPerTickFor32Inputs)
+{
+    const size_t ticks = 1 << 16;
+    std::vector<uint32_t> panel = busyPanel(ticks);
+    const uint64_t calls = 10000000;
+
+    GestureCounter idleEvents;
+    ButtonScanner idleScanner(&idleEvents);
+    for (uint8_t input = 0; input < INPUTS; input++)
+    {
+        idleScanner.addPin(input);
+    }
+    double idleNanos = nanosPerCall(calls, [&](uint64_t i) { idleScanner.scan(0xFFFFFFFFUL, (uint32_t)(i * TICK_MS)); });
+    keep(idleScanner);
+
+    GestureCounter busyEvents;
+    ButtonScanner busyScanner(&busyEvents);
+    for (uint8_t input = 0; input < INPUTS; input++)
+    {
+        busyScanner.addPin(input);
+    }
+    double busyNanos = nanosPerCall(calls, [&](uint64_t i) {
+        busyScanner.scan(panel[i & (ticks - 1)], (uint32_t)(i * TICK_MS));
+    });
+    keep(busyScanner);
+
+    PerPinDebouncer perPin;
+    double perPinNanos = nanosPerCall(calls, [&](uint64_t i) {
+        perPin.scan(panel[i & (ticks - 1)], (uint32_t)(i * TICK_MS));
+    });
+    keep(perPin);
+
+    const uint64_t *gestures = busyEvents.counts;
+    printf("[ bench    ] 32 inputs per tick: vertical counters %.1f ns idle, %.1f ns on a busy panel "
+           "(%llu presses, %llu long, %llu double); one counter per pin %.1f ns\n",
+           idleNanos, busyNanos, (unsigned long long)gestures[(int)ButtonGesture::PRESS],
+           (unsigned long long)gestures[(int)ButtonGesture::LONG_PRESS],
+           (unsigned long long)gestures[(int)ButtonGesture::DOUBLE_CLICK], perPinNanos);
+
+    // Same debouncing and gesture rules, same events
+    EXPECT_EQ(busyScanner.getPressed(), perPin.debounced);
+    for (int gesture = 0; gesture < 4; gesture++)
+    {
+        EXPECT_EQ(gestures[gesture], perPin.counts[gesture]) << gesture;
+    }
+    EXPECT_GT(gestures[(int)ButtonGesture::LONG_PRESS], 0u);
+    EXPECT_GT(gestures[(int)ButtonGesture::DOUBLE_CLICK], 0u);
+    for (uint64_t count : idleEvents.counts)
+    {
+        EXPECT_EQ(count, 0u);
+    }
+}
+
+} // namespace
@@ -0,0 +1,75 @@
+/**
+ * @file FixedTextBench.cpp
+ * @brief One LCD data row built with FixedText, snprintf() and String, per frame.
+ */
+
+#include "AllocationCounter.h"
+#include "Bench.h"
+#include "FixedText.h"
+#include "LcdFrameBuffer.h"
+#include <Arduino.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+
+float ppmFor(uint64_t frame)
+{
+    // Walks through every width the PPM field takes
+    return (float)((frame * 7919) % 20000);
+}
+
+TEST(FixedTextBench, DataRowPerFrame)
+{
+    const uint64_t frames = 2000000;
+    size_t checksum = 0;
+
+    AllocationScope fixedAllocations;
+    double fixedNanos = nanosPerCall(frames, [&](uint64_t i) {
+        FixedText<LcdFrameBuffer::COLS + 1> line;
+        line.append("PPM: ").appendKilo<6>(ppmFor(i)).append(" (").appendInt<3>((long)(i % 101)).append("%)");
+        checksum += line.size();
+        keep(line);
+    });
+    uint64_t fixedPerFrame = fixedAllocations.count();
+
+    AllocationScope printfAllocations;
+    double printfNanos = nanosPerCall(frames, [&](uint64_t i) {
+        char line[LcdFrameBuffer::COLS + 1];
+        float ppm = ppmFor(i);
+        if (ppm < 1000)
+        {
+            snprintf(line, sizeof(line), "PPM: %6d (%3d%%)", (int)ppm, (int)(i % 101));
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "PPM: %5.1fK (%3d%%)", ppm / 1000, (int)(i % 101));
+        }
+        checksum += strlen(line);
+        keep(line);
+    });
+    uint64_t printfPerFrame = printfAllocations.count();
+
+    AllocationScope stringAllocations;
+    double stringNanos = nanosPerCall(frames, [&](uint64_t i) {
+        float ppm = ppmFor(i);
+        String value = ppm < 1000 ? String((int)ppm) : String(ppm / 1000, 1) + "K";
+        String line = String("PPM: ") + value + " (" + String((int)(i % 101)) + "%)";
+        checksum += line.length();
+        keep(line);
+    });
+    uint64_t stringPerFrame = stringAllocations.count();
+
+    printf("[ bench    ] data row: FixedText %.1f ns, %llu allocations; snprintf %.1f ns, %llu; "
+           "String %.1f ns, %.2f allocations per frame\n",
+           fixedNanos, (unsigned long long)fixedPerFrame, printfNanos, (unsigned long long)printfPerFrame,
+           stringNanos, (double)stringPerFrame / frames);
+    keep(checksum);
+
+    EXPECT_EQ(fixedPerFrame, 0u);
+    EXPECT_GT(stringPerFrame, 0u);
+}
+
+} // namespace
@@ -0,0 +1,127 @@
+/**
+ * @file GasHistoryBench.cpp
+ * @brief Append and query throughput of the reading history on a file-backed flash stand-in.
+ *
+ * A week of 1 Hz readings goes into GasHistory through FileSegmentStorage, one file per segment
+ * as on LittleFS: noisy clean air, one 10-minute leak and a few seconds missed each hour. The
+ * store is then reopened as after a reboot and queried by random one-hour ranges and as a whole.
+ */
+
+#include "Bench.h"
+#include "FlashStandIn.h"
+#include "GasHistory.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const uint32_t WEEK_SECONDS = 7 * 24 * 3600;
+
+struct Sample
+{
+    uint32_t time;
+    float ppm;
+};
+
+void collect(uint32_t time, float ppm, void *context)
+{
+    static_cast<std::vector<Sample> *>(context)->push_back(Sample{time, ppm});
+}
+
+void countSample(uint32_t time, float ppm, void *context)
+{
+    (*static_cast<size_t *>(context))++;
+}
+
+double microsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::vector<Sample> week()
+{
+    std::mt19937 random(46);
+    std::normal_distribution<float> noise(0, 0.4f);
+    std::vector<Sample> samples;
+    samples.reserve(WEEK_SECONDS);
+    uint32_t time = 0;
+    for (uint32_t i = 0; i < WEEK_SECONDS; i++)
+    {
+        // A late pass every hour skips two seconds
+        time += i % 3600 == 1800 ? 3 : 1;
+        float ppm = 3.6f + noise(random);
+        if (i > 300000 && i < 300600)
+        {
+            ppm += (i - 300000) * 2.0f;
+        }
+        samples.push_back(Sample{time, (float)GasHistory::quantize(ppm)});
+    }
+    return samples;
+}
+
+TEST(GasHistoryBench, WeekOfReadingsOnFileFlash)
+{
+    std::vector<Sample> samples = week();
+    FileSegmentStorage storage;
+
+    GasHistory *history = new GasHistory(&storage);
+    ASSERT_TRUE(history->begin());
+    double appendNanos = nanosPerCall(samples.size(), [&](uint64_t i) { history->append(samples[i].time, samples[i].ppm); });
+    ASSERT_TRUE(history->flush());
+    float bitsPerSample = history->getBitsPerSample();
+    uint32_t storedBytes = history->getStoredBytes();
+    delete history;
+
+    // Reopened as after a reboot
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    history = new GasHistory(&storage);
+    ASSERT_TRUE(history->begin());
+    double beginMicros = microsSince(start);
+
+    std::mt19937 random(4600);
+    std::uniform_int_distribution<uint32_t> from(0, samples.back().time - 3600);
+    const int queries = 500;
+    size_t hourSamples = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < queries; i++)
+    {
+        uint32_t fromTime = from(random);
+        history->query(fromTime, fromTime + 3599, countSample, &hourSamples);
+    }
+    double hourQueryMicros = microsSince(start) / queries;
+
+    std::vector<Sample> restored;
+    restored.reserve(samples.size());
+    start = std::chrono::steady_clock::now();
+    size_t count = history->query(0, 0xFFFFFFFFUL, collect, &restored);
+    double scanMicros = microsSince(start);
+
+    printf("[ bench    ] history, a week at 1 Hz on file flash: append %.0f ns/sample, %.2f bits/sample, "
+           "%lu KB in %lu segments, %llu KB written in %llu appends\n",
+           appendNanos, bitsPerSample, (unsigned long)(storedBytes / 1024),
+           (unsigned long)history->getStoredSegments(), (unsigned long long)(storage.getBytesWritten() / 1024),
+           (unsigned long long)storage.getWrites());
+    printf("[ bench    ] history queries: reopen %.0f us, 1-hour range %.0f us (%.0f samples), "
+           "full week %.1f ms (%.1f M samples/s)\n",
+           beginMicros, hourQueryMicros, (double)hourSamples / queries, scanMicros / 1000,
+           count / scanMicros);
+    delete history;
+
+    // Every sample back, in order, after the reboot
+    ASSERT_EQ(count, samples.size());
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        ASSERT_EQ(restored[i].time, samples[i].time) << i;
+        ASSERT_EQ(restored[i].ppm, samples[i].ppm) << i;
+    }
+    // One-hour ranges hold 3600 seconds, less the two skipped around each half hour
+    EXPECT_GE(hourSamples, (size_t)queries * 3598);
+    EXPECT_LE(hourSamples, (size_t)queries * 3600);
+    // Appends add bytes; nothing is rewritten
+    EXPECT_LT(storage.getBytesWritten(), storedBytes + storedBytes / 10);
+}
+
+} // namespace
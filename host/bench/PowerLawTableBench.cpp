@@ -0,0 +1,49 @@
+/**
+ * @file PowerLawTableBench.cpp
+ * @brief The MQ-2 curve by table lookup against powf(), per evaluation.
+ */
+
+#include "Bench.h"
+#include "GasSensor.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+TEST(PowerLawTableBench, TableAgainstPowf)
+{
+    // Ratios a detector sees, from clean air down into a leak, in random order
+    std::mt19937 random(28);
+    std::uniform_real_distribution<float> logRatio(logf(0.2f), logf(12.0f));
+    std::vector<float> ratios(4096);
+    for (float &ratio : ratios)
+    {
+        ratio = expf(logRatio(random));
+    }
+    const size_t mask = ratios.size() - 1;
+    const uint64_t calls = 20000000;
+
+    const Mq2CurveTable &table = GasSensor::lpgCurve();
+    double tableSum = 0;
+    double tableNanos = nanosPerCall(calls, [&](uint64_t i) {
+        tableSum += table.evaluate(ratios[i & mask]);
+    });
+    keep(tableSum);
+
+    const float a = 574.25f;
+    const float b = -2.222f;
+    double powSum = 0;
+    double powNanos = nanosPerCall(calls, [&](uint64_t i) {
+        powSum += a * powf(ratios[i & mask], b);
+    });
+    keep(powSum);
+
+    printf("[ bench    ] table %.2f ns, powf %.2f ns per evaluation (%.2fx)\n", tableNanos, powNanos,
+           powNanos / tableNanos);
+    EXPECT_NEAR(tableSum / powSum, 1.0, 0.001);
+}
+
+} // namespace
@@ -0,0 +1,53 @@
+/**
+ * @file RollupSeriesBench.cpp
+ * @brief Per-sample cost of RollupSeries and of the QuantileSketch insertion behind it.
+ *
+ * Samples arrive once a second of series time, so the mean includes every minute, hour and day
+ * close with its cascade; a burst of samples within one minute shows the cost without closes.
+ */
+
+#include "AllocationCounter.h"
+#include "Bench.h"
+#include "RollupSeries.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+namespace
+{
+
+float ppmFor(uint64_t i)
+{
+    return 100.0f + (float)((i * 7919) % 1500);
+}
+
+TEST(RollupSeriesBench, PerSample)
+{
+    const uint64_t samples = 10000000; // About 116 days at 1 Hz
+
+    QuantileSketch sketch;
+    double sketchNanos = nanosPerCall(samples, [&](uint64_t i) { sketch.add(ppmFor(i)); });
+    keep(sketch);
+
+    RollupSeries *open = new RollupSeries("bench");
+    double openNanos = nanosPerCall(samples, [&](uint64_t i) { open->add(30, ppmFor(i)); });
+    keep(*open);
+
+    RollupSeries *series = new RollupSeries("bench");
+    AllocationScope allocations;
+    double seriesNanos = nanosPerCall(samples, [&](uint64_t i) { series->add((uint32_t)i, ppmFor(i)); });
+    uint64_t seriesAllocations = allocations.count();
+
+    RollupSummary day;
+    ASSERT_TRUE(series->closed(RollupResolution::DAY, 0, day));
+    printf("[ bench    ] rollup: %.1f ns per sample at 1 Hz (closes included), %.1f ns within one minute; "
+           "QuantileSketch::add %.1f ns; %u bytes per series\n",
+           seriesNanos, openNanos, sketchNanos, (unsigned)sizeof(RollupSeries));
+
+    EXPECT_EQ(seriesAllocations, 0u);
+    EXPECT_EQ(day.count, 86400u);
+    EXPECT_EQ(open->getClosedCount(RollupResolution::MINUTE), 0);
+    delete open;
+    delete series;
+}
+
+} // namespace
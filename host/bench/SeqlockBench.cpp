@@ -0,0 +1,101 @@
+/**
+ * @file SeqlockBench.cpp
+ * @brief Read and write cost of the FaucetStatus and GasSnapshot read models' Seqlock.
+ *
+ * Each value is written and read alone, as between passes, and then read while another thread
+ * publishes nonstop, the worst a status query can meet; retries count the reads that overlapped.
+ */
+
+#include "Bench.h"
+#include "CiaSteelFaucet.h"
+#include "GLPSecureSenseDevice.h"
+#include "Seqlock.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+
+const uint64_t CALLS = 5000000;
+
+template <typename T>
+void measure(const char *name, T (*versionOf)(uint64_t), uint32_t (*versionIn)(const T &))
+{
+    Seqlock<T> published;
+    double writeNanos = nanosPerCall(CALLS, [&](uint64_t i) { published.write(versionOf(i)); });
+
+    uint64_t checksum = 0;
+    double readNanos = nanosPerCall(CALLS, [&](uint64_t) {
+        T value = published.read();
+        checksum += versionIn(value);
+        keep(value);
+    });
+    uint32_t quietRetries = published.getRetries();
+
+    std::atomic<bool> reading(true);
+    std::thread writer([&]() {
+        for (uint64_t i = 0; reading.load(std::memory_order_relaxed); i++)
+        {
+            published.write(versionOf(i));
+        }
+    });
+    double contendedNanos = nanosPerCall(CALLS, [&](uint64_t) {
+        T value = published.read();
+        checksum += versionIn(value);
+        keep(value);
+    });
+    reading.store(false);
+    writer.join();
+
+    printf("[ seqlock  ] %s (%u bytes): write %.1f ns, read %.1f ns; read against a writer %.1f ns, "
+           "%.3f retries per read\n",
+           name, (unsigned)sizeof(T), writeNanos, readNanos, contendedNanos,
+           (double)(published.getRetries() - quietRetries) / CALLS);
+    keep(checksum);
+
+    EXPECT_EQ(quietRetries, 0u);
+}
+
+FaucetStatus faucetVersion(uint64_t i)
+{
+    FaucetStatus status = {};
+    status.distance = (float)(i % 400);
+    status.activations = (uint32_t)i;
+    status.commands = (uint32_t)i;
+    status.lastActivationMillis = (uint32_t)i;
+    return status;
+}
+
+uint32_t faucetActivations(const FaucetStatus &status)
+{
+    return status.activations;
+}
+
+GasSnapshot gasVersion(uint64_t i)
+{
+    GasSnapshot snapshot = {};
+    snapshot.reading.ppm = (float)(i % 10000);
+    snapshot.reading.timestamp = (unsigned long)i;
+    snapshot.criticalAlarms = (uint32_t)i;
+    snapshot.lastAlarmMillis = (unsigned long)i;
+    return snapshot;
+}
+
+uint32_t gasAlarms(const GasSnapshot &snapshot)
+{
+    return snapshot.criticalAlarms;
+}
+
+TEST(SeqlockBench, FaucetStatus)
+{
+    measure<FaucetStatus>("FaucetStatus", faucetVersion, faucetActivations);
+}
+
+TEST(SeqlockBench, GasSnapshot)
+{
+    measure<GasSnapshot>("GasSnapshot ", gasVersion, gasAlarms);
+}
+
+} // namespace
@@ -0,0 +1,234 @@
+/**
+ * @file StatusServerBench.cpp
+ * @brief Requests per second and tail latency of StatusServer over loopback, under concurrent
+ * keep-alive pollers.
+ *
+ * The server runs on its own thread, as on the device, and re-renders /status from its refresh
+ * callback whenever a version counter changes, which another thread bumps every 10 ms like a
+ * busy faucet's read model. Each poller sends GET /status on one keep-alive connection as fast
+ * as answers come back and reconnects when the server rotates it out after MAX_REQUESTS. With
+ * more pollers than connection slots, the rest wait in the listen backlog; that wait is timed
+ * apart from the requests, and every poller is answered at least once before the run ends.
+ */
+
+#include "AllocationCounter.h"
+#include "HttpResponse.h"
+#include "LoopbackClient.h"
+#include "StatusServer.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+const uint32_t LOAD_MILLIS = 2000;
+const uint32_t STATE_CHANGE_MILLIS = 10;
+
+/**
+ * @brief /status and what the server thread renders it from.
+ */
+struct StatusPage
+{
+    HttpResponse response;
+    std::atomic<uint32_t> version;
+    uint32_t renderedVersion;
+    std::atomic<uint32_t> refreshes;
+    std::atomic<uint64_t> serverAllocations; ///< Made by the server thread, as of the last refresh.
+
+    StatusPage() : response("200 OK", "application/json", 256), version(1), renderedVersion(0), refreshes(0),
+                   serverAllocations(0)
+    {
+    }
+};
+
+size_t renderStatus(char *body, size_t capacity, void *context)
+{
+    unsigned version = *static_cast<unsigned *>(context);
+    return snprintf(body, capacity,
+                    "{\"version\":%u,\"valve\":\"%s\",\"distance_cm\":%.1f,\"led\":%s,\"activations\":%u}\n",
+                    version, version % 2 == 0 ? "open" : "closed", 10 + (version % 50) * 0.5,
+                    version % 3 == 0 ? "true" : "false", version / 2);
+}
+
+void refreshStatus(void *context)
+{
+    StatusPage *page = static_cast<StatusPage *>(context);
+    unsigned version = page->version.load();
+    if (version != page->renderedVersion && page->response.render(renderStatus, &version))
+    {
+        page->renderedVersion = version;
+    }
+    page->serverAllocations.store(threadAllocations());
+    page->refreshes.fetch_add(1);
+}
+
+/**
+ * @brief One polling client's measurements.
+ */
+struct Poller
+{
+    std::vector<uint32_t> requestMicros;
+    std::vector<uint32_t> connectMicros;
+    uint32_t bad;         ///< Replies that were not the current /status or an older one.
+    uint32_t wentBack;    ///< Replies older than one already seen.
+    uint32_t reconnects;
+
+    Poller() : bad(0), wentBack(0), reconnects(0)
+    {
+        requestMicros.reserve(200000);
+    }
+};
+
+uint32_t microsSince(std::chrono::steady_clock::time_point start)
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+void poll(uint16_t port, const std::atomic<bool> &stopping, Poller &poller)
+{
+    LoopbackClient client;
+    HttpReply reply;
+    char expected[256];
+    unsigned lastVersion = 0;
+    // A poller still waiting in the backlog goes on until it is answered once
+    while (!stopping.load() || poller.requestMicros.empty())
+    {
+        if (!client.isOpen())
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (!client.connect(port))
+            {
+                continue;
+            }
+            poller.connectMicros.push_back(microsSince(start));
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (!client.send("GET /status HTTP/1.1\r\nHost: faucet\r\n\r\n") || !client.read(reply))
+        {
+            // Rotated out after MAX_REQUESTS; the request was never read
+            client.close();
+            poller.reconnects++;
+            continue;
+        }
+        poller.requestMicros.push_back(microsSince(start));
+
+        unsigned version = 0;
+        if (reply.status != 200 || sscanf(reply.body.c_str(), "{\"version\":%u", &version) != 1 ||
+            renderStatus(expected, sizeof(expected), &version) != reply.body.size() || reply.body != expected)
+        {
+            poller.bad++;
+            continue;
+        }
+        if (version < lastVersion)
+        {
+            poller.wentBack++;
+        }
+        lastVersion = version;
+    }
+}
+
+uint32_t percentile(const std::vector<uint32_t> &sorted, double fraction)
+{
+    return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+}
+
+void waitForRefreshes(const StatusPage &page, uint32_t count)
+{
+    uint32_t until = page.refreshes.load() + count;
+    while (page.refreshes.load() < until)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void runLoad(uint32_t pollerCount)
+{
+    StatusPage page;
+    StatusServer server(0);
+    ASSERT_TRUE(server.addRoute("/status", &page.response));
+    ASSERT_TRUE(server.begin());
+    ASSERT_TRUE(server.start(refreshStatus, &page));
+    waitForRefreshes(page, 1);
+    uint64_t allocationsBefore = page.serverAllocations.load();
+    uint32_t rendersBefore = page.response.getRenders();
+
+    std::atomic<bool> stopping(false);
+    std::vector<Poller> pollers(pollerCount);
+    std::vector<std::thread> threads;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (Poller &poller : pollers)
+    {
+        threads.emplace_back(poll, server.getPort(), std::cref(stopping), std::ref(poller));
+    }
+    while (microsSince(start) < LOAD_MILLIS * 1000)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(STATE_CHANGE_MILLIS));
+        page.version.fetch_add(1);
+    }
+    stopping.store(true);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = microsSince(start) / 1e6;
+    waitForRefreshes(page, 2);
+    uint64_t serverAllocations = page.serverAllocations.load() - allocationsBefore;
+    server.stop();
+
+    std::vector<uint32_t> requests;
+    std::vector<uint32_t> connects;
+    uint32_t bad = 0;
+    uint32_t wentBack = 0;
+    uint32_t reconnects = 0;
+    for (const Poller &poller : pollers)
+    {
+        requests.insert(requests.end(), poller.requestMicros.begin(), poller.requestMicros.end());
+        connects.insert(connects.end(), poller.connectMicros.begin(), poller.connectMicros.end());
+        bad += poller.bad;
+        wentBack += poller.wentBack;
+        reconnects += poller.reconnects;
+    }
+    std::sort(requests.begin(), requests.end());
+    std::sort(connects.begin(), connects.end());
+
+    const unsigned slots = StatusServer::MAX_CONNECTIONS;
+    printf("[ http     ] %u keep-alive pollers on %u slots: %.0f requests/s, p50 %u us, p99 %u us, "
+           "p99.9 %u us, max %u us\n",
+           (unsigned)pollerCount, slots, requests.size() / seconds, percentile(requests, 0.5),
+           percentile(requests, 0.99), percentile(requests, 0.999), requests.empty() ? 0 : requests.back());
+    printf("[ http     ] %lu connections (%u rotated out), connect p99 %u us, max %u us; "
+           "/status rendered %u times, %u refused; %llu server-thread allocations\n",
+           (unsigned long)connects.size(), (unsigned)reconnects, percentile(connects, 0.99),
+           connects.empty() ? 0 : connects.back(), (unsigned)(page.response.getRenders() - rendersBefore),
+           (unsigned)page.response.getRefused(), (unsigned long long)serverAllocations);
+
+    // Every answer complete and a version that was current, never older than one already seen
+    EXPECT_EQ(bad, 0u);
+    EXPECT_EQ(wentBack, 0u);
+    EXPECT_EQ(server.getServed(), (uint32_t)requests.size());
+    EXPECT_EQ(server.getFailed(), 0u);
+    EXPECT_EQ(server.getTimedOut(), 0u);
+    EXPECT_EQ(server.getAccepted(), (uint32_t)connects.size());
+    // Renders follow the state; requests only parse and send
+    EXPECT_GT(page.response.getRenders() - rendersBefore, 1u);
+    EXPECT_EQ(serverAllocations, 0u);
+}
+
+TEST(StatusServerBench, FourPollers)
+{
+    runLoad(4);
+}
+
+TEST(StatusServerBench, SixteenPollers)
+{
+    runLoad(16);
+}
+
+} // namespace
@@ -0,0 +1,333 @@
+/**
+ * @file Arduino.cpp
+ * @brief Implements the host Arduino core on top of VirtualBoard.
+ */
+
+#include "Arduino.h"
+#include "VirtualBoard.h"
+#include <stdarg.h>
+
+HardwareSerial Serial;
+
+unsigned long millis()
+{
+    return (uint32_t)(VirtualBoard::current().now() / 1000);
+}
+
+unsigned long micros()
+{
+    return (uint32_t)VirtualBoard::current().now();
+}
+
+void delay(unsigned long ms)
+{
+    VirtualBoard::current().advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    VirtualBoard::current().advance(us);
+}
+
+void yield()
+{
+    VirtualBoard::current().advance(0);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    VirtualBoard::current().setMode(pin, mode);
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    VirtualBoard::current().write(pin, level);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return VirtualBoard::current().read(pin);
+}
+
+uint16_t analogRead(uint8_t pin)
+{
+    return VirtualBoard::current().readAnalog(pin);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout)
+{
+    return VirtualBoard::current().measurePulse(pin, state, timeout);
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode)
+{
+    VirtualBoard::current().attachIsr(pin, isr, mode);
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    VirtualBoard::current().detachIsr(pin);
+}
+
+String::String(const char *text) : text(text != nullptr ? text : "") {}
+
+String::String(int value) : text(std::to_string(value)) {}
+
+String::String(unsigned int value) : text(std::to_string(value)) {}
+
+String::String(long value) : text(std::to_string(value)) {}
+
+String::String(unsigned long value) : text(std::to_string(value)) {}
+
+String::String(double value, unsigned int digits)
+{
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)digits, value);
+    text = buffer;
+}
+
+String String::operator+(const String &other) const
+{
+    String joined(*this);
+    joined += other;
+    return joined;
+}
+
+String &String::operator+=(const String &other)
+{
+    text += other.text;
+    return *this;
+}
+
+bool String::operator==(const String &other) const
+{
+    return text == other.text;
+}
+
+const char *String::c_str() const
+{
+    return text.c_str();
+}
+
+unsigned int String::length() const
+{
+    return (unsigned int)text.size();
+}
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t written = 0;
+    while (written < size && write(buffer[written]) == 1)
+    {
+        written++;
+    }
+    return written;
+}
+
+size_t Print::write(const char *text)
+{
+    return text != nullptr ? write((const uint8_t *)text, strlen(text)) : 0;
+}
+
+/**
+ * @brief Formats an integer in base 2 to 16, as the Arduino Print class does.
+ */
+static size_t printNumber(Print &out, unsigned long value, int base)
+{
+    char buffer[8 * sizeof(long) + 1];
+    char *digit = &buffer[sizeof(buffer) - 1];
+    *digit = '\0';
+    if (base < 2)
+    {
+        base = DEC;
+    }
+    do
+    {
+        unsigned long rest = value % base;
+        value /= base;
+        *--digit = rest < 10 ? '0' + rest : 'A' + rest - 10;
+    } while (value != 0);
+    return out.write(digit);
+}
+
+size_t Print::print(const String &text)
+{
+    return write(text.c_str());
+}
+
+size_t Print::print(const char *text)
+{
+    return write(text);
+}
+
+size_t Print::print(char value)
+{
+    return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned char value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base)
+{
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == DEC && value < 0)
+    {
+        return print('-') + printNumber(*this, -(unsigned long)value, base);
+    }
+    return printNumber(*this, (unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    return printNumber(*this, value, base);
+}
+
+size_t Print::print(double value, int digits)
+{
+    if (isnan(value))
+    {
+        return print("nan");
+    }
+    if (isinf(value))
+    {
+        return print("inf");
+    }
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return print(buffer);
+}
+
+size_t Print::println(const String &text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(const char *text)
+{
+    return print(text) + println();
+}
+
+size_t Print::println(char value)
+{
+    return print(value) + println();
+}
+
+size_t Print::println(unsigned char value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned int value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(unsigned long value, int base)
+{
+    return print(value, base) + println();
+}
+
+size_t Print::println(double value, int digits)
+{
+    return print(value, digits) + println();
+}
+
+size_t Print::println()
+{
+    return write("\r\n");
+}
+
+size_t Print::printf(const char *format, ...)
+{
+    char buffer[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, arguments);
+    va_end(arguments);
+    if (length < 0)
+    {
+        return 0;
+    }
+    return write((const uint8_t *)buffer, (size_t)length < sizeof(buffer) ? length : sizeof(buffer) - 1);
+}
+
+size_t HardwareSerial::setTxBufferSize(size_t size)
+{
+    VirtualBoard::current().setSerialBuffer(size);
+    return size;
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+    VirtualBoard::current().setBaud(baud);
+}
+
+void HardwareSerial::end() {}
+
+HardwareSerial::operator bool() const
+{
+    return true;
+}
+
+size_t HardwareSerial::write(uint8_t value)
+{
+    VirtualBoard::current().writeSerial(value);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    VirtualBoard &board = VirtualBoard::current();
+    for (size_t i = 0; i < size; i++)
+    {
+        board.writeSerial(buffer[i]);
+    }
+    return size;
+}
+
+int HardwareSerial::available()
+{
+    return 0;
+}
+
+int HardwareSerial::read()
+{
+    return -1;
+}
+
+int HardwareSerial::availableForWrite()
+{
+    return (int)VirtualBoard::current().serialRoom();
+}
+
+void HardwareSerial::flush()
+{
+    VirtualBoard::current().flushSerial();
+}
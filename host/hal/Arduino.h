@@ -0,0 +1,141 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/**
+ * @file Arduino.h
+ * @brief Arduino core API for host builds, running on the virtual time of VirtualBoard.
+ *
+ * Covers what the sketches and libraries of this repository call, with the ESP32 core's
+ * constants. Every call goes to the board bound to the calling thread (VirtualBoard::Scope).
+ * unsigned long is 64 bits wide on Linux, but millis() and micros() still wrap at 32 bits as
+ * on the ESP32.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+
+#define IRAM_ATTR
+#define ARDUINO_ISR_ATTR
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout = 1000000UL);
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+inline int digitalPinToInterrupt(int pin)
+{
+    return pin;
+}
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// Interrupts only fire while a test drives an input between sketch calls, never inside one
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class String
+{
+private:
+    std::string text;
+
+public:
+    String(const char *text = "");
+    String(int value);
+    String(unsigned int value);
+    String(long value);
+    String(unsigned long value);
+    String(double value, unsigned int digits = 2);
+
+    String operator+(const String &other) const;
+    String &operator+=(const String &other);
+    bool operator==(const String &other) const;
+    const char *c_str() const;
+    unsigned int length() const;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text);
+
+    size_t print(const String &text);
+    size_t print(const char *text);
+    size_t print(char value);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println(const String &text);
+    size_t println(const char *text);
+    size_t println(char value);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(double value, int digits = 2);
+    size_t println();
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+/**
+ * @brief The UART console: bytes go to the bound board's UART model.
+ */
+class HardwareSerial : public Print
+{
+public:
+    size_t setTxBufferSize(size_t size);
+    void begin(unsigned long baud);
+    void end();
+    operator bool() const;
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available();
+    int read();
+    int availableForWrite();
+    void flush();
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H
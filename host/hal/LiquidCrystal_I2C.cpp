@@ -0,0 +1,116 @@
+/**
+ * @file LiquidCrystal_I2C.cpp
+ * @brief Implements the host HD44780 over the host Wire.
+ */
+
+#include "LiquidCrystal_I2C.h"
+#include "Wire.h"
+
+static const uint8_t RS_BIT = 0x01;
+static const uint8_t EN_BIT = 0x04;
+static const uint8_t BACKLIGHT_BIT = 0x08;
+
+LiquidCrystal_I2C::LiquidCrystal_I2C(uint8_t address, uint8_t cols, uint8_t rows)
+    : address(address), cols(cols), rows(rows), backlightBit(BACKLIGHT_BIT) {}
+
+void LiquidCrystal_I2C::init()
+{
+    Wire.begin();
+    begin(cols, rows);
+}
+
+void LiquidCrystal_I2C::begin(uint8_t cols, uint8_t rows)
+{
+    this->cols = cols;
+    this->rows = rows;
+
+    // Power-up wait and the datasheet's 4-bit initialization sequence
+    delay(50);
+    expanderWrite(backlightBit);
+    delay(1000);
+    write4bits(0x03 << 4);
+    delayMicroseconds(4500);
+    write4bits(0x03 << 4);
+    delayMicroseconds(4500);
+    write4bits(0x03 << 4);
+    delayMicroseconds(150);
+    write4bits(0x02 << 4);
+
+    command(0x20 | 0x08);        // Function set: 4-bit, two lines, 5x8
+    command(0x08 | 0x04);        // Display on, cursor off
+    clear();
+    command(0x04 | 0x02);        // Entry mode: left to right
+    home();
+}
+
+void LiquidCrystal_I2C::clear()
+{
+    command(0x01);
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::home()
+{
+    command(0x02);
+    delayMicroseconds(2000);
+}
+
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row)
+{
+    static const uint8_t rowOffsets[] = {0x00, 0x40, 0x14, 0x54};
+    if (row >= rows || row > 3)
+    {
+        row = rows > 0 ? rows - 1 : 0;
+    }
+    command(0x80 | (col + rowOffsets[row]));
+}
+
+void LiquidCrystal_I2C::backlight()
+{
+    backlightBit = BACKLIGHT_BIT;
+    expanderWrite(0);
+}
+
+void LiquidCrystal_I2C::noBacklight()
+{
+    backlightBit = 0;
+    expanderWrite(0);
+}
+
+size_t LiquidCrystal_I2C::write(uint8_t value)
+{
+    send(value, RS_BIT);
+    return 1;
+}
+
+void LiquidCrystal_I2C::command(uint8_t value)
+{
+    send(value, 0);
+}
+
+void LiquidCrystal_I2C::send(uint8_t value, uint8_t mode)
+{
+    write4bits((value & 0xF0) | mode);
+    write4bits(((value << 4) & 0xF0) | mode);
+}
+
+void LiquidCrystal_I2C::write4bits(uint8_t value)
+{
+    expanderWrite(value);
+    pulseEnable(value);
+}
+
+void LiquidCrystal_I2C::expanderWrite(uint8_t data)
+{
+    Wire.beginTransmission(address);
+    Wire.write(data | backlightBit);
+    Wire.endTransmission();
+}
+
+void LiquidCrystal_I2C::pulseEnable(uint8_t data)
+{
+    expanderWrite(data | EN_BIT);
+    delayMicroseconds(1);
+    expanderWrite(data & ~EN_BIT);
+    delayMicroseconds(50);
+}
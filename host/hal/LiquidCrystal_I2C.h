@@ -0,0 +1,42 @@
+#ifndef LIQUID_CRYSTAL_I2C_H
+#define LIQUID_CRYSTAL_I2C_H
+
+/**
+ * @file LiquidCrystal_I2C.h
+ * @brief Host HD44780 behind a PCF8574 backpack, with the library's transfers and waits.
+ *
+ * Every expander write is its own Wire transfer and every command waits as the Arduino library
+ * does, so initialization and clear() cost the same bus and wall time as on the device.
+ */
+
+#include "Arduino.h"
+
+class LiquidCrystal_I2C : public Print
+{
+private:
+    uint8_t address;
+    uint8_t cols;
+    uint8_t rows;
+    uint8_t backlightBit;
+
+    void command(uint8_t value);
+    void send(uint8_t value, uint8_t mode);
+    void write4bits(uint8_t value);
+    void expanderWrite(uint8_t data);
+    void pulseEnable(uint8_t data);
+
+public:
+    LiquidCrystal_I2C(uint8_t address, uint8_t cols, uint8_t rows);
+
+    void init();
+    void begin(uint8_t cols, uint8_t rows);
+    void clear();
+    void home();
+    void setCursor(uint8_t col, uint8_t row);
+    void backlight();
+    void noBacklight();
+    size_t write(uint8_t value) override;
+    using Print::write;
+};
+
+#endif // LIQUID_CRYSTAL_I2C_H
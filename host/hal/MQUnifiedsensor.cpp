@@ -0,0 +1,103 @@
+/**
+ * @file MQUnifiedsensor.cpp
+ * @brief Implements the host subset of MQUnifiedsensor, with the library's formulas.
+ */
+
+#include "MQUnifiedsensor.h"
+
+MQUnifiedsensor::MQUnifiedsensor(String board, float voltageResolution, int adcBitResolution, int pin, String type)
+    : voltResolution(voltageResolution), adcBits(adcBitResolution), pin(pin), regressionMethod(1),
+      a(0), b(0), r0(0), rl(10), sensorVolt(0) {}
+
+void MQUnifiedsensor::init()
+{
+    pinMode(pin, INPUT);
+}
+
+void MQUnifiedsensor::update()
+{
+    sensorVolt = getVoltage();
+}
+
+void MQUnifiedsensor::externalADCUpdate(float volt)
+{
+    sensorVolt = volt;
+}
+
+void MQUnifiedsensor::setRegressionMethod(int method)
+{
+    regressionMethod = method;
+}
+
+void MQUnifiedsensor::setA(float a)
+{
+    this->a = a;
+}
+
+void MQUnifiedsensor::setB(float b)
+{
+    this->b = b;
+}
+
+void MQUnifiedsensor::setR0(float r0)
+{
+    this->r0 = r0;
+}
+
+void MQUnifiedsensor::setRL(float rl)
+{
+    this->rl = rl;
+}
+
+float MQUnifiedsensor::getR0() const
+{
+    return r0;
+}
+
+float MQUnifiedsensor::getRL() const
+{
+    return rl;
+}
+
+float MQUnifiedsensor::getVoltage(bool read, bool injected, int value)
+{
+    if (injected)
+    {
+        return value * voltResolution / ((1 << adcBits) - 1);
+    }
+    if (!read)
+    {
+        return sensorVolt;
+    }
+    // The library averages a few reads, 20 ms apart
+    float sum = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        sum += analogRead(pin);
+        delay(20);
+    }
+    return (sum / 2) * voltResolution / ((1 << adcBits) - 1);
+}
+
+float MQUnifiedsensor::calibrate(float ratioInCleanAir)
+{
+    float rsAir = (voltResolution * rl) / sensorVolt - rl;
+    if (rsAir < 0)
+    {
+        rsAir = 0;
+    }
+    float r0 = rsAir / ratioInCleanAir;
+    return r0 < 0 ? 0 : r0;
+}
+
+float MQUnifiedsensor::readSensor(bool isMQ303A, float correctionFactor, bool injected)
+{
+    float rs = (voltResolution * rl) / sensorVolt - rl;
+    if (rs < 0)
+    {
+        rs = 0;
+    }
+    float ratio = rs / r0;
+    float ppm = regressionMethod == 1 ? a * powf(ratio, b) : powf(10, (log10f(ratio) - b) / a);
+    return ppm < 0 ? 0 : ppm;
+}
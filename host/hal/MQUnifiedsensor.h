@@ -0,0 +1,44 @@
+#ifndef MQ_UNIFIED_SENSOR_H
+#define MQ_UNIFIED_SENSOR_H
+
+/**
+ * @file MQUnifiedsensor.h
+ * @brief Host subset of the MQUnifiedsensor library: the divider and regression model only.
+ *
+ * Readings come from externalADCUpdate() or from analogRead() on the bound VirtualBoard.
+ */
+
+#include "Arduino.h"
+
+class MQUnifiedsensor
+{
+private:
+    float voltResolution;
+    int adcBits;
+    int pin;
+    int regressionMethod;
+    float a;
+    float b;
+    float r0;
+    float rl;
+    float sensorVolt;
+
+public:
+    MQUnifiedsensor(String board, float voltageResolution, int adcBitResolution, int pin, String type);
+
+    void init();
+    void update();
+    void externalADCUpdate(float volt);
+    void setRegressionMethod(int method);
+    void setA(float a);
+    void setB(float b);
+    void setR0(float r0);
+    void setRL(float rl);
+    float getR0() const;
+    float getRL() const;
+    float getVoltage(bool read = true, bool injected = false, int value = 0);
+    float calibrate(float ratioInCleanAir);
+    float readSensor(bool isMQ303A = false, float correctionFactor = 0.0, bool injected = false);
+};
+
+#endif // MQ_UNIFIED_SENSOR_H
@@ -0,0 +1,414 @@
+/**
+ * @file VirtualBoard.cpp
+ * @brief Implements the VirtualBoard class.
+ */
+
+#include "VirtualBoard.h"
+#include "Arduino.h"
+#include <math.h>
+
+static thread_local VirtualBoard *boundBoard = nullptr;
+
+VirtualBoard::Scope::Scope(VirtualBoard &board) : previous(boundBoard)
+{
+    boundBoard = &board;
+}
+
+VirtualBoard::Scope::~Scope()
+{
+    boundBoard = previous;
+}
+
+VirtualBoard::VirtualBoard()
+    : nowMicros(0), scheduledCount(0), preemptedMicros(0), levels{}, modes{}, analogValues{}, isrs{}, isrModes{},
+      pinWrites(0), pinWatcher(nullptr), pinWatcherContext(nullptr),
+      uartBytesPerSecond(11520), uartForeignShare(0), uartQueueBytes(UART_FIFO_BYTES), uartIdleAtMicros(0), uartBlockedMicros(0), uartBytes(0),
+      serialCapture(false), serialWatcher(nullptr), serialWatcherContext(nullptr),
+      i2cPresent{}, i2cStretchMicrosPerByte(0), i2cTransfers(0), i2cBytes(0), i2cBusyMicros(0),
+      wifiStarted(false), wifiReachable(true), wifiConnectMicros(1500000), wifiUpAtMicros(0)
+{
+    for (int pin = 0; pin < PIN_COUNT; pin++)
+    {
+        echoCm[pin] = -1;
+    }
+}
+
+VirtualBoard &VirtualBoard::current()
+{
+    static thread_local VirtualBoard unbound;
+    return boundBoard != nullptr ? *boundBoard : unbound;
+}
+
+uint64_t VirtualBoard::now() const
+{
+    return nowMicros;
+}
+
+void VirtualBoard::advance(uint64_t micros)
+{
+    advanceTo(nowMicros + micros);
+}
+
+void VirtualBoard::advanceTo(uint64_t atMicros)
+{
+    if (atMicros < nowMicros)
+    {
+        atMicros = nowMicros;
+    }
+    runDue(atMicros);
+    nowMicros = atMicros;
+
+    uint64_t resumed = resumeAfterPreemption(nowMicros);
+    if (resumed > nowMicros)
+    {
+        preemptedMicros += resumed - nowMicros;
+        runDue(resumed);
+        nowMicros = resumed;
+    }
+}
+
+void VirtualBoard::runDue(uint64_t untilMicros)
+{
+    // Copy before popping: an action may schedule the next one
+    while (!schedule.empty() && schedule.top().atMicros <= untilMicros)
+    {
+        Scheduled due = schedule.top();
+        schedule.pop();
+        if (due.atMicros > nowMicros)
+        {
+            nowMicros = due.atMicros;
+        }
+        due.action(due.context);
+    }
+}
+
+uint64_t VirtualBoard::resumeAfterPreemption(uint64_t micros)
+{
+    // Windows that ended are gone for good; overlapping windows chain
+    while (!preemptions.empty() && preemptions.front().endMicros <= nowMicros)
+    {
+        preemptions.pop_front();
+    }
+
+    for (const Preemption &window : preemptions)
+    {
+        if (window.startMicros > micros)
+        {
+            break;
+        }
+        if (window.endMicros > micros)
+        {
+            micros = window.endMicros;
+        }
+    }
+    return micros;
+}
+
+void VirtualBoard::at(uint64_t atMicros, Action action, void *context)
+{
+    schedule.push(Scheduled{atMicros, scheduledCount++, action, context});
+}
+
+void VirtualBoard::setMode(int pin, int mode)
+{
+    if (pin >= 0 && pin < PIN_COUNT)
+    {
+        modes[pin] = (uint8_t)mode;
+    }
+}
+
+int VirtualBoard::getMode(int pin) const
+{
+    return pin >= 0 && pin < PIN_COUNT ? modes[pin] : 0;
+}
+
+void VirtualBoard::write(int pin, int level)
+{
+    if (pin < 0 || pin >= PIN_COUNT)
+    {
+        return;
+    }
+    levels[pin] = level ? HIGH : LOW;
+    pinWrites++;
+    if (pinWatcher != nullptr)
+    {
+        pinWatcher(pin, levels[pin], nowMicros, pinWatcherContext);
+    }
+}
+
+void VirtualBoard::drive(int pin, int level)
+{
+    if (pin < 0 || pin >= PIN_COUNT)
+    {
+        return;
+    }
+    uint8_t previous = levels[pin];
+    levels[pin] = level ? HIGH : LOW;
+    if (isrs[pin] == nullptr || previous == levels[pin])
+    {
+        return;
+    }
+    bool rising = levels[pin] == HIGH;
+    if (isrModes[pin] == CHANGE || (isrModes[pin] == RISING && rising) || (isrModes[pin] == FALLING && !rising))
+    {
+        isrs[pin]();
+    }
+}
+
+int VirtualBoard::read(int pin) const
+{
+    return pin >= 0 && pin < PIN_COUNT ? levels[pin] : LOW;
+}
+
+void VirtualBoard::setAnalog(int pin, uint16_t value)
+{
+    if (pin >= 0 && pin < PIN_COUNT)
+    {
+        analogValues[pin] = value > 4095 ? 4095 : value;
+    }
+}
+
+uint16_t VirtualBoard::readAnalog(int pin)
+{
+    // Sample and hold at the start of the conversion
+    uint16_t value = pin >= 0 && pin < PIN_COUNT ? analogValues[pin] : 0;
+    advance(ANALOG_READ_MICROS);
+    return value;
+}
+
+void VirtualBoard::setEchoDistance(int pin, float cm)
+{
+    if (pin >= 0 && pin < PIN_COUNT)
+    {
+        echoCm[pin] = cm;
+    }
+}
+
+unsigned long VirtualBoard::measurePulse(int pin, int level, unsigned long timeoutMicros)
+{
+    float cm = pin >= 0 && pin < PIN_COUNT && level == HIGH ? echoCm[pin] : -1;
+    if (cm < 0)
+    {
+        advance(timeoutMicros);
+        return 0;
+    }
+    // Round trip at 343 m/s, the inverse of UltrasoundSensor's conversion
+    double pulse = cm * 2 / 0.0343;
+    if (ECHO_LEAD_MICROS + pulse > timeoutMicros)
+    {
+        advance(timeoutMicros);
+        return 0;
+    }
+    advance(ECHO_LEAD_MICROS + (uint64_t)pulse);
+    return (unsigned long)lround(pulse);
+}
+
+void VirtualBoard::attachIsr(int pin, void (*isr)(), int mode)
+{
+    if (pin >= 0 && pin < PIN_COUNT)
+    {
+        isrs[pin] = isr;
+        isrModes[pin] = mode;
+    }
+}
+
+void VirtualBoard::detachIsr(int pin)
+{
+    if (pin >= 0 && pin < PIN_COUNT)
+    {
+        isrs[pin] = nullptr;
+    }
+}
+
+void VirtualBoard::watchPins(PinWatcher watcher, void *context)
+{
+    pinWatcher = watcher;
+    pinWatcherContext = context;
+}
+
+uint32_t VirtualBoard::getPinWrites() const
+{
+    return pinWrites;
+}
+
+void VirtualBoard::setBaud(uint32_t baud)
+{
+    // 8N1: ten bits per byte
+    uartBytesPerSecond = baud / 10 > 0 ? baud / 10 : 1;
+}
+
+void VirtualBoard::setSerialLoad(float share)
+{
+    uartForeignShare = share < 0 ? 0 : (share > 0.99f ? 0.99f : share);
+}
+
+void VirtualBoard::setSerialBuffer(size_t driverBytes)
+{
+    uartQueueBytes = UART_FIFO_BYTES + driverBytes;
+}
+
+void VirtualBoard::writeSerial(uint8_t byte)
+{
+    double byteMicros = 1e6 / (uartBytesPerSecond * (1.0 - uartForeignShare));
+    if (uartIdleAtMicros < nowMicros)
+    {
+        uartIdleAtMicros = nowMicros;
+    }
+
+    // Wait for the FIFO to have room for this byte
+    double roomAt = uartIdleAtMicros - (uartQueueBytes - 1) * byteMicros;
+    if (roomAt > nowMicros)
+    {
+        uint64_t start = nowMicros;
+        advanceTo((uint64_t)ceil(roomAt));
+        uartBlockedMicros += nowMicros - start;
+        if (uartIdleAtMicros < nowMicros)
+        {
+            uartIdleAtMicros = nowMicros;
+        }
+    }
+    uartIdleAtMicros += byteMicros;
+    uartBytes++;
+
+    if (serialCapture)
+    {
+        serialText.push_back((char)byte);
+    }
+    if (serialWatcher != nullptr)
+    {
+        serialWatcher(&byte, 1, nowMicros, serialWatcherContext);
+    }
+}
+
+void VirtualBoard::flushSerial()
+{
+    if (uartIdleAtMicros > nowMicros)
+    {
+        uint64_t start = nowMicros;
+        advanceTo((uint64_t)ceil(uartIdleAtMicros));
+        uartBlockedMicros += nowMicros - start;
+    }
+}
+
+size_t VirtualBoard::serialRoom()
+{
+    if (uartIdleAtMicros <= nowMicros)
+    {
+        return uartQueueBytes;
+    }
+    double byteMicros = 1e6 / (uartBytesPerSecond * (1.0 - uartForeignShare));
+    size_t queued = (size_t)ceil((uartIdleAtMicros - nowMicros) / byteMicros);
+    return queued >= uartQueueBytes ? 0 : uartQueueBytes - queued;
+}
+
+void VirtualBoard::captureSerial(bool enabled)
+{
+    serialCapture = enabled;
+}
+
+const std::string &VirtualBoard::getSerialText() const
+{
+    return serialText;
+}
+
+void VirtualBoard::clearSerialText()
+{
+    serialText.clear();
+}
+
+void VirtualBoard::watchSerial(SerialWatcher watcher, void *context)
+{
+    serialWatcher = watcher;
+    serialWatcherContext = context;
+}
+
+uint64_t VirtualBoard::getSerialBlockedMicros() const
+{
+    return uartBlockedMicros;
+}
+
+uint64_t VirtualBoard::getSerialBytes() const
+{
+    return uartBytes;
+}
+
+void VirtualBoard::addI2cDevice(uint8_t address)
+{
+    i2cPresent[address & 0x7F] = true;
+}
+
+void VirtualBoard::setI2cStretch(uint32_t microsPerByte)
+{
+    i2cStretchMicrosPerByte = microsPerByte;
+}
+
+bool VirtualBoard::transferI2c(uint8_t address, size_t length, uint32_t clockHz)
+{
+    uint64_t bytes = length + 1;
+    uint64_t micros = I2C_OVERHEAD_MICROS + bytes * 9 * 1000000ULL / (clockHz > 0 ? clockHz : 100000) +
+                      bytes * i2cStretchMicrosPerByte;
+    advance(micros);
+    i2cTransfers++;
+    i2cBytes += bytes;
+    i2cBusyMicros += micros;
+    return i2cPresent[address & 0x7F];
+}
+
+uint32_t VirtualBoard::getI2cTransfers() const
+{
+    return i2cTransfers;
+}
+
+uint64_t VirtualBoard::getI2cBytes() const
+{
+    return i2cBytes;
+}
+
+uint64_t VirtualBoard::getI2cBusyMicros() const
+{
+    return i2cBusyMicros;
+}
+
+void VirtualBoard::preempt(uint64_t startMicros, uint32_t lengthMicros)
+{
+    Preemption window{startMicros, startMicros + lengthMicros};
+    size_t i = preemptions.size();
+    preemptions.push_back(window);
+    while (i > 0 && preemptions[i - 1].startMicros > window.startMicros)
+    {
+        preemptions[i] = preemptions[i - 1];
+        i--;
+    }
+    preemptions[i] = window;
+}
+
+uint64_t VirtualBoard::getPreemptedMicros() const
+{
+    return preemptedMicros;
+}
+
+void VirtualBoard::setWifiConnectTime(uint32_t micros)
+{
+    wifiConnectMicros = micros;
+}
+
+void VirtualBoard::beginWifi()
+{
+    wifiStarted = true;
+    wifiUpAtMicros = nowMicros + wifiConnectMicros;
+}
+
+void VirtualBoard::setWifiReachable(bool reachable)
+{
+    // The station reconnects on its own once the access point is back
+    if (reachable && !wifiReachable)
+    {
+        wifiUpAtMicros = nowMicros + wifiConnectMicros;
+    }
+    wifiReachable = reachable;
+}
+
+bool VirtualBoard::isWifiConnected() const
+{
+    return wifiStarted && wifiReachable && nowMicros >= wifiUpAtMicros;
+}
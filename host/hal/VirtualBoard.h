@@ -0,0 +1,281 @@
+#ifndef VIRTUAL_BOARD_H
+#define VIRTUAL_BOARD_H
+
+/**
+ * @file VirtualBoard.h
+ * @brief Declares the VirtualBoard class, the host stand-in for one ESP32 and its wiring.
+ *
+ * The host Arduino core (Arduino.h, Wire.h, WiFi.h in this folder) forwards every call to the
+ * board bound to the calling thread. A board owns a virtual microsecond clock, the pin levels,
+ * the analog inputs and the echo each ultrasound pin would see, and models the peripherals the
+ * sketches wait on:
+ *
+ * - UART: a 128-byte transmit FIFO, plus the driver buffer set with setTxBufferSize(), drained at
+ *   the configured baud rate. A full queue blocks the writer, as Serial does on the ESP32. Other
+ *   traffic can take a share of the line.
+ * - I2C: each transfer takes its bit time at the bus clock, plus optional clock stretching.
+ * - CPU: preemption windows, during which the sketch's task does not run (the WiFi task during
+ *   a reconnect, for example). Time that would end inside a window ends at its end.
+ *
+ * Time only passes where the firmware waits: delay(), pulseIn(), a full UART, an I2C transfer,
+ * analogRead(). Code between those calls takes no virtual time. Stimulus is scheduled on the
+ * same clock with at(), and runs at its exact time even while the sketch is inside a delay(), so
+ * interrupts attached to an input fire when the edge happens.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <queue>
+#include <string>
+#include <vector>
+
+class VirtualBoard
+{
+public:
+    static const int PIN_COUNT = 40;
+    static const uint32_t ANALOG_READ_MICROS = 10;   ///< One SAR conversion through analogRead().
+    static const uint32_t ECHO_LEAD_MICROS = 460;    ///< HC-SR04 trigger to echo start.
+    static const size_t UART_FIFO_BYTES = 128;       ///< ESP32 UART transmit FIFO, no driver buffer.
+    static const uint32_t I2C_OVERHEAD_MICROS = 20;  ///< Start, stop and driver setup per transfer.
+
+    /**
+     * @brief Scheduled stimulus or observer work.
+     */
+    typedef void (*Action)(void *context);
+
+    /**
+     * @brief Told about every digitalWrite(), also writes that keep the level.
+     */
+    typedef void (*PinWatcher)(int pin, int level, uint64_t atMicros, void *context);
+
+    /**
+     * @brief Told about every byte the sketch hands to Serial.
+     */
+    typedef void (*SerialWatcher)(const uint8_t *data, size_t length, uint64_t atMicros, void *context);
+
+    /**
+     * @brief Binds a board to the calling thread for the lifetime of the scope.
+     */
+    class Scope
+    {
+    private:
+        VirtualBoard *previous;
+
+    public:
+        explicit Scope(VirtualBoard &board);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+private:
+    struct Scheduled
+    {
+        uint64_t atMicros;
+        uint64_t sequence; ///< Keeps actions due at the same time in the order they were added.
+        Action action;
+        void *context;
+
+        bool operator>(const Scheduled &other) const
+        {
+            return atMicros != other.atMicros ? atMicros > other.atMicros : sequence > other.sequence;
+        }
+    };
+
+    struct Preemption
+    {
+        uint64_t startMicros;
+        uint64_t endMicros;
+    };
+
+    uint64_t nowMicros;
+    uint64_t scheduledCount;
+    std::priority_queue<Scheduled, std::vector<Scheduled>, std::greater<Scheduled>> schedule;
+    std::deque<Preemption> preemptions; ///< Sorted by start; windows that ended are dropped.
+    uint64_t preemptedMicros;
+
+    uint8_t levels[PIN_COUNT];
+    uint8_t modes[PIN_COUNT];
+    uint16_t analogValues[PIN_COUNT];
+    float echoCm[PIN_COUNT];
+    void (*isrs[PIN_COUNT])();
+    int isrModes[PIN_COUNT];
+    uint32_t pinWrites;
+    PinWatcher pinWatcher;
+    void *pinWatcherContext;
+
+    uint32_t uartBytesPerSecond;
+    float uartForeignShare;
+    size_t uartQueueBytes; ///< FIFO plus the driver's transmit buffer.
+    double uartIdleAtMicros; ///< When the last queued byte leaves the wire.
+    uint64_t uartBlockedMicros;
+    uint64_t uartBytes;
+    bool serialCapture;
+    std::string serialText;
+    SerialWatcher serialWatcher;
+    void *serialWatcherContext;
+
+    bool i2cPresent[128];
+    uint32_t i2cStretchMicrosPerByte;
+    uint32_t i2cTransfers;
+    uint64_t i2cBytes;
+    uint64_t i2cBusyMicros;
+
+    bool wifiStarted;
+    bool wifiReachable;
+    uint32_t wifiConnectMicros;
+    uint64_t wifiUpAtMicros;
+
+    void runDue(uint64_t untilMicros);
+    uint64_t resumeAfterPreemption(uint64_t micros);
+
+public:
+    VirtualBoard();
+
+    /**
+     * @brief Gets the board bound to the calling thread.
+     * @return The bound board, or a default board of this thread when none is bound.
+     */
+    static VirtualBoard &current();
+
+    // ---- Clock ----
+
+    uint64_t now() const;
+
+    /**
+     * @brief Lets time pass for the sketch, as a wait would.
+     *
+     * Scheduled actions due on the way run at their own time. When the wait ends inside a
+     * preemption window, the sketch resumes when the window ends.
+     * @param micros Time to pass.
+     */
+    void advance(uint64_t micros);
+
+    /**
+     * @brief Same as advance(), up to an absolute time; does nothing for a time already past.
+     */
+    void advanceTo(uint64_t atMicros);
+
+    /**
+     * @brief Runs an action at a virtual time. Actions in the past run on the next time step.
+     */
+    void at(uint64_t atMicros, Action action, void *context);
+
+    // ---- Pins ----
+
+    void setMode(int pin, int mode);
+    int getMode(int pin) const;
+
+    /**
+     * @brief Writes an output, as digitalWrite() does, and tells the pin watcher.
+     */
+    void write(int pin, int level);
+
+    /**
+     * @brief Drives an input from outside; an interrupt attached to the pin fires on its edge.
+     */
+    void drive(int pin, int level);
+
+    int read(int pin) const;
+    void setAnalog(int pin, uint16_t value);
+    uint16_t readAnalog(int pin);
+
+    /**
+     * @brief Sets the distance an HC-SR04 whose echo is on this pin measures.
+     * @param cm Distance in cm; negative for no echo.
+     */
+    void setEchoDistance(int pin, float cm);
+
+    /**
+     * @brief Measures an echo pulse as pulseIn() does, letting the echo time pass.
+     * @return Pulse length in microseconds, 0 on timeout.
+     */
+    unsigned long measurePulse(int pin, int level, unsigned long timeoutMicros);
+
+    void attachIsr(int pin, void (*isr)(), int mode);
+    void detachIsr(int pin);
+    void watchPins(PinWatcher watcher, void *context);
+    uint32_t getPinWrites() const;
+
+    // ---- UART ----
+
+    /**
+     * @brief Sets the line rate; Serial.begin() calls it with the baud rate.
+     */
+    void setBaud(uint32_t baud);
+
+    /**
+     * @brief Gives other traffic a share of the line, so the sketch's bytes drain slower.
+     * @param share 0 for an idle line, up to 0.99.
+     */
+    void setSerialLoad(float share);
+
+    /**
+     * @brief Adds a driver transmit buffer in front of the FIFO, as Serial.setTxBufferSize() does.
+     * @param driverBytes Buffer size; 0 leaves the FIFO alone.
+     */
+    void setSerialBuffer(size_t driverBytes);
+
+    /**
+     * @brief Queues one byte on the UART, blocking while the FIFO is full.
+     */
+    void writeSerial(uint8_t byte);
+
+    /**
+     * @brief Waits until every queued byte has left the wire, as Serial.flush() does.
+     */
+    void flushSerial();
+
+    size_t serialRoom();
+    void captureSerial(bool enabled);
+    const std::string &getSerialText() const;
+    void clearSerialText();
+    void watchSerial(SerialWatcher watcher, void *context);
+    uint64_t getSerialBlockedMicros() const;
+    uint64_t getSerialBytes() const;
+
+    // ---- I2C ----
+
+    void addI2cDevice(uint8_t address);
+
+    /**
+     * @brief Slows every byte down, as a device stretching the clock would.
+     */
+    void setI2cStretch(uint32_t microsPerByte);
+
+    /**
+     * @brief Runs one write transfer: address byte plus payload, 9 bits each at the bus clock.
+     * @return True when a device acknowledged the address.
+     */
+    bool transferI2c(uint8_t address, size_t length, uint32_t clockHz);
+
+    uint32_t getI2cTransfers() const;
+    uint64_t getI2cBytes() const;
+    uint64_t getI2cBusyMicros() const;
+
+    // ---- CPU and WiFi ----
+
+    /**
+     * @brief Takes the CPU from the sketch for a while, like a higher-priority task on its core.
+     */
+    void preempt(uint64_t startMicros, uint32_t lengthMicros);
+
+    uint64_t getPreemptedMicros() const;
+
+    /**
+     * @brief Sets how long WiFi.begin() takes to associate while the access point is reachable.
+     */
+    void setWifiConnectTime(uint32_t micros);
+
+    void beginWifi();
+
+    /**
+     * @brief Drops or restores the access point; a drop disconnects at once.
+     */
+    void setWifiReachable(bool reachable);
+
+    bool isWifiConnected() const;
+};
+
+#endif // VIRTUAL_BOARD_H
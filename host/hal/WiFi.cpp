@@ -0,0 +1,41 @@
+/**
+ * @file WiFi.cpp
+ * @brief Implements the host WiFi station.
+ */
+
+#include "WiFi.h"
+#include "VirtualBoard.h"
+
+WiFiClass WiFi;
+
+IPAddress::IPAddress(uint8_t first, uint8_t second, uint8_t third, uint8_t fourth)
+    : octets{first, second, third, fourth} {}
+
+String IPAddress::toString() const
+{
+    char text[16];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u", octets[0], octets[1], octets[2], octets[3]);
+    return String(text);
+}
+
+int WiFiClass::begin(const char *ssid, const char *password)
+{
+    VirtualBoard::current().beginWifi();
+    return status();
+}
+
+int WiFiClass::status()
+{
+    return VirtualBoard::current().isWifiConnected() ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+IPAddress WiFiClass::localIP()
+{
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+bool WiFiClass::reconnect()
+{
+    VirtualBoard::current().beginWifi();
+    return true;
+}
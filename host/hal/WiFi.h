@@ -0,0 +1,36 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+/**
+ * @file WiFi.h
+ * @brief Host WiFi station: associates after the bound VirtualBoard's connect time.
+ */
+
+#include "Arduino.h"
+
+#define WL_IDLE_STATUS 0
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+
+class IPAddress
+{
+private:
+    uint8_t octets[4];
+
+public:
+    IPAddress(uint8_t first = 0, uint8_t second = 0, uint8_t third = 0, uint8_t fourth = 0);
+    String toString() const;
+};
+
+class WiFiClass
+{
+public:
+    int begin(const char *ssid, const char *password = nullptr);
+    int status();
+    IPAddress localIP();
+    bool reconnect();
+};
+
+extern WiFiClass WiFi;
+
+#endif // WIFI_H
@@ -0,0 +1,59 @@
+/**
+ * @file Wire.cpp
+ * @brief Implements the host I2C master.
+ */
+
+#include "Wire.h"
+#include "VirtualBoard.h"
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : clockHz(100000), address(0), length(0), transmitting(false) {}
+
+bool TwoWire::begin()
+{
+    return true;
+}
+
+void TwoWire::setClock(uint32_t frequency)
+{
+    clockHz = frequency;
+}
+
+uint32_t TwoWire::getClock() const
+{
+    return clockHz;
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    this->address = address;
+    length = 0;
+    transmitting = true;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if (!transmitting || length >= BUFFER_BYTES)
+    {
+        return 0;
+    }
+    length++;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity)
+{
+    size_t written = 0;
+    while (written < quantity && write(data[written]) == 1)
+    {
+        written++;
+    }
+    return written;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+    transmitting = false;
+    return VirtualBoard::current().transferI2c(address, length, clockHz) ? 0 : 2;
+}
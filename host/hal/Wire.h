@@ -0,0 +1,40 @@
+#ifndef TWO_WIRE_H
+#define TWO_WIRE_H
+
+/**
+ * @file Wire.h
+ * @brief Host I2C master: write transfers take their bus time on the bound VirtualBoard.
+ */
+
+#include "Arduino.h"
+
+class TwoWire
+{
+public:
+    static const size_t BUFFER_BYTES = 128;
+
+private:
+    uint32_t clockHz;
+    uint8_t address;
+    size_t length;
+    bool transmitting;
+
+public:
+    TwoWire();
+
+    bool begin();
+    void setClock(uint32_t frequency);
+    uint32_t getClock() const;
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t value);
+    size_t write(const uint8_t *data, size_t quantity);
+
+    /**
+     * @return 0 on success, 2 when no device acknowledged the address.
+     */
+    uint8_t endTransmission(bool sendStop = true);
+};
+
+extern TwoWire Wire;
+
+#endif // TWO_WIRE_H
@@ -0,0 +1,189 @@
+/**
+ * @file FleetSimulator.cpp
+ * @brief Implements the FleetSimulator class.
+ */
+
+#include "FleetSimulator.h"
+#include "CiaSteelFaucet.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+
+/**
+ * @brief Spreads consecutive device numbers over unrelated seeds (splitmix64).
+ */
+uint64_t deviceSeed(uint64_t seed, size_t index)
+{
+    uint64_t z = seed + (index + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Message count of one worker in the current step, on a cache line of its own.
+ */
+struct alignas(64) WorkerMessages
+{
+    uint64_t count;
+};
+
+} // namespace
+
+FleetReport::FleetReport()
+    : devices(0), virtualMicros(0), wallSeconds(0), events(0), eventsPerSecond(0), speedup(0), threads(0), steals(0),
+      chunks(0), hands(0), missedHands(0),
+      detection("detection", CiaSteelFaucet::PROXIMITY_PERIOD_US + CiaSteelFaucet::HAND_TO_VALVE_BUDGET_US),
+      valveClose("valve close", CiaSteelFaucet::VALVE_CLOSE_BUDGET_US), detectionP99(), valveCloseP99(),
+      devicesOverDetectionBudget(0), devicesOverValveCloseBudget(0), messages(0), meanMessagesPerSecond(0),
+      peakMessagesPerSecond(0)
+{
+}
+
+FleetSimulator::FleetSimulator(const FleetConfig &config) : config(config), pool(config.threads)
+{
+    devices.reserve(config.devices);
+    for (size_t i = 0; i < config.devices; i++)
+    {
+        devices.emplace_back(new SimulatedFaucet(deviceSeed(config.seed, i), config.startHour));
+    }
+}
+
+FleetReport FleetSimulator::run()
+{
+    FleetReport report;
+    std::vector<WorkerMessages> stepMessages(pool.getThreadCount());
+    uint64_t horizon = 0;
+    const WorkStealingPool::Task step = [&](size_t begin, size_t end, unsigned worker) {
+        for (size_t i = begin; i < end; i++)
+        {
+            stepMessages[worker].count += devices[i]->runUntil(horizon);
+        }
+    };
+
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    while (horizon < config.durationMicros)
+    {
+        horizon += STEP_MICROS;
+        if (horizon > config.durationMicros)
+        {
+            horizon = config.durationMicros;
+        }
+        for (WorkerMessages &messages : stepMessages)
+        {
+            messages.count = 0;
+        }
+        pool.run(devices.size(), CHUNK_DEVICES, step);
+
+        uint64_t messages = 0;
+        for (const WorkerMessages &worker : stepMessages)
+        {
+            messages += worker.count;
+        }
+        report.messages += messages;
+        if (messages > report.peakMessagesPerSecond)
+        {
+            report.peakMessagesPerSecond = (uint32_t)messages;
+        }
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - started;
+
+    // Reduced in device order, so the results do not depend on which worker ran what
+    std::vector<uint32_t> detectionP99s;
+    std::vector<uint32_t> valveCloseP99s;
+    for (const std::unique_ptr<SimulatedFaucet> &device : devices)
+    {
+        report.events += device->getEvents();
+        report.hands += device->getHands();
+        report.missedHands += device->getMissedHands();
+
+        const LatencyHistogram &detection = device->getDetection();
+        report.detection.merge(detection);
+        if (detection.getCount() > 0)
+        {
+            detectionP99s.push_back(detection.percentile(990));
+        }
+        if (!detection.meetsBudget())
+        {
+            report.devicesOverDetectionBudget++;
+        }
+
+        const LatencyHistogram &valveClose = device->getValveClose();
+        report.valveClose.merge(valveClose);
+        if (valveClose.getCount() > 0)
+        {
+            valveCloseP99s.push_back(valveClose.percentile(990));
+        }
+        if (!valveClose.meetsBudget())
+        {
+            report.devicesOverValveCloseBudget++;
+        }
+    }
+    report.detectionP99 = spreadOf(detectionP99s);
+    report.valveCloseP99 = spreadOf(valveCloseP99s);
+
+    report.devices = devices.size();
+    report.virtualMicros = config.durationMicros;
+    report.wallSeconds = wall.count();
+    report.eventsPerSecond = report.wallSeconds > 0 ? report.events / report.wallSeconds : 0;
+    report.speedup = report.wallSeconds > 0 ? config.durationMicros / 1e6 / report.wallSeconds : 0;
+    report.threads = pool.getThreadCount();
+    report.steals = pool.getSteals();
+    report.chunks = pool.getChunksRun();
+    report.meanMessagesPerSecond = config.durationMicros > 0 ? report.messages * 1e6 / config.durationMicros : 0;
+    return report;
+}
+
+const SimulatedFaucet &FleetSimulator::getDevice(size_t index) const
+{
+    return *devices[index];
+}
+
+DeviceSpread FleetSimulator::spreadOf(std::vector<uint32_t> &values)
+{
+    DeviceSpread spread = {};
+    if (values.empty())
+    {
+        return spread;
+    }
+    std::sort(values.begin(), values.end());
+    spread.min = values.front();
+    spread.median = values[(values.size() - 1) / 2];
+    spread.p90 = values[(values.size() - 1) * 9 / 10];
+    spread.max = values.back();
+    return spread;
+}
+
+void printFleetReport(const FleetReport &report, FILE *out)
+{
+    fprintf(out, "devices          %lu\n", (unsigned long)report.devices);
+    fprintf(out, "virtual time     %.1f s\n", report.virtualMicros / 1e6);
+    fprintf(out, "wall time        %.2f s\n", report.wallSeconds);
+    fprintf(out, "events           %llu (%.2f M/s)\n", (unsigned long long)report.events,
+            report.eventsPerSecond / 1e6);
+    fprintf(out, "sim/wall         %.0fx\n", report.speedup);
+    fprintf(out, "threads          %u (%llu of %llu chunks stolen)\n", report.threads,
+            (unsigned long long)report.steals, (unsigned long long)report.chunks);
+    fprintf(out, "hands            %llu (%llu missed)\n", (unsigned long long)report.hands,
+            (unsigned long long)report.missedHands);
+
+    const LatencyHistogram *histograms[] = {&report.detection, &report.valveClose};
+    const DeviceSpread *spreads[] = {&report.detectionP99, &report.valveCloseP99};
+    const size_t overBudget[] = {report.devicesOverDetectionBudget, report.devicesOverValveCloseBudget};
+    for (int i = 0; i < 2; i++)
+    {
+        const LatencyHistogram &histogram = *histograms[i];
+        fprintf(out, "%-16s fleet p50 %lu us, p99 %lu us, p99.9 %lu us, max %lu us (budget p99 %lu us, %lu samples)\n",
+                histogram.getName(), (unsigned long)histogram.percentile(500), (unsigned long)histogram.percentile(990),
+                (unsigned long)histogram.percentile(999), (unsigned long)histogram.getMaxMicros(),
+                (unsigned long)histogram.getBudgetMicros(), (unsigned long)histogram.getCount());
+        fprintf(out, "%-16s device p99 min %lu us, median %lu us, p90 %lu us, max %lu us; %lu devices over budget\n",
+                "", (unsigned long)spreads[i]->min, (unsigned long)spreads[i]->median, (unsigned long)spreads[i]->p90,
+                (unsigned long)spreads[i]->max, (unsigned long)overBudget[i]);
+    }
+
+    fprintf(out, "backend          %llu messages, mean %.1f/s, peak %lu/s\n", (unsigned long long)report.messages,
+            report.meanMessagesPerSecond, (unsigned long)report.peakMessagesPerSecond);
+}
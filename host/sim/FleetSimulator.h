@@ -0,0 +1,106 @@
+#ifndef FLEET_SIMULATOR_H
+#define FLEET_SIMULATOR_H
+
+/**
+ * @file FleetSimulator.h
+ * @brief Declares the FleetSimulator class, thousands of faucets on one virtual clock.
+ *
+ * The fleet shares a discrete-event clock that moves in steps of STEP_MICROS. In each step the
+ * WorkStealingPool runs every device's events up to the step's end; devices do not talk to each
+ * other, so a step needs no ordering between them and a run gives the same results on any number
+ * of threads. Between steps the backend messages of the step are added up, which gives the load
+ * the fleet puts on the backend second by second.
+ */
+
+#include "LatencyHistogram.h"
+#include "SimulatedFaucet.h"
+#include "WorkStealingPool.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief What to simulate.
+ */
+struct FleetConfig
+{
+    size_t devices;
+    uint64_t durationMicros; ///< Virtual time to run.
+    unsigned threads;
+    uint64_t seed;
+    uint32_t startHour; ///< Hour of the day the run starts at.
+};
+
+/**
+ * @brief Per-device p99s, to show how evenly the fleet is served.
+ */
+struct DeviceSpread
+{
+    uint32_t min;
+    uint32_t median;
+    uint32_t p90;
+    uint32_t max;
+};
+
+/**
+ * @brief Results of one run.
+ */
+struct FleetReport
+{
+    size_t devices;
+    uint64_t virtualMicros;
+    double wallSeconds;
+    uint64_t events;
+    double eventsPerSecond; ///< Wall-clock rate.
+    double speedup;         ///< Simulated time over wall time.
+    unsigned threads;
+    uint64_t steals;
+    uint64_t chunks;
+
+    uint64_t hands;
+    uint64_t missedHands;
+    LatencyHistogram detection;  ///< Whole fleet.
+    LatencyHistogram valveClose; ///< Whole fleet.
+    DeviceSpread detectionP99;   ///< Devices with at least one detection.
+    DeviceSpread valveCloseP99;
+    size_t devicesOverDetectionBudget;
+    size_t devicesOverValveCloseBudget;
+
+    uint64_t messages;
+    double meanMessagesPerSecond;
+    uint32_t peakMessagesPerSecond;
+
+    FleetReport();
+};
+
+class FleetSimulator
+{
+public:
+    static const uint32_t STEP_MICROS = 1000000; ///< Clock step; also the backend load window.
+    static const size_t CHUNK_DEVICES = 16;      ///< Devices per work item of the pool.
+
+private:
+    FleetConfig config;
+    std::vector<std::unique_ptr<SimulatedFaucet>> devices;
+    WorkStealingPool pool;
+
+    static DeviceSpread spreadOf(std::vector<uint32_t> &values);
+
+public:
+    explicit FleetSimulator(const FleetConfig &config);
+
+    /**
+     * @brief Runs the fleet for the configured time. Call once.
+     */
+    FleetReport run();
+
+    const SimulatedFaucet &getDevice(size_t index) const;
+};
+
+/**
+ * @brief Prints a report as the fleet_sim tool does.
+ */
+void printFleetReport(const FleetReport &report, FILE *out);
+
+#endif // FLEET_SIMULATOR_H
@@ -0,0 +1,111 @@
+/**
+ * @file FleetSimulatorTest.cpp
+ * @brief Tests of the work-stealing pool and the fleet simulator.
+ */
+
+#include "FleetSimulator.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+
+namespace
+{
+
+FleetConfig smallFleet(unsigned threads)
+{
+    FleetConfig config;
+    config.devices = 200;
+    config.durationMicros = 5ULL * 60 * 1000000;
+    config.threads = threads;
+    config.seed = 7;
+    config.startHour = 12;
+    return config;
+}
+
+TEST(WorkStealingPool, RunsEveryIndexOnce)
+{
+    // Many short runs back to back, each with a task of its own: no chunk may leak into the next run
+    WorkStealingPool pool(4);
+    std::vector<std::atomic<int>> runs(1000);
+    for (int round = 0; round < 500; round++)
+    {
+        pool.run(runs.size(), 7, [&](size_t begin, size_t end, unsigned worker) {
+            for (size_t i = begin; i < end; i++)
+            {
+                runs[i]++;
+            }
+        });
+    }
+    for (const std::atomic<int> &count : runs)
+    {
+        EXPECT_EQ(count.load(), 500);
+    }
+    EXPECT_EQ(pool.getChunksRun(), 500u * ((1000 + 6) / 7));
+}
+
+TEST(WorkStealingPool, StealsFromASlowShard)
+{
+    // The first shard is the slow one; without stealing the run would take all of its chunks in a row
+    WorkStealingPool pool(2);
+    pool.run(64, 1, [](size_t begin, size_t end, unsigned worker) {
+        if (begin < 32)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    });
+    EXPECT_GT(pool.getSteals(), 0u);
+}
+
+TEST(FleetSimulator, SameResultsOnAnyThreadCount)
+{
+    FleetSimulator single(smallFleet(1));
+    FleetReport one = single.run();
+    FleetSimulator several(smallFleet(3));
+    FleetReport three = several.run();
+
+    EXPECT_EQ(one.events, three.events);
+    EXPECT_EQ(one.hands, three.hands);
+    EXPECT_EQ(one.messages, three.messages);
+    EXPECT_EQ(one.peakMessagesPerSecond, three.peakMessagesPerSecond);
+    EXPECT_EQ(one.detection.getCount(), three.detection.getCount());
+    EXPECT_EQ(one.detection.percentile(990), three.detection.percentile(990));
+    EXPECT_EQ(one.detection.getMaxMicros(), three.detection.getMaxMicros());
+    EXPECT_EQ(one.valveClose.percentile(990), three.valveClose.percentile(990));
+    EXPECT_EQ(one.detectionP99.max, three.detectionP99.max);
+}
+
+TEST(FleetSimulator, FleetMeetsLatencyBudgets)
+{
+    FleetSimulator fleet(smallFleet(2));
+    FleetReport report = fleet.run();
+    printFleetReport(report, stdout);
+
+    EXPECT_EQ(report.devices, 200u);
+    EXPECT_GT(report.hands, 1000u);
+    EXPECT_EQ(report.missedHands, 0u);
+    // Only a hand that arrived in the last moments of the run may still be waiting
+    EXPECT_LE(report.hands - report.detection.getCount(), report.devices);
+    EXPECT_TRUE(report.detection.meetsBudget());
+    EXPECT_TRUE(report.valveClose.meetsBudget());
+    // Worst case: the first measurement after the hand loses its echo, the next one sees it
+    EXPECT_LE(report.detection.getMaxMicros(), 2u * 60000 + 2000);
+    EXPECT_LE(report.valveClose.getMaxMicros(), 50000u);
+
+    // Heartbeats alone: one per device per minute
+    EXPECT_GE(report.messages, 200u * 5);
+    EXPECT_GE(report.peakMessagesPerSecond, (uint32_t)report.meanMessagesPerSecond);
+}
+
+TEST(FleetSimulator, HandRateFollowsTheTimeOfDay)
+{
+    FleetConfig night = smallFleet(2);
+    night.startHour = 3;
+    FleetConfig morning = smallFleet(2);
+    morning.startHour = 8;
+    FleetReport quiet = FleetSimulator(night).run();
+    FleetReport busy = FleetSimulator(morning).run();
+    // 0.01 against 1.00 of the peak rate
+    EXPECT_GT(busy.hands, 20 * (quiet.hands + 1));
+}
+
+} // namespace
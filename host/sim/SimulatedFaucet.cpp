@@ -0,0 +1,230 @@
+/**
+ * @file SimulatedFaucet.cpp
+ * @brief Implements the SimulatedFaucet class.
+ *
+ * Hand arrivals are a Poisson process whose rate follows the hour of the day, drawn by thinning:
+ * candidates come at the peak rate and each is kept with the occupancy of its hour.
+ */
+
+#include "SimulatedFaucet.h"
+#include "CiaSteelFaucet.h"
+
+const float SimulatedFaucet::BACKGROUND_CM = 80.0f;
+
+// A public washroom: quiet at night, rushes before work, at lunch and in the evening
+const float SimulatedFaucet::OCCUPANCY_BY_HOUR[24] = {
+    0.02f, 0.01f, 0.01f, 0.01f, 0.02f, 0.08f, 0.35f, 0.80f, 1.00f, 0.70f, 0.50f, 0.60f,
+    0.95f, 0.85f, 0.50f, 0.45f, 0.50f, 0.70f, 0.85f, 0.75f, 0.55f, 0.40f, 0.20f, 0.06f};
+
+SimulatedFaucet::SimulatedFaucet(uint64_t seed, uint32_t startHour)
+    : random((uint32_t)(seed ^ (seed >> 32)) | 1), startOfDayMicros((uint64_t)(startHour % 24) * 3600000000ULL),
+      nextEvaluateAt(NEVER), echoCm(-1), handPresent(false), handCm(0), handPending(false), handArrivedAt(0),
+      valveOpen(false), openedAt(0),
+      detection("detection", CiaSteelFaucet::PROXIMITY_PERIOD_US + CiaSteelFaucet::HAND_TO_VALVE_BUDGET_US),
+      valveClose("valve close", CiaSteelFaucet::VALVE_CLOSE_BUDGET_US), events(0), hands(0), missedHands(0),
+      messages(0)
+{
+    // Washrooms differ: most near the average, a few several times busier
+    busyness = std::lognormal_distribution<double>(0.0, 0.6)(random);
+
+    // Devices were powered up at different times, so their periods are out of phase
+    nextMeasureAt = std::uniform_int_distribution<uint32_t>(0, CiaSteelFaucet::PROXIMITY_PERIOD_US - 1)(random);
+    nextTickAt = std::uniform_int_distribution<uint32_t>(0, CiaSteelFaucet::REAL_TIME_PERIOD_US - 1)(random);
+    nextHeartbeatAt = std::uniform_int_distribution<uint32_t>(0, HEARTBEAT_PERIOD_US - 1)(random);
+    nextHandChangeAt = nextArrival(0);
+
+    VirtualBoard::Scope scope(board);
+    board.watchPins(onPin, this);
+    board.setEchoDistance(CiaSteelFaucet::ULTRASOUND_ECHO_PIN, BACKGROUND_CM);
+    sensor.reset(new UltrasoundSensor(CiaSteelFaucet::ULTRASOUND_TRIG_PIN, CiaSteelFaucet::ULTRASOUND_ECHO_PIN,
+                                      CiaSteelFaucet::PROXIMITY_THRESHOLD_CM, this));
+    valve.reset(new RelayModule(CiaSteelFaucet::RELAY_PIN));
+}
+
+uint32_t SimulatedFaucet::runUntil(uint64_t horizonMicros)
+{
+    VirtualBoard::Scope scope(board);
+    messages = 0;
+    while (true)
+    {
+        uint64_t next = nextHandChangeAt;
+        if (nextEvaluateAt < next)
+        {
+            next = nextEvaluateAt;
+        }
+        if (nextMeasureAt < next)
+        {
+            next = nextMeasureAt;
+        }
+        if (nextTickAt < next)
+        {
+            next = nextTickAt;
+        }
+        if (next >= horizonMicros)
+        {
+            break;
+        }
+
+        board.advanceTo(next);
+        events++;
+        // At a tie the hand moves first, then the echo in flight is read before a new trigger
+        if (next == nextHandChangeAt)
+        {
+            changeHand(next);
+        }
+        else if (next == nextEvaluateAt)
+        {
+            evaluate(next);
+        }
+        else if (next == nextMeasureAt)
+        {
+            measure(next);
+        }
+        else
+        {
+            tick(next);
+        }
+    }
+    return messages;
+}
+
+void SimulatedFaucet::measure(uint64_t now)
+{
+    // The echo reflects what is in front of the sensor when it is triggered
+    bool lost = std::uniform_int_distribution<uint32_t>(0, 999)(random) < LOST_ECHO_PERMILLE;
+    echoCm = lost ? -1 : (handPresent ? handCm : BACKGROUND_CM);
+    uint32_t echoMicros = lost ? ECHO_TIMEOUT_US : (uint32_t)(echoCm * 2 / 0.0343f);
+    nextEvaluateAt = now + VirtualBoard::ECHO_LEAD_MICROS + echoMicros;
+    nextMeasureAt += CiaSteelFaucet::PROXIMITY_PERIOD_US;
+}
+
+void SimulatedFaucet::evaluate(uint64_t now)
+{
+    nextEvaluateAt = NEVER;
+    sensor->evaluateDistance(echoCm, (unsigned long)(now / 1000));
+}
+
+void SimulatedFaucet::tick(uint64_t now)
+{
+    valve->updateTimer((unsigned long)(now / 1000));
+    if (now >= nextHeartbeatAt)
+    {
+        messages++;
+        nextHeartbeatAt += HEARTBEAT_PERIOD_US;
+    }
+    nextTickAt += CiaSteelFaucet::REAL_TIME_PERIOD_US;
+}
+
+void SimulatedFaucet::changeHand(uint64_t now)
+{
+    if (!handPresent)
+    {
+        handPresent = true;
+        handCm = std::uniform_real_distribution<float>(3.0f, 9.0f)(random);
+        handPending = true;
+        handArrivedAt = now;
+        hands++;
+        // Hands are held about 2 s, a few much longer
+        double dwell = std::lognormal_distribution<double>(0.7, 0.6)(random);
+        nextHandChangeAt = now + MIN_DWELL_US + (uint64_t)(dwell * 1000000);
+        return;
+    }
+
+    handPresent = false;
+    if (handPending)
+    {
+        missedHands++;
+        handPending = false;
+    }
+    nextHandChangeAt = nextArrival(now + MIN_HAND_GAP_US);
+}
+
+uint64_t SimulatedFaucet::nextArrival(uint64_t from)
+{
+    std::exponential_distribution<double> gap(busyness * 1000000.0 / PEAK_HAND_GAP_US);
+    std::uniform_real_distribution<float> keep(0.0f, 1.0f);
+    uint64_t candidate = from;
+    while (true)
+    {
+        candidate += (uint64_t)(gap(random) * 1000000);
+        if (keep(random) < occupancyAt(candidate))
+        {
+            return candidate;
+        }
+    }
+}
+
+float SimulatedFaucet::occupancyAt(uint64_t micros) const
+{
+    return OCCUPANCY_BY_HOUR[((startOfDayMicros + micros) / 3600000000ULL) % 24];
+}
+
+void SimulatedFaucet::on(Event event)
+{
+    // What CiaSteelFaucet::on() does with a detection, without the console and journal
+    if (event == UltrasoundSensor::PROXIMITY_DETECTED_EVENT)
+    {
+        valve->openValveTimed(CiaSteelFaucet::VALVE_OPEN_DURATION_MS, (unsigned long)(board.now() / 1000));
+    }
+}
+
+void SimulatedFaucet::onPin(int pin, int level, uint64_t atMicros, void *context)
+{
+    SimulatedFaucet *device = static_cast<SimulatedFaucet *>(context);
+    if (pin != CiaSteelFaucet::RELAY_PIN)
+    {
+        return;
+    }
+    if (level == HIGH)
+    {
+        if (device->handPending)
+        {
+            device->detection.record((uint32_t)(atMicros - device->handArrivedAt));
+            device->handPending = false;
+        }
+        if (!device->valveOpen)
+        {
+            device->messages++;
+        }
+        device->valveOpen = true;
+        device->openedAt = atMicros;
+    }
+    else if (device->valveOpen)
+    {
+        // The timer counts whole milliseconds, so the valve may close up to one early
+        uint64_t due = device->openedAt + CiaSteelFaucet::VALVE_OPEN_DURATION_MS * 1000;
+        device->valveClose.record(atMicros > due ? (uint32_t)(atMicros - due) : 0);
+        device->valveOpen = false;
+        device->messages++;
+    }
+}
+
+const LatencyHistogram &SimulatedFaucet::getDetection() const
+{
+    return detection;
+}
+
+const LatencyHistogram &SimulatedFaucet::getValveClose() const
+{
+    return valveClose;
+}
+
+uint64_t SimulatedFaucet::getEvents() const
+{
+    return events;
+}
+
+uint32_t SimulatedFaucet::getHands() const
+{
+    return hands;
+}
+
+uint32_t SimulatedFaucet::getMissedHands() const
+{
+    return missedHands;
+}
+
+double SimulatedFaucet::getBusyness() const
+{
+    return busyness;
+}
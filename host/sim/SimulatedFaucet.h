@@ -0,0 +1,114 @@
+#ifndef SIMULATED_FAUCET_H
+#define SIMULATED_FAUCET_H
+
+/**
+ * @file SimulatedFaucet.h
+ * @brief Declares the SimulatedFaucet class, one faucet of the fleet simulator.
+ *
+ * A device is the firmware's own UltrasoundSensor and RelayModule on a VirtualBoard of its own,
+ * driven as discrete events instead of through the sketch's loop: a measurement every proximity
+ * period, its evaluation once the echo is back, a valve timer check every real-time step, and hands
+ * arriving and leaving. Hands follow an occupancy profile over the day, scaled by how busy the
+ * device's washroom is, so a fleet has quiet and busy units at once.
+ *
+ * The relay pin is watched like a probe on the real board: a hand arriving to the pin going
+ * HIGH is the detection latency, and the pin going LOW after the timed opening ran out is the
+ * valve close lateness. Valve changes and a periodic heartbeat count as backend messages.
+ */
+
+#include "LatencyHistogram.h"
+#include "RelayModule.h"
+#include "UltrasoundSensor.h"
+#include "VirtualBoard.h"
+#include <stdint.h>
+#include <memory>
+#include <random>
+
+class SimulatedFaucet : public EventHandler
+{
+public:
+    static const uint32_t HEARTBEAT_PERIOD_US = 60000000; ///< Backend keep-alive.
+    static const uint32_t ECHO_TIMEOUT_US = 30000;     ///< pulseIn() timeout of measureDistance().
+    static const uint32_t MIN_DWELL_US = 300000;       ///< A hand is held for five measurements at least.
+    static const uint32_t MIN_HAND_GAP_US = 300000;    ///< Out of range between two hands.
+    static const uint32_t PEAK_HAND_GAP_US = 20000000; ///< Mean time between hands at the busiest hour.
+    static const uint32_t LOST_ECHO_PERMILLE = 5;      ///< Measurements with no echo back.
+    static const float BACKGROUND_CM;                  ///< Basin seen with no hand.
+
+    /**
+     * @brief Share of the peak hand rate in each hour of the day, peak = 1.
+     */
+    static const float OCCUPANCY_BY_HOUR[24];
+
+private:
+    static const uint64_t NEVER = UINT64_MAX;
+
+    VirtualBoard board;
+    std::unique_ptr<UltrasoundSensor> sensor;
+    std::unique_ptr<RelayModule> valve;
+    std::minstd_rand random;
+    double busyness;           ///< Hand rate relative to an average washroom.
+    uint64_t startOfDayMicros; ///< Time of day at virtual time 0.
+
+    // Next time of each event stream
+    uint64_t nextMeasureAt;
+    uint64_t nextEvaluateAt;
+    uint64_t nextTickAt;
+    uint64_t nextHandChangeAt;
+    uint64_t nextHeartbeatAt;
+
+    float echoCm; ///< Distance measured by the measurement in flight, -1 for none.
+    bool handPresent;
+    float handCm;
+
+    // Probe on the relay pin
+    bool handPending;
+    uint64_t handArrivedAt;
+    bool valveOpen;
+    uint64_t openedAt;
+    LatencyHistogram detection;
+    LatencyHistogram valveClose;
+
+    uint64_t events;
+    uint32_t hands;
+    uint32_t missedHands;
+    uint32_t messages; ///< Sent since the last runUntil() started.
+
+    void measure(uint64_t now);
+    void evaluate(uint64_t now);
+    void tick(uint64_t now);
+    void changeHand(uint64_t now);
+    uint64_t nextArrival(uint64_t from);
+    float occupancyAt(uint64_t micros) const;
+
+    static void onPin(int pin, int level, uint64_t atMicros, void *context);
+
+public:
+    /**
+     * @brief Builds a device with its own board, random stream and busyness.
+     * @param seed Seed of this device; the same seed gives the same run.
+     * @param startHour Hour of the day at virtual time 0.
+     */
+    SimulatedFaucet(uint64_t seed, uint32_t startHour);
+
+    SimulatedFaucet(const SimulatedFaucet &) = delete;
+    SimulatedFaucet &operator=(const SimulatedFaucet &) = delete;
+
+    /**
+     * @brief Runs every event due before a time, on the calling thread.
+     * @param horizonMicros End of the step; events at or after it wait for the next one.
+     * @return Backend messages sent during the step.
+     */
+    uint32_t runUntil(uint64_t horizonMicros);
+
+    void on(Event event) override;
+
+    const LatencyHistogram &getDetection() const;
+    const LatencyHistogram &getValveClose() const;
+    uint64_t getEvents() const;
+    uint32_t getHands() const;
+    uint32_t getMissedHands() const;
+    double getBusyness() const;
+};
+
+#endif // SIMULATED_FAUCET_H
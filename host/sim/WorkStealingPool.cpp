@@ -0,0 +1,190 @@
+/**
+ * @file WorkStealingPool.cpp
+ * @brief Implements the WorkStealingPool class.
+ *
+ * Chunks are only dealt out at the start of a generation, so a worker that finds its own deque
+ * and every other one empty has nothing left to do in it and waits for the next one.
+ *
+ * Waits are timed, with the condition checked again after each: the untimed
+ * condition_variable::wait() got a new symbol version in GCC 12, which the older libstdc++ some
+ * GoogleTest packages put on the runtime path does not have.
+ */
+
+#include "WorkStealingPool.h"
+
+static const std::chrono::milliseconds WAIT_SLICE(100);
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+    : generation(0), stopping(false), task(nullptr), busyWorkers(0), remaining(0), steals(0), chunksRun(0)
+{
+    if (threadCount == 0)
+    {
+        threadCount = 1;
+    }
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        workers.emplace_back(new Worker());
+    }
+    for (unsigned i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(generationLock);
+        stopping = true;
+    }
+    generationStarted.notify_all();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::run(size_t count, size_t chunkSize, const Task &work)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (chunkSize == 0)
+    {
+        chunkSize = 1;
+    }
+
+    // Dealt under the lock: no worker is between generations while its deque fills
+    std::unique_lock<std::mutex> guard(generationLock);
+
+    // Contiguous shards: worker w starts with the chunks of the w-th slice of the range
+    size_t chunks = (count + chunkSize - 1) / chunkSize;
+    size_t workerCount = workers.size();
+    for (size_t w = 0; w < workerCount; w++)
+    {
+        size_t first = chunks * w / workerCount;
+        size_t last = chunks * (w + 1) / workerCount;
+        std::lock_guard<std::mutex> dealing(workers[w]->lock);
+        for (size_t c = first; c < last; c++)
+        {
+            size_t begin = c * chunkSize;
+            size_t end = begin + chunkSize < count ? begin + chunkSize : count;
+            workers[w]->chunks.push_back({begin, end});
+        }
+    }
+
+    task = &work;
+    remaining.store(chunks, std::memory_order_release);
+    generation++;
+    generationStarted.notify_all();
+    // Every chunk done and every worker out of its loop, so none takes a chunk of the next run
+    while (!generationDone.wait_for(guard, WAIT_SLICE, [this]() {
+        return busyWorkers == 0 && remaining.load(std::memory_order_acquire) == 0;
+    }))
+    {
+    }
+    task = nullptr;
+}
+
+bool WorkStealingPool::takeOwn(unsigned index, Range &range)
+{
+    Worker &own = *workers[index];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (own.chunks.empty())
+    {
+        return false;
+    }
+    range = own.chunks.back();
+    own.chunks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(unsigned index, Range &range)
+{
+    // Victims in a fixed rotation from the next worker on, so thieves spread out
+    size_t workerCount = workers.size();
+    for (size_t i = 1; i < workerCount; i++)
+    {
+        Worker &victim = *workers[(index + i) % workerCount];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.chunks.empty())
+        {
+            range = victim.chunks.front();
+            victim.chunks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned index)
+{
+    uint64_t seen = 0;
+    while (true)
+    {
+        const Task *work;
+        {
+            std::unique_lock<std::mutex> guard(generationLock);
+            while (!generationStarted.wait_for(guard, WAIT_SLICE,
+                                               [this, seen]() { return stopping || generation != seen; }))
+            {
+            }
+            if (stopping)
+            {
+                return;
+            }
+            seen = generation;
+            work = task;
+            if (work == nullptr)
+            {
+                // Woke after that run was over
+                continue;
+            }
+            busyWorkers++;
+        }
+
+        Range range;
+        while (true)
+        {
+            bool stolen = false;
+            if (!takeOwn(index, range))
+            {
+                if (!steal(index, range))
+                {
+                    break;
+                }
+                stolen = true;
+            }
+            (*work)(range.begin, range.end, index);
+            chunksRun.fetch_add(1, std::memory_order_relaxed);
+            if (stolen)
+            {
+                steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        std::lock_guard<std::mutex> guard(generationLock);
+        busyWorkers--;
+        if (busyWorkers == 0)
+        {
+            generationDone.notify_all();
+        }
+    }
+}
+
+unsigned WorkStealingPool::getThreadCount() const
+{
+    return (unsigned)workers.size();
+}
+
+uint64_t WorkStealingPool::getSteals() const
+{
+    return steals.load(std::memory_order_relaxed);
+}
+
+uint64_t WorkStealingPool::getChunksRun() const
+{
+    return chunksRun.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,95 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+/**
+ * @file WorkStealingPool.h
+ * @brief Declares the WorkStealingPool class, the worker threads of the fleet simulator.
+ *
+ * run() splits an index range into chunks and deals them out in contiguous shards, one per
+ * worker. A worker takes chunks from the back of its own deque and, once that is empty, steals
+ * from the front of another worker's, so a shard full of busy devices is shared out instead of
+ * holding up the whole step. Workers persist across run() calls; each call is one generation.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool
+{
+public:
+    /**
+     * @brief Work on the indexes [begin, end), on the given worker.
+     */
+    typedef std::function<void(size_t begin, size_t end, unsigned worker)> Task;
+
+private:
+    struct Range
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<Range> chunks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex generationLock;
+    std::condition_variable generationStarted;
+    std::condition_variable generationDone;
+    uint64_t generation;
+    bool stopping;
+    const Task *task;     ///< Null between runs.
+    unsigned busyWorkers; ///< Workers inside the current generation.
+    std::atomic<size_t> remaining; ///< Chunks of this generation not finished yet.
+
+    std::atomic<uint64_t> steals;
+    std::atomic<uint64_t> chunksRun;
+
+    void workerLoop(unsigned index);
+    bool takeOwn(unsigned index, Range &range);
+    bool steal(unsigned index, Range &range);
+
+public:
+    /**
+     * @brief Starts the workers.
+     * @param threadCount Number of worker threads, at least 1.
+     */
+    explicit WorkStealingPool(unsigned threadCount);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * @brief Runs a task over [0, count) and waits until every chunk is done.
+     * @param count Number of indexes.
+     * @param chunkSize Indexes per chunk, the unit of stealing.
+     * @param work Task to run; called concurrently from the workers.
+     */
+    void run(size_t count, size_t chunkSize, const Task &work);
+
+    unsigned getThreadCount() const;
+
+    /**
+     * @brief Gets the number of chunks run by a worker other than the one they were dealt to.
+     */
+    uint64_t getSteals() const;
+
+    uint64_t getChunksRun() const;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,82 @@
+/**
+ * @file main.cpp
+ * @brief fleet_sim: runs a fleet of simulated faucets and prints throughput and latencies.
+ *
+ * Usage: fleet_sim [--devices N] [--minutes M | --hours H] [--threads T] [--seed S] [--start-hour H]
+ */
+
+#include "FleetSimulator.h"
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+namespace
+{
+
+void usage(const char *program)
+{
+    fprintf(stderr,
+            "usage: %s [--devices N] [--minutes M | --hours H] [--threads T] [--seed S] [--start-hour H]\n",
+            program);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    FleetConfig config;
+    config.devices = 2000;
+    config.durationMicros = 10ULL * 60 * 1000000;
+    config.threads = std::thread::hardware_concurrency();
+    config.seed = 2025;
+    config.startHour = 8;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        const char *option = argv[i];
+        double value = atof(argv[++i]);
+        if (strcmp(option, "--devices") == 0)
+        {
+            config.devices = (size_t)value;
+        }
+        else if (strcmp(option, "--minutes") == 0)
+        {
+            config.durationMicros = (uint64_t)(value * 60 * 1000000);
+        }
+        else if (strcmp(option, "--hours") == 0)
+        {
+            config.durationMicros = (uint64_t)(value * 3600 * 1000000);
+        }
+        else if (strcmp(option, "--threads") == 0)
+        {
+            config.threads = (unsigned)value;
+        }
+        else if (strcmp(option, "--seed") == 0)
+        {
+            config.seed = strtoull(argv[i], nullptr, 10);
+        }
+        else if (strcmp(option, "--start-hour") == 0)
+        {
+            config.startHour = (uint32_t)value;
+        }
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (config.threads == 0)
+    {
+        config.threads = 1;
+    }
+
+    FleetSimulator fleet(config);
+    FleetReport report = fleet.run();
+    printFleetReport(report, stdout);
+    return report.missedHands == 0 ? 0 : 1;
+}
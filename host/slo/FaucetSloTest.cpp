@@ -0,0 +1,273 @@
+/**
+ * @file FaucetSloTest.cpp
+ * @brief End-to-end latency SLOs of the faucet, measured on its pins and console under load.
+ *
+ * The sketch's single-core loop (update(), then delay(50)) runs for half an hour of virtual
+ * time while hands come and go in front of the ultrasound sensor. The test only looks at what
+ * leaves the board:
+ *
+ * - Hand to valve: a hand arriving to the relay pin going HIGH. Up to one proximity period
+ *   passes before the next measurement starts, so the budget is PROXIMITY_PERIOD_US plus the
+ *   device's own HAND_TO_VALVE_BUDGET_US from that measurement's start.
+ * - Valve close: VALVE_OPEN_DURATION_MS after the last opening to the relay pin going LOW.
+ * - Status: STATUS_UPDATE_INTERVAL_MS after the previous status block's last line to the next
+ *   block's header, the interval the device promises.
+ */
+
+#include "CiaSteelFaucet.h"
+#include "SloHarness.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+const uint64_t RUN_MICROS = 30ULL * 60 * 1000000;
+const uint64_t STIMULUS_START_MICROS = 1000000; ///< After initialize() returns
+const uint32_t LOOP_DELAY_MS = 50;              ///< The sketch's loop()
+const char STATUS_HEADER[] = "--- Moen Cia Steel Faucet Status ---";
+const char STATUS_FOOTER[] = "------------------------------------";
+
+struct FaucetProbe;
+
+struct HandVisit
+{
+    FaucetProbe *probe;
+    float distanceCm;
+};
+
+/**
+ * @brief Watches the relay pin and the console, and drives the echo.
+ */
+struct FaucetProbe
+{
+    VirtualBoard &board;
+    float backgroundCm;
+
+    // Hand to valve
+    bool handPending;
+    uint64_t handArrivedAt;
+    uint32_t missedHands;
+    LatencySamples handToValve;
+
+    // Valve close
+    bool valveOpen;
+    uint64_t openedAt;
+    LatencySamples valveClose;
+
+    // Status cadence
+    std::string line;
+    uint64_t lineStartedAt;
+    bool footerSeen;
+    uint64_t footerEndedAt;
+    LatencySamples status;
+
+    explicit FaucetProbe(VirtualBoard &board)
+        : board(board), backgroundCm(80), handPending(false), handArrivedAt(0), missedHands(0),
+          valveOpen(false), openedAt(0), lineStartedAt(0), footerSeen(false), footerEndedAt(0)
+    {
+        board.watchPins(onPin, this);
+        board.watchSerial(onSerial, this);
+        board.setEchoDistance(CiaSteelFaucet::ULTRASOUND_ECHO_PIN, backgroundCm);
+    }
+
+    ~FaucetProbe()
+    {
+        board.watchPins(nullptr, nullptr);
+        board.watchSerial(nullptr, nullptr);
+    }
+
+    static void onPin(int pin, int level, uint64_t atMicros, void *context)
+    {
+        FaucetProbe *probe = static_cast<FaucetProbe *>(context);
+        if (pin != CiaSteelFaucet::RELAY_PIN)
+        {
+            return;
+        }
+        if (level == HIGH)
+        {
+            if (probe->handPending)
+            {
+                probe->handToValve.record(atMicros - probe->handArrivedAt);
+                probe->handPending = false;
+            }
+            probe->valveOpen = true;
+            probe->openedAt = atMicros;
+        }
+        else if (probe->valveOpen)
+        {
+            uint64_t due = probe->openedAt + CiaSteelFaucet::VALVE_OPEN_DURATION_MS * 1000;
+            // The valve timer counts whole milliseconds, so it may close up to one early
+            probe->valveClose.record(atMicros > due ? atMicros - due : 0);
+            probe->valveOpen = false;
+        }
+    }
+
+    static void onSerial(const uint8_t *data, size_t length, uint64_t atMicros, void *context)
+    {
+        FaucetProbe *probe = static_cast<FaucetProbe *>(context);
+        for (size_t i = 0; i < length; i++)
+        {
+            char c = (char)data[i];
+            if (c == '\r')
+            {
+                continue;
+            }
+            if (c != '\n')
+            {
+                if (probe->line.empty())
+                {
+                    probe->lineStartedAt = atMicros;
+                }
+                probe->line += c;
+                continue;
+            }
+            probe->onLine(atMicros);
+            probe->line.clear();
+        }
+    }
+
+    void onLine(uint64_t endedAt)
+    {
+        if (line == STATUS_HEADER && footerSeen)
+        {
+            uint64_t due = footerEndedAt + CiaSteelFaucet::STATUS_UPDATE_INTERVAL_MS * 1000;
+            status.record(lineStartedAt > due ? lineStartedAt - due : 0);
+        }
+        else if (line == STATUS_FOOTER)
+        {
+            footerSeen = true;
+            footerEndedAt = endedAt;
+        }
+    }
+
+    static void handArrives(void *context)
+    {
+        HandVisit *visit = static_cast<HandVisit *>(context);
+        FaucetProbe *probe = visit->probe;
+        probe->board.setEchoDistance(CiaSteelFaucet::ULTRASOUND_ECHO_PIN, visit->distanceCm);
+        probe->handPending = true;
+        probe->handArrivedAt = probe->board.now();
+    }
+
+    static void handLeaves(void *context)
+    {
+        HandVisit *visit = static_cast<HandVisit *>(context);
+        FaucetProbe *probe = visit->probe;
+        probe->board.setEchoDistance(CiaSteelFaucet::ULTRASOUND_ECHO_PIN, probe->backgroundCm);
+        if (probe->handPending)
+        {
+            probe->missedHands++;
+            probe->handPending = false;
+        }
+    }
+};
+
+struct FaucetResult
+{
+    uint32_t hands;
+    uint32_t missedHands;
+    uint32_t handToValveP99;
+    uint32_t handToValveMax;
+    size_t closes;
+    uint32_t valveCloseP99;
+    size_t statuses;
+    uint32_t statusP99;
+    bool deviceBudgetsMet;
+};
+
+/**
+ * @brief Runs the faucet under one load profile.
+ */
+FaucetResult runFaucet(const LoadProfile &profile, uint32_t seed)
+{
+    FaucetResult result = {};
+    runIsolated([&]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        FaucetProbe probe(board);
+
+        // No SSID: the HTTP server would bind port 80 on the host
+        CiaSteelFaucet faucet;
+        faucet.initialize();
+
+        applyLoad(board, profile);
+        uint64_t start = board.now() + STIMULUS_START_MICROS;
+        uint64_t end = start + RUN_MICROS;
+        scheduleLoad(board, profile, start, end, seed);
+
+        // Hands every 12 s on average, held 0.5 to 3 s at 2 to 8 cm
+        std::mt19937 random(seed);
+        std::exponential_distribution<double> gap(1.0 / 12000000);
+        std::uniform_int_distribution<uint32_t> dwell(500000, 3000000);
+        std::uniform_real_distribution<float> distance(2.0f, 8.0f);
+        std::vector<HandVisit> visits;
+        visits.reserve(RUN_MICROS / 500000);
+        uint64_t arrival = start + (uint64_t)gap(random);
+        while (arrival < end)
+        {
+            uint64_t departure = arrival + dwell(random);
+            visits.push_back({&probe, distance(random)});
+            board.at(arrival, FaucetProbe::handArrives, &visits.back());
+            board.at(departure, FaucetProbe::handLeaves, &visits.back());
+            // Out of range for a few measurements before the next hand
+            arrival = departure + 300000 + (uint64_t)gap(random);
+        }
+
+        while (board.now() < end)
+        {
+            faucet.update();
+            delay(LOOP_DELAY_MS);
+        }
+
+        result.hands = (uint32_t)visits.size();
+        result.missedHands = probe.missedHands;
+        result.handToValveP99 = probe.handToValve.percentile(0.99);
+        result.handToValveMax = probe.handToValve.max();
+        result.closes = probe.valveClose.getCount();
+        result.valveCloseP99 = probe.valveClose.percentile(0.99);
+        result.statuses = probe.status.getCount();
+        result.statusP99 = probe.status.percentile(0.99);
+        result.deviceBudgetsMet = faucet.meetsLatencyBudgets();
+    });
+    return result;
+}
+
+class FaucetSlo : public ::testing::TestWithParam<LoadProfile>
+{
+};
+
+TEST_P(FaucetSlo, MeetsBudgetsUnderLoad)
+{
+    const LoadProfile &profile = GetParam();
+    FaucetResult result = runFaucet(profile, 2025);
+    std::string name = profile.name;
+
+    printf("[ faucet   ] %-16s hand->valve p99 %6lu us (max %6lu, %lu hands, %lu missed), "
+           "valve close p99 %6lu us (%lu), status p99 %6lu us (%lu)\n",
+           profile.name, (unsigned long)result.handToValveP99, (unsigned long)result.handToValveMax,
+           (unsigned long)result.hands, (unsigned long)result.missedHands, (unsigned long)result.valveCloseP99,
+           (unsigned long)result.closes, (unsigned long)result.statusP99, (unsigned long)result.statuses);
+
+    // Every hand held for half a second must open the valve
+    EXPECT_EQ(result.missedHands, 0u);
+    EXPECT_GT(result.closes, result.hands / 2);
+    EXPECT_GT(result.statuses, RUN_MICROS / (CiaSteelFaucet::STATUS_UPDATE_INTERVAL_MS * 1000) / 2);
+
+    // Copies: gtest takes its operands by reference
+    const uint32_t handToValveBudget = CiaSteelFaucet::PROXIMITY_PERIOD_US + CiaSteelFaucet::HAND_TO_VALVE_BUDGET_US;
+    const uint32_t valveCloseBudget = CiaSteelFaucet::VALVE_CLOSE_BUDGET_US;
+    const uint32_t statusBudget = CiaSteelFaucet::STATUS_BUDGET_US;
+    EXPECT_LE(result.handToValveP99, handToValveBudget);
+    EXPECT_LE(result.valveCloseP99, valveCloseBudget);
+    EXPECT_LE(result.statusP99, statusBudget);
+    EXPECT_TRUE(result.deviceBudgetsMet);
+
+    expectWithinBaseline("faucet.hand_to_valve." + name, result.handToValveP99);
+    expectWithinBaseline("faucet.valve_close." + name, result.valveCloseP99);
+    expectWithinBaseline("faucet.status." + name, result.statusP99);
+}
+
+INSTANTIATE_TEST_SUITE_P(Loads, FaucetSlo, ::testing::ValuesIn(LOAD_PROFILES, LOAD_PROFILES + LOAD_PROFILE_COUNT),
+                         [](const ::testing::TestParamInfo<LoadProfile> &info) { return std::string(info.param.name); });
+
+} // namespace
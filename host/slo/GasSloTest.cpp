@@ -0,0 +1,214 @@
+/**
+ * @file GasSloTest.cpp
+ * @brief End-to-end alarm latency SLO of the gas detector, measured on its pins under load.
+ *
+ * The sketch's loop (run(), then idle()) runs for half an hour of virtual time while the MQ-2
+ * sees clean air with leaks stepping past 500 PPM now and then. The analog output is driven
+ * from mq2_stimulus.h, the model the Wokwi chip uses; D0 stays LOW, as with the module's
+ * comparator set above the leak, so only the analog path can raise the alarm.
+ *
+ * - Leak to red LED: the PPM crossing into CRITICAL to the red LED pin going HIGH. Up to one
+ *   sense period passes before the next conversion, so the budget is SENSE_PERIOD_US plus the
+ *   device's own CRITICAL-to-LED budget.
+ */
+
+#include "GLPSecureSenseDevice.h"
+#include "SloHarness.h"
+#include "mq2_stimulus.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+const uint64_t RUN_MICROS = 30ULL * 60 * 1000000;
+const uint64_t STIMULUS_START_MICROS = 1000000;
+const uint32_t STIMULUS_STEP_MICROS = 20000; ///< Noise and level update rate of the A0 stimulus
+
+// The device's pins and periods; the constants are private to it
+const int GAS_ANALOG_PIN = 4;
+const int RED_LED_PIN = 27;
+const uint32_t SENSE_PERIOD_US = 100000;
+const uint32_t CRITICAL_TO_LED_BUDGET_US = 5000;
+
+/**
+ * @brief Drives A0 through clean air and leaks, and watches the red LED.
+ */
+struct GasProbe
+{
+    VirtualBoard &board;
+    std::mt19937 random;
+    mq2_wave_t air;
+    bool leaking;
+    uint64_t nextChangeAt;
+    uint64_t stopAt;
+
+    bool redOn;
+    bool alarmPending;
+    uint64_t leakAt;
+    uint32_t leaks;
+    uint32_t leaksDuringAlarm; ///< Leaks that began while the previous alarm still showed
+    LatencySamples leakToRed;
+
+    GasProbe(VirtualBoard &board, uint32_t seed)
+        : board(board), random(seed), leaking(false), nextChangeAt(0), stopAt(0), redOn(false),
+          alarmPending(false), leakAt(0), leaks(0), leaksDuringAlarm(0)
+    {
+        air.kind = MQ2_WAVE_NOISE;
+        air.base_ppm = 100;
+        air.peak_ppm = 100;
+        air.start_ms = 0;
+        air.rise_ms = 0;
+        air.noise_ppm = 10;
+        air.seed = seed;
+        board.watchPins(onPin, this);
+        drive(0);
+    }
+
+    ~GasProbe()
+    {
+        board.watchPins(nullptr, nullptr);
+    }
+
+    void drive(float ppm)
+    {
+        float voltage = mq2_ppm_to_voltage(ppm);
+        board.setAnalog(GAS_ANALOG_PIN, (uint16_t)(voltage / MQ2_VCC * 4095 + 0.5f));
+    }
+
+    /**
+     * @brief Starts leaks 20 to 40 s apart that last 10 to 20 s, from a time on.
+     */
+    void start(uint64_t fromMicros, uint64_t toMicros)
+    {
+        stopAt = toMicros;
+        nextChangeAt = fromMicros + std::uniform_int_distribution<uint32_t>(20000000, 40000000)(random);
+        board.at(fromMicros, step, this);
+    }
+
+    static void step(void *context)
+    {
+        GasProbe *probe = static_cast<GasProbe *>(context);
+        uint64_t now = probe->board.now();
+        if (now >= probe->nextChangeAt)
+        {
+            probe->leaking = !probe->leaking;
+            if (probe->leaking)
+            {
+                probe->air.base_ppm = std::uniform_real_distribution<float>(600, 900)(probe->random);
+                probe->nextChangeAt = now + std::uniform_int_distribution<uint32_t>(10000000, 20000000)(probe->random);
+                probe->leaks++;
+                if (probe->redOn)
+                {
+                    probe->leaksDuringAlarm++;
+                }
+                else
+                {
+                    probe->alarmPending = true;
+                    probe->leakAt = now;
+                }
+            }
+            else
+            {
+                probe->air.base_ppm = 100;
+                probe->nextChangeAt = now + std::uniform_int_distribution<uint32_t>(20000000, 40000000)(probe->random);
+            }
+        }
+        probe->drive(mq2_wave_ppm(&probe->air, (uint32_t)(now / 1000)));
+        if (now + STIMULUS_STEP_MICROS < probe->stopAt)
+        {
+            probe->board.at(now + STIMULUS_STEP_MICROS, step, probe);
+        }
+    }
+
+    static void onPin(int pin, int level, uint64_t atMicros, void *context)
+    {
+        GasProbe *probe = static_cast<GasProbe *>(context);
+        if (pin != RED_LED_PIN)
+        {
+            return;
+        }
+        probe->redOn = level == HIGH;
+        if (probe->redOn && probe->alarmPending)
+        {
+            probe->leakToRed.record(atMicros - probe->leakAt);
+            probe->alarmPending = false;
+        }
+    }
+};
+
+struct GasResult
+{
+    uint32_t leaks;
+    uint32_t leaksDuringAlarm;
+    size_t alarms;
+    uint32_t leakToRedP99;
+    uint32_t leakToRedMax;
+    bool deviceBudgetsMet;
+};
+
+/**
+ * @brief Runs the gas detector under one load profile.
+ */
+GasResult runGas(const LoadProfile &profile, uint32_t seed)
+{
+    GasResult result = {};
+    runIsolated([&]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        board.addI2cDevice(0x27);
+        GasProbe probe(board, seed);
+
+        GLPSecureSenseDevice *device = new GLPSecureSenseDevice();
+        device->initialize();
+
+        applyLoad(board, profile);
+        uint64_t start = board.now() + STIMULUS_START_MICROS;
+        uint64_t end = start + RUN_MICROS;
+        scheduleLoad(board, profile, start, end, seed);
+        probe.start(start, end);
+
+        while (board.now() < end)
+        {
+            device->run();
+            device->idle();
+        }
+
+        result.leaks = probe.leaks;
+        result.leaksDuringAlarm = probe.leaksDuringAlarm;
+        result.alarms = probe.leakToRed.getCount();
+        result.leakToRedP99 = probe.leakToRed.percentile(0.99);
+        result.leakToRedMax = probe.leakToRed.max();
+        result.deviceBudgetsMet = device->meetsLatencyBudgets();
+        delete device;
+    });
+    return result;
+}
+
+class GasSlo : public ::testing::TestWithParam<LoadProfile>
+{
+};
+
+TEST_P(GasSlo, MeetsBudgetsUnderLoad)
+{
+    const LoadProfile &profile = GetParam();
+    GasResult result = runGas(profile, 2025);
+
+    printf("[ gas      ] %-16s leak->red p99 %6lu us (max %6lu, %lu alarms of %lu leaks, %lu during an alarm)\n",
+           profile.name, (unsigned long)result.leakToRedP99, (unsigned long)result.leakToRedMax,
+           (unsigned long)result.alarms, (unsigned long)result.leaks, (unsigned long)result.leaksDuringAlarm);
+
+    // Every leak that starts with the red LED off must light it
+    EXPECT_GT(result.leaks, 0u);
+    EXPECT_EQ(result.alarms + result.leaksDuringAlarm, result.leaks);
+
+    const uint32_t leakToRedBudget = SENSE_PERIOD_US + CRITICAL_TO_LED_BUDGET_US;
+    EXPECT_LE(result.leakToRedP99, leakToRedBudget);
+    EXPECT_TRUE(result.deviceBudgetsMet);
+
+    expectWithinBaseline(std::string("gas.leak_to_red.") + profile.name, result.leakToRedP99);
+}
+
+INSTANTIATE_TEST_SUITE_P(Loads, GasSlo, ::testing::ValuesIn(LOAD_PROFILES, LOAD_PROFILES + LOAD_PROFILE_COUNT),
+                         [](const ::testing::TestParamInfo<LoadProfile> &info) { return std::string(info.param.name); });
+
+} // namespace
@@ -0,0 +1,190 @@
+/**
+ * @file SloHarness.cpp
+ * @brief Implements the load profiles, latency samples and p99 baseline of the SLO suite.
+ */
+
+#include "SloHarness.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+const LoadProfile LOAD_PROFILES[] = {
+    {"idle", 0, 0.0f, false},
+    {"slow_i2c", 400, 0.0f, false},
+    {"saturated_serial", 0, 0.75f, false},
+    {"wifi_storm", 0, 0.0f, true},
+    {"combined", 400, 0.75f, true},
+};
+const size_t LOAD_PROFILE_COUNT = sizeof(LOAD_PROFILES) / sizeof(LOAD_PROFILES[0]);
+
+void PrintTo(const LoadProfile &profile, std::ostream *out)
+{
+    *out << profile.name;
+}
+
+void applyLoad(VirtualBoard &board, const LoadProfile &profile)
+{
+    board.setI2cStretch(profile.i2cStretchMicrosPerByte);
+    board.setSerialLoad(profile.serialLoad);
+}
+
+static void dropAccessPoint(void *context)
+{
+    static_cast<VirtualBoard *>(context)->setWifiReachable(false);
+}
+
+static void restoreAccessPoint(void *context)
+{
+    static_cast<VirtualBoard *>(context)->setWifiReachable(true);
+}
+
+void scheduleLoad(VirtualBoard &board, const LoadProfile &profile, uint64_t fromMicros, uint64_t toMicros,
+                  uint32_t seed)
+{
+    if (!profile.wifiStorm)
+    {
+        return;
+    }
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<uint32_t> gap(20000000, 40000000);
+    std::uniform_int_distribution<uint32_t> outage(2000000, 6000000);
+    std::uniform_int_distribution<uint32_t> burst(3000, 8000);
+
+    uint64_t start = fromMicros + gap(random);
+    while (start < toMicros)
+    {
+        uint64_t end = start + outage(random);
+        board.at(start, dropAccessPoint, &board);
+        board.at(end, restoreAccessPoint, &board);
+        for (uint64_t scan = start; scan < end; scan += 100000)
+        {
+            board.preempt(scan, burst(random));
+        }
+        start = end + gap(random);
+    }
+}
+
+void runIsolated(const std::function<void()> &scenario)
+{
+    std::thread runner(scenario);
+    runner.join();
+}
+
+void LatencySamples::record(uint64_t micros)
+{
+    samples.push_back(micros > UINT32_MAX ? UINT32_MAX : (uint32_t)micros);
+}
+
+size_t LatencySamples::getCount() const
+{
+    return samples.size();
+}
+
+uint32_t LatencySamples::percentile(double fraction)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+    // Nearest rank
+    size_t rank = (size_t)(fraction * samples.size() + 0.999999);
+    size_t index = rank > 0 ? rank - 1 : 0;
+    if (index >= samples.size())
+    {
+        index = samples.size() - 1;
+    }
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+uint32_t LatencySamples::max() const
+{
+    return samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+}
+
+SloBaseline::SloBaseline(const char *path) : path(path), updating(false), dirty(false)
+{
+    const char *update = getenv("SLO_UPDATE_BASELINE");
+    updating = update != nullptr && strcmp(update, "0") != 0;
+
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        return;
+    }
+    char line[160];
+    while (fgets(line, sizeof(line), file) != nullptr)
+    {
+        char key[128];
+        unsigned long micros;
+        if (line[0] != '#' && sscanf(line, "%127[^,],%lu", key, &micros) == 2)
+        {
+            values[key] = (uint32_t)micros;
+        }
+    }
+    fclose(file);
+}
+
+SloBaseline::~SloBaseline()
+{
+    save();
+}
+
+bool SloBaseline::isUpdating() const
+{
+    return updating;
+}
+
+bool SloBaseline::check(const std::string &key, uint32_t p99Micros, uint32_t &baselineMicros)
+{
+    std::map<std::string, uint32_t>::const_iterator recorded = values.find(key);
+    baselineMicros = recorded != values.end() ? recorded->second : 0;
+    if (updating)
+    {
+        values[key] = p99Micros;
+        dirty = true;
+        return true;
+    }
+    if (recorded == values.end())
+    {
+        // A new SLO has nothing to regress from; record it with SLO_UPDATE_BASELINE=1
+        return true;
+    }
+    return p99Micros <= baselineMicros * TOLERANCE + SLACK_MICROS;
+}
+
+void SloBaseline::save()
+{
+    if (!dirty)
+    {
+        return;
+    }
+    FILE *file = fopen(path.c_str(), "w");
+    if (file == nullptr)
+    {
+        return;
+    }
+    fprintf(file, "# p99 in microseconds per SLO and load profile; SLO_UPDATE_BASELINE=1 rewrites this file\n");
+    for (const std::pair<const std::string, uint32_t> &value : values)
+    {
+        fprintf(file, "%s,%lu\n", value.first.c_str(), (unsigned long)value.second);
+    }
+    fclose(file);
+    dirty = false;
+}
+
+SloBaseline &sloBaseline()
+{
+    static SloBaseline baseline(SLO_BASELINE_FILE);
+    return baseline;
+}
+
+void expectWithinBaseline(const std::string &key, uint32_t p99Micros)
+{
+    uint32_t baseline;
+    EXPECT_TRUE(sloBaseline().check(key, p99Micros, baseline))
+        << key << ": p99 " << p99Micros << " us regressed from the baseline's " << baseline << " us";
+}
@@ -0,0 +1,131 @@
+#ifndef SLO_HARNESS_H
+#define SLO_HARNESS_H
+
+/**
+ * @file SloHarness.h
+ * @brief Declares the load profiles, latency samples and p99 baseline of the SLO suite.
+ *
+ * A test drives one device on a VirtualBoard, applies a LoadProfile, measures stimulus to
+ * actuation on the board's pins and serial line, and checks each percentile twice: against the
+ * product budget, and against the p99 recorded in the baseline file so a change that makes
+ * latency worse fails even while the budget still holds.
+ */
+
+#include "VirtualBoard.h"
+#include <functional>
+#include <map>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Interference injected around a device while it runs.
+ */
+struct LoadProfile
+{
+    const char *name;
+    uint32_t i2cStretchMicrosPerByte; ///< Clock stretching per I2C byte, 0 for a clean bus.
+    float serialLoad;                 ///< Share of the UART taken by other traffic, 0 to 0.99.
+    bool wifiStorm;                   ///< Access point drops with reconnect bursts on the sketch's core.
+};
+
+/**
+ * @brief The profiles every SLO runs under.
+ */
+extern const LoadProfile LOAD_PROFILES[];
+extern const size_t LOAD_PROFILE_COUNT;
+
+/**
+ * @brief Names a profile in test output.
+ */
+void PrintTo(const LoadProfile &profile, std::ostream *out);
+
+/**
+ * @brief Schedules a profile's WiFi storm on a board.
+ *
+ * Every 20 to 40 s the access point drops for 2 to 6 s. While it is gone the station scans and
+ * retries: a 3 to 8 ms burst of WiFi task work every 100 ms takes the CPU from the sketch.
+ * @param board Board to schedule on.
+ * @param profile Load to apply; only its WiFi part needs scheduling.
+ * @param fromMicros Start of the storm.
+ * @param toMicros End of the storm.
+ * @param seed Seed of the storm's timing.
+ */
+void scheduleLoad(VirtualBoard &board, const LoadProfile &profile, uint64_t fromMicros, uint64_t toMicros,
+                  uint32_t seed);
+
+/**
+ * @brief Applies the I2C and serial parts of a profile, which hold for the whole run.
+ */
+void applyLoad(VirtualBoard &board, const LoadProfile &profile);
+
+/**
+ * @brief Runs one device's scenario on a thread of its own, and waits for it.
+ *
+ * Clocks widened past the 32-bit micros() wrap keep their epoch per thread (SamplingClock), so
+ * each board, whose time starts at zero, gets a fresh thread.
+ */
+void runIsolated(const std::function<void()> &scenario);
+
+/**
+ * @brief Exact latency percentiles of one SLO run.
+ */
+class LatencySamples
+{
+private:
+    std::vector<uint32_t> samples;
+
+public:
+    void record(uint64_t micros);
+    size_t getCount() const;
+    uint32_t percentile(double fraction);
+    uint32_t max() const;
+};
+
+/**
+ * @brief p99 values of the last accepted run, one per SLO and load profile.
+ *
+ * Set SLO_UPDATE_BASELINE=1 to write the measured values instead of checking against them.
+ */
+class SloBaseline
+{
+public:
+    static constexpr double TOLERANCE = 1.10;        ///< p99 may grow by 10%...
+    static const uint32_t SLACK_MICROS = 2000;       ///< ...plus 2 ms, for SLOs close to zero.
+
+private:
+    std::string path;
+    std::map<std::string, uint32_t> values;
+    bool updating;
+    bool dirty;
+
+public:
+    explicit SloBaseline(const char *path);
+    ~SloBaseline();
+
+    bool isUpdating() const;
+
+    /**
+     * @brief Checks a p99 against its recorded value, or records it when updating.
+     * @param key SLO and load profile.
+     * @param p99Micros Measured p99.
+     * @param baselineMicros Receives the recorded value, 0 when there is none.
+     * @return False when the p99 regressed beyond the tolerance.
+     */
+    bool check(const std::string &key, uint32_t p99Micros, uint32_t &baselineMicros);
+
+    void save();
+};
+
+/**
+ * @brief The baseline shared by all tests of the suite.
+ */
+SloBaseline &sloBaseline();
+
+/**
+ * @brief Fails the running test when a p99 regressed from the suite's baseline.
+ */
+void expectWithinBaseline(const std::string &key, uint32_t p99Micros);
+
+#endif // SLO_HARNESS_H
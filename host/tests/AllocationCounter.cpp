@@ -0,0 +1,82 @@
+/**
+ * @file AllocationCounter.cpp
+ * @brief Global operator new and delete that count per thread.
+ */
+
+#include "AllocationCounter.h"
+#include <new>
+#include <stdlib.h>
+
+namespace
+{
+
+thread_local uint64_t allocations = 0;
+thread_local uint64_t allocatedBytes = 0;
+
+void *countedAllocate(size_t size)
+{
+    allocations++;
+    allocatedBytes += size;
+    void *block = malloc(size > 0 ? size : 1);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+} // namespace
+
+uint64_t threadAllocations()
+{
+    return allocations;
+}
+
+uint64_t threadAllocatedBytes()
+{
+    return allocatedBytes;
+}
+
+void *operator new(size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new[](size_t size)
+{
+    return countedAllocate(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    allocations++;
+    allocatedBytes += size;
+    return malloc(size > 0 ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    allocations++;
+    allocatedBytes += size;
+    return malloc(size > 0 ? size : 1);
+}
+
+void operator delete(void *block) noexcept
+{
+    free(block);
+}
+
+void operator delete[](void *block) noexcept
+{
+    free(block);
+}
+
+void operator delete(void *block, size_t) noexcept
+{
+    free(block);
+}
+
+void operator delete[](void *block, size_t) noexcept
+{
+    free(block);
+}
@@ -0,0 +1,42 @@
+#ifndef HOST_ALLOCATION_COUNTER_H
+#define HOST_ALLOCATION_COUNTER_H
+
+/**
+ * @file AllocationCounter.h
+ * @brief Counts heap allocations made by the calling thread.
+ *
+ * AllocationCounter.cpp replaces the global operator new and delete of the executable it is linked
+ * into. Every allocation through them, including the ones std::string and the host String make,
+ * is counted on the thread that made it, so other test threads do not disturb a measurement.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Allocations made by the calling thread since it was created.
+ */
+uint64_t threadAllocations();
+
+/**
+ * @brief Bytes requested by those allocations.
+ */
+uint64_t threadAllocatedBytes();
+
+/**
+ * @brief Allocations made on the calling thread between construction and count().
+ */
+class AllocationScope
+{
+private:
+    uint64_t startCount;
+    uint64_t startBytes;
+
+public:
+    AllocationScope() : startCount(threadAllocations()), startBytes(threadAllocatedBytes()) {}
+
+    uint64_t count() const { return threadAllocations() - startCount; }
+    uint64_t bytes() const { return threadAllocatedBytes() - startBytes; }
+};
+
+#endif // HOST_ALLOCATION_COUNTER_H
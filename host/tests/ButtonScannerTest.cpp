@@ -0,0 +1,246 @@
+/**
+ * @file ButtonScannerTest.cpp
+ * @brief Debouncing and the long-press and double-click thresholds of ButtonScanner.
+ *
+ * scan() is fed one sample per millisecond, so every debounced edge lands 3 ms after the raw
+ * one and each threshold can be approached from both sides to the millisecond. Gestures are
+ * timed from the debounced PRESS and RELEASE events, as the scanner times them.
+ */
+
+#include "ButtonScanner.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+
+const uint32_t LONG_PRESS_MS = ButtonScanner::LONG_PRESS_MS;
+const uint32_t DOUBLE_CLICK_MS = ButtonScanner::DOUBLE_CLICK_MS;
+const uint8_t INPUT_PIN = 4;
+
+struct Raised
+{
+    ButtonGesture gesture;
+    uint32_t millis;
+};
+
+/**
+ * @brief One button, sampled every millisecond; records each event with its sample time.
+ */
+class Button : public EventHandler
+{
+public:
+    ButtonScanner scanner;
+    std::vector<Raised> raised;
+    uint32_t now;
+
+    Button(uint32_t startMillis = 1000) : scanner(this), now(startMillis)
+    {
+        scanner.addPin(INPUT_PIN);
+    }
+
+    Button(const Button &) = delete;
+
+    void on(Event event) override
+    {
+        ButtonGesture gesture;
+        uint8_t input;
+        ASSERT_TRUE(ButtonScanner::decode(event, gesture, input));
+        EXPECT_EQ(input, INPUT_PIN);
+        raised.push_back(Raised{gesture, now});
+    }
+
+    /**
+     * @brief Holds the raw level for some milliseconds, one sample each.
+     */
+    void hold(bool pressed, uint32_t ms, uint32_t step = 1)
+    {
+        for (uint32_t t = 0; t < ms; t += step)
+        {
+            scanner.scan(pressed ? ~(1UL << INPUT_PIN) : 0xFFFFFFFFUL, now);
+            now += step;
+        }
+    }
+
+    /**
+     * @brief Holds the raw level with contact bounce at its start.
+     */
+    void bounceThenHold(bool pressed, uint32_t ms)
+    {
+        hold(pressed, 1);
+        hold(!pressed, 1);
+        hold(pressed, 2);
+        hold(!pressed, 1);
+        hold(pressed, ms - 5);
+    }
+
+    std::vector<ButtonGesture> gestures() const
+    {
+        std::vector<ButtonGesture> result;
+        for (const Raised &event : raised)
+        {
+            result.push_back(event.gesture);
+        }
+        return result;
+    }
+
+    const Raised *find(ButtonGesture gesture, int nth = 0) const
+    {
+        for (const Raised &event : raised)
+        {
+            if (event.gesture == gesture && nth-- == 0)
+            {
+                return &event;
+            }
+        }
+        return nullptr;
+    }
+};
+
+typedef std::vector<ButtonGesture> Gestures;
+const ButtonGesture PRESS = ButtonGesture::PRESS;
+const ButtonGesture RELEASE = ButtonGesture::RELEASE;
+const ButtonGesture LONG_PRESS = ButtonGesture::LONG_PRESS;
+const ButtonGesture DOUBLE_CLICK = ButtonGesture::DOUBLE_CLICK;
+
+TEST(ButtonScanner, FourAgreeingSamplesDebounceAnEdge)
+{
+    Button button;
+    button.hold(false, 10);
+    button.hold(true, 3);
+    EXPECT_FALSE(button.scanner.isPressed(INPUT_PIN));
+    button.hold(false, 1); // A glitch starts the count again
+    button.hold(true, 3);
+    EXPECT_TRUE(button.raised.empty());
+    button.hold(true, 1);
+    EXPECT_TRUE(button.scanner.isPressed(INPUT_PIN));
+    EXPECT_EQ(button.gestures(), (Gestures{PRESS}));
+
+    // Bounce on both edges still gives one press and one release
+    Button bouncy;
+    bouncy.bounceThenHold(true, 100);
+    bouncy.bounceThenHold(false, 500);
+    EXPECT_EQ(bouncy.gestures(), (Gestures{PRESS, RELEASE}));
+    EXPECT_EQ(bouncy.scanner.getPressed(), 0u);
+}
+
+TEST(ButtonScanner, LongPressIsRaisedAt800Milliseconds)
+{
+    // Held: raised once, exactly LONG_PRESS_MS after the press
+    Button held;
+    held.hold(true, 3000);
+    ASSERT_EQ(held.gestures(), (Gestures{PRESS, LONG_PRESS}));
+    EXPECT_EQ(held.raised[1].millis - held.raised[0].millis, LONG_PRESS_MS);
+    held.hold(false, 10);
+    EXPECT_EQ(held.gestures(), (Gestures{PRESS, LONG_PRESS, RELEASE}));
+
+    // Released 1 ms before the threshold: a plain press
+    Button under;
+    under.hold(true, LONG_PRESS_MS - 1);
+    under.hold(false, 1000);
+    ASSERT_EQ(under.gestures(), (Gestures{PRESS, RELEASE}));
+    EXPECT_EQ(under.raised[1].millis - under.raised[0].millis, LONG_PRESS_MS - 1);
+
+    // Released 1 ms after it: the long press came first
+    Button over;
+    over.hold(true, LONG_PRESS_MS + 1);
+    over.hold(false, 1000);
+    ASSERT_EQ(over.gestures(), (Gestures{PRESS, LONG_PRESS, RELEASE}));
+    EXPECT_EQ(over.raised[1].millis - over.raised[0].millis, LONG_PRESS_MS);
+    EXPECT_EQ(over.raised[2].millis - over.raised[0].millis, LONG_PRESS_MS + 1);
+
+    // At the 5 ms timer tick, and across the millis() wrap
+    Button ticked(0xFFFFFFFFUL - 400);
+    ticked.hold(true, 2000, ButtonScanner::TICK_US / 1000);
+    ASSERT_EQ(ticked.gestures(), (Gestures{PRESS, LONG_PRESS}));
+    EXPECT_EQ(ticked.raised[1].millis - ticked.raised[0].millis, LONG_PRESS_MS);
+}
+
+/**
+ * @brief Two clicks whose debounced release-to-press gap is exactly gapMillis.
+ */
+void clickTwice(Button &button, uint32_t gapMillis)
+{
+    button.hold(true, 80);
+    button.hold(false, gapMillis);
+    button.hold(true, 80);
+    button.hold(false, 1000);
+    const Raised *released = button.find(RELEASE);
+    const Raised *pressed = button.find(PRESS, 1);
+    EXPECT_NE(released, nullptr);
+    EXPECT_NE(pressed, nullptr);
+    if (released != nullptr && pressed != nullptr)
+    {
+        EXPECT_EQ(pressed->millis - released->millis, gapMillis);
+    }
+}
+
+Gestures doubleClick(uint32_t gapMillis)
+{
+    Button button;
+    clickTwice(button, gapMillis);
+    return button.gestures();
+}
+
+TEST(ButtonScanner, DoubleClickNeedsAGapOfAtMost300Milliseconds)
+{
+    EXPECT_EQ(doubleClick(DOUBLE_CLICK_MS - 1), (Gestures{PRESS, RELEASE, PRESS, DOUBLE_CLICK, RELEASE}));
+    EXPECT_EQ(doubleClick(DOUBLE_CLICK_MS), (Gestures{PRESS, RELEASE, PRESS, DOUBLE_CLICK, RELEASE}));
+    EXPECT_EQ(doubleClick(DOUBLE_CLICK_MS + 1), (Gestures{PRESS, RELEASE, PRESS, RELEASE}));
+
+    // The double click is raised with the second press
+    Button quick;
+    clickTwice(quick, 100);
+    EXPECT_EQ(quick.find(DOUBLE_CLICK)->millis, quick.find(PRESS, 1)->millis);
+}
+
+TEST(ButtonScanner, AGestureStartsNoNewClick)
+{
+    // A third quick click after a double click is a fresh first click
+    Button triple;
+    for (int click = 0; click < 3; click++)
+    {
+        triple.hold(true, 80);
+        triple.hold(false, 100);
+    }
+    EXPECT_EQ(triple.gestures(), (Gestures{PRESS, RELEASE, PRESS, DOUBLE_CLICK, RELEASE, PRESS, RELEASE}));
+
+    // Nor does a long press: a quick click after it is a single click
+    Button afterLong;
+    afterLong.hold(true, LONG_PRESS_MS + 100);
+    afterLong.hold(false, 100);
+    afterLong.hold(true, 80);
+    afterLong.hold(false, 500);
+    EXPECT_EQ(afterLong.gestures(), (Gestures{PRESS, LONG_PRESS, RELEASE, PRESS, RELEASE}));
+
+    // A second press held past the threshold is a double click, never also a long press
+    Button clickAndHold;
+    clickAndHold.hold(true, 80);
+    clickAndHold.hold(false, 100);
+    clickAndHold.hold(true, 2 * LONG_PRESS_MS);
+    EXPECT_EQ(clickAndHold.gestures(), (Gestures{PRESS, RELEASE, PRESS, DOUBLE_CLICK}));
+}
+
+TEST(ButtonScanner, EventsCarryGestureAndInput)
+{
+    for (uint8_t input : {0, 7, 31})
+    {
+        for (ButtonGesture gesture : {PRESS, RELEASE, LONG_PRESS, DOUBLE_CLICK})
+        {
+            ButtonGesture decodedGesture;
+            uint8_t decodedInput;
+            ASSERT_TRUE(ButtonScanner::decode(ButtonScanner::eventFor(gesture, input), decodedGesture, decodedInput));
+            EXPECT_EQ(decodedGesture, gesture);
+            EXPECT_EQ(decodedInput, input);
+        }
+    }
+    ButtonGesture gesture;
+    uint8_t input;
+    EXPECT_FALSE(ButtonScanner::decode(Event(ButtonScanner::EVENT_ID_BASE - 1), gesture, input));
+    EXPECT_FALSE(ButtonScanner::decode(Event(ButtonScanner::EVENT_ID_BASE + 4 * ButtonScanner::MAX_INPUTS), gesture, input));
+
+    ButtonScanner scanner;
+    EXPECT_FALSE(scanner.addPin(ButtonScanner::MAX_INPUTS));
+}
+
+} // namespace
@@ -0,0 +1,199 @@
+/**
+ * @file DualCoreRunnerTest.cpp
+ * @brief Wall-time isolation of the real-time loop from I/O stalls, on the std::thread backend.
+ *
+ * A 5 ms real-time step and a 100 ms I/O step run for two seconds of wall time. Every third I/O
+ * step stalls the way a full UART or a clock-stretched LCD does: it blocks, here for 60 ms. Run
+ * in turn from one loop, as loop() does, each stall holds the real-time step back; run by
+ * DualCoreRunner on two threads, the real-time step keeps its slots. Events go from the
+ * real-time side to the I/O side, and commands back, through the mailboxes while this happens.
+ */
+
+#include "CoreMailbox.h"
+#include "DualCoreRunner.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+
+const uint32_t REAL_TIME_PERIOD_US = 5000;
+const uint32_t IO_PERIOD_US = 100000;
+const uint32_t STALL_US = 60000;
+const uint32_t LATENESS_BUDGET_US = 2000;
+const std::chrono::milliseconds RUN_TIME(2000);
+
+uint64_t wallMicros()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief Receives on the I/O side and checks nothing arrives out of order.
+ */
+struct IoSide : public EventHandler
+{
+    uint32_t received = 0;
+    int lastId = -1;
+    uint32_t outOfOrder = 0;
+
+    void on(Event event) override
+    {
+        if (event.id <= lastId)
+        {
+            outOfOrder++;
+        }
+        lastId = event.id;
+        received++;
+    }
+};
+
+struct RealTimeSide : public CommandHandler
+{
+    uint32_t commands = 0;
+
+    void handle(Command command) override
+    {
+        commands++;
+    }
+};
+
+/**
+ * @brief The two halves of a device, wired through mailboxes as a dual-core device is.
+ */
+struct SplitDevice
+{
+    IoSide io;
+    RealTimeSide realTime;
+    EventMailbox toIo;
+    CommandMailbox toRealTime;
+    uint32_t realTimeSteps = 0;
+    uint32_t ioSteps = 0;
+    uint32_t eventsSent = 0;
+    uint32_t commandsSent = 0;
+
+    SplitDevice() : toIo(&io), toRealTime(&realTime) {}
+
+    static void realTimeStep(void *context)
+    {
+        SplitDevice *device = static_cast<SplitDevice *>(context);
+        device->toRealTime.deliver();
+        // A level change now and then, as the sensor raises them
+        if (device->realTimeSteps % 10 == 0)
+        {
+            device->toIo.on(Event(device->eventsSent++ % 30000));
+        }
+        device->realTimeSteps++;
+    }
+
+    static void ioStep(void *context)
+    {
+        SplitDevice *device = static_cast<SplitDevice *>(context);
+        device->toIo.deliver();
+        device->toRealTime.handle(Command(1));
+        device->commandsSent++;
+        if (device->ioSteps++ % 3 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(STALL_US));
+        }
+    }
+};
+
+struct IsolationResult
+{
+    uint32_t latenessP99;
+    uint32_t latenessMax;
+    uint32_t realTimeSteps;
+    uint32_t ioSteps;
+};
+
+IsolationResult runSingleLoop(SplitDevice &device)
+{
+    // Both steps in turn from one task, each at its own slot
+    LatencyHistogram lateness("single loop", LATENESS_BUDGET_US);
+    uint64_t start = wallMicros();
+    uint64_t end = start + std::chrono::duration_cast<std::chrono::microseconds>(RUN_TIME).count();
+    uint64_t nextRealTime = start;
+    uint64_t nextIo = start;
+    while (wallMicros() < end)
+    {
+        uint64_t now = wallMicros();
+        if (now >= nextRealTime)
+        {
+            uint64_t late = now - nextRealTime;
+            lateness.record(late > LatencyHistogram::MAX_TRACKED ? LatencyHistogram::MAX_TRACKED : (uint32_t)late);
+            SplitDevice::realTimeStep(&device);
+            nextRealTime += REAL_TIME_PERIOD_US;
+            if (nextRealTime + REAL_TIME_PERIOD_US < wallMicros())
+            {
+                nextRealTime = wallMicros();
+            }
+        }
+        if (wallMicros() >= nextIo)
+        {
+            SplitDevice::ioStep(&device);
+            nextIo += IO_PERIOD_US;
+        }
+        uint64_t next = nextRealTime < nextIo ? nextRealTime : nextIo;
+        now = wallMicros();
+        if (next > now)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(next - now));
+        }
+    }
+    return IsolationResult{lateness.percentile(990), lateness.getMaxMicros(), device.realTimeSteps, device.ioSteps};
+}
+
+IsolationResult runDualCore(SplitDevice &device)
+{
+    DualCoreRunner runner(SplitDevice::realTimeStep, SplitDevice::ioStep, &device, REAL_TIME_PERIOD_US, IO_PERIOD_US,
+                          LATENESS_BUDGET_US);
+    EXPECT_TRUE(runner.start());
+    std::this_thread::sleep_for(RUN_TIME);
+    runner.stop();
+    const LatencyHistogram &lateness = runner.getRealTimeLateness();
+    return IsolationResult{lateness.percentile(990), lateness.getMaxMicros(), runner.getRealTimeSteps(),
+                           runner.getIoSteps()};
+}
+
+TEST(DualCoreRunner, RealTimeLoopIsIsolatedFromIoStalls)
+{
+    SplitDevice single;
+    IsolationResult oneLoop = runSingleLoop(single);
+    SplitDevice split;
+    IsolationResult twoCores = runDualCore(split);
+    // What is left in the mailboxes after the runner stopped
+    split.toIo.deliver();
+    split.toRealTime.deliver();
+
+    printf("[ cores    ] single loop: %lu real-time steps, lateness p99 %lu us max %lu us\n",
+           (unsigned long)oneLoop.realTimeSteps, (unsigned long)oneLoop.latenessP99, (unsigned long)oneLoop.latenessMax);
+    printf("[ cores    ] dual core:   %lu real-time steps, lateness p99 %lu us max %lu us; "
+           "%lu I/O steps, %lu events and %lu commands handed over\n",
+           (unsigned long)twoCores.realTimeSteps, (unsigned long)twoCores.latenessP99,
+           (unsigned long)twoCores.latenessMax, (unsigned long)twoCores.ioSteps, (unsigned long)split.io.received,
+           (unsigned long)split.realTime.commands);
+
+    const uint32_t slots = (uint32_t)(RUN_TIME.count() * 1000 / REAL_TIME_PERIOD_US);
+    // One loop: every stall holds a real-time step back by about its length, and slots are lost
+    EXPECT_GE(oneLoop.latenessMax, STALL_US - 2 * REAL_TIME_PERIOD_US);
+    EXPECT_LT(oneLoop.realTimeSteps, slots * 9 / 10);
+
+    // Two threads: the real-time loop keeps its rate and starts each step near its slot. The
+    // bounds leave room for a loaded host; the stall is 30 times larger
+    EXPECT_GE(twoCores.realTimeSteps, slots * 9 / 10);
+    EXPECT_LT(twoCores.latenessP99, STALL_US / 4);
+    EXPECT_GE(twoCores.ioSteps, 10u);
+
+    // Nothing lost or reordered crossing the cores
+    EXPECT_EQ(split.toIo.getDropped(), 0u);
+    EXPECT_EQ(split.toRealTime.getDropped(), 0u);
+    EXPECT_EQ(split.io.received, split.eventsSent);
+    EXPECT_EQ(split.io.outOfOrder, 0u);
+    EXPECT_EQ(split.realTime.commands, split.commandsSent);
+}
+
+} // namespace
@@ -0,0 +1,273 @@
+/**
+ * @file FaucetJournalTest.cpp
+ * @brief Restore time and write amplification of the faucet journal on a file-backed flash stand-in.
+ *
+ * A day of faucet use is journaled one flush per loop pass, as persistJournal() does, and
+ * restored by a fresh journal as after a reboot: once from snapshot and tail, and once from a
+ * log that keeps every record, which is what restoring without snapshots costs. Power is also
+ * cut at every byte of the flush that writes a snapshot; each reboot must restore exactly the
+ * records that reached flash, and keep journaling after them. Finally, flushes fail for a while
+ * with the device still running; records dropped meanwhile must not strand the ones after them.
+ */
+
+#include "FaucetJournal.h"
+#include "FlashStandIn.h"
+#include "Led.h"
+#include "RelayModule.h"
+#include "UltrasoundSensor.h"
+#include "VirtualBoard.h"
+#include <gtest/gtest.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const uint32_t VALVE_OPEN_MS = 5000;
+
+struct Entry
+{
+    JournalKind kind;
+    int16_t id;
+    uint32_t timeMillis;
+};
+
+typedef std::vector<Entry> Pass;
+
+/**
+ * @brief Journal entries of a day at a busy sink: hand washes, LED toggles and the odd manual
+ * close from the button.
+ */
+std::vector<Pass> dayOfUse(uint32_t washes)
+{
+    std::mt19937 random(48);
+    std::uniform_int_distribution<uint32_t> gap(20000, 300000);
+    std::uniform_int_distribution<uint32_t> washMillis(3000, 20000);
+    std::uniform_int_distribution<int> extra(0, 9);
+    std::vector<Pass> passes;
+    uint32_t time = 0;
+    for (uint32_t i = 0; i < washes; i++)
+    {
+        time += gap(random);
+        passes.push_back({{JournalKind::EVENT, UltrasoundSensor::PROXIMITY_DETECTED_EVENT_ID, time},
+                          {JournalKind::COMMAND, RelayModule::OPEN_VALVE_TIMED_COMMAND_ID, time}});
+        time += washMillis(random);
+        passes.push_back({{JournalKind::EVENT, UltrasoundSensor::PROXIMITY_LOST_EVENT_ID, time}});
+        int roll = extra(random);
+        if (roll == 0)
+        {
+            time += 1000;
+            passes.push_back({{JournalKind::COMMAND, RelayModule::CLOSE_VALVE_COMMAND_ID, time}});
+        }
+        else if (roll == 1)
+        {
+            time += 1000;
+            passes.push_back({{JournalKind::COMMAND, Led::TOGGLE_LED_COMMAND_ID, time},
+                              {JournalKind::COMMAND, Led::TOGGLE_LED_COMMAND_ID, time + 400},
+                              {JournalKind::COMMAND, Led::TOGGLE_LED_COMMAND_ID, time + 800}});
+        }
+    }
+    return passes;
+}
+
+void journal(FaucetJournal &target, const Pass &pass)
+{
+    for (const Entry &entry : pass)
+    {
+        target.append(entry.kind, entry.id, entry.timeMillis);
+    }
+    target.flush();
+}
+
+bool sameState(const FaucetState &a, const FaucetState &b)
+{
+    return memcmp(&a, &b, sizeof(FaucetState)) == 0;
+}
+
+/**
+ * @brief Restores from storage, the fastest of a few boots.
+ */
+double restoreMicros(FileJournalStorage &storage, FaucetState &restored, uint32_t &replayed)
+{
+    double best = 1e12;
+    for (int boot = 0; boot < 20; boot++)
+    {
+        FaucetJournal rebooted(&storage, VALVE_OPEN_MS);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        rebooted.begin();
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+        restored = rebooted.getState();
+        replayed = rebooted.getReplayed();
+    }
+    return best;
+}
+
+TEST(FaucetJournal, RestoresADayFromSnapshotAndTail)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    std::vector<Pass> passes = dayOfUse(600);
+
+    FileJournalStorage compacted;
+    FileJournalStorage fullLog(false);
+    FaucetJournal live(&compacted, VALVE_OPEN_MS);
+    FaucetJournal unsnapshotted(&fullLog, VALVE_OPEN_MS);
+    ASSERT_TRUE(live.begin());
+    ASSERT_TRUE(unsnapshotted.begin());
+    for (const Pass &pass : passes)
+    {
+        journal(live, pass);
+        journal(unsnapshotted, pass);
+    }
+
+    uint64_t recordBytes = (uint64_t)live.getAppended() * sizeof(JournalRecord);
+    double pageAmplification = (double)compacted.getPageBytesProgrammed() / recordBytes;
+    FaucetState restored;
+    uint32_t replayed;
+    double snapshotMicros = restoreMicros(compacted, restored, replayed);
+    FaucetState fullRestored;
+    uint32_t fullReplayed;
+    double fullMicros = restoreMicros(fullLog, fullRestored, fullReplayed);
+
+    printf("[ journal  ] a day, %lu records in %lu passes: %.3f bytes written per record byte, "
+           "%.1f counting 256-byte page programs\n",
+           (unsigned long)live.getAppended(), (unsigned long)passes.size(), live.getWriteAmplification(),
+           pageAmplification);
+    printf("[ journal  ] restore: snapshot + %lu-record tail %.0f us; whole %lu-record log %.0f us\n",
+           (unsigned long)replayed, snapshotMicros, (unsigned long)fullReplayed, fullMicros);
+
+    // The exact state, either way
+    EXPECT_TRUE(sameState(restored, live.getPersistedState()));
+    EXPECT_TRUE(sameState(fullRestored, live.getPersistedState()));
+    EXPECT_EQ(fullReplayed, live.getAppended());
+    EXPECT_LT(replayed, (uint32_t)FaucetJournal::SNAPSHOT_INTERVAL + FaucetJournal::BATCH_RECORDS);
+
+    // Log and snapshots together: records once, plus one small snapshot per interval
+    EXPECT_FLOAT_EQ(live.getWriteAmplification(), (float)compacted.getBytesWritten() / recordBytes);
+    EXPECT_LT(live.getWriteAmplification(), 1.1f);
+}
+
+TEST(FaucetJournal, PowerCutAtAnyByteRestoresWhatReachedFlash)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    // Two records a pass up to one short of a snapshot, then a three-record pass that crosses it
+    std::vector<Entry> entries;
+    for (uint32_t i = 0; i < FaucetJournal::SNAPSHOT_INTERVAL - 2; i++)
+    {
+        int16_t id = i % 2 == 0 ? UltrasoundSensor::PROXIMITY_DETECTED_EVENT_ID
+                                : UltrasoundSensor::PROXIMITY_LOST_EVENT_ID;
+        entries.push_back({JournalKind::EVENT, id, 1000 * (i + 1)});
+    }
+    const size_t before = entries.size();
+    uint32_t last = entries.back().timeMillis;
+    Pass crossing = {{JournalKind::EVENT, UltrasoundSensor::PROXIMITY_DETECTED_EVENT_ID, last + 1000},
+                     {JournalKind::COMMAND, Led::TURN_OFF_COMMAND_ID, last + 1100},
+                     {JournalKind::COMMAND, RelayModule::CLOSE_VALVE_COMMAND_ID, last + 1200}};
+    Pass after = {{JournalKind::COMMAND, RelayModule::OPEN_VALVE_COMMAND_ID, last + 9000},
+                  {JournalKind::COMMAND, Led::TURN_ON_COMMAND_ID, last + 9100}};
+    const size_t logBytes = crossing.size() * sizeof(JournalRecord);
+
+    uint32_t cuts = 0;
+    for (size_t cut = 0; cut <= logBytes + 64; cut++)
+    {
+        FileJournalStorage storage;
+        {
+            FaucetJournal device(&storage, VALVE_OPEN_MS);
+            ASSERT_TRUE(device.begin());
+            for (size_t i = 0; i < before; i += 2)
+            {
+                journal(device, Pass(entries.begin() + i, entries.begin() + std::min(before, i + 2)));
+            }
+            storage.cutPowerAfter(cut);
+            journal(device, crossing);
+            if (!storage.isOff())
+            {
+                continue; // The whole flush fitted
+            }
+            cuts++;
+        }
+
+        // What reached flash: whole records of the crossing pass inside the cut
+        size_t kept = std::min(cut, logBytes) / sizeof(JournalRecord);
+        FaucetJournal reference(nullptr, VALVE_OPEN_MS);
+        reference.begin();
+        for (size_t i = 0; i < before; i++)
+        {
+            reference.append(entries[i].kind, entries[i].id, entries[i].timeMillis);
+        }
+        journal(reference, Pass(crossing.begin(), crossing.begin() + kept));
+
+        storage.powerOn();
+        FaucetJournal rebooted(&storage, VALVE_OPEN_MS);
+        ASSERT_TRUE(rebooted.begin());
+        ASSERT_TRUE(sameState(rebooted.getState(), reference.getState())) << "cut at byte " << cut;
+
+        // Journaling goes on after whatever was restored
+        journal(rebooted, after);
+        journal(reference, after);
+        FaucetJournal again(&storage, VALVE_OPEN_MS);
+        ASSERT_TRUE(again.begin());
+        ASSERT_TRUE(sameState(again.getState(), reference.getState())) << "cut at byte " << cut;
+    }
+    // Every byte of the log append and of the snapshot was cut at
+    EXPECT_GT(cuts, logBytes + sizeof(FaucetState));
+}
+
+TEST(FaucetJournal, RecordsAfterFailedFlushesSurviveAReboot)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    std::vector<Pass> passes = dayOfUse(30);
+    FileJournalStorage storage;
+    FaucetJournal device(&storage, VALVE_OPEN_MS);
+    ASSERT_TRUE(device.begin());
+    size_t pass = 0;
+    for (; pass < 10; pass++)
+    {
+        journal(device, passes[pass]);
+    }
+
+    // More records than a batch holds while every write fails
+    storage.failWrites(true);
+    uint32_t appendedBefore = device.getAppended();
+    for (; device.getAppended() - appendedBefore < FaucetJournal::BATCH_RECORDS + 8; pass++)
+    {
+        journal(device, passes[pass]);
+    }
+    ASSERT_GT(device.getLost(), 0u);
+    EXPECT_FALSE(sameState(device.getPersistedState(), device.getState()));
+
+    // Storage recovers; the valve opens and closes again after the lost records, well before a
+    // snapshot is due
+    storage.failWrites(false);
+    uint32_t activations = 0;
+    for (size_t end = pass + 6; pass < end; pass++)
+    {
+        journal(device, passes[pass]);
+    }
+    for (size_t i = 0; i < pass; i++)
+    {
+        activations += passes[i][0].id == UltrasoundSensor::PROXIMITY_DETECTED_EVENT_ID ? 1 : 0;
+    }
+    EXPECT_TRUE(sameState(device.getPersistedState(), device.getState()));
+
+    FaucetJournal rebooted(&storage, VALVE_OPEN_MS);
+    ASSERT_TRUE(rebooted.begin());
+    ASSERT_TRUE(sameState(rebooted.getState(), device.getState()));
+    EXPECT_EQ(rebooted.getState().activations, activations);
+
+    // And the log goes on from there
+    uint32_t last = rebooted.getState().timeMillis;
+    journal(rebooted, {{JournalKind::COMMAND, RelayModule::OPEN_VALVE_COMMAND_ID, last + 1000}});
+    FaucetJournal again(&storage, VALVE_OPEN_MS);
+    ASSERT_TRUE(again.begin());
+    EXPECT_TRUE(sameState(again.getState(), rebooted.getState()));
+    EXPECT_EQ(again.getState().valveOpen, 1);
+}
+
+} // namespace
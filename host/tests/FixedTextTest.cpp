@@ -0,0 +1,170 @@
+/**
+ * @file FixedTextTest.cpp
+ * @brief FixedText formatting, and zero heap activity on the display and status paths.
+ */
+
+#include "AllocationCounter.h"
+#include "DisplayManager.h"
+#include "FixedText.h"
+#include "GLPSecureSenseDevice.h"
+#include "I2cBusManager.h"
+#include "SloHarness.h"
+#include "mq2_stimulus.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace
+{
+
+const uint8_t LCD_ADDRESS = 0x27;
+const int GAS_ANALOG_PIN = 4;
+
+void driveGas(VirtualBoard &board, float ppm)
+{
+    board.setAnalog(GAS_ANALOG_PIN, (uint16_t)(mq2_ppm_to_voltage(ppm) / MQ2_VCC * 4095 + 0.5f));
+}
+
+TEST(FixedText, FormatsIntegersFixedPointAndKilo)
+{
+    FixedText<32> text;
+    text.appendInt(0).append('|').appendInt(-42).append('|').appendInt(2147483647L);
+    EXPECT_STREQ(text.c_str(), "0|-42|2147483647");
+
+    text.clear();
+    text.appendFixed(3.14159f, 2).append('|').appendFixed(-0.004f, 2).append('|').appendFixed(9.995f, 2);
+    EXPECT_STREQ(text.c_str(), "3.14|0.00|10.00");
+
+    text.clear();
+    text.appendKilo(999).append('|').appendKilo(1000).append('|').appendKilo(12345);
+    EXPECT_STREQ(text.c_str(), "999|1.0K|12.3K");
+}
+
+TEST(FixedText, PadsAndAlignsFields)
+{
+    FixedText<21> text;
+    text.appendPadded<6>("SAFE").append('|').appendInt<4>(42).append('|').appendInt<4>(7, TextAlign::RIGHT, '0');
+    EXPECT_STREQ(text.c_str(), "SAFE  |  42|0007");
+
+    // A field wider than its width is kept whole
+    text.clear();
+    text.appendInt<2>(12345);
+    EXPECT_STREQ(text.c_str(), "12345");
+}
+
+TEST(FixedText, TruncatesInsteadOfOverflowing)
+{
+    FixedText<8> text;
+    text.append("GLP SecureSense");
+    EXPECT_STREQ(text.c_str(), "GLP Sec");
+    EXPECT_EQ(text.size(), FixedText<8>::capacity());
+    text.appendInt(5).append('x');
+    EXPECT_STREQ(text.c_str(), "GLP Sec");
+
+    char small[4];
+    EXPECT_EQ(text_format::formatInt(small, sizeof(small), -12345), 3u);
+    EXPECT_STREQ(small, "-12");
+    EXPECT_EQ(text_format::formatFixed(small, sizeof(small), 1.5f, 2), 3u);
+    EXPECT_STREQ(small, "1.5");
+}
+
+TEST(FixedText, MatchesPrintfOverTheDisplayRange)
+{
+    char expected[24];
+    for (int tenths = 0; tenths < 100000; tenths += 7)
+    {
+        float value = tenths / 10.0f;
+        snprintf(expected, sizeof(expected), "%.1f", value);
+        FixedText<24> text;
+        text.appendFixed(value, 1);
+        ASSERT_STREQ(text.c_str(), expected) << value;
+    }
+}
+
+TEST(FixedTextAllocations, CounterSeesStringConcatenation)
+{
+    // The String building the display used to do, so a zero below means something
+    AllocationScope allocations;
+    String line = String("PPM: ") + String(12345) + " (" + String(42) + "%) MODERATE";
+    EXPECT_GT(allocations.count(), 0u);
+    EXPECT_GT(line.length(), 20u);
+}
+
+TEST(FixedTextAllocations, DisplayFramesDoNotTouchTheHeap)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    board.addI2cDevice(LCD_ADDRESS);
+    I2cBusManager bus;
+    bus.begin();
+    DisplayManager display(LCD_ADDRESS, &bus);
+    display.initialize();
+
+    GasReading reading = {};
+    const GasLevel levels[] = {GasLevel::SAFE, GasLevel::MODERATE, GasLevel::CRITICAL};
+    AllocationScope allocations;
+    for (int frame = 0; frame < 2000; frame++)
+    {
+        // Every width the PPM field takes, every level and status text
+        reading.ppm = 40 * powf(1.005f, (float)frame);
+        reading.percentage = frame % 101;
+        reading.level = levels[frame % 3];
+        reading.timestamp = millis();
+        display.updateDisplay(reading, GasSensor::statusText(reading));
+        bus.waitIdle(100);
+        delay(500);
+    }
+    display.showErrorMessage("Sensor fault");
+    bus.waitIdle(100);
+
+    printf("[ alloc    ] %lu display frames: %llu allocations, %llu bytes\n",
+           (unsigned long)display.getRedrawCount(), (unsigned long long)allocations.count(),
+           (unsigned long long)allocations.bytes());
+    EXPECT_GT(display.getRedrawCount(), 1900u);
+    EXPECT_EQ(allocations.count(), 0u);
+}
+
+TEST(FixedTextAllocations, DeviceLoopDoesNotTouchTheHeapOnceRunning)
+{
+    // The whole detector: sensing, classification, LEDs, LCD, serial log and history, over a leak
+    uint64_t allocationsRunning = 0;
+    uint64_t passes = 0;
+    runIsolated([&]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        board.addI2cDevice(LCD_ADDRESS);
+        // R0 is calibrated against zero PPM in initialize(), as GasSloTest does
+        driveGas(board, 0);
+        GLPSecureSenseDevice *device = new GLPSecureSenseDevice();
+        device->initialize();
+
+        // A first minute for whatever is set up lazily
+        driveGas(board, 100);
+        uint64_t warmUntil = board.now() + 60000000ULL;
+        while (board.now() < warmUntil)
+        {
+            device->run();
+            device->idle();
+        }
+
+        AllocationScope allocations;
+        uint64_t start = board.now();
+        while (board.now() < start + 5ULL * 60 * 1000000)
+        {
+            float seconds = (board.now() - start) / 1e6f;
+            float ppm = seconds < 60 ? 100 : 100 + 6 * (seconds - 60);
+            driveGas(board, ppm);
+            device->run();
+            device->idle();
+            passes++;
+        }
+        allocationsRunning = allocations.count();
+        delete device;
+    });
+
+    printf("[ alloc    ] %llu device passes: %llu allocations\n", (unsigned long long)passes,
+           (unsigned long long)allocationsRunning);
+    EXPECT_GT(passes, 1000u);
+    EXPECT_EQ(allocationsRunning, 0u);
+}
+
+} // namespace
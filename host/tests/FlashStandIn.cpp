@@ -0,0 +1,236 @@
+/**
+ * @file FlashStandIn.cpp
+ * @brief File-backed flash stand-ins.
+ */
+
+#include "FlashStandIn.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <filesystem>
+#include <stdexcept>
+
+FlashDirectory::FlashDirectory(const char *prefix) : writes(0), bytesWritten(0), pageBytesProgrammed(0), reads(0)
+{
+    std::string pattern = (std::filesystem::temp_directory_path() / prefix).string() + "_XXXXXX";
+    if (mkdtemp(&pattern[0]) == nullptr)
+    {
+        throw std::runtime_error("cannot create " + pattern);
+    }
+    directory = pattern;
+}
+
+FlashDirectory::~FlashDirectory()
+{
+    std::error_code ignored;
+    std::filesystem::remove_all(directory, ignored);
+}
+
+void FlashDirectory::countWrite(size_t length)
+{
+    writes++;
+    bytesWritten += length;
+    pageBytesProgrammed += (length + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+}
+
+void FlashDirectory::resetCounters()
+{
+    writes = 0;
+    bytesWritten = 0;
+    pageBytesProgrammed = 0;
+    reads = 0;
+}
+
+FileSegmentStorage::FileSegmentStorage() : FlashDirectory("gas_history") {}
+
+std::string FileSegmentStorage::pathOf(uint32_t sequence) const
+{
+    char name[16];
+    snprintf(name, sizeof(name), "%08lx", (unsigned long)sequence);
+    return directory + "/" + name;
+}
+
+bool FileSegmentStorage::begin()
+{
+    return std::filesystem::is_directory(directory);
+}
+
+bool FileSegmentStorage::range(uint32_t &first, uint32_t &next)
+{
+    bool any = false;
+    for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(directory))
+    {
+        std::string name = entry.path().filename().string();
+        char *end;
+        uint32_t sequence = strtoul(name.c_str(), &end, 16);
+        if (end == name.c_str() || *end != '\0')
+        {
+            continue;
+        }
+        if (!any || sequence < first)
+        {
+            first = sequence;
+        }
+        if (!any || sequence >= next)
+        {
+            next = sequence + 1;
+        }
+        any = true;
+    }
+    return any;
+}
+
+bool FileSegmentStorage::append(uint32_t sequence, const uint8_t *data, size_t length)
+{
+    FILE *file = fopen(pathOf(sequence).c_str(), "ab");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    size_t written = fwrite(data, 1, length, file);
+    bool closed = fclose(file) == 0;
+    countWrite(length);
+    return written == length && closed;
+}
+
+size_t FileSegmentStorage::read(uint32_t sequence, size_t offset, uint8_t *dst, size_t length)
+{
+    FILE *file = fopen(pathOf(sequence).c_str(), "rb");
+    if (file == nullptr)
+    {
+        return 0;
+    }
+    reads++;
+    size_t got = fseek(file, (long)offset, SEEK_SET) == 0 ? fread(dst, 1, length, file) : 0;
+    fclose(file);
+    return got;
+}
+
+bool FileSegmentStorage::remove(uint32_t sequence)
+{
+    return ::remove(pathOf(sequence).c_str()) == 0;
+}
+
+FileJournalStorage::FileJournalStorage(bool compacting)
+    : FlashDirectory("faucet_journal"), logPath(directory + "/log"), snapshotPath(directory + "/snapshot"),
+      pendingPath(directory + "/snapshot.new"), compacting(compacting), powerCut(false), off(false), failing(false), budget(0)
+{
+}
+
+void FileJournalStorage::cutPowerAfter(size_t bytes)
+{
+    powerCut = true;
+    off = false;
+    budget = bytes;
+}
+
+void FileJournalStorage::powerOn()
+{
+    powerCut = false;
+    off = false;
+}
+
+size_t FileJournalStorage::allow(size_t length)
+{
+    if (!powerCut)
+    {
+        return length;
+    }
+    size_t allowed = length < budget ? length : budget;
+    budget -= allowed;
+    if (budget == 0)
+    {
+        off = true;
+    }
+    return allowed;
+}
+
+size_t FileJournalStorage::getLogBytes() const
+{
+    std::error_code missing;
+    uintmax_t size = std::filesystem::file_size(logPath, missing);
+    return missing ? 0 : (size_t)size;
+}
+
+bool FileJournalStorage::begin()
+{
+    return !off && std::filesystem::is_directory(directory);
+}
+
+bool FileJournalStorage::append(const uint8_t *data, size_t length)
+{
+    if (off || failing)
+    {
+        return false;
+    }
+    FILE *file = fopen(logPath.c_str(), "ab");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    size_t allowed = allow(length);
+    size_t written = fwrite(data, 1, allowed, file);
+    bool closed = fclose(file) == 0;
+    countWrite(allowed);
+    return written == length && closed;
+}
+
+size_t FileJournalStorage::readLog(size_t offset, uint8_t *dst, size_t length)
+{
+    FILE *file = fopen(logPath.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return 0;
+    }
+    reads++;
+    size_t got = fseek(file, (long)offset, SEEK_SET) == 0 ? fread(dst, 1, length, file) : 0;
+    fclose(file);
+    return got;
+}
+
+bool FileJournalStorage::clearLog()
+{
+    if (off || !compacting)
+    {
+        return false;
+    }
+    std::error_code ignored;
+    std::filesystem::remove(logPath, ignored);
+    return true;
+}
+
+bool FileJournalStorage::writeSnapshot(const uint8_t *data, size_t length)
+{
+    if (off || failing || !compacting)
+    {
+        return false;
+    }
+    FILE *file = fopen(pendingPath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        return false;
+    }
+    size_t allowed = allow(length);
+    size_t written = fwrite(data, 1, allowed, file);
+    bool closed = fclose(file) == 0;
+    countWrite(allowed);
+    if (written != length || !closed)
+    {
+        return false;
+    }
+    std::error_code failed;
+    std::filesystem::rename(pendingPath, snapshotPath, failed);
+    return !failed;
+}
+
+size_t FileJournalStorage::readSnapshot(uint8_t *dst, size_t length)
+{
+    FILE *file = fopen(snapshotPath.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return 0;
+    }
+    reads++;
+    size_t got = fread(dst, 1, length, file);
+    fclose(file);
+    return got;
+}
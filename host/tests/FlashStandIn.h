@@ -0,0 +1,115 @@
+#ifndef HOST_FLASH_STAND_IN_H
+#define HOST_FLASH_STAND_IN_H
+
+/**
+ * @file FlashStandIn.h
+ * @brief File-backed stand-ins for the devices' flash storage backends.
+ *
+ * Each stand-in keeps its files in a fresh directory under the system temp directory, removed
+ * again on destruction, and goes through the file system for every call, as the LittleFS
+ * backends do. Writes are counted twice: the bytes handed over, and the bytes of the 256-byte
+ * flash pages those writes program, since a write always programs whole pages.
+ */
+
+#include "JournalStorage.h"
+#include "SegmentStorage.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * @brief A temporary directory and the write counters shared by the stand-ins.
+ */
+class FlashDirectory
+{
+public:
+    static const size_t PAGE_BYTES = 256;
+
+protected:
+    std::string directory;
+    uint64_t writes;
+    uint64_t bytesWritten;
+    uint64_t pageBytesProgrammed;
+    uint64_t reads;
+
+    void countWrite(size_t length);
+
+public:
+    explicit FlashDirectory(const char *prefix);
+    ~FlashDirectory();
+
+    FlashDirectory(const FlashDirectory &) = delete;
+    FlashDirectory &operator=(const FlashDirectory &) = delete;
+
+    const std::string &getDirectory() const { return directory; }
+    uint64_t getWrites() const { return writes; }
+    uint64_t getBytesWritten() const { return bytesWritten; }
+    uint64_t getPageBytesProgrammed() const { return pageBytesProgrammed; }
+    uint64_t getReads() const { return reads; }
+    void resetCounters();
+};
+
+/**
+ * @brief GasHistory segments as one file each, like LittleFsSegmentStorage.
+ */
+class FileSegmentStorage : public SegmentStorage, public FlashDirectory
+{
+public:
+    FileSegmentStorage();
+
+    std::string pathOf(uint32_t sequence) const;
+
+    bool begin() override;
+    bool range(uint32_t &first, uint32_t &next) override;
+    bool append(uint32_t sequence, const uint8_t *data, size_t length) override;
+    size_t read(uint32_t sequence, size_t offset, uint8_t *dst, size_t length) override;
+    bool remove(uint32_t sequence) override;
+};
+
+/**
+ * @brief The faucet journal as a "log" file and a "snapshot" file replaced by rename, like
+ * LittleFsJournalStorage.
+ *
+ * cutPowerAfter() simulates a reset part-way through the writes that follow: the write that
+ * crosses the byte budget stops at it, a snapshot cut short is never renamed into place, and
+ * every later call fails as if the device were off. powerOn() ends the cut; a new journal on
+ * the same storage is then the reboot. failWrites() instead rejects whole writes while the
+ * device keeps running, as a full or busy file system does.
+ */
+class FileJournalStorage : public JournalStorage, public FlashDirectory
+{
+private:
+    std::string logPath;
+    std::string snapshotPath;
+    std::string pendingPath;
+    bool compacting;
+    bool powerCut;
+    bool off;
+    bool failing;
+    size_t budget;
+
+    size_t allow(size_t length);
+
+public:
+    /**
+     * @brief Creates the stand-in in a new directory.
+     * @param compacting False keeps every record in the log and discards snapshots, for
+     *        comparing with a journal that replays its whole history.
+     */
+    explicit FileJournalStorage(bool compacting = true);
+
+    void cutPowerAfter(size_t bytes);
+    void powerOn();
+    void failWrites(bool failing) { this->failing = failing; }
+    bool isOff() const { return off; }
+    size_t getLogBytes() const;
+
+    bool begin() override;
+    bool append(const uint8_t *data, size_t length) override;
+    size_t readLog(size_t offset, uint8_t *dst, size_t length) override;
+    bool clearLog() override;
+    bool writeSnapshot(const uint8_t *data, size_t length) override;
+    size_t readSnapshot(uint8_t *dst, size_t length) override;
+};
+
+#endif // HOST_FLASH_STAND_IN_H
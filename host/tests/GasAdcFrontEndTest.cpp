@@ -0,0 +1,211 @@
+/**
+ * @file GasAdcFrontEndTest.cpp
+ * @brief Decimation, noise floor, rates and non-blocking polls of the ADC front end.
+ *
+ * A scripted source hands over exactly the conversions a test makes ready, so every block is
+ * known; ClockedAdcSource then feeds the front end from analogRead() on the virtual board.
+ */
+
+#include "AdcSources.h"
+#include "GasAdcFrontEnd.h"
+#include "VirtualBoard.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <deque>
+#include <vector>
+
+namespace
+{
+
+/**
+ * @brief Conversions queued by the test; available() is what has been made ready.
+ */
+class ScriptedSource : public AdcSampleSource
+{
+public:
+    std::deque<uint16_t> ready;
+    uint32_t reads = 0;
+    uint32_t services = 0;
+
+    void begin() override {}
+
+    void service() override
+    {
+        services++;
+    }
+
+    size_t available() const override
+    {
+        return ready.size();
+    }
+
+    size_t read(uint16_t *dst, size_t maxSamples) override
+    {
+        reads++;
+        size_t count = 0;
+        while (count < maxSamples && !ready.empty())
+        {
+            dst[count++] = ready.front();
+            ready.pop_front();
+        }
+        return count;
+    }
+
+    void make(const std::vector<uint16_t> &values)
+    {
+        ready.insert(ready.end(), values.begin(), values.end());
+    }
+};
+
+TEST(GasAdcFrontEnd, DecimatesABlockToItsAverageAndNoiseFloor)
+{
+    ScriptedSource source;
+    GasAdcFrontEnd frontEnd(&source, 8);
+    frontEnd.begin();
+
+    std::vector<uint16_t> block = {1000, 1002, 998, 1004, 996, 1001, 999, 1000};
+    source.make(block);
+    EXPECT_TRUE(frontEnd.poll(0));
+    ASSERT_TRUE(frontEnd.hasSample());
+
+    double sum = 0;
+    double sumSquares = 0;
+    for (uint16_t value : block)
+    {
+        sum += value;
+        sumSquares += (double)value * value;
+    }
+    double mean = sum / block.size();
+    double variance = sumSquares / block.size() - mean * mean;
+    EXPECT_FLOAT_EQ(frontEnd.getAverage(), (float)mean);
+    EXPECT_NEAR(frontEnd.getNoiseFloor(), sqrt(variance / block.size()), 1e-3);
+    EXPECT_EQ(frontEnd.getBlockCount(), 1u);
+
+    // A constant input has no noise; readings past 12 bits are clamped
+    source.make(std::vector<uint16_t>(8, 0xFFFF));
+    EXPECT_TRUE(frontEnd.poll(0));
+    EXPECT_FLOAT_EQ(frontEnd.getAverage(), GasAdcFrontEnd::ADC_MAX);
+    EXPECT_FLOAT_EQ(frontEnd.getNoiseFloor(), 0.0f);
+}
+
+TEST(GasAdcFrontEnd, NoiseFloorFallsWithTheOversamplingRatio)
+{
+    // Alternating 990/1010: standard deviation 10 counts, so sqrt(var/n) = 10/sqrt(n)
+    for (uint16_t ratio : {4, 16, 64, 256})
+    {
+        ScriptedSource source;
+        GasAdcFrontEnd frontEnd(&source, ratio);
+        std::vector<uint16_t> block;
+        for (uint16_t i = 0; i < ratio; i++)
+        {
+            block.push_back(i % 2 == 0 ? 990 : 1010);
+        }
+        source.make(block);
+        ASSERT_TRUE(frontEnd.poll(0)) << ratio;
+        EXPECT_FLOAT_EQ(frontEnd.getAverage(), 1000.0f) << ratio;
+        EXPECT_NEAR(frontEnd.getNoiseFloor(), 10.0 / sqrt((double)ratio), 1e-3) << ratio;
+    }
+}
+
+TEST(GasAdcFrontEnd, AcceptsOnlyPowerOfTwoRatios)
+{
+    ScriptedSource source;
+    GasAdcFrontEnd frontEnd(&source, 16);
+    const uint16_t maxOversampling = GasAdcFrontEnd::MAX_OVERSAMPLING;
+    for (uint16_t ratio : {0, 3, 12, 24, 100, 255})
+    {
+        EXPECT_FALSE(frontEnd.setOversampling(ratio)) << ratio;
+        EXPECT_EQ(frontEnd.getOversampling(), 16u) << ratio;
+    }
+    EXPECT_FALSE(frontEnd.setOversampling(2 * maxOversampling));
+    for (uint16_t ratio = 1; ratio <= maxOversampling; ratio *= 2)
+    {
+        EXPECT_TRUE(frontEnd.setOversampling(ratio)) << ratio;
+        EXPECT_EQ(frontEnd.getOversampling(), ratio);
+    }
+
+    // A rejected ratio at construction leaves no oversampling rather than a wrong one
+    GasAdcFrontEnd rejected(&source, 12);
+    EXPECT_EQ(rejected.getOversampling(), 1u);
+}
+
+TEST(GasAdcFrontEnd, PollReturnsAtOnceWithoutAFullBlock)
+{
+    ScriptedSource source;
+    GasAdcFrontEnd frontEnd(&source, 16);
+
+    // Nothing ready: the source is serviced but never read
+    EXPECT_FALSE(frontEnd.poll(0));
+    EXPECT_EQ(source.services, 1u);
+    EXPECT_EQ(source.reads, 0u);
+    EXPECT_FALSE(frontEnd.hasSample());
+
+    // Part of a block is kept for later polls
+    source.make(std::vector<uint16_t>(10, 2000));
+    EXPECT_FALSE(frontEnd.poll(1000));
+    EXPECT_EQ(source.reads, 1u);
+    EXPECT_FALSE(frontEnd.hasSample());
+    source.make(std::vector<uint16_t>(6, 2016));
+    EXPECT_TRUE(frontEnd.poll(2000));
+    EXPECT_FLOAT_EQ(frontEnd.getAverage(), 2006.0f);
+
+    // More than a block: every whole block is published, the remainder waits
+    source.make(std::vector<uint16_t>(40, 100));
+    EXPECT_TRUE(frontEnd.poll(3000));
+    EXPECT_EQ(frontEnd.getBlockCount(), 3u);
+    EXPECT_TRUE(source.ready.empty());
+    EXPECT_FALSE(frontEnd.poll(4000));
+    EXPECT_EQ(frontEnd.getBlockCount(), 3u);
+}
+
+TEST(GasAdcFrontEnd, EffectiveRateIsTheConversionRateOverTheRatio)
+{
+    // 8 kHz conversions, handed over once a millisecond, for three seconds
+    ScriptedSource source;
+    GasAdcFrontEnd frontEnd(&source, 16);
+    for (unsigned long micros = 0; micros <= 3000000; micros += 1000)
+    {
+        source.make(std::vector<uint16_t>(8, 1234));
+        frontEnd.poll(micros);
+    }
+    EXPECT_NEAR(frontEnd.getConversionRate(), 8000.0f, 10.0f);
+    EXPECT_NEAR(frontEnd.getEffectiveSampleRate(), 500.0f, 1.0f);
+    EXPECT_NEAR(frontEnd.getEffectiveSampleRate() * frontEnd.getOversampling(), frontEnd.getConversionRate(), 20.0f);
+}
+
+TEST(GasAdcFrontEnd, ClockedSourceGivesEvenlySpacedBlocks)
+{
+    const int pin = 4;
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    board.setAnalog(pin, 1800);
+    ClockedAdcSource source(pin);
+    GasAdcFrontEnd frontEnd(&source, 16);
+    frontEnd.begin();
+
+    // A loop that polls every millisecond: conversions follow the clock, not the loop
+    std::vector<unsigned long> blockTimes;
+    for (int pass = 0; pass < 3000; pass++)
+    {
+        if (frontEnd.poll(micros()))
+        {
+            unsigned long blockTime;
+            ASSERT_TRUE(frontEnd.getBlockTime(blockTime));
+            blockTimes.push_back(blockTime);
+        }
+        board.advance(1000);
+    }
+
+    // 160 Hz conversions: 10 blocks a second, each stamped 100 ms after the last
+    const uint32_t period = ClockedAdcSource::DEFAULT_PERIOD_US;
+    EXPECT_NEAR(frontEnd.getConversionRate(), 1e6f / period, 2.0f);
+    EXPECT_NEAR(frontEnd.getEffectiveSampleRate(), 1e6f / period / 16, 0.2f);
+    EXPECT_FLOAT_EQ(frontEnd.getAverage(), 1800.0f);
+    ASSERT_GE(blockTimes.size(), 25u);
+    for (size_t i = 1; i < blockTimes.size(); i++)
+    {
+        EXPECT_EQ(blockTimes[i] - blockTimes[i - 1], 16 * period / 1000) << i;
+    }
+}
+
+} // namespace
@@ -0,0 +1,241 @@
+/**
+ * @file GasAlarmLatchTest.cpp
+ * @brief Worst-case alarm latency of the D0 fast path, with the comparator pin simulated.
+ *
+ * The gas detector runs its own loop on the virtual board while the MQ-2 module's D0 output is
+ * driven: false trips with clean air on A0, and real leaks where A0 and D0 rise together. Edges
+ * land at random points of the loop, inside LCD transfers, serial logging and idle windows alike.
+ * The red LED pin is watched:
+ *
+ * - Edge to red: the comparator's rising edge to the red LED going HIGH. The interrupt drives
+ *   the pin itself, so no loop work may stand in between.
+ * - Edge to clear: on a false trip, the edge to the red LED going LOW again once a conversion
+ *   taken after the edge reads below CRITICAL; within D0_CONFIRM_BUDGET_US.
+ * - Leak to red without D0: the same leaks with D0 left unwired, for comparison with the
+ *   polled analog path.
+ */
+
+#include "GLPSecureSenseDevice.h"
+#include "SloHarness.h"
+#include "mq2_stimulus.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+const uint64_t RUN_MICROS = 20ULL * 60 * 1000000;
+const uint64_t STIMULUS_START_MICROS = 1000000;
+
+// The device's pins and budgets; the constants are private to it
+const int GAS_ANALOG_PIN = 4;
+const int GAS_DIGITAL_PIN = 23;
+const int RED_LED_PIN = 27;
+const uint32_t D0_CONFIRM_BUDGET_US = 300000;
+const uint32_t EDGE_TO_RED_BUDGET_US = 0; ///< Same virtual instant: the ISR writes the pin
+
+const float CLEAN_PPM = 100;
+const float LEAK_PPM = 700;
+
+/**
+ * @brief Drives A0 and D0 through false trips and leaks, and watches the red LED.
+ */
+struct ComparatorProbe
+{
+    VirtualBoard &board;
+    std::mt19937 random;
+    bool d0Wired;
+    uint64_t stopAt;
+
+    bool active;      ///< A trip or leak is on
+    bool falseTrip;
+    uint64_t edgeAt;
+    bool redPending;  ///< Waiting for the red LED to go HIGH
+    bool clearPending; ///< False trip: waiting for the red LED to go LOW
+
+    uint32_t falseTrips;
+    uint32_t leaks;
+    LatencySamples edgeToRed;
+    LatencySamples edgeToClear;
+
+    ComparatorProbe(VirtualBoard &board, uint32_t seed, bool d0Wired)
+        : board(board), random(seed), d0Wired(d0Wired), stopAt(0), active(false), falseTrip(false), edgeAt(0),
+          redPending(false), clearPending(false), falseTrips(0), leaks(0)
+    {
+        board.watchPins(onPin, this);
+        // The device calibrates R0 in initialize(), against zero PPM as GasSloTest does
+        driveAnalog(0);
+        board.drive(GAS_DIGITAL_PIN, LOW);
+    }
+
+    ~ComparatorProbe()
+    {
+        board.watchPins(nullptr, nullptr);
+    }
+
+    void driveAnalog(float ppm)
+    {
+        float voltage = mq2_ppm_to_voltage(ppm);
+        board.setAnalog(GAS_ANALOG_PIN, (uint16_t)(voltage / MQ2_VCC * 4095 + 0.5f));
+    }
+
+    void start(uint64_t fromMicros, uint64_t toMicros)
+    {
+        stopAt = toMicros;
+        driveAnalog(CLEAN_PPM);
+        scheduleNext(fromMicros);
+    }
+
+    void scheduleNext(uint64_t after)
+    {
+        // Past the CRITICAL dwell, so the red LED is off again; any microsecond, so edges fall
+        // anywhere in the loop
+        uint64_t at = after + std::uniform_int_distribution<uint32_t>(20000000, 35000000)(random);
+        if (at < stopAt)
+        {
+            board.at(at, begin, this);
+        }
+    }
+
+    static void begin(void *context)
+    {
+        ComparatorProbe *probe = static_cast<ComparatorProbe *>(context);
+        uint64_t now = probe->board.now();
+        probe->falseTrip = !probe->d0Wired ? false : std::bernoulli_distribution(0.5)(probe->random);
+        probe->active = true;
+        probe->edgeAt = now;
+        probe->redPending = true;
+        uint32_t hold;
+        if (probe->falseTrip)
+        {
+            // A draught or a heater: D0 blips with clean air on A0
+            probe->falseTrips++;
+            hold = std::uniform_int_distribution<uint32_t>(20000, 2000000)(probe->random);
+        }
+        else
+        {
+            probe->leaks++;
+            probe->driveAnalog(LEAK_PPM);
+            hold = std::uniform_int_distribution<uint32_t>(3000000, 6000000)(probe->random);
+        }
+        if (probe->d0Wired)
+        {
+            probe->board.drive(GAS_DIGITAL_PIN, HIGH);
+        }
+        probe->board.at(now + hold, end, probe);
+    }
+
+    static void end(void *context)
+    {
+        ComparatorProbe *probe = static_cast<ComparatorProbe *>(context);
+        if (probe->d0Wired)
+        {
+            probe->board.drive(GAS_DIGITAL_PIN, LOW);
+        }
+        probe->driveAnalog(CLEAN_PPM);
+        probe->active = false;
+        probe->scheduleNext(probe->board.now());
+    }
+
+    static void onPin(int pin, int level, uint64_t atMicros, void *context)
+    {
+        ComparatorProbe *probe = static_cast<ComparatorProbe *>(context);
+        if (pin != RED_LED_PIN)
+        {
+            return;
+        }
+        if (level == HIGH && probe->redPending)
+        {
+            probe->edgeToRed.record(atMicros - probe->edgeAt);
+            probe->redPending = false;
+            probe->clearPending = probe->falseTrip;
+        }
+        else if (level == LOW && probe->clearPending)
+        {
+            probe->edgeToClear.record(atMicros - probe->edgeAt);
+            probe->clearPending = false;
+        }
+    }
+};
+
+struct LatchResult
+{
+    uint32_t falseTrips;
+    uint32_t leaks;
+    size_t reds;
+    uint32_t edgeToRedMax;
+    size_t clears;
+    uint32_t edgeToClearMax;
+};
+
+LatchResult runLatch(const LoadProfile &profile, uint32_t seed, bool d0Wired)
+{
+    LatchResult result = {};
+    runIsolated([&]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        board.addI2cDevice(0x27);
+        ComparatorProbe probe(board, seed, d0Wired);
+
+        GLPSecureSenseDevice *device = new GLPSecureSenseDevice();
+        device->initialize();
+
+        applyLoad(board, profile);
+        uint64_t start = board.now() + STIMULUS_START_MICROS;
+        uint64_t end = start + RUN_MICROS;
+        scheduleLoad(board, profile, start, end, seed);
+        probe.start(start, end);
+
+        while (board.now() < end)
+        {
+            device->run();
+            device->idle();
+        }
+
+        result.falseTrips = probe.falseTrips;
+        result.leaks = probe.leaks;
+        result.reds = probe.edgeToRed.getCount();
+        result.edgeToRedMax = probe.edgeToRed.max();
+        result.clears = probe.edgeToClear.getCount();
+        result.edgeToClearMax = probe.edgeToClear.max();
+        delete device;
+    });
+    return result;
+}
+
+class GasAlarmLatchLatency : public ::testing::TestWithParam<LoadProfile>
+{
+};
+
+TEST_P(GasAlarmLatchLatency, InterruptLightsRedAtTheEdge)
+{
+    const LoadProfile &profile = GetParam();
+    LatchResult wired = runLatch(profile, 31, true);
+    LatchResult polled = runLatch(profile, 31, false);
+
+    printf("[ d0 latch ] %-16s edge->red max %6lu us (%lu edges), false trip cleared max %6lu us (%lu); "
+           "without D0 leak->red max %6lu us (%lu leaks)\n",
+           profile.name, (unsigned long)wired.edgeToRedMax, (unsigned long)wired.reds,
+           (unsigned long)wired.edgeToClearMax, (unsigned long)wired.clears, (unsigned long)polled.edgeToRedMax,
+           (unsigned long)polled.reds);
+
+    // Every edge lights red, and every false trip is cleared again
+    ASSERT_GT(wired.falseTrips, 5u);
+    ASSERT_GT(wired.leaks, 5u);
+    EXPECT_EQ(wired.reds, wired.falseTrips + wired.leaks);
+    EXPECT_EQ(wired.clears, wired.falseTrips);
+
+    const uint32_t edgeToRedBudget = EDGE_TO_RED_BUDGET_US;
+    const uint32_t confirmBudget = D0_CONFIRM_BUDGET_US;
+    EXPECT_LE(wired.edgeToRedMax, edgeToRedBudget);
+    EXPECT_LE(wired.edgeToClearMax, confirmBudget);
+
+    // The polled path waits for a conversion; the fast path does not
+    EXPECT_EQ(polled.reds, polled.leaks);
+    EXPECT_GT(polled.edgeToRedMax, wired.edgeToRedMax);
+}
+
+INSTANTIATE_TEST_SUITE_P(Loads, GasAlarmLatchLatency,
+                         ::testing::ValuesIn(LOAD_PROFILES, LOAD_PROFILES + LOAD_PROFILE_COUNT),
+                         [](const ::testing::TestParamInfo<LoadProfile> &info) { return std::string(info.param.name); });
+
+} // namespace
@@ -0,0 +1,136 @@
+/**
+ * @file GasHistoryTest.cpp
+ * @brief Reading history across reboots, torn checkpoints and retention, on file-backed flash.
+ */
+
+#include "FlashStandIn.h"
+#include "GasHistory.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <vector>
+
+namespace
+{
+
+struct Sample
+{
+    uint32_t time;
+    float ppm;
+};
+
+void collect(uint32_t time, float ppm, void *context)
+{
+    static_cast<std::vector<Sample> *>(context)->push_back(Sample{time, ppm});
+}
+
+float ppmAt(uint32_t time)
+{
+    return (float)((time * 13) % 700);
+}
+
+std::vector<Sample> everything(GasHistory &history)
+{
+    std::vector<Sample> samples;
+    history.query(0, 0xFFFFFFFFUL, collect, &samples);
+    return samples;
+}
+
+TEST(GasHistory, RestoresEverySampleAcrossReboots)
+{
+    FileSegmentStorage storage;
+    uint32_t time = 0;
+    for (int boot = 0; boot < 5; boot++)
+    {
+        GasHistory history(&storage);
+        ASSERT_TRUE(history.begin());
+        // The log clock picks up after the last stored second
+        EXPECT_EQ(history.timeAt(0), time);
+        for (int i = 0; i < 3000; i++, time++)
+        {
+            history.append(time, ppmAt(time));
+        }
+        ASSERT_TRUE(history.flush());
+    }
+
+    GasHistory history(&storage);
+    ASSERT_TRUE(history.begin());
+    std::vector<Sample> samples = everything(history);
+    ASSERT_EQ(samples.size(), time);
+    for (uint32_t i = 0; i < time; i++)
+    {
+        ASSERT_EQ(samples[i].time, i);
+        ASSERT_EQ(samples[i].ppm, ppmAt(i));
+    }
+}
+
+TEST(GasHistory, TornCheckpointStartsANewSegment)
+{
+    FileSegmentStorage storage;
+    uint32_t time = 0;
+    {
+        GasHistory history(&storage);
+        ASSERT_TRUE(history.begin());
+        for (; time < 2000; time++)
+        {
+            history.append(time, ppmAt(time));
+            if (time % 500 == 499)
+            {
+                ASSERT_TRUE(history.flush());
+            }
+        }
+    }
+
+    // A reset in the middle of the last checkpoint's append
+    uint32_t first, next;
+    ASSERT_TRUE(storage.range(first, next));
+    std::string newest = storage.pathOf(next - 1);
+    std::filesystem::resize_file(newest, std::filesystem::file_size(newest) - 3);
+
+    GasHistory history(&storage);
+    ASSERT_TRUE(history.begin());
+    std::vector<Sample> before = everything(history);
+    // Up to the third checkpoint survives
+    ASSERT_EQ(before.size(), 1500u);
+    EXPECT_EQ(history.timeAt(0), 1500u);
+    for (uint32_t t = 1500; t < 1600; t++)
+    {
+        history.append(t, 1);
+    }
+    ASSERT_TRUE(history.flush());
+
+    uint32_t after;
+    ASSERT_TRUE(storage.range(first, after));
+    EXPECT_EQ(after, next + 1);
+    std::vector<Sample> samples = everything(history);
+    ASSERT_EQ(samples.size(), 1600u);
+    for (size_t i = 1; i < samples.size(); i++)
+    {
+        ASSERT_GT(samples[i].time, samples[i - 1].time) << i;
+    }
+}
+
+TEST(GasHistory, DropsTheOldestSegmentsWhenFull)
+{
+    FileSegmentStorage storage;
+    GasHistory history(&storage, 4);
+    ASSERT_TRUE(history.begin());
+    const uint32_t count = 100000;
+    for (uint32_t t = 0; t < count; t++)
+    {
+        history.append(t, ppmAt(t));
+    }
+
+    std::vector<Sample> samples = everything(history);
+    EXPECT_LE(history.getStoredSegments(), 4u);
+    ASSERT_FALSE(samples.empty());
+    EXPECT_GT(samples.front().time, 0u);
+    EXPECT_EQ(samples.back().time, count - 1);
+    for (const Sample &sample : samples)
+    {
+        ASSERT_EQ(sample.ppm, ppmAt(sample.time)) << sample.time;
+    }
+    // Only whole segments go: the kept samples are contiguous
+    EXPECT_EQ(samples.size(), count - samples.front().time);
+}
+
+} // namespace
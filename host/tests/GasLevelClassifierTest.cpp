@@ -0,0 +1,193 @@
+/**
+ * @file GasLevelClassifierTest.cpp
+ * @brief Transitions, LED writes and status redraws the hysteresis classifier saves on noisy traces.
+ *
+ * Each trace is sampled at the detector's 10 Hz and classified twice: by the shipped classifier
+ * (20 and 50 PPM bands, 5 and 10 s dwell) and by the same classifier with bands and dwell at zero,
+ * which is the plain threshold mapping. Each level change drives a LedIndicator on the virtual
+ * board, as the device's level events do, and redraws the LCD status line, which shows the level.
+ */
+
+#include "GasLevelClassifier.h"
+#include "LedIndicator.h"
+#include "VirtualBoard.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+
+namespace
+{
+
+const unsigned long SAMPLE_MS = 100;
+const unsigned long TRACE_MS = 30UL * 60 * 1000;
+
+struct NoisyTrace
+{
+    const char *name;
+    float (*ppmAt)(float seconds);
+    float noise; ///< Standard deviation, PPM
+};
+
+float hoverSafe(float seconds)
+{
+    return 200;
+}
+
+float hoverCritical(float seconds)
+{
+    return 500;
+}
+
+float slowSwell(float seconds)
+{
+    // Up through both thresholds and back over the half hour
+    return 100 + 480 * sinf(seconds / 1800 * 3.14159f);
+}
+
+float cookingCycles(float seconds)
+{
+    // Fumes breathing around the MODERATE threshold every couple of minutes
+    return 195 + 25 * sinf(seconds / 20);
+}
+
+const NoisyTrace TRACES[] = {
+    {"hover_200", hoverSafe, 10},
+    {"hover_500", hoverCritical, 15},
+    {"slow_swell", slowSwell, 8},
+    {"cooking", cookingCycles, 6},
+};
+
+struct Outputs
+{
+    GasLevelClassifier classifier;
+    LedIndicator leds;
+    uint32_t levelChanges;
+
+    Outputs(int firstPin) : classifier(200, 500), leds(firstPin, firstPin + 1, firstPin + 2), levelChanges(0)
+    {
+        leds.initialize();
+    }
+
+    GasLevel update(float ppm, unsigned long timestamp)
+    {
+        GasLevel before = classifier.getLevel();
+        GasLevel level = classifier.update(ppm, timestamp);
+        if (level != before)
+        {
+            levelChanges++;
+            leds.handle(LedIndicator::commandFor(level, false));
+        }
+        return level;
+    }
+};
+
+struct TraceResult
+{
+    uint32_t rawChanges;
+    uint32_t dampedChanges;
+    uint32_t rawPinWrites;
+    uint32_t dampedPinWrites;
+    uint32_t lateEscalations; ///< Samples where the raw level was above the damped one
+    GasLevel finalLevel;
+};
+
+TraceResult runTrace(const NoisyTrace &trace, uint32_t seed)
+{
+    TraceResult result = {};
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    Outputs raw(12);
+    raw.classifier.setBands(0, 0);
+    raw.classifier.setDwell(GasLevel::MODERATE, 0);
+    raw.classifier.setDwell(GasLevel::CRITICAL, 0);
+    Outputs damped(32);
+
+    std::mt19937 random(seed);
+    std::normal_distribution<float> noise(0, trace.noise);
+    uint32_t rawWrites = 0;
+    uint32_t dampedWrites = 0;
+    for (unsigned long t = 0; t < TRACE_MS; t += SAMPLE_MS)
+    {
+        float ppm = trace.ppmAt(t / 1000.0f) + noise(random);
+        uint32_t before = board.getPinWrites();
+        GasLevel rawLevel = raw.update(ppm, t);
+        uint32_t between = board.getPinWrites();
+        GasLevel dampedLevel = damped.update(ppm, t);
+        rawWrites += between - before;
+        dampedWrites += board.getPinWrites() - between;
+        if ((int)rawLevel > (int)dampedLevel)
+        {
+            result.lateEscalations++;
+        }
+        result.finalLevel = dampedLevel;
+    }
+
+    result.rawChanges = raw.levelChanges;
+    result.dampedChanges = damped.levelChanges;
+    result.rawPinWrites = rawWrites;
+    result.dampedPinWrites = dampedWrites;
+    return result;
+}
+
+class GasLevelHysteresis : public ::testing::TestWithParam<NoisyTrace>
+{
+};
+
+TEST_P(GasLevelHysteresis, SavesTransitionsWithoutDelayingEscalation)
+{
+    const NoisyTrace &trace = GetParam();
+    TraceResult result = runTrace(trace, 36);
+
+    printf("[ levels   ] %-10s transitions and status redraws %4lu -> %3lu, LED pin writes %5lu -> %3lu\n",
+           trace.name, (unsigned long)result.rawChanges, (unsigned long)result.dampedChanges,
+           (unsigned long)result.rawPinWrites, (unsigned long)result.dampedPinWrites);
+
+    // Escalation is never behind the plain thresholds, de-escalation is damped
+    EXPECT_EQ(result.lateEscalations, 0u);
+    EXPECT_LE(result.dampedChanges, result.rawChanges);
+    EXPECT_LE(result.dampedPinWrites, result.rawPinWrites);
+    if (result.rawChanges > 50)
+    {
+        EXPECT_LT(result.dampedChanges * 5, result.rawChanges);
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Traces, GasLevelHysteresis, ::testing::ValuesIn(TRACES),
+                         [](const ::testing::TestParamInfo<NoisyTrace> &info) { return std::string(info.param.name); });
+
+TEST(GasLevelClassifier, StepsDownAfterTheDwellBelowTheBand)
+{
+    GasLevelClassifier classifier(200, 500);
+    unsigned long t = 0;
+    EXPECT_EQ(classifier.update(520, t), GasLevel::CRITICAL);
+
+    // Under 500 but inside the 50 PPM band: stays CRITICAL however long
+    for (t = 100; t < 60000; t += 100)
+    {
+        ASSERT_EQ(classifier.update(470, t), GasLevel::CRITICAL) << t;
+    }
+
+    // Below the band: MODERATE after the 10 s CRITICAL dwell, not before
+    unsigned long below = t;
+    GasLevel level = GasLevel::CRITICAL;
+    for (; level == GasLevel::CRITICAL; t += 100)
+    {
+        level = classifier.update(300, t);
+    }
+    EXPECT_EQ(level, GasLevel::MODERATE);
+    EXPECT_GE(t - below, 10000u);
+    EXPECT_LE(t - below, 10200u);
+
+    // Straight back up is immediate
+    EXPECT_EQ(classifier.update(501, t), GasLevel::CRITICAL);
+}
+
+TEST(GasLevelClassifier, SlowSwellEndsSafe)
+{
+    TraceResult result = runTrace(TRACES[2], 1);
+    EXPECT_EQ(result.finalLevel, GasLevel::SAFE);
+    // Up through MODERATE and CRITICAL and back down, once each way
+    EXPECT_EQ(result.dampedChanges, 4u);
+}
+
+} // namespace
@@ -0,0 +1,156 @@
+/**
+ * @file GasOutputTrafficTest.cpp
+ * @brief GPIO and I2C operations of the event-driven gas detector over a simulated hour.
+ *
+ * The detector runs an hour of each gas trace on the virtual board. Pin writes and I2C traffic
+ * are counted from the board and compared with what the polled design cost: three LED writes
+ * every pass, and a clear plus a full rewrite of the 20x4 LCD every 500 ms.
+ */
+
+#include "GLPSecureSenseDevice.h"
+#include "SloHarness.h"
+#include "mq2_stimulus.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace
+{
+
+const uint8_t LCD_ADDRESS = 0x27;
+const int GAS_ANALOG_PIN = 4;
+const uint64_t HOUR_MICROS = 3600ULL * 1000000;
+
+// What the polled design did
+const uint32_t POLLED_LED_WRITES_PER_PASS = 3;
+const uint32_t POLLED_REFRESHES_PER_HOUR = 7200;
+const uint32_t POLLED_LCD_BYTES_PER_REFRESH = 1 + 4 + 80; ///< Clear, a cursor move per row, every cell
+const uint32_t EXPANDER_BYTES_PER_LCD_BYTE = 6;           ///< Two nibbles of three PCF8574 writes
+
+struct GasTrace
+{
+    const char *name;
+    float (*ppmAt)(float seconds, float noise);
+};
+
+float cleanAir(float seconds, float noise)
+{
+    return 100 + noise;
+}
+
+float cooking(float seconds, float noise)
+{
+    // Three 8-minute bursts of cooking fumes that reach MODERATE
+    float phase = fmodf(seconds, 1200);
+    float bump = phase > 300 && phase < 780 ? 160 * sinf((phase - 300) / 480 * 3.14159f) : 0;
+    return 100 + bump + noise;
+}
+
+float twoLeaks(float seconds, float noise)
+{
+    // A leak at 10 and at 40 minutes, up to 800 PPM, each ventilated away over five minutes
+    float ppm = 100;
+    const float starts[] = {600, 2400};
+    for (float start : starts)
+    {
+        float t = seconds - start;
+        if (t > 0 && t < 120)
+        {
+            ppm += 700 * t / 120;
+        }
+        else if (t >= 120 && t < 420)
+        {
+            ppm += 700 * (1 - (t - 120) / 300);
+        }
+    }
+    return ppm + noise;
+}
+
+const GasTrace TRACES[] = {
+    {"clean_air", cleanAir},
+    {"cooking", cooking},
+    {"two_leaks", twoLeaks},
+};
+
+void driveGas(VirtualBoard &board, float ppm)
+{
+    board.setAnalog(GAS_ANALOG_PIN, (uint16_t)(mq2_ppm_to_voltage(ppm) / MQ2_VCC * 4095 + 0.5f));
+}
+
+struct TrafficResult
+{
+    uint64_t passes;
+    uint32_t levelChanges;
+    uint32_t pinWrites;
+    uint32_t i2cTransfers;
+    uint64_t lcdBytes;
+};
+
+TrafficResult runHour(const GasTrace &trace)
+{
+    TrafficResult result = {};
+    runIsolated([&]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        board.addI2cDevice(LCD_ADDRESS);
+        driveGas(board, 0);
+        GLPSecureSenseDevice *device = new GLPSecureSenseDevice();
+        device->initialize();
+
+        std::mt19937 random(35);
+        std::normal_distribution<float> noise(0, 4);
+        uint32_t pinWrites = board.getPinWrites();
+        uint32_t transfers = board.getI2cTransfers();
+        uint64_t i2cBytes = board.getI2cBytes();
+        GasLevel level = device->getStatus().reading.level;
+        uint64_t start = board.now();
+        while (board.now() < start + HOUR_MICROS)
+        {
+            driveGas(board, trace.ppmAt((board.now() - start) / 1e6f, noise(random)));
+            device->run();
+            device->idle();
+            result.passes++;
+            GasLevel now = device->getStatus().reading.level;
+            if (now != level)
+            {
+                result.levelChanges++;
+                level = now;
+            }
+        }
+
+        result.pinWrites = board.getPinWrites() - pinWrites;
+        result.i2cTransfers = board.getI2cTransfers() - transfers;
+        // Each transfer also carries its address byte
+        result.lcdBytes = (board.getI2cBytes() - i2cBytes - result.i2cTransfers) / EXPANDER_BYTES_PER_LCD_BYTE;
+        delete device;
+    });
+    return result;
+}
+
+class GasOutputTraffic : public ::testing::TestWithParam<GasTrace>
+{
+};
+
+TEST_P(GasOutputTraffic, OutputsOnlyMoveWhenStateChanges)
+{
+    const GasTrace &trace = GetParam();
+    TrafficResult result = runHour(trace);
+    uint64_t polledPinWrites = result.passes * POLLED_LED_WRITES_PER_PASS;
+    uint64_t polledLcdBytes = (uint64_t)POLLED_REFRESHES_PER_HOUR * POLLED_LCD_BYTES_PER_REFRESH;
+
+    printf("[ outputs  ] %-9s %6llu passes, %3lu level changes: %4lu pin writes (polled %llu), "
+           "%6llu LCD bytes in %5lu transfers (polled %llu)\n",
+           trace.name, (unsigned long long)result.passes, (unsigned long)result.levelChanges,
+           (unsigned long)result.pinWrites, (unsigned long long)polledPinWrites, (unsigned long long)result.lcdBytes,
+           (unsigned long)result.i2cTransfers, (unsigned long long)polledLcdBytes);
+
+    ASSERT_GT(result.passes, 30000u);
+    // LEDs move on level events only: at most the three LEDs per change, plus the first reading's
+    EXPECT_LE(result.pinWrites, 3 * (result.levelChanges + 1));
+    // The clock's seconds change every second; the rest of the screen rarely does
+    EXPECT_LT(result.lcdBytes * 10, polledLcdBytes);
+}
+
+INSTANTIATE_TEST_SUITE_P(Traces, GasOutputTraffic, ::testing::ValuesIn(TRACES),
+                         [](const ::testing::TestParamInfo<GasTrace> &info) { return std::string(info.param.name); });
+
+} // namespace
@@ -0,0 +1,153 @@
+/**
+ * @file GasSpeciesTableTest.cpp
+ * @brief Per-species PPM of the sensor's species table against the MQ-2 datasheet curves.
+ *
+ * Each species is checked at Rs/R0 points across the datasheet's range against its regression
+ * PPM = a * (Rs/R0)^b in double, as MQUnifiedsensor evaluates it. The table evaluates every
+ * species from one shared segment lookup, so it must also agree with each curve on its own.
+ */
+
+#include "GasSensor.h"
+#include "VirtualBoard.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+
+/**
+ * @brief One curve as the MQ-2 datasheet fit gives it, with the alarm threshold the sensor uses.
+ */
+struct DatasheetCurve
+{
+    const char *name;
+    double a;
+    double b;
+    float alarmPpm;
+    double maxError; ///< Interpolation error allowed: the CO and alcohol curves are steeper.
+};
+
+const DatasheetCurve CURVES[] = {
+    {"LPG", 574.25, -2.222, 500, 0.001},
+    {"Propane", 658.71, -2.168, 500, 0.001},
+    {"H2", 987.99, -2.162, 1000, 0.001},
+    {"CO", 36974, -3.109, 50, 0.002},
+    {"Alcohol", 3616.1, -2.675, 1000, 0.002},
+};
+const int CURVE_COUNT = sizeof(CURVES) / sizeof(CURVES[0]);
+
+// From the MQ-2 datasheet's 200-10000 PPM span out to clean air (9.83)
+const double RATIOS[] = {0.2, 0.35, 0.5, 0.8, 1.0, 1.5, 2.2, 3.0, 4.7, 6.5, 9.83, 12.0};
+
+double datasheetPpm(const DatasheetCurve &curve, double ratio)
+{
+    return curve.a * pow(ratio, curve.b);
+}
+
+TEST(GasSpeciesTable, EverySpeciesFollowsItsDatasheetCurve)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    GasSensor sensor(4, 23);
+    const GasSpeciesTable &species = sensor.getSpecies();
+    ASSERT_EQ(species.size(), CURVE_COUNT);
+
+    float ppm[GasSpeciesTable::MAX_SPECIES];
+    for (double ratio : RATIOS)
+    {
+        species.evaluate((float)ratio, ppm);
+        for (int i = 0; i < CURVE_COUNT; i++)
+        {
+            const DatasheetCurve &curve = CURVES[i];
+            ASSERT_STREQ(species.getName(i), curve.name);
+            double exact = datasheetPpm(curve, ratio);
+            EXPECT_NEAR(ppm[i], exact, exact * curve.maxError) << curve.name << " at Rs/R0 " << ratio;
+        }
+    }
+
+    // Each curve is a compile-time table with the datasheet coefficients
+    for (int i = 0; i < CURVE_COUNT; i++)
+    {
+        const Mq2CurveTable *table = species.getCurve(i);
+        ASSERT_NE(table, nullptr);
+        EXPECT_DOUBLE_EQ(table->getA(), CURVES[i].a) << CURVES[i].name;
+        EXPECT_DOUBLE_EQ(table->getB(), CURVES[i].b) << CURVES[i].name;
+        EXPECT_LT(table->maxRelativeError(), CURVES[i].maxError) << CURVES[i].name;
+        EXPECT_FLOAT_EQ(species.getAlarmThreshold(i), CURVES[i].alarmPpm) << CURVES[i].name;
+    }
+    EXPECT_EQ(species.getCurve(CURVE_COUNT), nullptr);
+    EXPECT_EQ(species.getCurve(0), &GasSensor::lpgCurve());
+}
+
+TEST(GasSpeciesTable, SharedLookupMatchesEachCurveAlone)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    GasSensor sensor(4, 23);
+    const GasSpeciesTable &species = sensor.getSpecies();
+
+    // Every 1/8 of a segment over the whole table, plus both clamped ends
+    float ppm[GasSpeciesTable::MAX_SPECIES];
+    for (int step = -8; step <= (Mq2CurveTable::SIZE - 1) * 8 + 8; step++)
+    {
+        int node = step < 0 ? 0 : step / 8 >= Mq2CurveTable::SIZE - 1 ? Mq2CurveTable::SIZE - 1 : step / 8;
+        double from = Mq2CurveTable::nodeAt(node);
+        double to = node + 1 < Mq2CurveTable::SIZE ? Mq2CurveTable::nodeAt(node + 1) : from * 2;
+        float ratio = (float)(step < 0 ? from / 2 : from + (to - from) * (step % 8) / 8.0);
+        species.evaluate(ratio, ppm);
+        for (int i = 0; i < species.size(); i++)
+        {
+            EXPECT_FLOAT_EQ(ppm[i], species.getCurve(i)->evaluate(ratio)) << species.getName(i) << " at " << ratio;
+        }
+    }
+}
+
+TEST(GasSpeciesTable, AlarmMaskFollowsEachThreshold)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    GasSensor sensor(4, 23);
+    GasSpeciesTable &species = sensor.getSpecies();
+    int co = species.indexOf("CO");
+    int lpg = species.indexOf("LPG");
+    ASSERT_GE(co, 0);
+    ASSERT_GE(lpg, 0);
+    EXPECT_EQ(species.indexOf("Smoke"), -1);
+
+    // Clean air: nothing over its threshold
+    float ppm[GasSpeciesTable::MAX_SPECIES];
+    EXPECT_EQ(species.evaluate(9.83f, ppm), 0u);
+
+    // Rs/R0 where CO crosses 50 PPM while LPG is still far below 500
+    float coRatio = (float)pow(50 / CURVES[co].a, 1 / CURVES[co].b);
+    uint32_t mask = species.evaluate(coRatio * 0.99f, ppm);
+    EXPECT_TRUE(mask & (1UL << co));
+    EXPECT_FALSE(mask & (1UL << lpg));
+    EXPECT_FALSE(species.evaluate(coRatio * 1.01f, ppm) & (1UL << co));
+
+    // A saturated sensor reports every species at its alarm level
+    uint32_t all = (1UL << species.size()) - 1;
+    EXPECT_EQ(species.evaluate(0.0f, ppm), all);
+    EXPECT_EQ(species.evaluate(NAN, ppm), all);
+    EXPECT_FLOAT_EQ(ppm[co], 50.0f);
+
+    species.setAlarmThreshold(co, 500);
+    EXPECT_FALSE(species.evaluate(coRatio * 0.99f, ppm) & (1UL << co));
+}
+
+TEST(GasSpeciesTable, HoldsAtMostMaxSpecies)
+{
+    static constexpr Mq2CurveTable curve(1000, -2.0);
+    const int maxSpecies = GasSpeciesTable::MAX_SPECIES;
+    GasSpeciesTable species;
+    for (int i = 0; i < maxSpecies; i++)
+    {
+        EXPECT_EQ(species.addSpecies("gas", curve, 100), i);
+    }
+    EXPECT_EQ(species.addSpecies("one too many", curve, 100), -1);
+    EXPECT_EQ(species.size(), maxSpecies);
+    EXPECT_STREQ(species.getName(maxSpecies), "");
+}
+
+} // namespace
@@ -0,0 +1,181 @@
+/**
+ * @file GasTrendDetectorTest.cpp
+ * @brief Detection lead time of the rate-of-rise alarm on simulated leak profiles.
+ *
+ * Each profile is sampled at the detector's 10 Hz sense rate with sensor noise, after a minute of
+ * clean air so the window is full when the leak starts. Lead time is how long before the PPM
+ * crosses the 500 PPM CRITICAL threshold the trend alarm went up.
+ */
+
+#include "GasTrendDetector.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+
+namespace
+{
+
+const unsigned long SAMPLE_MS = 100;
+const unsigned long CLEAN_AIR_MS = 60000;
+const float CLEAN_PPM = 100;
+const float CRITICAL_PPM = 500;
+
+struct LeakProfile
+{
+    const char *name;
+    float (*ppmAt)(float seconds); ///< Seconds since the leak started
+    float minLeadSeconds;          ///< What the alarm must beat the threshold by
+};
+
+float slowRamp(float seconds)
+{
+    return CLEAN_PPM + 8 * seconds;
+}
+
+float steadyRamp(float seconds)
+{
+    return CLEAN_PPM + 20 * seconds;
+}
+
+float fastRamp(float seconds)
+{
+    return CLEAN_PPM + 60 * seconds;
+}
+
+float fillingRoom(float seconds)
+{
+    // Concentration approaching a 900 PPM equilibrium, 30 s time constant
+    return CLEAN_PPM + 800 * (1 - expf(-seconds / 30));
+}
+
+float burst(float seconds)
+{
+    return seconds < 0.05f ? CLEAN_PPM : 700;
+}
+
+const LeakProfile PROFILES[] = {
+    {"ramp 8 PPM/s", slowRamp, 40},
+    {"ramp 20 PPM/s", steadyRamp, 15},
+    {"ramp 60 PPM/s", fastRamp, 4},
+    {"room filling", fillingRoom, 15},
+    {"burst", burst, -1}, // Nothing to predict: the level itself alarms first
+};
+
+struct LeadResult
+{
+    float alarmAt;          ///< First non-STEADY alarm, seconds after the leak started; -1 for none
+    float fastAt;           ///< First FAST_RISE
+    float criticalAt;       ///< First sample at or above 500 PPM
+    float predictedAtAlarm; ///< secondsUntil(500) when the alarm went up
+};
+
+LeadResult runProfile(const LeakProfile &profile, uint32_t seed)
+{
+    GasTrendDetector detector(10000);
+    std::mt19937 random(seed);
+    std::normal_distribution<float> noise(0, 5);
+    LeadResult result = {-1, -1, -1, -1};
+
+    for (unsigned long elapsed = 0; elapsed < CLEAN_AIR_MS + 120000; elapsed += SAMPLE_MS)
+    {
+        float leakSeconds = elapsed < CLEAN_AIR_MS ? -1 : (elapsed - CLEAN_AIR_MS) / 1000.0f;
+        float ppm = (leakSeconds < 0 ? CLEAN_PPM : profile.ppmAt(leakSeconds)) + noise(random);
+        RiseAlarm alarm = detector.update(elapsed, ppm);
+        if (leakSeconds < 0)
+        {
+            EXPECT_EQ(alarm, RiseAlarm::STEADY) << profile.name << " false alarm in clean air";
+            continue;
+        }
+        if (alarm != RiseAlarm::STEADY && result.alarmAt < 0)
+        {
+            result.alarmAt = leakSeconds;
+            result.predictedAtAlarm = detector.secondsUntil(ppm, CRITICAL_PPM);
+        }
+        if (alarm == RiseAlarm::FAST_RISE && result.fastAt < 0)
+        {
+            result.fastAt = leakSeconds;
+        }
+        if (ppm >= CRITICAL_PPM && result.criticalAt < 0)
+        {
+            result.criticalAt = leakSeconds;
+        }
+    }
+    return result;
+}
+
+TEST(GasTrendDetector, WarnsBeforeCriticalOnLeakProfiles)
+{
+    for (const LeakProfile &profile : PROFILES)
+    {
+        LeadResult result = runProfile(profile, 29);
+        float lead = result.alarmAt >= 0 ? result.criticalAt - result.alarmAt : 0;
+        printf("[ lead     ] %-14s alarm %6.1f s, fast %6.1f s, critical %6.1f s: lead %5.1f s "
+               "(predicted %5.1f s to critical)\n",
+               profile.name, result.alarmAt, result.fastAt, result.criticalAt, lead, result.predictedAtAlarm);
+
+        ASSERT_GE(result.criticalAt, 0) << profile.name;
+        if (profile.minLeadSeconds >= 0)
+        {
+            ASSERT_GE(result.alarmAt, 0) << profile.name;
+            EXPECT_GE(lead, profile.minLeadSeconds) << profile.name;
+        }
+    }
+}
+
+TEST(GasTrendDetector, LeadTimeHoldsAcrossNoiseSeeds)
+{
+    // The worst of many noise draws, not one lucky run
+    for (const LeakProfile &profile : PROFILES)
+    {
+        if (profile.minLeadSeconds < 0)
+        {
+            continue;
+        }
+        float worst = 1e9f;
+        for (uint32_t seed = 1; seed <= 50; seed++)
+        {
+            LeadResult result = runProfile(profile, seed);
+            ASSERT_GE(result.alarmAt, 0) << profile.name << " seed " << seed;
+            worst = fminf(worst, result.criticalAt - result.alarmAt);
+        }
+        printf("[ lead     ] %-14s worst lead over 50 seeds %5.1f s\n", profile.name, worst);
+        EXPECT_GE(worst, profile.minLeadSeconds) << profile.name;
+    }
+}
+
+TEST(GasTrendDetector, NoAlarmOnCleanAirOrSlowDrift)
+{
+    // An hour of noise, then an hour of sensor warm-up drift at 0.02 PPM/s
+    GasTrendDetector detector(10000);
+    std::mt19937 random(7);
+    std::normal_distribution<float> noise(0, 8);
+    unsigned alarms = 0;
+    for (unsigned long t = 0; t < 2 * 3600000UL; t += SAMPLE_MS)
+    {
+        float drift = t < 3600000UL ? 0 : (t - 3600000UL) / 1000.0f * 0.02f;
+        if (detector.update(t, CLEAN_PPM + drift + noise(random)) != RiseAlarm::STEADY)
+        {
+            alarms++;
+        }
+    }
+    EXPECT_EQ(alarms, 0u);
+}
+
+TEST(GasTrendDetector, SlopeIsExactOnALineAtAnySampleRate)
+{
+    // 10 Hz polling, the continuous ADC's 31.25 blocks/s and a fast 500 Hz source all fit the window
+    const float rates[] = {10.0f, 31.25f, 500.0f};
+    for (float hz : rates)
+    {
+        GasTrendDetector detector(10000);
+        for (int i = 0; i < (int)(hz * 20); i++)
+        {
+            unsigned long t = (unsigned long)(i * 1000 / hz);
+            detector.update(t, 150 + 8.0f * i / hz);
+        }
+        EXPECT_NEAR(detector.getSlope(), 8.0f, 0.05f) << hz << " Hz";
+        EXPECT_EQ(detector.getAlarm(), RiseAlarm::SUSTAINED_RISE) << hz << " Hz";
+    }
+}
+
+} // namespace
@@ -0,0 +1,197 @@
+/**
+ * @file I2cBusManagerTest.cpp
+ * @brief Loop jitter with the queued I2C bus against blocking mode, and queue ordering.
+ *
+ * A loop shaped like the gas detector's runs on the virtual board: a sense tick every 100 ms,
+ * the LCD refreshed every 500 ms through DisplayManager, and the bus serviced each pass. Events
+ * such as a button press arrive at random times and wake the loop; jitter is how long each one
+ * waits for the next pass to start, and how late each sense tick starts. In blocking mode every
+ * LCD transaction runs inside the display update; queued, the host build (no FreeRTOS worker)
+ * runs one service slice per pass.
+ */
+
+#include "DisplayManager.h"
+#include "I2cBusManager.h"
+#include "SloHarness.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+
+namespace
+{
+
+const uint8_t LCD_ADDRESS = 0x27;
+const uint64_t SENSE_PERIOD_US = 100000;
+const uint64_t RUN_MICROS = 5ULL * 60 * 1000000;
+
+struct JitterResult
+{
+    uint32_t eventP99;
+    uint32_t eventMax;
+    uint32_t tickP99;
+    uint32_t tickMax;
+    size_t events;
+    size_t ticks;
+    uint32_t redraws;
+    uint32_t transfers;
+    unsigned long maxCallerMicros;
+};
+
+JitterResult runSenseLoop(uint32_t stretchMicrosPerByte, bool blocking)
+{
+    JitterResult result = {};
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    board.addI2cDevice(LCD_ADDRESS);
+    board.setI2cStretch(stretchMicrosPerByte);
+
+    I2cBusManager bus;
+    bus.begin();
+    DisplayManager display(LCD_ADDRESS, &bus);
+    display.initialize();
+    bus.setBlocking(blocking);
+
+    GasReading reading = {};
+    LatencySamples eventWait;
+    LatencySamples late;
+    std::mt19937 random(33);
+    std::uniform_int_distribution<uint32_t> eventGap(30000, 170000);
+    uint64_t start = board.now();
+    uint64_t nextSense = start;
+    uint64_t nextEvent = start + eventGap(random);
+    while (board.now() < start + RUN_MICROS)
+    {
+        if (board.now() >= nextEvent)
+        {
+            eventWait.record(board.now() - nextEvent);
+            nextEvent += eventGap(random);
+        }
+        if (board.now() >= nextSense)
+        {
+            late.record(board.now() - nextSense);
+            nextSense += SENSE_PERIOD_US;
+            // A reading that moves every digit now and then
+            float seconds = (board.now() - start) / 1e6f;
+            reading.ppm = 180 + 150 * sinf(seconds / 7) + 40 * sinf(seconds * 1.3f);
+            reading.percentage = (int)(reading.ppm / 10);
+            reading.level = reading.ppm > 200 ? GasLevel::MODERATE : GasLevel::SAFE;
+            reading.timestamp = millis();
+        }
+        if (display.isUpdateDue())
+        {
+            display.updateDisplay(reading, reading.level == GasLevel::SAFE ? "Normal" : "Caution");
+        }
+        bus.service();
+
+        if (bus.isIdle())
+        {
+            uint64_t wake = board.now() + display.millisUntilUpdate() * 1000ULL;
+            wake = wake < nextSense ? wake : nextSense;
+            board.advanceTo(wake < nextEvent ? wake : nextEvent);
+        }
+    }
+
+    result.eventP99 = eventWait.percentile(0.99);
+    result.eventMax = eventWait.max();
+    result.tickP99 = late.percentile(0.99);
+    result.tickMax = late.max();
+    result.events = eventWait.getCount();
+    result.ticks = late.getCount();
+    result.redraws = display.getRedrawCount();
+    result.transfers = bus.getCompleted();
+    result.maxCallerMicros = bus.getMaxCallerMicros();
+    return result;
+}
+
+struct BusLoad
+{
+    const char *name;
+    uint32_t stretchMicrosPerByte;
+    uint32_t oneTransferMicros; ///< A full 30-byte transaction at 100 kHz on this bus
+};
+
+class I2cLoopJitter : public ::testing::TestWithParam<BusLoad>
+{
+};
+
+TEST_P(I2cLoopJitter, QueueKeepsSenseTicksOnTime)
+{
+    const BusLoad &load = GetParam();
+    JitterResult blocking = runSenseLoop(load.stretchMicrosPerByte, true);
+    JitterResult queued = runSenseLoop(load.stretchMicrosPerByte, false);
+
+    printf("[ jitter   ] %-9s blocking: event wait p99 %6lu max %6lu us, tick late max %6lu us, enqueue max %5lu us\n"
+           "[ jitter   ] %-9s queued:   event wait p99 %6lu max %6lu us, tick late max %6lu us, enqueue max %5lu us "
+           "(%lu redraws, %lu transfers)\n",
+           load.name, (unsigned long)blocking.eventP99, (unsigned long)blocking.eventMax,
+           (unsigned long)blocking.tickMax, blocking.maxCallerMicros, load.name, (unsigned long)queued.eventP99,
+           (unsigned long)queued.eventMax, (unsigned long)queued.tickMax, queued.maxCallerMicros,
+           (unsigned long)queued.redraws, (unsigned long)queued.transfers);
+
+    // Both loops did the same work, give or take the odd redraw that fell on another second
+    ASSERT_GT(queued.redraws, 500u);
+    EXPECT_NEAR(queued.redraws, blocking.redraws, blocking.redraws / 50);
+    EXPECT_NEAR(queued.transfers, blocking.transfers, blocking.transfers / 50);
+    EXPECT_EQ(queued.ticks, blocking.ticks);
+    EXPECT_EQ(queued.events, blocking.events);
+
+    // Queued, the display only enqueues, and the loop is back after one service slice and the
+    // transfer it started last; blocking, after the whole redraw
+    const uint32_t queuedBound = I2cBusManager::SERVICE_SLICE_US + load.oneTransferMicros;
+    EXPECT_EQ(queued.maxCallerMicros, 0u);
+    EXPECT_LE(queued.eventMax, queuedBound);
+    EXPECT_LE(queued.tickMax, queuedBound);
+    EXPECT_LT(queued.eventMax, blocking.eventMax);
+    EXPECT_LT(queued.tickMax, blocking.tickMax);
+}
+
+INSTANTIATE_TEST_SUITE_P(Buses, I2cLoopJitter,
+                         ::testing::Values(BusLoad{"clean", 0, 3000}, BusLoad{"stretched", 400, 16000}),
+                         [](const ::testing::TestParamInfo<BusLoad> &info) { return std::string(info.param.name); });
+
+TEST(I2cBusManager, HigherPriorityOvertakesAQueuedRedraw)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    board.addI2cDevice(LCD_ADDRESS);
+    // Each 30-byte transfer outlasts a service slice: one transfer per service() call
+    board.setI2cStretch(200);
+
+    I2cBusManager bus;
+    bus.begin();
+    uint8_t payload[I2cTransaction::MAX_PAYLOAD] = {};
+    for (int i = 0; i < 10; i++)
+    {
+        ASSERT_TRUE(bus.enqueue(LCD_ADDRESS, payload, sizeof(payload), I2cPriority::LOW_PRIORITY));
+    }
+    // Nothing answers at 0x50: its transfer is the one that fails
+    ASSERT_TRUE(bus.enqueue(0x50, payload, sizeof(payload), I2cPriority::HIGH_PRIORITY));
+    EXPECT_EQ(bus.getPending(), 11u);
+
+    bus.service();
+    EXPECT_EQ(bus.getFailed(), 1u);
+    EXPECT_EQ(bus.getCompleted(), 0u);
+    bus.waitIdle(1000);
+    EXPECT_EQ(bus.getCompleted(), 10u);
+}
+
+TEST(I2cBusManager, FullQueueDropsInsteadOfBlocking)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    board.addI2cDevice(LCD_ADDRESS);
+
+    I2cBusManager bus;
+    bus.begin();
+    uint8_t payload[8] = {};
+    uint64_t before = board.now();
+    for (int i = 0; i < I2cBusManager::QUEUE_DEPTH + 5; i++)
+    {
+        bus.enqueue(LCD_ADDRESS, payload, sizeof(payload), I2cPriority::LOW_PRIORITY);
+    }
+    EXPECT_EQ(board.now(), before);
+    EXPECT_EQ(bus.getDropped(), 5u);
+    EXPECT_EQ(bus.getPending(), (size_t)I2cBusManager::QUEUE_DEPTH);
+}
+
+} // namespace
@@ -0,0 +1,311 @@
+/**
+ * @file LcdFrameBufferTest.cpp
+ * @brief The frame buffer's diff engine against a fake 20x4 LCD.
+ *
+ * The fake keeps its own screen and cursor the way an HD44780 does: a write lands at the cursor
+ * and moves it right. After every flush the fake must show exactly what was rendered, whatever
+ * runs and cursor moves the diff chose to get there.
+ */
+
+#include "LcdFrameBuffer.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+
+const uint8_t COLS = LcdFrameBuffer::COLS;
+const uint8_t ROWS = LcdFrameBuffer::ROWS;
+
+/**
+ * @brief A character LCD that only knows what it was sent.
+ */
+class FakeLcd : public LcdSink
+{
+public:
+    char screen[ROWS][COLS];
+    uint8_t col;
+    uint8_t row;
+    bool cursorKnown;
+    uint32_t bytes;       ///< One per cursor move or character, as on the wire
+    uint32_t cursorMoves;
+    uint32_t commits;
+    uint32_t misuse;      ///< Writes with no cursor set, or past the end of a row
+
+    FakeLcd() : col(0), row(0), cursorKnown(false), bytes(0), cursorMoves(0), commits(0), misuse(0)
+    {
+        memset(screen, '?', sizeof(screen));
+    }
+
+    void setCursor(uint8_t toCol, uint8_t toRow) override
+    {
+        col = toCol;
+        row = toRow;
+        cursorKnown = true;
+        bytes++;
+        cursorMoves++;
+    }
+
+    void write(const char *text, uint8_t length) override
+    {
+        // Past column 20 the HD44780 carries on into another row's DDRAM; the buffer must never rely on it
+        if (!cursorKnown || row >= ROWS || col + length > COLS)
+        {
+            misuse++;
+            return;
+        }
+        memcpy(&screen[row][col], text, length);
+        col += length;
+        bytes += length;
+    }
+
+    void commit() override
+    {
+        commits++;
+    }
+
+    void blank()
+    {
+        memset(screen, ' ', sizeof(screen));
+    }
+
+    std::string rowText(uint8_t r) const
+    {
+        return std::string(screen[r], COLS);
+    }
+};
+
+/**
+ * @brief Draws the same text into the frame buffer and a plain copy, to compare the fake against.
+ */
+struct Renderer
+{
+    LcdFrameBuffer frame;
+    char expected[ROWS][COLS];
+
+    Renderer()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        frame.clear();
+        memset(expected, ' ', sizeof(expected));
+    }
+
+    void printAt(uint8_t col, uint8_t row, const char *text)
+    {
+        frame.printAt(col, row, text);
+        for (size_t i = 0; text[i] && col + i < COLS; i++)
+        {
+            expected[row][col + i] = text[i];
+        }
+    }
+
+    bool shownBy(const FakeLcd &lcd) const
+    {
+        return memcmp(expected, lcd.screen, sizeof(expected)) == 0;
+    }
+};
+
+void drawStatusScreen(Renderer &renderer, float ppm, int percent, const char *status, unsigned long seconds)
+{
+    char text[24];
+    renderer.clear();
+    renderer.printAt(0, 0, "GLP SecureSense");
+    snprintf(text, sizeof(text), "PPM: %.1f (%d%%)", ppm, percent);
+    renderer.printAt(0, 1, text);
+    renderer.printAt(0, 2, status);
+    snprintf(text, sizeof(text), "Time: %02lu:%02lu:%02lu", seconds / 3600, seconds / 60 % 60, seconds % 60);
+    renderer.printAt(0, 3, text);
+}
+
+TEST(LcdFrameBuffer, FirstFlushWritesEveryRow)
+{
+    FakeLcd lcd;
+    Renderer renderer;
+    renderer.printAt(0, 0, "Hello");
+    uint16_t bytes = renderer.frame.flush(lcd);
+
+    // Nothing known about the LCD yet: all 80 cells, one cursor move per row
+    EXPECT_TRUE(renderer.shownBy(lcd));
+    EXPECT_EQ(bytes, ROWS * COLS + ROWS);
+    EXPECT_EQ(renderer.frame.getLastFlushCursorMoves(), ROWS);
+    EXPECT_EQ(lcd.bytes, bytes);
+    EXPECT_EQ(lcd.commits, 1u);
+    EXPECT_EQ(lcd.misuse, 0u);
+}
+
+TEST(LcdFrameBuffer, UnchangedFrameSendsNothing)
+{
+    FakeLcd lcd;
+    Renderer renderer;
+    drawStatusScreen(renderer, 123.4f, 12, "SAFE", 83);
+    renderer.frame.flush(lcd);
+    drawStatusScreen(renderer, 123.4f, 12, "SAFE", 83);
+    EXPECT_EQ(renderer.frame.flush(lcd), 0);
+    EXPECT_EQ(renderer.frame.getLastFlushCursorMoves(), 0);
+    EXPECT_EQ(lcd.commits, 2u);
+}
+
+TEST(LcdFrameBuffer, OneDigitIsACursorMoveAndOneCharacter)
+{
+    FakeLcd lcd;
+    Renderer renderer;
+    drawStatusScreen(renderer, 123.4f, 12, "SAFE", 83);
+    renderer.frame.flush(lcd);
+    drawStatusScreen(renderer, 123.4f, 12, "SAFE", 84);
+    EXPECT_EQ(renderer.frame.flush(lcd), 2);
+    EXPECT_TRUE(renderer.shownBy(lcd));
+}
+
+TEST(LcdFrameBuffer, SmallGapsJoinOneRun)
+{
+    FakeLcd lcd;
+    Renderer renderer;
+    renderer.printAt(0, 0, "abcdef");
+    renderer.frame.flush(lcd);
+
+    // b and d change, c between them does not: rewriting c beats a second cursor move
+    renderer.printAt(0, 0, "aXcYef");
+    EXPECT_EQ(renderer.frame.flush(lcd), 1 + 3);
+    EXPECT_EQ(renderer.frame.getLastFlushCursorMoves(), 1);
+
+    // Two unchanged cells between the changes: two runs
+    renderer.printAt(0, 0, "PXcdQf");
+    EXPECT_EQ(renderer.frame.flush(lcd), 2 + 3);
+    EXPECT_EQ(renderer.frame.getLastFlushCursorMoves(), 2);
+    EXPECT_TRUE(renderer.shownBy(lcd));
+}
+
+TEST(LcdFrameBuffer, RunsOnTheNextRowAlwaysMoveTheCursor)
+{
+    // A change at the end of one row and the start of the next is two runs: the LCD's cursor does
+    // not wrap to the next visible row
+    FakeLcd lcd;
+    Renderer renderer;
+    renderer.frame.flush(lcd);
+    renderer.printAt(19, 0, "x");
+    renderer.printAt(0, 1, "y");
+    EXPECT_EQ(renderer.frame.flush(lcd), 4);
+    EXPECT_EQ(renderer.frame.getLastFlushCursorMoves(), 2);
+    EXPECT_TRUE(renderer.shownBy(lcd));
+    EXPECT_EQ(lcd.misuse, 0u);
+}
+
+TEST(LcdFrameBuffer, TextPastTheEdgeIsClipped)
+{
+    FakeLcd lcd;
+    Renderer renderer;
+    renderer.printAt(15, 2, "0123456789");
+    renderer.frame.flush(lcd);
+    EXPECT_EQ(lcd.rowText(2), std::string(15, ' ') + "01234");
+    EXPECT_EQ(lcd.rowText(3), std::string(COLS, ' '));
+    EXPECT_EQ(lcd.misuse, 0u);
+}
+
+TEST(LcdFrameBuffer, InvalidateRewritesAndAssumeBlankSkipsSpaces)
+{
+    FakeLcd lcd;
+    Renderer renderer;
+    drawStatusScreen(renderer, 123.4f, 12, "SAFE", 83);
+    renderer.frame.flush(lcd);
+
+    // The LCD glitched: whatever it shows now, a full rewrite fixes it
+    memset(lcd.screen, '#', sizeof(lcd.screen));
+    renderer.frame.invalidate();
+    EXPECT_EQ(renderer.frame.flush(lcd), ROWS * COLS + ROWS);
+    EXPECT_TRUE(renderer.shownBy(lcd));
+
+    // After a hardware clear only the non-blank text goes out
+    lcd.blank();
+    renderer.frame.assumeBlank();
+    EXPECT_LT(renderer.frame.flush(lcd), 60);
+    EXPECT_TRUE(renderer.shownBy(lcd));
+}
+
+TEST(LcdFrameBuffer, RandomEditsAlwaysLeaveTheLcdInSync)
+{
+    std::mt19937 random(32);
+    std::uniform_int_distribution<int> colOf(0, COLS - 1);
+    std::uniform_int_distribution<int> rowOf(0, ROWS - 1);
+    std::uniform_int_distribution<int> lengthOf(0, 8);
+    std::uniform_int_distribution<int> charOf(' ', '~');
+    std::uniform_int_distribution<int> editsOf(0, 6);
+
+    FakeLcd lcd;
+    Renderer renderer;
+    uint32_t sent = 0;
+    for (int frame = 0; frame < 20000; frame++)
+    {
+        // Mostly small edits on top of the last frame, sometimes a full redraw from blank
+        if (frame % 97 == 0)
+        {
+            renderer.clear();
+        }
+        int edits = editsOf(random);
+        for (int e = 0; e < edits; e++)
+        {
+            char text[10];
+            int length = lengthOf(random);
+            for (int i = 0; i < length; i++)
+            {
+                text[i] = (char)charOf(random);
+            }
+            text[length] = '\0';
+            renderer.printAt(colOf(random), rowOf(random), text);
+        }
+        if (frame % 1000 == 999)
+        {
+            renderer.frame.invalidate();
+        }
+
+        uint16_t bytes = renderer.frame.flush(lcd);
+        sent += bytes;
+        ASSERT_TRUE(renderer.shownBy(lcd)) << "frame " << frame;
+        ASSERT_EQ(lcd.misuse, 0u) << "frame " << frame;
+        ASSERT_LE(bytes, ROWS * COLS + ROWS);
+    }
+    EXPECT_EQ(lcd.bytes, sent);
+    EXPECT_EQ(renderer.frame.getTotalFlushBytes(), sent);
+}
+
+TEST(LcdFrameBuffer, StatusScreenCostsAFewBytesPerRefresh)
+{
+    // Ten minutes of 500 ms refreshes with a wandering reading, against a clear and a full rewrite
+    // each time as the display used to do: the clear command, four cursor moves and 80 characters
+    const uint32_t REWRITE_BYTES = 1 + ROWS + ROWS * COLS;
+    std::mt19937 random(7);
+    std::normal_distribution<float> noise(0, 3);
+
+    FakeLcd lcd;
+    Renderer renderer;
+    uint32_t frames = 0;
+    uint32_t worst = 0;
+    uint64_t total = 0;
+    for (unsigned long millis = 0; millis < 10UL * 60 * 1000; millis += 500)
+    {
+        float ppm = 150 + 20 * sinf(millis / 60000.0f) + noise(random);
+        const char *status = ppm > 165 ? "MODERATE" : "SAFE";
+        drawStatusScreen(renderer, ppm, (int)(ppm / 10), status, millis / 1000);
+        uint16_t bytes = renderer.frame.flush(lcd);
+        ASSERT_TRUE(renderer.shownBy(lcd));
+        if (frames > 0)
+        {
+            total += bytes;
+            worst = bytes > worst ? bytes : worst;
+        }
+        frames++;
+    }
+    double mean = (double)total / (frames - 1);
+    printf("[ lcd      ] %lu refreshes: mean %.1f bytes, worst %lu, against %lu for clear and rewrite (%.1fx)\n",
+           (unsigned long)frames, mean, (unsigned long)worst, (unsigned long)REWRITE_BYTES, REWRITE_BYTES / mean);
+    EXPECT_LT(mean, REWRITE_BYTES / 5.0);
+    EXPECT_LT(worst, REWRITE_BYTES);
+}
+
+} // namespace
@@ -0,0 +1,276 @@
+/**
+ * @file LedPatternTest.cpp
+ * @brief LEDC programs of the LED patterns, checked against a simulated LEDC peripheral.
+ *
+ * The simulated peripheral takes a program the way the ESP32 does: it picks a source clock whose
+ * divider fits the timer's 10.8 fixed-point range for the frequency and resolution, or refuses
+ * the program. It then produces the pin waveform itself, so the test measures blink rate, on
+ * time and breathing period from the output instead of re-reading the program's fields.
+ */
+
+#include "LedPattern.h"
+#include "LedPatternDriver.h"
+#include "VirtualBoard.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace
+{
+
+/**
+ * @brief One LEDC channel and its timer, as seen from the pin.
+ */
+class SimulatedLedc
+{
+public:
+    static constexpr double APB_CLOCK_HZ = 80e6;
+    static constexpr double REF_TICK_HZ = 1e6;
+    static constexpr double MIN_DIVIDER = 1.0;
+    static constexpr double MAX_DIVIDER = 1024.0 - 1.0 / 256; ///< 10 integer bits, 8 fraction bits
+
+private:
+    LedcProgram program;
+    double sourceClockHz;
+    double periodSeconds;
+    bool fading;
+    double fadeStart;
+    bool fadingUp;
+
+public:
+    SimulatedLedc()
+        : program{0, 0, 0, 0}, sourceClockHz(0), periodSeconds(0), fading(false), fadeStart(0), fadingUp(true)
+    {
+    }
+
+    /**
+     * @brief Configures the timer and channel, as ledcAttach() and ledcWrite() do.
+     * @return False when no source clock can produce the frequency at this resolution.
+     */
+    bool load(const LedcProgram &newProgram)
+    {
+        program = newProgram;
+        sourceClockHz = 0;
+        if (program.frequencyHz == 0 || program.resolutionBits == 0 || program.resolutionBits > 20)
+        {
+            return false;
+        }
+        const double clocks[] = {APB_CLOCK_HZ, REF_TICK_HZ};
+        for (double clock : clocks)
+        {
+            double divider = clock / ((double)program.frequencyHz * (1UL << program.resolutionBits));
+            if (divider >= MIN_DIVIDER && divider <= MAX_DIVIDER)
+            {
+                // The divider is truncated to 1/256 steps
+                double programmed = floor(divider * 256) / 256;
+                sourceClockHz = clock;
+                periodSeconds = programmed * (1UL << program.resolutionBits) / clock;
+                return program.duty <= (1UL << program.resolutionBits);
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Starts one hardware fade ramp, as ledcFade() does.
+     */
+    void startFade(double atSeconds, bool up)
+    {
+        fading = true;
+        fadeStart = atSeconds;
+        fadingUp = up;
+    }
+
+    bool fadeDone(double atSeconds) const
+    {
+        return fading && atSeconds - fadeStart >= program.fadeMs / 1000.0;
+    }
+
+    double getSourceClock() const
+    {
+        return sourceClockHz;
+    }
+
+    double getFrequency() const
+    {
+        return 1 / periodSeconds;
+    }
+
+    /**
+     * @brief Duty in effect at a time: the fixed duty, or where the fade ramp has got to.
+     */
+    double dutyAt(double atSeconds) const
+    {
+        double fullScale = (double)(1UL << program.resolutionBits);
+        if (!fading)
+        {
+            return program.duty / fullScale;
+        }
+        double progress = fmin(1.0, (atSeconds - fadeStart) / (program.fadeMs / 1000.0));
+        return (fadingUp ? progress : 1 - progress) * program.duty / fullScale;
+    }
+
+    /**
+     * @brief Pin level at a time: high for the first duty share of each timer period.
+     */
+    bool levelAt(double atSeconds) const
+    {
+        double phase = fmod(atSeconds, periodSeconds) / periodSeconds;
+        return phase < dutyAt(atSeconds);
+    }
+};
+
+struct Waveform
+{
+    double riseRateHz; ///< Rising edges per second
+    double onShare;    ///< Share of the time the pin was high
+    double longestOnMs;
+};
+
+Waveform measure(const SimulatedLedc &ledc, double seconds)
+{
+    // 10 kHz sampling against blink rates of at most 50 Hz
+    const double step = 1e-4;
+    Waveform waveform = {0, 0, 0};
+    bool last = ledc.levelAt(0);
+    double onSince = 0;
+    uint32_t rises = 0;
+    uint32_t onSamples = 0;
+    uint32_t samples = 0;
+    for (double t = step; t < seconds; t += step)
+    {
+        bool level = ledc.levelAt(t);
+        if (level && !last)
+        {
+            rises++;
+            onSince = t;
+        }
+        if (!level && last)
+        {
+            waveform.longestOnMs = fmax(waveform.longestOnMs, (t - onSince) * 1000);
+        }
+        onSamples += level;
+        samples++;
+        last = level;
+    }
+    waveform.riseRateHz = rises / seconds;
+    waveform.onShare = (double)onSamples / samples;
+    return waveform;
+}
+
+TEST(LedPattern, CommandPatternsRunAsProgrammed)
+{
+    struct Case
+    {
+        const char *name;
+        LedPattern pattern;
+        double hz;
+        double onShare;
+        double onMs;
+    };
+    const Case cases[] = {
+        {"BLINK", LedPattern::blink(1), 1, 0.5, 500},
+        {"FAST_BLINK", LedPattern::blink(4), 4, 0.5, 125},
+        {"STROBE", LedPattern::strobe(10), 10, 0.1, 10},
+    };
+    for (const Case &c : cases)
+    {
+        SimulatedLedc ledc;
+        ASSERT_TRUE(ledc.load(compileLedPattern(c.pattern))) << c.name;
+        Waveform waveform = measure(ledc, 10);
+        printf("[ ledc     ] %-10s %.0f MHz clock: %.3f Hz, %.1f%% on, %.1f ms flashes\n", c.name,
+               ledc.getSourceClock() / 1e6, ledc.getFrequency(), waveform.onShare * 100, waveform.longestOnMs);
+        EXPECT_NEAR(ledc.getFrequency(), c.hz, c.hz * 0.001) << c.name;
+        EXPECT_NEAR(waveform.riseRateHz, c.hz, 0.15) << c.name;
+        EXPECT_NEAR(waveform.onShare, c.onShare, 0.01) << c.name;
+        EXPECT_NEAR(waveform.longestOnMs, c.onMs, c.onMs * 0.02 + 0.2) << c.name;
+    }
+}
+
+TEST(LedPattern, EveryRateAndDutyFitsThePeripheral)
+{
+    // Clamping keeps every request, however wild, loadable
+    for (uint32_t hz = 0; hz <= 1000; hz++)
+    {
+        for (uint32_t duty = 0; duty <= 100; duty += 5)
+        {
+            LedcProgram program = compileLedPattern(LedPattern::blink((uint16_t)hz, (uint8_t)duty));
+            SimulatedLedc ledc;
+            ASSERT_TRUE(ledc.load(program)) << hz << " Hz " << duty << "%";
+            EXPECT_GE(program.frequencyHz, LEDC_MIN_BLINK_HZ);
+            EXPECT_LE(program.frequencyHz, LEDC_MAX_BLINK_HZ);
+            // Never stuck fully on or off
+            EXPECT_GT(program.duty, 0u);
+            EXPECT_LT(program.duty, 1u << program.resolutionBits);
+        }
+    }
+    // 1 Hz at 10 bits needs the 1 MHz REF_TICK; the APB clock would need a divider of 78125
+    SimulatedLedc slowest;
+    ASSERT_TRUE(slowest.load(compileLedPattern(LedPattern::blink(1))));
+    EXPECT_EQ(slowest.getSourceClock(), SimulatedLedc::REF_TICK_HZ);
+}
+
+TEST(LedPattern, BreatheRampsOnACarrierWithOneRestartPerHalfCycle)
+{
+    LedcProgram program = compileLedPattern(LedPattern::breathe(2000));
+    SimulatedLedc ledc;
+    ASSERT_TRUE(ledc.load(program));
+    EXPECT_GE(ledc.getFrequency(), 1000.0); // No visible flicker at any brightness
+    EXPECT_EQ(program.fadeMs, 1000u);
+
+    // What LedPatternDriver::update() does: restart the ramp the other way once the last one ended
+    bool up = true;
+    ledc.startFade(0, up);
+    uint32_t restarts = 0;
+    double peakAt = -1;
+    double troughAt = -1;
+    for (double t = 0; t < 10; t += 0.001)
+    {
+        if (ledc.fadeDone(t))
+        {
+            up = !up;
+            ledc.startFade(t, up);
+            restarts++;
+        }
+        double duty = ledc.dutyAt(t);
+        if (peakAt < 0 && duty > 0.99)
+        {
+            peakAt = t;
+        }
+        if (peakAt >= 0 && troughAt < 0 && duty < 0.01)
+        {
+            troughAt = t;
+        }
+    }
+    printf("[ ledc     ] BREATHE    %.0f Hz carrier, peak at %.3f s, dark again at %.3f s, %lu restarts in 10 s\n",
+           ledc.getFrequency(), peakAt, troughAt, (unsigned long)restarts);
+    EXPECT_NEAR(peakAt, 1.0, 0.02);
+    EXPECT_NEAR(troughAt, 2.0, 0.02);
+    EXPECT_NEAR(restarts, 9u, 1);
+}
+
+TEST(LedPattern, DriverProgramsOncePerPatternChange)
+{
+    VirtualBoard board;
+    VirtualBoard::Scope scope(board);
+    LedPatternDriver led(27);
+
+    led.handle(LedPatternDriver::STROBE_COMMAND);
+    uint32_t programs = led.getProgramCount();
+    for (int i = 0; i < 100; i++)
+    {
+        led.handle(LedPatternDriver::STROBE_COMMAND);
+    }
+    EXPECT_EQ(led.getProgramCount(), programs);
+    EXPECT_EQ(led.getPattern(), LedPattern::strobe(10));
+
+    led.handle(LedPatternDriver::FAST_BLINK_COMMAND);
+    EXPECT_EQ(led.getProgramCount(), programs + 1);
+    EXPECT_EQ(led.getPattern(), LedPattern::blink(4));
+
+    led.handle(Led::TURN_OFF_COMMAND);
+    EXPECT_FALSE(led.getState());
+    EXPECT_EQ(led.getPattern(), LedPattern::solid());
+    EXPECT_EQ(board.read(27), LOW);
+}
+
+} // namespace
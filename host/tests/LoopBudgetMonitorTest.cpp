@@ -0,0 +1,193 @@
+/**
+ * @file LoopBudgetMonitorTest.cpp
+ * @brief Stage shedding under the gas detector's 20 ms loop budget, on a simulated clock.
+ *
+ * Passes start every 100 ms and run the device's stages in order; each stage that shouldRun()
+ * lets through advances the clock by its cost. When sensing alone overruns the budget, the
+ * critical stages must still run every pass, the sheddable ones must be deferred, and each
+ * deferred stage must be forced through once it has waited the 2 s limit.
+ */
+
+#include "LoopBudgetMonitor.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace
+{
+
+const uint32_t BUDGET_US = 20000;
+const uint32_t MAX_DEFER_US = 2000000;
+const uint32_t PASS_PERIOD_US = 100000;
+const int STAGES = (int)LoopStage::COUNT;
+
+bool isCritical(LoopStage stage)
+{
+    return stage == LoopStage::SENSE || stage == LoopStage::ALARM;
+}
+
+/**
+ * @brief The loop: per-stage costs, and when each stage ran.
+ */
+struct Loop
+{
+    LoopBudgetMonitor monitor;
+    unsigned long now;
+    uint32_t cost[STAGES];
+    std::vector<unsigned long> runs[STAGES];
+
+    Loop() : monitor(BUDGET_US, MAX_DEFER_US), now(1000000)
+    {
+        for (int i = 0; i < STAGES; i++)
+        {
+            cost[i] = 500;
+        }
+    }
+
+    void pass()
+    {
+        unsigned long start = now;
+        monitor.beginPass(now);
+        for (int i = 0; i < STAGES; i++)
+        {
+            LoopStage stage = (LoopStage)i;
+            if (!monitor.shouldRun(stage, now))
+            {
+                continue;
+            }
+            monitor.beginStage(stage, now);
+            runs[i].push_back(now);
+            now += cost[i];
+            monitor.endStage(now);
+        }
+        monitor.endPass(now);
+        now = start + PASS_PERIOD_US;
+    }
+
+    void passes(int count)
+    {
+        for (int p = 0; p < count; p++)
+        {
+            pass();
+        }
+    }
+
+    void forget()
+    {
+        for (std::vector<unsigned long> &stageRuns : runs)
+        {
+            stageRuns.clear();
+        }
+    }
+};
+
+TEST(LoopBudgetMonitor, EveryStageRunsWithinBudget)
+{
+    Loop loop;
+    loop.passes(50);
+    for (int i = 0; i < STAGES; i++)
+    {
+        EXPECT_EQ(loop.runs[i].size(), 50u) << LoopBudgetMonitor::stageName((LoopStage)i);
+    }
+    EXPECT_EQ(loop.monitor.getTotalShedCount(), 0u);
+    EXPECT_EQ(loop.monitor.getOverrunCount(), 0u);
+    EXPECT_EQ(loop.monitor.getLastPassMicros(), STAGES * 500u);
+    EXPECT_EQ(loop.monitor.getPassCount(), 50u);
+}
+
+TEST(LoopBudgetMonitor, OverrunShedsDeferrableStagesButNeverCriticalOnes)
+{
+    Loop loop;
+    loop.passes(10);
+    loop.forget();
+
+    // Sensing alone now takes longer than the whole budget, for 10 s
+    const int passes = 100;
+    loop.cost[(int)LoopStage::SENSE] = 25000;
+    loop.passes(passes);
+
+    EXPECT_EQ(loop.runs[(int)LoopStage::SENSE].size(), (size_t)passes);
+    EXPECT_EQ(loop.runs[(int)LoopStage::ALARM].size(), (size_t)passes);
+    EXPECT_EQ(loop.monitor.getShedCount(LoopStage::SENSE), 0u);
+    EXPECT_EQ(loop.monitor.getShedCount(LoopStage::ALARM), 0u);
+    EXPECT_EQ(loop.monitor.getOverrunCount(), (uint32_t)passes);
+    EXPECT_GE(loop.monitor.getWorstPassMicros(), 25000u);
+
+    for (int i = 0; i < STAGES; i++)
+    {
+        LoopStage stage = (LoopStage)i;
+        if (isCritical(stage))
+        {
+            continue;
+        }
+        const std::vector<unsigned long> &runs = loop.runs[i];
+        const char *name = LoopBudgetMonitor::stageName(stage);
+
+        // Starved stages are forced through at the first pass 2 s after their last run ended
+        ASSERT_GE(runs.size(), 4u) << name;
+        EXPECT_LE(runs.size(), (size_t)(passes * PASS_PERIOD_US / MAX_DEFER_US + 1)) << name;
+        for (size_t r = 1; r < runs.size(); r++)
+        {
+            EXPECT_GE(runs[r] - runs[r - 1], MAX_DEFER_US) << name << " run " << r;
+            EXPECT_LE(runs[r] - runs[r - 1], MAX_DEFER_US + PASS_PERIOD_US) << name << " run " << r;
+        }
+        EXPECT_EQ(loop.monitor.getShedCount(stage), passes - runs.size()) << name;
+    }
+
+    // Back under budget: everything runs again
+    loop.cost[(int)LoopStage::SENSE] = 500;
+    loop.passes(5);
+    loop.forget();
+    loop.passes(10);
+    for (int i = 0; i < STAGES; i++)
+    {
+        EXPECT_EQ(loop.runs[i].size(), 10u) << LoopBudgetMonitor::stageName((LoopStage)i);
+    }
+}
+
+TEST(LoopBudgetMonitor, AStageIsDeferredWhenItsExpectedCostWouldOverrun)
+{
+    // One 12 ms redraw sets the display's expected cost
+    Loop loop;
+    loop.cost[(int)LoopStage::DISPLAY] = 12000;
+    loop.pass();
+    loop.cost[(int)LoopStage::DISPLAY] = 500;
+    EXPECT_EQ(loop.monitor.getWorstStageMicros(LoopStage::DISPLAY), 12000u);
+
+    // With 10 ms of sensing it no longer fits, although the pass is still under budget
+    loop.forget();
+    loop.cost[(int)LoopStage::SENSE] = 10000;
+    loop.pass();
+    EXPECT_TRUE(loop.runs[(int)LoopStage::DISPLAY].empty());
+    EXPECT_EQ(loop.runs[(int)LoopStage::SERIAL_LOG].size(), 1u);
+    EXPECT_EQ(loop.monitor.getShedCount(LoopStage::DISPLAY), 1u);
+    EXPECT_LE(loop.monitor.getLastPassMicros(), BUDGET_US);
+
+    // Forced runs every 2 s are cheap; the expected cost decays by 1/16 per run, so after a few
+    // of them the display fits again and runs every pass
+    loop.passes(200);
+    const std::vector<unsigned long> &display = loop.runs[(int)LoopStage::DISPLAY];
+    ASSERT_GE(display.size(), 2u);
+    EXPECT_GE(display.front() - loop.runs[(int)LoopStage::SENSE].front(), MAX_DEFER_US);
+    size_t forced = 1;
+    while (forced < display.size() && display[forced] - display[forced - 1] >= MAX_DEFER_US)
+    {
+        forced++;
+    }
+    EXPECT_GE(forced, 2u);
+    EXPECT_LE(forced, 6u);
+    for (size_t r = forced; r < display.size(); r++)
+    {
+        EXPECT_EQ(display[r] - display[r - 1], PASS_PERIOD_US) << r;
+    }
+    EXPECT_EQ(display.back(), loop.runs[(int)LoopStage::SENSE].back() + 10000 + 500);
+    EXPECT_EQ(loop.monitor.getOverrunCount(), 0u);
+}
+
+TEST(LoopBudgetMonitor, NamesEveryStage)
+{
+    EXPECT_STREQ(LoopBudgetMonitor::stageName(LoopStage::SENSE), "sense");
+    EXPECT_STREQ(LoopBudgetMonitor::stageName(LoopStage::HISTORY), "history");
+    EXPECT_STREQ(LoopBudgetMonitor::stageName(LoopStage::COUNT), "?");
+}
+
+} // namespace
@@ -0,0 +1,118 @@
+/**
+ * @file LoopbackClient.cpp
+ * @brief Blocking HTTP/1.1 client over loopback.
+ */
+
+#include "LoopbackClient.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+LoopbackClient::LoopbackClient() : socket(-1)
+{
+    pending.reserve(4096);
+}
+
+LoopbackClient::~LoopbackClient()
+{
+    close();
+}
+
+bool LoopbackClient::connect(uint16_t port)
+{
+    close();
+    socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socket < 0)
+    {
+        return false;
+    }
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (::connect(socket, (struct sockaddr *)&address, sizeof(address)) < 0)
+    {
+        close();
+        return false;
+    }
+    int yes = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    return true;
+}
+
+void LoopbackClient::close()
+{
+    if (socket >= 0)
+    {
+        ::close(socket);
+        socket = -1;
+    }
+    pending.clear();
+}
+
+bool LoopbackClient::send(const char *request)
+{
+    size_t length = strlen(request);
+    size_t sent = 0;
+    while (sent < length)
+    {
+        ssize_t written = ::send(socket, request + sent, length - sent, MSG_NOSIGNAL);
+        if (written <= 0)
+        {
+            return false;
+        }
+        sent += written;
+    }
+    return true;
+}
+
+bool LoopbackClient::get(const char *path, HttpReply &reply)
+{
+    std::string request = std::string("GET ") + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    return send(request.c_str()) && read(reply);
+}
+
+bool LoopbackClient::read(HttpReply &reply)
+{
+    char chunk[4096];
+    for (;;)
+    {
+        size_t headerEnd = pending.find("\r\n\r\n");
+        if (headerEnd != std::string::npos)
+        {
+            size_t lengthAt = pending.find("Content-Length:");
+            if (pending.compare(0, 9, "HTTP/1.1 ") != 0 || lengthAt == std::string::npos || lengthAt > headerEnd)
+            {
+                return false;
+            }
+            size_t bodyAt = headerEnd + 4;
+            size_t bodyLength = strtoul(pending.c_str() + lengthAt + 15, nullptr, 10);
+            if (pending.size() >= bodyAt + bodyLength)
+            {
+                reply.status = atoi(pending.c_str() + 9);
+                reply.body.assign(pending, bodyAt, bodyLength);
+                pending.erase(0, bodyAt + bodyLength);
+                return true;
+            }
+        }
+        ssize_t got = recv(socket, chunk, sizeof(chunk), 0);
+        if (got <= 0)
+        {
+            return false;
+        }
+        pending.append(chunk, got);
+    }
+}
+
+bool LoopbackClient::closedByServer(uint32_t timeoutMillis)
+{
+    struct pollfd readable = {socket, POLLIN, 0};
+    char chunk[64];
+    return pending.empty() && poll(&readable, 1, (int)timeoutMillis) == 1 && recv(socket, chunk, sizeof(chunk), 0) == 0;
+}
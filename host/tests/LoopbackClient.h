@@ -0,0 +1,66 @@
+#ifndef HOST_LOOPBACK_CLIENT_H
+#define HOST_LOOPBACK_CLIENT_H
+
+/**
+ * @file LoopbackClient.h
+ * @brief Blocking HTTP/1.1 client over loopback, for testing StatusServer on the host.
+ *
+ * Reads responses by their Content-Length and keeps any bytes past one response for the next,
+ * so pipelined answers come back one read() at a time.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+struct HttpReply
+{
+    int status;
+    std::string body;
+};
+
+class LoopbackClient
+{
+private:
+    int socket;
+    std::string pending;
+
+public:
+    LoopbackClient();
+    ~LoopbackClient();
+
+    LoopbackClient(const LoopbackClient &) = delete;
+    LoopbackClient &operator=(const LoopbackClient &) = delete;
+
+    /**
+     * @brief Connects to 127.0.0.1, closing any previous connection first.
+     */
+    bool connect(uint16_t port);
+    void close();
+    bool isOpen() const { return socket >= 0; }
+
+    /**
+     * @brief Sends raw request bytes.
+     */
+    bool send(const char *request);
+
+    /**
+     * @brief Sends a keep-alive GET and reads its response.
+     */
+    bool get(const char *path, HttpReply &reply);
+
+    /**
+     * @brief Reads the next response.
+     * @return False when the server closed the connection or sent something other than a
+     *         complete response.
+     */
+    bool read(HttpReply &reply);
+
+    /**
+     * @brief Waits for the server to close the connection.
+     * @return True when it closed, false on timeout or unread response bytes.
+     */
+    bool closedByServer(uint32_t timeoutMillis);
+};
+
+#endif // HOST_LOOPBACK_CLIENT_H
@@ -0,0 +1,100 @@
+/**
+ * @file PowerLawTableTest.cpp
+ * @brief Accuracy of the compile-time MQ-2 curve table against pow().
+ */
+
+#include "GasSensor.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace
+{
+
+const double LPG_A = 574.25;
+const double LPG_B = -2.222;
+
+struct ErrorReport
+{
+    double maxRelative;
+    double meanRelative;
+    double worstRatio;
+};
+
+/**
+ * @brief Compares a table with a * x^b in double at points spread evenly in log(x).
+ */
+template <typename Table>
+ErrorReport sweep(const Table &table, double a, double b, double from, double to, int points)
+{
+    ErrorReport report = {0, 0, 0};
+    double step = log(to / from) / (points - 1);
+    for (int i = 0; i < points; i++)
+    {
+        double ratio = from * exp(step * i);
+        double exact = a * pow(ratio, b);
+        double error = fabs(table.evaluate((float)ratio) - exact) / exact;
+        report.meanRelative += error;
+        if (error > report.maxRelative)
+        {
+            report.maxRelative = error;
+            report.worstRatio = ratio;
+        }
+    }
+    report.meanRelative /= points;
+    return report;
+}
+
+TEST(PowerLawTable, LpgCurveWithinTenthOfAPercentOverTheSensorRange)
+{
+    const Mq2CurveTable &table = GasSensor::lpgCurve();
+    ErrorReport whole = sweep(table, LPG_A, LPG_B, Mq2CurveTable::minInput(), Mq2CurveTable::maxInput(), 200001);
+    // 200 to 10000 PPM: from the first threshold to the MQ-2's rated top
+    double alarmFrom = pow(10000 / LPG_A, 1 / LPG_B);
+    double alarmTo = pow(200 / LPG_A, 1 / LPG_B);
+    ErrorReport alarm = sweep(table, LPG_A, LPG_B, alarmFrom, alarmTo, 50001);
+
+    printf("[ accuracy ] Rs/R0 %.3f-%.0f: max %.4f%% at %.4f, mean %.4f%%; 200-10000 PPM: max %.4f%%, mean %.4f%%; "
+           "midpoint probe %.4f%%\n",
+           Mq2CurveTable::minInput(), Mq2CurveTable::maxInput(), whole.maxRelative * 100, whole.worstRatio,
+           whole.meanRelative * 100, alarm.maxRelative * 100, alarm.meanRelative * 100,
+           table.maxRelativeError() * 100);
+
+    EXPECT_LT(whole.maxRelative, 0.001);
+    EXPECT_LT(alarm.maxRelative, 0.001);
+    // The build-time probe sees the same worst case as the dense sweep, to within float rounding
+    EXPECT_NEAR(whole.maxRelative, table.maxRelativeError(), 0.0001);
+}
+
+TEST(PowerLawTable, NodesAreExact)
+{
+    const Mq2CurveTable &table = GasSensor::lpgCurve();
+    for (int i = 0; i < Mq2CurveTable::SIZE; i++)
+    {
+        double x = Mq2CurveTable::nodeAt(i);
+        double exact = LPG_A * pow(x, LPG_B);
+        EXPECT_NEAR(table.evaluate((float)x), exact, exact * 1e-6) << "node " << i;
+    }
+}
+
+TEST(PowerLawTable, ClampsOutsideTheTable)
+{
+    const Mq2CurveTable &table = GasSensor::lpgCurve();
+    float saturated = table.evaluate((float)Mq2CurveTable::minInput());
+    float clean = table.evaluate((float)Mq2CurveTable::maxInput());
+    EXPECT_EQ(table.evaluate(0.0f), saturated);
+    EXPECT_EQ(table.evaluate(-1.0f), saturated);
+    EXPECT_EQ(table.evaluate(1000.0f), clean);
+    EXPECT_EQ(table.evaluate(NAN), 0.0f);
+}
+
+TEST(PowerLawTable, OtherCurvesReuseTheGenerator)
+{
+    // MQ-2 CO fit from the MQUnifiedsensor examples; steeper, so the same table is less exact
+    static constexpr PowerLawTable<-3, 4, 32> coCurve(36974, -3.109);
+    static_assert(coCurve.maxRelativeError() < 0.002, "CO table error");
+    ErrorReport co = sweep(coCurve, 36974, -3.109, 0.125, 16, 100001);
+    printf("[ accuracy ] CO curve: max %.4f%%, mean %.4f%%\n", co.maxRelative * 100, co.meanRelative * 100);
+    EXPECT_LT(co.maxRelative, 0.002);
+}
+
+} // namespace
@@ -0,0 +1,198 @@
+/**
+ * @file PowerManagerTest.cpp
+ * @brief Sleep windows, duty cycle and current estimate of the power manager, on a virtual clock.
+ *
+ * plan() and account() are driven with times around the 32-bit micros() wrap. The gas detector
+ * then idles through ten minutes on the virtual board, whose clock advances through every sleep:
+ * the sleep time the manager reports must be the time the clock spent in it, and a D0 edge must
+ * end a sleep at the edge rather than at its deadline.
+ */
+
+#include "GLPSecureSenseDevice.h"
+#include "SloHarness.h"
+#include "mq2_stimulus.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+namespace
+{
+
+const uint32_t NEAR_WRAP = 0xFFFFFFFFUL - 150000; ///< 150 ms before micros() wraps
+const int GAS_ANALOG_PIN = 4;
+const int GAS_DIGITAL_PIN = 23;
+const uint8_t LCD_ADDRESS = 0x27;
+
+TEST(PowerManager, PlansTheEarliestDeadlineAcrossTheWrap)
+{
+    PowerManager power(40, 20, 0.8f, 150);
+    uint32_t window;
+
+    // Deadlines on both sides of the wrap: the earlier one wins, though its value is larger
+    unsigned long now = NEAR_WRAP;
+    power.beginPass(now);
+    power.offerDeadline((uint32_t)(now + 400000));
+    power.offerDeadline(now + 100000);
+    EXPECT_EQ(power.plan(now, window), IdleMode::LIGHT_SLEEP);
+    EXPECT_EQ(window, 100000u);
+
+    power.offerDeadline((uint32_t)(now + 200000));
+    EXPECT_EQ(power.plan(now, window), IdleMode::LIGHT_SLEEP);
+    EXPECT_EQ(window, 100000u);
+
+    // Short windows and held passes are waited out awake; a due deadline is not waited at all
+    EXPECT_EQ(power.plan(now + 100000 - PowerManager::MIN_LIGHT_SLEEP_US + 1, window), IdleMode::DELAY);
+    EXPECT_EQ(power.plan(now + 100000, window), IdleMode::NONE);
+    EXPECT_EQ(window, 0u);
+    power.hold();
+    EXPECT_EQ(power.plan(now, window), IdleMode::DELAY);
+    EXPECT_EQ(window, 100000u);
+
+    // Without deadlines the manager still checks in
+    const uint32_t maxWindow = PowerManager::MAX_WINDOW_US;
+    power.beginPass(now);
+    EXPECT_EQ(power.plan(now, window), IdleMode::LIGHT_SLEEP);
+    EXPECT_EQ(window, maxWindow);
+}
+
+TEST(PowerManager, ReportsDutyCycleAndCurrentFromVirtualTime)
+{
+    PowerManager power(40, 20, 0.8f, 150);
+    EXPECT_FLOAT_EQ(power.getDutyCycle(), 1.0f);
+
+    // A virtual clock across the wrap: 3 ms of work per 100 ms pass. Every tenth pass is held
+    // awake, and one in a hundred is woken halfway through its sleep
+    uint32_t clock = NEAR_WRAP;
+    uint64_t active = 0;
+    uint64_t awake = 0;
+    uint64_t asleep = 0;
+    for (int pass = 0; pass < 1000; pass++)
+    {
+        uint32_t start = clock;
+        power.beginPass(start);
+        clock += 3000;
+        power.offerDeadline((uint32_t)(start + 100000));
+        power.offerDeadline((uint32_t)(clock + 400000));
+        if (pass % 10 == 0)
+        {
+            power.hold();
+        }
+        uint32_t window;
+        IdleMode mode = power.plan(clock, window);
+        bool wokeEarly = mode == IdleMode::LIGHT_SLEEP && pass % 100 == 55;
+        uint32_t waited = wokeEarly ? window / 2 : window;
+        power.account(clock - start, mode, waited, wokeEarly);
+        clock += waited;
+        active += 3000;
+        (mode == IdleMode::LIGHT_SLEEP ? asleep : awake) += waited;
+    }
+
+    float duty = (float)active / (active + awake + asleep);
+    float milliamps = (active * 40.0f + awake * 20.0f + asleep * 0.8f) / (active + awake + asleep) + 150;
+    printf("[ power    ] 3 ms per 100 ms pass: duty cycle %.2f%%, %.2f mA plus %.0f mA heater, %lu sleeps, "
+           "%lu woken early\n",
+           power.getDutyCycle() * 100, power.getAverageMilliamps() - power.getAlwaysOnMilliamps(),
+           power.getAlwaysOnMilliamps(), (unsigned long)power.getSleepCount(),
+           (unsigned long)power.getEarlyWakeCount());
+    EXPECT_NEAR(power.getDutyCycle(), duty, 1e-5);
+    EXPECT_NEAR(power.getAverageMilliamps(), milliamps, 1e-3);
+    EXPECT_EQ(power.getSleepMicros(), asleep);
+    EXPECT_EQ(power.getSleepCount(), 900u);
+    EXPECT_EQ(power.getEarlyWakeCount(), 10u);
+    EXPECT_EQ(power.getHeldCount(), 100u);
+}
+
+void driveGas(VirtualBoard &board, float ppm)
+{
+    board.setAnalog(GAS_ANALOG_PIN, (uint16_t)(mq2_ppm_to_voltage(ppm) / MQ2_VCC * 4095 + 0.5f));
+}
+
+void raiseD0(void *context)
+{
+    static_cast<VirtualBoard *>(context)->drive(GAS_DIGITAL_PIN, HIGH);
+}
+
+void dropD0(void *context)
+{
+    static_cast<VirtualBoard *>(context)->drive(GAS_DIGITAL_PIN, LOW);
+}
+
+TEST(PowerManager, DetectorSleepsBetweenPassesAndWakesOnD0)
+{
+    runIsolated([]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        board.addI2cDevice(LCD_ADDRESS);
+        board.drive(GAS_DIGITAL_PIN, LOW);
+        driveGas(board, 0);
+        GLPSecureSenseDevice *device = new GLPSecureSenseDevice();
+        device->initialize();
+        driveGas(board, 100);
+        const PowerManager &power = device->getPowerManager();
+
+        // A false trip on D0 every 20 s, at varying points of the pass
+        const uint32_t trips = 30;
+        uint64_t start = board.now();
+        uint64_t edges[trips];
+        for (uint32_t i = 0; i < trips; i++)
+        {
+            edges[i] = start + (i + 1) * 20000000ULL - (i * 7919) % 100000;
+            board.at(edges[i], raiseD0, &board);
+            board.at(edges[i] + 50000, dropD0, &board);
+        }
+
+        uint64_t sleptOnClock = 0;
+        uint32_t passes = 0;
+        uint32_t wokeByEdge = 0;
+        uint64_t worstWake = 0;
+        while (board.now() < start + 600ULL * 1000000)
+        {
+            device->run();
+            passes++;
+            uint32_t sleeps = power.getSleepCount();
+            uint32_t earlyWakes = power.getEarlyWakeCount();
+            uint64_t before = board.now();
+            device->idle();
+            if (power.getSleepCount() != sleeps)
+            {
+                sleptOnClock += board.now() - before;
+            }
+            if (power.getEarlyWakeCount() != earlyWakes)
+            {
+                // Which edge ended this sleep, and how long after it
+                for (uint64_t edge : edges)
+                {
+                    if (edge > before && edge <= board.now())
+                    {
+                        wokeByEdge++;
+                        worstWake = std::max(worstWake, board.now() - edge);
+                    }
+                }
+            }
+        }
+        uint64_t elapsed = board.now() - start;
+
+        printf("[ power    ] detector, 10 min of clean air: %lu passes, duty cycle %.2f%%, %.1f s asleep in %lu "
+               "sleeps, %lu held awake, %.2f mA plus %.0f mA heater; %lu of %lu D0 edges ended a sleep, within %lu us\n",
+               (unsigned long)passes, power.getDutyCycle() * 100, power.getSleepMicros() / 1e6,
+               (unsigned long)power.getSleepCount(), (unsigned long)power.getHeldCount(),
+               power.getAverageMilliamps() - power.getAlwaysOnMilliamps(), power.getAlwaysOnMilliamps(),
+               (unsigned long)power.getEarlyWakeCount(), (unsigned long)trips, (unsigned long)worstWake);
+
+        // The sleep reported is the clock's; the 100 ms sense period still holds
+        EXPECT_EQ(power.getSleepMicros(), sleptOnClock);
+        EXPECT_LE(power.getSleepMicros(), elapsed);
+        EXPECT_GT(power.getSleepMicros(), elapsed / 2);
+        EXPECT_GE(passes, 6000u);
+        EXPECT_LT(power.getDutyCycle(), 0.2f);
+        EXPECT_LT(power.getAverageMilliamps() - power.getAlwaysOnMilliamps(), 20.0f);
+
+        // Edges landing in a sleep end it, within the 1 ms wait step; the rest land in passes or
+        // in windows held awake
+        EXPECT_GT(power.getEarlyWakeCount(), trips / 2);
+        EXPECT_EQ(wokeByEdge, power.getEarlyWakeCount());
+        EXPECT_LE(worstWake, 1000u);
+        delete device;
+    });
+}
+
+} // namespace
@@ -0,0 +1,134 @@
+/**
+ * @file QuantileSketchTest.cpp
+ * @brief QuantileSketch estimates against exact nearest-rank quantiles, merging and edge values.
+ */
+
+#include "QuantileSketch.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const float MAX_ERROR = (QuantileSketch::GAMMA - 1) / (QuantileSketch::GAMMA + 1);
+const float QUANTILES[] = {0.0f, 0.01f, 0.1f, 0.25f, 0.5f, 0.75f, 0.9f, 0.99f, 0.999f, 1.0f};
+
+/**
+ * @brief The nearest-rank quantile the sketch estimates.
+ */
+float exactQuantile(const std::vector<float> &sorted, float q)
+{
+    return sorted[(size_t)(q * (sorted.size() - 1))];
+}
+
+void expectWithinBound(const std::vector<float> &values, const QuantileSketch &sketch)
+{
+    std::vector<float> sorted(values);
+    std::sort(sorted.begin(), sorted.end());
+    for (float q : QUANTILES)
+    {
+        float exact = exactQuantile(sorted, q);
+        float estimate = sketch.quantile(q);
+        EXPECT_LE(fabsf(estimate - exact), MAX_ERROR * exact * 1.0001f) << "q " << q << ", exact " << exact;
+    }
+}
+
+TEST(QuantileSketch, EstimatesStayWithinTwoPercent)
+{
+    EXPECT_NEAR(MAX_ERROR, 0.02f, 0.0005f);
+
+    // Log-uniform from 1 to 60000, then PPM-like readings with a long leak tail
+    std::mt19937 random(47);
+    std::uniform_real_distribution<float> exponent(0.0f, log10f(60000.0f));
+    std::vector<float> spread;
+    QuantileSketch spreadSketch;
+    for (int i = 0; i < 100000; i++)
+    {
+        float value = powf(10.0f, exponent(random));
+        spread.push_back(value);
+        spreadSketch.add(value);
+    }
+    expectWithinBound(spread, spreadSketch);
+
+    std::normal_distribution<float> clean(120.0f, 15.0f);
+    std::exponential_distribution<float> leak(1.0f / 900.0f);
+    std::vector<float> readings;
+    QuantileSketch readingSketch;
+    for (int i = 0; i < 50000; i++)
+    {
+        float value = i % 50 == 0 ? 300.0f + leak(random) : std::max(1.0f, clean(random));
+        readings.push_back(value);
+        readingSketch.add(value);
+    }
+    expectWithinBound(readings, readingSketch);
+    EXPECT_EQ(readingSketch.getCount(), 50000u);
+}
+
+TEST(QuantileSketch, EveryBucketReportsWithinTheBound)
+{
+    // Both edges of every bucket
+    for (int key = 1; key < QuantileSketch::BUCKETS - 1; key++)
+    {
+        float upper = QuantileSketch::MIN_VALUE * powf(QuantileSketch::GAMMA, (float)key);
+        float lower = upper / QuantileSketch::GAMMA;
+        for (float value : {lower * 1.0001f, upper * 0.9999f})
+        {
+            QuantileSketch sketch;
+            sketch.add(value);
+            EXPECT_LE(fabsf(sketch.quantile(0.5f) - value), MAX_ERROR * value * 1.001f) << value;
+        }
+    }
+}
+
+TEST(QuantileSketch, MergeEqualsAddingEverySample)
+{
+    std::mt19937 random(470);
+    std::uniform_real_distribution<float> value(1.0f, 5000.0f);
+    QuantileSketch first;
+    QuantileSketch second;
+    QuantileSketch both;
+    for (int i = 0; i < 20000; i++)
+    {
+        float sample = value(random) * (i < 10000 ? 1.0f : 3.0f);
+        (i < 10000 ? first : second).add(sample);
+        both.add(sample);
+    }
+    first.merge(second);
+    EXPECT_EQ(first.getCount(), both.getCount());
+    for (float q : QUANTILES)
+    {
+        EXPECT_FLOAT_EQ(first.quantile(q), both.quantile(q)) << q;
+    }
+}
+
+TEST(QuantileSketch, ZeroBucketAndRange)
+{
+    QuantileSketch sketch;
+    EXPECT_EQ(sketch.quantile(0.5f), 0.0f);
+
+    // At or below MIN_VALUE, negative and NaN all count as zero
+    for (float value : {0.0f, -3.0f, QuantileSketch::MIN_VALUE, NAN})
+    {
+        EXPECT_EQ(QuantileSketch::keyOf(value), -1) << value;
+        sketch.add(value);
+    }
+    EXPECT_EQ(sketch.quantile(1.0f), 0.0f);
+
+    // The last bucket ends near 78000; values past it are clamped into it
+    const int last = QuantileSketch::BUCKETS - 1;
+    EXPECT_EQ(QuantileSketch::keyOf(77000.0f), last);
+    EXPECT_EQ(QuantileSketch::keyOf(1e9f), last);
+    sketch.add(1e9f);
+    EXPECT_NEAR(sketch.quantile(1.0f), 76400.0f, 100.0f);
+    EXPECT_EQ(sketch.quantile(0.0f), 0.0f);
+    EXPECT_EQ(sketch.getCount(), 5u);
+
+    sketch.reset();
+    EXPECT_EQ(sketch.getCount(), 0u);
+    EXPECT_EQ(sketch.quantile(0.99f), 0.0f);
+}
+
+} // namespace
@@ -0,0 +1,179 @@
+/**
+ * @file ReadModelTest.cpp
+ * @brief The FaucetStatus and GasSnapshot read models follow what the devices do.
+ *
+ * Each device runs its sketch loop on the virtual board through a short scenario; getStatus()
+ * is read between passes, as another task would, and must match the device at every step.
+ */
+
+#include "CiaSteelFaucet.h"
+#include "GLPSecureSenseDevice.h"
+#include "SloHarness.h"
+#include "mq2_stimulus.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+namespace
+{
+
+const uint32_t FAUCET_LOOP_MS = 50;
+const float BACKGROUND_CM = 80.0f;
+const int GAS_ANALOG_PIN = 4;
+const int GAS_DIGITAL_PIN = 23;
+const uint8_t LCD_ADDRESS = 0x27;
+
+void runFaucetFor(CiaSteelFaucet &faucet, uint64_t micros)
+{
+    uint64_t end = VirtualBoard::current().now() + micros;
+    while (VirtualBoard::current().now() < end)
+    {
+        faucet.update();
+        delay(FAUCET_LOOP_MS);
+    }
+}
+
+TEST(ReadModel, FaucetStatusFollowsHandsTimerAndCommands)
+{
+    runIsolated([]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        board.setEchoDistance(CiaSteelFaucet::ULTRASOUND_ECHO_PIN, BACKGROUND_CM);
+        CiaSteelFaucet faucet;
+        faucet.initialize();
+        runFaucetFor(faucet, 1000000);
+
+        FaucetStatus idle = faucet.getStatus();
+        EXPECT_NEAR(idle.distance, BACKGROUND_CM, 1.0f);
+        EXPECT_FALSE(idle.inRange);
+        EXPECT_FALSE(idle.valveOpen);
+        EXPECT_EQ(idle.activations, 0u);
+        EXPECT_EQ(idle.lastActivationMillis, 0u);
+
+        // A hand for one second: detected, valve on its timer
+        unsigned long handMillis = millis();
+        board.setEchoDistance(CiaSteelFaucet::ULTRASOUND_ECHO_PIN, 5.0f);
+        runFaucetFor(faucet, 1000000);
+        FaucetStatus washing = faucet.getStatus();
+        EXPECT_NEAR(washing.distance, 5.0f, 1.0f);
+        EXPECT_TRUE(washing.inRange);
+        EXPECT_TRUE(washing.valveOpen);
+        EXPECT_TRUE(washing.valveTimed);
+        EXPECT_TRUE(washing.ledOn);
+        EXPECT_EQ(washing.activations, 1u);
+        EXPECT_GE(washing.lastActivationMillis, handMillis);
+        EXPECT_LE(washing.lastActivationMillis, handMillis + 200);
+
+        // Gone: out of range at once, the valve still open until its timer runs out
+        board.setEchoDistance(CiaSteelFaucet::ULTRASOUND_ECHO_PIN, BACKGROUND_CM);
+        runFaucetFor(faucet, 1000000);
+        FaucetStatus rinsing = faucet.getStatus();
+        EXPECT_FALSE(rinsing.inRange);
+        EXPECT_TRUE(rinsing.valveOpen);
+        EXPECT_EQ(rinsing.lastActivationMillis, washing.lastActivationMillis);
+
+        const uint64_t valveOpenMicros = CiaSteelFaucet::VALVE_OPEN_DURATION_MS * 1000;
+        runFaucetFor(faucet, valveOpenMicros);
+        FaucetStatus closed = faucet.getStatus();
+        EXPECT_FALSE(closed.valveOpen);
+        EXPECT_FALSE(closed.valveTimed);
+        EXPECT_EQ(closed.activations, 1u);
+        EXPECT_EQ(closed.valveOpen, faucet.getWaterValve().getState());
+
+        // Commands are counted and their effect shows on the next pass
+        uint32_t commands = closed.commands;
+        faucet.handle(RelayModule::OPEN_VALVE_COMMAND);
+        faucet.handle(Led::TURN_OFF_COMMAND);
+        runFaucetFor(faucet, 100000);
+        FaucetStatus opened = faucet.getStatus();
+        EXPECT_TRUE(opened.valveOpen);
+        EXPECT_FALSE(opened.valveTimed);
+        EXPECT_FALSE(opened.ledOn);
+        EXPECT_EQ(opened.commands, commands + 2);
+        EXPECT_EQ(opened.ledOn, faucet.getStatusLed().getState());
+    });
+}
+
+void driveGas(VirtualBoard &board, float ppm)
+{
+    board.setAnalog(GAS_ANALOG_PIN, (uint16_t)(mq2_ppm_to_voltage(ppm) / MQ2_VCC * 4095 + 0.5f));
+}
+
+void runDetectorFor(GLPSecureSenseDevice &device, uint64_t micros)
+{
+    uint64_t end = VirtualBoard::current().now() + micros;
+    while (VirtualBoard::current().now() < end)
+    {
+        device.run();
+        device.idle();
+    }
+}
+
+TEST(ReadModel, GasSnapshotTracksAlarmsAndTheirPeak)
+{
+    runIsolated([]() {
+        VirtualBoard board;
+        VirtualBoard::Scope scope(board);
+        board.addI2cDevice(LCD_ADDRESS);
+        board.drive(GAS_DIGITAL_PIN, LOW);
+        driveGas(board, 0);
+        GLPSecureSenseDevice *device = new GLPSecureSenseDevice();
+        device->initialize();
+
+        driveGas(board, 100);
+        runDetectorFor(*device, 30000000);
+        GasSnapshot clean = device->getStatus();
+        EXPECT_EQ(clean.reading.level, GasLevel::SAFE);
+        EXPECT_NEAR(clean.reading.ppm, 100, 15);
+        EXPECT_FALSE(clean.alarmActive);
+        EXPECT_EQ(clean.criticalAlarms, 0u);
+        EXPECT_EQ(clean.lastAlarmMillis, 0u);
+
+        // A leak well past critical, peaking at 1200 PPM
+        unsigned long leakMillis = millis();
+        driveGas(board, 800);
+        runDetectorFor(*device, 20000000);
+        driveGas(board, 1200);
+        runDetectorFor(*device, 5000000);
+        driveGas(board, 800);
+        runDetectorFor(*device, 5000000);
+        GasSnapshot leak = device->getStatus();
+        EXPECT_EQ(leak.reading.level, GasLevel::CRITICAL);
+        EXPECT_TRUE(leak.alarmActive);
+        EXPECT_EQ(leak.criticalAlarms, 1u);
+        EXPECT_GE(leak.lastAlarmMillis, leakMillis);
+        EXPECT_NEAR(leak.lastAlarmPeakPpm, 1200, 120);
+        EXPECT_GE(leak.lastAlarmPeakPpm, leak.reading.ppm);
+
+        // Aired out: the alarm ends, its start and peak stay for the record
+        driveGas(board, 100);
+        runDetectorFor(*device, 60000000);
+        GasSnapshot aired = device->getStatus();
+        EXPECT_EQ(aired.reading.level, GasLevel::SAFE);
+        EXPECT_FALSE(aired.alarmActive);
+        EXPECT_EQ(aired.criticalAlarms, 1u);
+        EXPECT_EQ(aired.lastAlarmMillis, leak.lastAlarmMillis);
+        EXPECT_FLOAT_EQ(aired.lastAlarmPeakPpm, leak.lastAlarmPeakPpm);
+
+        // A D0 trip in clean air: the next pass's conversion judges it at once, so the snapshot
+        // never shows it latched nor counts it as an alarm
+        board.advance(1000);
+        board.drive(GAS_DIGITAL_PIN, HIGH);
+        device->run();
+        GasSnapshot tripped = device->getStatus();
+        EXPECT_FALSE(tripped.latched);
+        EXPECT_FALSE(tripped.alarmActive);
+        EXPECT_EQ(tripped.criticalAlarms, 1u);
+        EXPECT_EQ(tripped.lastAlarmMillis, aired.lastAlarmMillis);
+        EXPECT_GT(tripped.reading.timestamp, aired.reading.timestamp);
+
+        board.drive(GAS_DIGITAL_PIN, LOW);
+        runDetectorFor(*device, 10000000);
+        GasSnapshot cleared = device->getStatus();
+        EXPECT_FALSE(cleared.latched);
+        EXPECT_FALSE(cleared.alarmActive);
+        EXPECT_EQ(cleared.criticalAlarms, 1u);
+        delete device;
+    });
+}
+
+} // namespace
@@ -0,0 +1,227 @@
+/**
+ * @file RollupSeriesTest.cpp
+ * @brief Minute to hour to day cascade, empty windows, the millis() wrap and the fixed footprint.
+ */
+
+#include "AllocationCounter.h"
+#include "RollupSeries.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+const float MAX_ERROR = (QuantileSketch::GAMMA - 1) / (QuantileSketch::GAMMA + 1);
+const uint8_t MINUTES_KEPT = RollupSeries::MINUTES_KEPT;
+const uint8_t HOURS_KEPT = RollupSeries::HOURS_KEPT;
+const uint8_t DAYS_KEPT = RollupSeries::DAYS_KEPT;
+
+void expectNearRelative(float estimate, float exact)
+{
+    EXPECT_LE(fabsf(estimate - exact), MAX_ERROR * exact * 1.0001f) << "exact " << exact;
+}
+
+TEST(RollupSeries, MinutesCascadeIntoTheHourAndHoursIntoTheDay)
+{
+    // Day 0: every minute of hour h holds the values h * 60 + m + 1, one a second
+    RollupSeries series("test");
+    std::vector<float> hourValues[24];
+    for (uint32_t second = 0; second < 86400; second++)
+    {
+        float value = (float)(second / 60 + 1);
+        series.add(second, value);
+        hourValues[second / 3600].push_back(value);
+    }
+    series.advance(86400);
+
+    // The minute ring keeps the last hour, each window exact
+    ASSERT_EQ(series.getClosedCount(RollupResolution::MINUTE), MINUTES_KEPT);
+    RollupSummary minute;
+    ASSERT_TRUE(series.closed(RollupResolution::MINUTE, 0, minute));
+    EXPECT_EQ(minute.start, 86400u - 60);
+    EXPECT_EQ(minute.count, 60u);
+    EXPECT_FLOAT_EQ(minute.min, 1440.0f);
+    EXPECT_FLOAT_EQ(minute.max, 1440.0f);
+    EXPECT_FLOAT_EQ(minute.mean, 1440.0f);
+    expectNearRelative(minute.p99, 1440.0f);
+
+    // Each hour is its 60 minutes merged
+    ASSERT_EQ(series.getClosedCount(RollupResolution::HOUR), HOURS_KEPT);
+    for (uint8_t ago = 0; ago < HOURS_KEPT; ago++)
+    {
+        uint32_t hour = 23 - ago;
+        std::vector<float> &values = hourValues[hour];
+        RollupSummary summary;
+        ASSERT_TRUE(series.closed(RollupResolution::HOUR, ago, summary));
+        EXPECT_EQ(summary.start, hour * 3600);
+        EXPECT_EQ(summary.count, 3600u);
+        EXPECT_FLOAT_EQ(summary.min, values.front());
+        EXPECT_FLOAT_EQ(summary.max, values.back());
+        EXPECT_NEAR(summary.mean, hour * 60 + 30.5f, 1e-3f);
+        expectNearRelative(summary.p50, values[(size_t)(0.5f * (values.size() - 1))]);
+        expectNearRelative(summary.p90, values[(size_t)(0.9f * (values.size() - 1))]);
+        expectNearRelative(summary.p99, values[(size_t)(0.99f * (values.size() - 1))]);
+    }
+
+    // The day is every hour merged
+    ASSERT_EQ(series.getClosedCount(RollupResolution::DAY), 1);
+    RollupSummary day;
+    ASSERT_TRUE(series.closed(RollupResolution::DAY, 0, day));
+    EXPECT_EQ(day.start, 0u);
+    EXPECT_EQ(day.count, 86400u);
+    EXPECT_FLOAT_EQ(day.min, 1.0f);
+    EXPECT_FLOAT_EQ(day.max, 1440.0f);
+    EXPECT_NEAR(day.mean, 720.5f, 1e-3f);
+    expectNearRelative(day.p50, 720.0f);
+    expectNearRelative(day.p99, 1426.0f);
+}
+
+TEST(RollupSeries, CurrentWindowsIncludeTheOpenFinerOnes)
+{
+    RollupSeries series("test");
+    RollupSummary summary;
+    EXPECT_FALSE(series.current(RollupResolution::HOUR, summary));
+
+    // 90 s into an hour: one closed minute and half of the next, not yet in the hour's own totals
+    for (uint32_t second = 7200; second < 7290; second++)
+    {
+        series.add(second, second < 7260 ? 10.0f : 30.0f);
+    }
+    ASSERT_TRUE(series.current(RollupResolution::MINUTE, summary));
+    EXPECT_EQ(summary.start, 7260u);
+    EXPECT_EQ(summary.count, 30u);
+    EXPECT_FLOAT_EQ(summary.mean, 30.0f);
+
+    ASSERT_TRUE(series.current(RollupResolution::HOUR, summary));
+    EXPECT_EQ(summary.start, 7200u);
+    EXPECT_EQ(summary.count, 90u);
+    EXPECT_FLOAT_EQ(summary.min, 10.0f);
+    EXPECT_FLOAT_EQ(summary.max, 30.0f);
+    EXPECT_NEAR(summary.mean, (60 * 10.0f + 30 * 30.0f) / 90, 1e-4f);
+
+    ASSERT_TRUE(series.current(RollupResolution::DAY, summary));
+    EXPECT_EQ(summary.start, 0u);
+    EXPECT_EQ(summary.count, 90u);
+}
+
+TEST(RollupSeries, QuietPeriodsCloseAsEmptyWindows)
+{
+    RollupSeries series("test");
+    series.add(30, 5.0f);
+    series.add(330, 7.0f); // Minutes 1 to 4 had no sample
+
+    ASSERT_EQ(series.getClosedCount(RollupResolution::MINUTE), 5);
+    std::vector<RollupSummary> minutes;
+    size_t visited = series.forEach(
+        RollupResolution::MINUTE,
+        [](RollupResolution, const RollupSummary &summary, void *context) {
+            static_cast<std::vector<RollupSummary> *>(context)->push_back(summary);
+        },
+        &minutes);
+    ASSERT_EQ(visited, 5u);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(minutes[i].start, i * 60) << i;
+        EXPECT_EQ(minutes[i].count, i == 0 ? 1u : 0u) << i;
+    }
+    EXPECT_FLOAT_EQ(minutes[0].mean, 5.0f);
+    EXPECT_FLOAT_EQ(minutes[1].max, 0.0f);
+
+    // A gap longer than a ring keeps one ring's worth of empty windows
+    series.advance(330 + 3 * 3600);
+    EXPECT_EQ(series.getClosedCount(RollupResolution::MINUTE), MINUTES_KEPT);
+    EXPECT_EQ(series.getClosedCount(RollupResolution::HOUR), 3);
+    RollupSummary hour;
+    ASSERT_TRUE(series.closed(RollupResolution::HOUR, 2, hour));
+    EXPECT_EQ(hour.start, 0u);
+    EXPECT_EQ(hour.count, 2u);
+    EXPECT_FLOAT_EQ(hour.max, 7.0f);
+}
+
+TEST(RollupClock, KeepsCountingAcrossTheMillisWrap)
+{
+    // Starts 10 s before millis() wraps and runs a minute past it, in 250 ms steps
+    const uint32_t start = 0xFFFFFFFFUL - 10000;
+    RollupClock clock;
+    EXPECT_EQ(clock.seconds(start), start / 1000);
+
+    uint32_t last = start / 1000;
+    uint64_t elapsed = start;
+    for (int step = 1; step <= 280; step++)
+    {
+        uint32_t nowMillis = start + (uint32_t)step * 250;
+        elapsed += 250;
+        uint32_t seconds = clock.seconds(nowMillis);
+        EXPECT_EQ(seconds, (uint32_t)(elapsed / 1000)) << step;
+        EXPECT_GE(seconds, last) << step;
+        last = seconds;
+    }
+    EXPECT_GT(last, 0xFFFFFFFFUL / 1000);
+
+    // A time that runs backwards keeps the last value
+    EXPECT_EQ(clock.seconds(start + 280 * 250 - 5000), last);
+    EXPECT_EQ(clock.seconds(start + 281 * 250), (uint32_t)((elapsed + 250) / 1000));
+}
+
+TEST(RollupClock, SeriesWindowsAdvancePastTheWrap)
+{
+    // A sample every second from 5 minutes before the wrap to 5 minutes after it
+    RollupClock clock;
+    RollupSeries series("test");
+    const uint32_t start = 0xFFFFFFFFUL - 300000;
+    for (uint32_t i = 0; i <= 600; i++)
+    {
+        series.add(clock.seconds(start + i * 1000), 1.0f);
+    }
+
+    // Minutes close in order and stay 60 s apart through the wrap
+    uint8_t closedMinutes = series.getClosedCount(RollupResolution::MINUTE);
+    ASSERT_GE(closedMinutes, 9);
+    uint32_t total = 0;
+    RollupSummary previous;
+    ASSERT_TRUE(series.closed(RollupResolution::MINUTE, closedMinutes - 1, previous));
+    total += previous.count;
+    for (int ago = closedMinutes - 2; ago >= 0; ago--)
+    {
+        RollupSummary summary;
+        ASSERT_TRUE(series.closed(RollupResolution::MINUTE, (uint8_t)ago, summary));
+        EXPECT_EQ(summary.start, previous.start + 60) << ago;
+        EXPECT_GT(summary.count, 0u) << ago;
+        total += summary.count;
+        previous = summary;
+    }
+    RollupSummary open;
+    ASSERT_TRUE(series.current(RollupResolution::MINUTE, open));
+    EXPECT_EQ(total + open.count, 601u);
+}
+
+TEST(RollupSeries, FootprintIsFixedWhateverTheUptime)
+{
+    // The rings and three open sketches, near the 7.3 KB quoted per series
+    const size_t rings = (MINUTES_KEPT + HOURS_KEPT + DAYS_KEPT) *
+                         sizeof(RollupSummary);
+    const size_t sketches = RollupSeries::LEVELS * sizeof(QuantileSketch);
+    EXPECT_GE(sizeof(RollupSeries), rings + sketches);
+    EXPECT_LE(sizeof(RollupSeries), rings + sketches + 256);
+    EXPECT_LE(sizeof(RollupSeries), 7600u);
+
+    // 90 days at one sample every 10 s, day 89 still open: no allocation, rings full and no further
+    RollupSeries series("test");
+    AllocationScope allocations;
+    for (uint32_t second = 0; second < 90 * 86400; second += 10)
+    {
+        series.add(second, (float)(second % 977));
+    }
+    EXPECT_EQ(allocations.count(), 0u);
+    EXPECT_EQ(series.getClosedCount(RollupResolution::MINUTE), MINUTES_KEPT);
+    EXPECT_EQ(series.getClosedCount(RollupResolution::HOUR), HOURS_KEPT);
+    EXPECT_EQ(series.getClosedCount(RollupResolution::DAY), DAYS_KEPT);
+    RollupSummary oldest;
+    ASSERT_TRUE(series.closed(RollupResolution::DAY, DAYS_KEPT - 1, oldest));
+    EXPECT_EQ(oldest.start, (89u - DAYS_KEPT) * 86400);
+    EXPECT_EQ(oldest.count, 8640u);
+}
+
+} // namespace
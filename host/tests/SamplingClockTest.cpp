@@ -0,0 +1,192 @@
+/**
+ * @file SamplingClockTest.cpp
+ * @brief Loop-driven against timer-driven sampling on a virtual clock, under a varying loop load.
+ *
+ * The same 60 ms proximity clock is driven two ways through poll(uint64_t). Loop-driven, the
+ * loop polls it once per pass, and a pass takes what the faucet's used to: a 50 ms delay, an
+ * echo of up to 30 ms and the odd console burst. Timer-driven, a virtual timer action polls it
+ * at every slot plus a few tens of microseconds of interrupt-to-task latency, while the same loop
+ * load runs and only takes samples. The spread of the intervals between acquisitions, and their
+ * lateness after the slot, are compared.
+ */
+
+#include "SamplingClock.h"
+#include "VirtualBoard.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const uint32_t PERIOD_US = 60000;
+const uint32_t JITTER_BUDGET_US = 1000;
+const uint32_t MAX_TASK_WAKE_US = 40; ///< Timer interrupt to sampling task.
+const int PASSES = 3000;
+
+/**
+ * @brief The sensor side: stamps when each acquisition started.
+ */
+struct Probe
+{
+    VirtualBoard *board;
+    std::vector<uint64_t> startedMicros;
+};
+
+float acquireDistance(void *context)
+{
+    Probe *probe = static_cast<Probe *>(context);
+    probe->startedMicros.push_back(probe->board->now());
+    return 42.0f;
+}
+
+/**
+ * @brief One loop pass of the faucet before the clock: delay(50), a pulseIn() of up to 30 ms
+ * and, one pass in ten, 10 to 40 ms of console output.
+ */
+uint64_t passMicros(std::mt19937 &random)
+{
+    std::uniform_int_distribution<uint32_t> echo(500, 30000);
+    std::uniform_int_distribution<uint32_t> console(10000, 40000);
+    uint64_t micros = 50000 + echo(random);
+    if (random() % 10 == 0)
+    {
+        micros += console(random);
+    }
+    return micros;
+}
+
+struct Timer
+{
+    VirtualBoard *board;
+    SamplingClock *clock;
+    std::mt19937 wake;
+    uint64_t nextSlot;
+};
+
+void onTick(void *context)
+{
+    Timer *timer = static_cast<Timer *>(context);
+    timer->clock->poll(timer->board->now());
+    timer->nextSlot += PERIOD_US;
+    std::uniform_int_distribution<uint32_t> latency(5, MAX_TASK_WAKE_US);
+    timer->board->at(timer->nextSlot + latency(timer->wake), onTick, timer);
+}
+
+struct Spread
+{
+    double meanMicros;
+    double deviationMicros;
+    uint64_t minMicros;
+    uint64_t maxMicros;
+};
+
+Spread intervalsOf(const std::vector<uint64_t> &times)
+{
+    Spread spread = {0, 0, UINT64_MAX, 0};
+    size_t count = times.size() - 1;
+    for (size_t i = 1; i < times.size(); i++)
+    {
+        uint64_t interval = times[i] - times[i - 1];
+        spread.meanMicros += interval;
+        spread.minMicros = std::min(spread.minMicros, interval);
+        spread.maxMicros = std::max(spread.maxMicros, interval);
+    }
+    spread.meanMicros /= count;
+    for (size_t i = 1; i < times.size(); i++)
+    {
+        double deviation = (times[i] - times[i - 1]) - spread.meanMicros;
+        spread.deviationMicros += deviation * deviation;
+    }
+    spread.deviationMicros = std::sqrt(spread.deviationMicros / count);
+    return spread;
+}
+
+/**
+ * @brief Takes every queued sample; slots must be whole periods after the first.
+ */
+uint32_t drain(SamplingClock &clock, uint64_t firstSlot, uint32_t &offSlot)
+{
+    uint32_t taken = 0;
+    TimedSample sample;
+    while (clock.take(sample))
+    {
+        offSlot += (sample.scheduledMicros - firstSlot) % PERIOD_US != 0 ? 1 : 0;
+        taken++;
+    }
+    return taken;
+}
+
+void report(const char *mode, const Spread &spread, const SamplingClock &clock)
+{
+    printf("[ jitter   ] %s: interval %.1f ms mean, %.2f ms deviation, %.3f to %.3f ms; lateness p50 %lu us, "
+           "p99 %lu us; %lu slots skipped\n",
+           mode, spread.meanMicros / 1000, spread.deviationMicros / 1000, spread.minMicros / 1000.0,
+           spread.maxMicros / 1000.0, (unsigned long)clock.getJitter().percentile(500),
+           (unsigned long)clock.getJitter().percentile(990), (unsigned long)clock.getSkippedTicks());
+}
+
+TEST(SamplingClock, TimerDrivenIntervalsStayEvenUnderLoopLoad)
+{
+    // Loop-driven: polled at the start of every pass
+    VirtualBoard loopBoard;
+    Probe loopProbe = {&loopBoard, {}};
+    SamplingClock loopDriven("loop jitter", acquireDistance, &loopProbe, PERIOD_US, JITTER_BUDGET_US);
+    std::mt19937 loopLoad(45);
+    uint64_t loopFirst = loopBoard.now();
+    uint32_t loopTaken = 0;
+    uint32_t loopOffSlot = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        loopDriven.poll(loopBoard.now());
+        loopTaken += drain(loopDriven, loopFirst, loopOffSlot);
+        loopBoard.advance(passMicros(loopLoad));
+    }
+
+    // Timer-driven: the same load, while a timer polls at every slot
+    VirtualBoard timerBoard;
+    Probe timerProbe = {&timerBoard, {}};
+    SamplingClock timerDriven("timer jitter", acquireDistance, &timerProbe, PERIOD_US, JITTER_BUDGET_US);
+    std::mt19937 timerLoad(45);
+    uint64_t timerFirst = timerBoard.now();
+    Timer timer = {&timerBoard, &timerDriven, std::mt19937(450), timerFirst};
+    onTick(&timer);
+    uint32_t timerTaken = 0;
+    uint32_t timerOffSlot = 0;
+    for (int pass = 0; pass < PASSES; pass++)
+    {
+        timerTaken += drain(timerDriven, timerFirst, timerOffSlot);
+        timerBoard.advance(passMicros(timerLoad));
+    }
+    timerTaken += drain(timerDriven, timerFirst, timerOffSlot);
+
+    Spread loopSpread = intervalsOf(loopProbe.startedMicros);
+    Spread timerSpread = intervalsOf(timerProbe.startedMicros);
+    report("loop-driven ", loopSpread, loopDriven);
+    report("timer-driven", timerSpread, timerDriven);
+
+    // Either way every sample is taken and carries a slot on the period grid
+    EXPECT_EQ(loopTaken, loopProbe.startedMicros.size());
+    EXPECT_EQ(timerTaken, timerProbe.startedMicros.size());
+    EXPECT_EQ(loopOffSlot, 0u);
+    EXPECT_EQ(timerOffSlot, 0u);
+    EXPECT_EQ(loopDriven.getDroppedSamples(), 0u);
+    EXPECT_EQ(timerDriven.getDroppedSamples(), 0u);
+
+    // The timer keeps the period within its wake-up latency, whatever the loop does
+    EXPECT_EQ(timerDriven.getSkippedTicks(), 0u);
+    EXPECT_NEAR(timerSpread.meanMicros, PERIOD_US, 1.0);
+    EXPECT_LE(timerSpread.maxMicros - timerSpread.minMicros, 2 * (uint64_t)MAX_TASK_WAKE_US);
+    EXPECT_TRUE(timerDriven.getJitter().meetsBudget());
+
+    // The loop stretches it to whole passes and loses slots
+    EXPECT_GT(loopDriven.getSkippedTicks(), 0u);
+    EXPECT_GT(loopSpread.deviationMicros, 100 * timerSpread.deviationMicros);
+    EXPECT_GE(loopSpread.maxMicros, 2 * (uint64_t)PERIOD_US);
+    EXPECT_FALSE(loopDriven.getJitter().meetsBudget());
+}
+
+} // namespace
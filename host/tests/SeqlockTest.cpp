@@ -0,0 +1,93 @@
+/**
+ * @file SeqlockTest.cpp
+ * @brief Consistent reads of a Seqlock against a writer on another thread.
+ *
+ * The writer publishes a 64-byte value whose words all carry the same version, nonstop; a
+ * reader on another thread must never see words from two versions, nor a version older than
+ * one it has already read.
+ */
+
+#include "Seqlock.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+
+struct Versioned
+{
+    uint32_t words[16];
+};
+
+Versioned versionOf(uint32_t version)
+{
+    Versioned value;
+    for (uint32_t &word : value.words)
+    {
+        word = version;
+    }
+    return value;
+}
+
+TEST(Seqlock, ReadsAreNeverTornByAConcurrentWriter)
+{
+    const uint32_t reads = 1000000;
+    Seqlock<Versioned> published;
+    std::atomic<bool> reading(true);
+    std::atomic<uint32_t> written(0);
+
+    std::thread writer([&]() {
+        uint32_t version = 0;
+        while (reading.load(std::memory_order_relaxed))
+        {
+            published.write(versionOf(++version));
+        }
+        written.store(version);
+    });
+
+    uint32_t torn = 0;
+    uint32_t wentBack = 0;
+    uint32_t changes = 0;
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < reads; i++)
+    {
+        Versioned value = published.read();
+        for (uint32_t word : value.words)
+        {
+            if (word != value.words[0])
+            {
+                torn++;
+                break;
+            }
+        }
+        wentBack += value.words[0] < last ? 1 : 0;
+        changes += value.words[0] != last ? 1 : 0;
+        last = value.words[0];
+    }
+    reading.store(false);
+    writer.join();
+
+    printf("[ seqlock  ] %lu reads against %lu writes: %lu versions seen, %lu retries, %lu torn\n",
+           (unsigned long)reads, (unsigned long)written.load(), (unsigned long)changes,
+           (unsigned long)published.getRetries(), (unsigned long)torn);
+    EXPECT_EQ(torn, 0u);
+    EXPECT_EQ(wentBack, 0u);
+    EXPECT_GT(changes, 1u);
+    EXPECT_EQ(published.getVersion(), written.load() + 1); // Plus the default value
+}
+
+TEST(Seqlock, VersionCountsWrites)
+{
+    Seqlock<Versioned> published;
+    EXPECT_EQ(published.getVersion(), 1u);
+    EXPECT_EQ(published.read().words[7], 0u);
+    published.write(versionOf(5));
+    published.write(versionOf(6));
+    EXPECT_EQ(published.getVersion(), 3u);
+    EXPECT_EQ(published.read().words[15], 6u);
+    EXPECT_EQ(published.getRetries(), 0u);
+}
+
+} // namespace
@@ -0,0 +1,191 @@
+/**
+ * @file StatusServerTest.cpp
+ * @brief StatusServer and HttpResponse over loopback: routing, pipelining, keep-alive limits,
+ * idle timeouts and double-buffered renders.
+ */
+
+#include "HttpResponse.h"
+#include "LoopbackClient.h"
+#include "StatusServer.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string>
+
+namespace
+{
+
+size_t renderCount(char *body, size_t capacity, void *context)
+{
+    return snprintf(body, capacity, "{\"count\":%u}\n", *static_cast<unsigned *>(context));
+}
+
+TEST(StatusServer, ServesRoutesAndRefusesTheRest)
+{
+    HttpResponse status("200 OK", "application/json", 64);
+    HttpResponse metrics("200 OK", "text/plain", 64);
+    unsigned count = 7;
+    ASSERT_TRUE(status.render(renderCount, &count));
+    ASSERT_TRUE(metrics.render("uptime 1\n"));
+    StatusServer server(0);
+    ASSERT_TRUE(server.addRoute("/status", &status));
+    ASSERT_TRUE(server.addRoute("/metrics", &metrics));
+    ASSERT_TRUE(server.begin());
+    ASSERT_TRUE(server.start(nullptr, nullptr));
+
+    LoopbackClient client;
+    ASSERT_TRUE(client.connect(server.getPort()));
+    HttpReply reply;
+    ASSERT_TRUE(client.get("/status", reply));
+    EXPECT_EQ(reply.status, 200);
+    EXPECT_EQ(reply.body, "{\"count\":7}\n");
+    ASSERT_TRUE(client.get("/metrics?format=text", reply));
+    EXPECT_EQ(reply.status, 200);
+    EXPECT_EQ(reply.body, "uptime 1\n");
+    ASSERT_TRUE(client.get("/statusx", reply));
+    EXPECT_EQ(reply.status, 404);
+
+    // Anything but GET is refused, and the connection closed
+    ASSERT_TRUE(client.send("POST /status HTTP/1.1\r\n\r\n"));
+    ASSERT_TRUE(client.read(reply));
+    EXPECT_EQ(reply.status, 400);
+    EXPECT_TRUE(client.closedByServer(1000));
+
+    // So is a request that does not fit the receive buffer
+    ASSERT_TRUE(client.connect(server.getPort()));
+    std::string oversized = "GET /status HTTP/1.1\r\nX-Padding: ";
+    oversized.append(StatusServer::REQUEST_BYTES - oversized.size(), 'x');
+    ASSERT_TRUE(client.send(oversized.c_str()));
+    ASSERT_TRUE(client.read(reply));
+    EXPECT_EQ(reply.status, 400);
+    EXPECT_TRUE(client.closedByServer(1000));
+
+    server.stop();
+    EXPECT_EQ(server.getAccepted(), 2u);
+    EXPECT_EQ(server.getServed(), 5u);
+    EXPECT_EQ(server.getFailed(), 0u);
+}
+
+TEST(StatusServer, AnswersPipelinedRequestsInOrder)
+{
+    HttpResponse status("200 OK", "text/plain", 32);
+    ASSERT_TRUE(status.render("ok\n"));
+    StatusServer server(0);
+    server.addRoute("/status", &status);
+    ASSERT_TRUE(server.begin());
+    ASSERT_TRUE(server.start(nullptr, nullptr));
+
+    LoopbackClient client;
+    ASSERT_TRUE(client.connect(server.getPort()));
+    ASSERT_TRUE(client.send("GET /nope HTTP/1.1\r\n\r\n"
+                            "GET /status HTTP/1.1\r\n\r\n"
+                            "GET /status HTTP/1.1\r\nConnection: close\r\n\r\n"
+                            "GET /status HTTP/1.1\r\n\r\n"));
+    HttpReply reply;
+    ASSERT_TRUE(client.read(reply));
+    EXPECT_EQ(reply.status, 404);
+    ASSERT_TRUE(client.read(reply));
+    EXPECT_EQ(reply.status, 200);
+    ASSERT_TRUE(client.read(reply));
+    EXPECT_EQ(reply.status, 200);
+    EXPECT_EQ(reply.body, "ok\n");
+    // Nothing after the request that asked to close
+    EXPECT_TRUE(client.closedByServer(1000));
+
+    // HTTP/1.0 is answered once, then closed
+    ASSERT_TRUE(client.connect(server.getPort()));
+    ASSERT_TRUE(client.send("GET /status HTTP/1.0\r\n\r\n"));
+    ASSERT_TRUE(client.read(reply));
+    EXPECT_EQ(reply.status, 200);
+    EXPECT_TRUE(client.closedByServer(1000));
+    server.stop();
+}
+
+TEST(StatusServer, ClosesAKeepAliveConnectionAfterMaxRequests)
+{
+    HttpResponse status("200 OK", "text/plain", 32);
+    ASSERT_TRUE(status.render("ok\n"));
+    StatusServer server(0);
+    server.addRoute("/status", &status);
+    ASSERT_TRUE(server.begin());
+    ASSERT_TRUE(server.start(nullptr, nullptr));
+
+    const uint16_t maxRequests = StatusServer::MAX_REQUESTS;
+    LoopbackClient client;
+    ASSERT_TRUE(client.connect(server.getPort()));
+    HttpReply reply;
+    for (uint16_t i = 0; i < maxRequests; i++)
+    {
+        ASSERT_TRUE(client.get("/status", reply)) << i;
+        ASSERT_EQ(reply.status, 200);
+    }
+    // The slot goes to whoever waits in the backlog
+    EXPECT_TRUE(client.closedByServer(1000));
+    server.stop();
+    EXPECT_EQ(server.getAccepted(), 1u);
+    EXPECT_EQ(server.getServed(), (uint32_t)maxRequests);
+}
+
+TEST(StatusServer, ClosesIdleConnections)
+{
+    StatusServer server(0);
+    ASSERT_TRUE(server.begin());
+
+    // Driven by hand, with its own clock
+    LoopbackClient client;
+    ASSERT_TRUE(client.connect(server.getPort()));
+    for (int pass = 0; pass < 50 && server.getOpenConnections() == 0; pass++)
+    {
+        server.service(1000, 10);
+    }
+    ASSERT_EQ(server.getOpenConnections(), 1u);
+
+    const uint32_t idleTimeout = StatusServer::IDLE_TIMEOUT_MS;
+    server.service(1000 + idleTimeout - 1, 0);
+    EXPECT_EQ(server.getOpenConnections(), 1u);
+    server.service(1000 + idleTimeout, 0);
+    EXPECT_EQ(server.getOpenConnections(), 0u);
+    EXPECT_EQ(server.getTimedOut(), 1u);
+    EXPECT_TRUE(client.closedByServer(1000));
+}
+
+TEST(HttpResponse, SlowReaderKeepsTheVersionItStarted)
+{
+    HttpResponse response("200 OK", "application/json", 64);
+    unsigned count = 1;
+    ASSERT_TRUE(response.render(renderCount, &count));
+
+    const char *first;
+    size_t firstLength;
+    uint8_t firstSlot = response.acquire(first, firstLength);
+    std::string firstBytes(first, firstLength);
+
+    // The next version goes into the other buffer
+    count = 2;
+    ASSERT_TRUE(response.render(renderCount, &count));
+    const char *second;
+    size_t secondLength;
+    uint8_t secondSlot = response.acquire(second, secondLength);
+    EXPECT_NE(secondSlot, firstSlot);
+    EXPECT_NE(std::string(second, secondLength).find("{\"count\":2}"), std::string::npos);
+
+    // Both in use: refused, and neither reader sees a change
+    count = 3;
+    EXPECT_FALSE(response.render(renderCount, &count));
+    EXPECT_EQ(response.getRefused(), 1u);
+    EXPECT_EQ(std::string(first, firstLength), firstBytes);
+    EXPECT_NE(firstBytes.find("Content-Length: 12\r\n"), std::string::npos);
+
+    response.release(firstSlot);
+    EXPECT_TRUE(response.render(renderCount, &count));
+    response.release(secondSlot);
+
+    // A body that does not fit changes nothing
+    std::string large(100, 'x');
+    EXPECT_FALSE(response.render(large.c_str()));
+    const char *data;
+    size_t length;
+    response.release(response.acquire(data, length));
+    EXPECT_NE(std::string(data, length).find("{\"count\":3}"), std::string::npos);
+}
+
+} // namespace
@@ -0,0 +1,111 @@
+/**
+ * @file CoreMailbox.cpp
+ * @brief Implements the EventMailbox and CommandMailbox classes.
+ *
+ * Only ids cross the queue; events and commands are rebuilt from them on the consuming core.
+ */
+
+#include "CoreMailbox.h"
+
+EventMailbox::EventMailbox(EventHandler *target)
+    : target(target)
+{
+}
+
+void EventMailbox::on(Event event)
+{
+    pending.push(event.id);
+}
+
+bool EventMailbox::take(Event &event)
+{
+    int id;
+    if (!pending.pop(id))
+    {
+        return false;
+    }
+    event = Event(id);
+    return true;
+}
+
+uint16_t EventMailbox::deliver()
+{
+    uint16_t delivered = 0;
+    Event event(0);
+    // Bounded so events posted while delivering wait for the next call
+    while (delivered < CAPACITY && take(event))
+    {
+        if (target != nullptr)
+        {
+            target->on(event);
+        }
+        delivered++;
+    }
+    return delivered;
+}
+
+void EventMailbox::setTarget(EventHandler *target)
+{
+    this->target = target;
+}
+
+uint32_t EventMailbox::getPending() const
+{
+    return pending.size();
+}
+
+uint32_t EventMailbox::getDropped() const
+{
+    return pending.getDropped();
+}
+
+CommandMailbox::CommandMailbox(CommandHandler *target)
+    : target(target)
+{
+}
+
+void CommandMailbox::handle(Command command)
+{
+    pending.push(command.id);
+}
+
+bool CommandMailbox::take(Command &command)
+{
+    int id;
+    if (!pending.pop(id))
+    {
+        return false;
+    }
+    command = Command(id);
+    return true;
+}
+
+uint16_t CommandMailbox::deliver()
+{
+    uint16_t delivered = 0;
+    Command command(0);
+    while (delivered < CAPACITY && take(command))
+    {
+        if (target != nullptr)
+        {
+            target->handle(command);
+        }
+        delivered++;
+    }
+    return delivered;
+}
+
+void CommandMailbox::setTarget(CommandHandler *target)
+{
+    this->target = target;
+}
+
+uint32_t CommandMailbox::getPending() const
+{
+    return pending.size();
+}
+
+uint32_t CommandMailbox::getDropped() const
+{
+    return pending.getDropped();
+}
@@ -0,0 +1,98 @@
+#ifndef CORE_MAILBOX_H
+#define CORE_MAILBOX_H
+
+/**
+ * @file CoreMailbox.h
+ * @brief Declares the EventMailbox and CommandMailbox classes.
+ *
+ * Mailboxes stand in for a handler that runs on the other core. A component wired to a mailbox
+ * calls on() or handle() as usual; the event or command is queued without locking and reaches
+ * the real handler when the consuming core calls deliver(). Each mailbox is single-producer,
+ * single-consumer: one task posts into it and one task delivers from it.
+ */
+
+#include "EventHandler.h"
+#include "CommandHandler.h"
+#include "SpscQueue.h"
+
+class EventMailbox : public EventHandler
+{
+public:
+    static const uint16_t CAPACITY = 32;
+
+private:
+    SpscQueue<int, CAPACITY> pending; ///< Queued event ids.
+    EventHandler *target;             ///< Handler on the consuming core.
+
+public:
+    /**
+     * @brief Constructs a mailbox for a handler on the consuming core.
+     * @param target Handler that deliver() passes events to (may be nullptr when using take()).
+     */
+    explicit EventMailbox(EventHandler *target = nullptr);
+
+    /**
+     * @brief Queues an event. Producer side only.
+     * @param event The event to queue; dropped and counted when the mailbox is full.
+     */
+    void on(Event event) override;
+
+    /**
+     * @brief Takes the oldest queued event. Consumer side only.
+     * @param event Receives the event.
+     * @return False when the mailbox is empty.
+     */
+    bool take(Event &event);
+
+    /**
+     * @brief Passes every queued event to the target handler. Consumer side only.
+     * @return Number of events delivered.
+     */
+    uint16_t deliver();
+
+    void setTarget(EventHandler *target);
+    uint32_t getPending() const;
+    uint32_t getDropped() const;
+};
+
+class CommandMailbox : public CommandHandler
+{
+public:
+    static const uint16_t CAPACITY = 32;
+
+private:
+    SpscQueue<int, CAPACITY> pending; ///< Queued command ids.
+    CommandHandler *target;           ///< Handler on the consuming core.
+
+public:
+    /**
+     * @brief Constructs a mailbox for a handler on the consuming core.
+     * @param target Handler that deliver() passes commands to (may be nullptr when using take()).
+     */
+    explicit CommandMailbox(CommandHandler *target = nullptr);
+
+    /**
+     * @brief Queues a command. Producer side only.
+     * @param command The command to queue; dropped and counted when the mailbox is full.
+     */
+    void handle(Command command) override;
+
+    /**
+     * @brief Takes the oldest queued command. Consumer side only.
+     * @param command Receives the command.
+     * @return False when the mailbox is empty.
+     */
+    bool take(Command &command);
+
+    /**
+     * @brief Passes every queued command to the target handler. Consumer side only.
+     * @return Number of commands delivered.
+     */
+    uint16_t deliver();
+
+    void setTarget(CommandHandler *target);
+    uint32_t getPending() const;
+    uint32_t getDropped() const;
+};
+
+#endif // CORE_MAILBOX_H
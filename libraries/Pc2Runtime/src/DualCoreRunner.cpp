@@ -0,0 +1,247 @@
+/**
+ * @file DualCoreRunner.cpp
+ * @brief Implements the DualCoreRunner class.
+ *
+ * Both tasks run the same periodic loop: step, then sleep until the next slot. A step that
+ * overruns its whole period restarts the schedule from now instead of running back-to-back
+ * steps to catch up.
+ */
+
+#include "DualCoreRunner.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#else
+#include <chrono>
+#endif
+
+DualCoreRunner::DualCoreRunner(CoreStep realTimeStep, CoreStep ioStep, void *context,
+                               uint32_t realTimePeriodMicros, uint32_t ioPeriodMicros, uint32_t latenessBudgetMicros)
+    : realTimeStep(realTimeStep), ioStep(ioStep), context(context),
+      realTimePeriodMicros(realTimePeriodMicros), ioPeriodMicros(ioPeriodMicros),
+      running(false), realTimeSteps(0), ioSteps(0), worstRealTimeStepMicros(0), worstIoStepMicros(0),
+      realTimeLateness("rt lateness", latenessBudgetMicros)
+#if defined(ARDUINO_ARCH_ESP32)
+      ,
+      realTimeTask(nullptr), ioTask(nullptr), activeTasks(0)
+#else
+      ,
+      wakePending(false)
+#endif
+{
+}
+
+DualCoreRunner::~DualCoreRunner()
+{
+    stop();
+}
+
+bool DualCoreRunner::start()
+{
+    if (running.load() || !isSupported())
+    {
+        return false;
+    }
+    running.store(true);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    activeTasks.store(2);
+    BaseType_t realTimeCreated = xTaskCreatePinnedToCore(realTimeEntry, "rt-core", STACK_BYTES, this,
+                                                         REAL_TIME_PRIORITY, &realTimeTask, REAL_TIME_CORE);
+    if (realTimeCreated != pdPASS)
+    {
+        running.store(false);
+        activeTasks.store(0);
+        return false;
+    }
+    if (xTaskCreatePinnedToCore(ioEntry, "io-core", STACK_BYTES, this, IO_PRIORITY, &ioTask, IO_CORE) != pdPASS)
+    {
+        activeTasks.fetch_sub(1);
+        stop();
+        return false;
+    }
+#else
+    realTimeThread = std::thread(&DualCoreRunner::runLoop, this, true);
+    ioThread = std::thread(&DualCoreRunner::runLoop, this, false);
+#endif
+    return true;
+}
+
+void DualCoreRunner::stop()
+{
+    running.store(false);
+#if defined(ARDUINO_ARCH_ESP32)
+    // Call from another task; each task deletes itself after its current step
+    while (activeTasks.load() > 0)
+    {
+        vTaskDelay(1);
+    }
+    realTimeTask = nullptr;
+    ioTask = nullptr;
+#else
+    if (realTimeThread.joinable())
+    {
+        realTimeThread.join();
+    }
+    if (ioThread.joinable())
+    {
+        ioThread.join();
+    }
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void DualCoreRunner::realTimeEntry(void *parameter)
+{
+    DualCoreRunner *runner = static_cast<DualCoreRunner *>(parameter);
+    runner->runLoop(true);
+    runner->activeTasks.fetch_sub(1);
+    vTaskDelete(nullptr);
+}
+
+void DualCoreRunner::ioEntry(void *parameter)
+{
+    DualCoreRunner *runner = static_cast<DualCoreRunner *>(parameter);
+    runner->runLoop(false);
+    runner->activeTasks.fetch_sub(1);
+    vTaskDelete(nullptr);
+}
+#endif
+
+void DualCoreRunner::runLoop(bool realTime)
+{
+    CoreStep step = realTime ? realTimeStep : ioStep;
+    uint32_t period = realTime ? realTimePeriodMicros : ioPeriodMicros;
+    std::atomic<uint32_t> &steps = realTime ? realTimeSteps : ioSteps;
+    std::atomic<uint32_t> &worst = realTime ? worstRealTimeStepMicros : worstIoStepMicros;
+
+    uint64_t next = nowMicros();
+    bool woken = false;
+    while (running.load())
+    {
+        uint64_t start = nowMicros();
+        // A woken step runs ahead of its slot; the slot still comes
+        if (realTime && !woken)
+        {
+            uint64_t late = start > next ? start - next : 0;
+            realTimeLateness.record(late > LatencyHistogram::MAX_TRACKED ? LatencyHistogram::MAX_TRACKED : (uint32_t)late);
+        }
+
+        step(context);
+
+        uint32_t spent = (uint32_t)(nowMicros() - start);
+        if (spent > worst.load(std::memory_order_relaxed))
+        {
+            worst.store(spent, std::memory_order_relaxed);
+        }
+        steps.fetch_add(1, std::memory_order_relaxed);
+
+        if (!woken)
+        {
+            next += period;
+            uint64_t now = nowMicros();
+            if (next + period < now)
+            {
+                next = now;
+            }
+        }
+        woken = sleepUntil(next, realTime);
+    }
+}
+
+uint64_t DualCoreRunner::nowMicros()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return (uint64_t)esp_timer_get_time();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+bool DualCoreRunner::sleepUntil(uint64_t deadlineMicros, bool realTime)
+{
+    uint64_t now = nowMicros();
+    uint64_t remaining = deadlineMicros > now ? deadlineMicros - now : 0;
+#if defined(ARDUINO_ARCH_ESP32)
+    // Round up so a step never starts before its slot, and always give up at
+    // least one tick so the idle task (and its watchdog) can run
+    const uint64_t tickMicros = portTICK_PERIOD_MS * 1000ULL;
+    TickType_t ticks = (TickType_t)((remaining + tickMicros - 1) / tickMicros);
+    if (!realTime)
+    {
+        vTaskDelay(ticks > 0 ? ticks : 1);
+        return false;
+    }
+    return ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1) > 0;
+#else
+    if (!realTime)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(remaining));
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(wakeLock);
+    wakeSignal.wait_for(lock, std::chrono::microseconds(remaining), [this] { return wakePending; });
+    bool woken = wakePending;
+    wakePending = false;
+    return woken;
+#endif
+}
+
+void DualCoreRunner::wake()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t task = realTimeTask;
+    if (running.load() && task != nullptr)
+    {
+        xTaskNotifyGive(task);
+    }
+#else
+    if (running.load())
+    {
+        std::lock_guard<std::mutex> lock(wakeLock);
+        wakePending = true;
+        wakeSignal.notify_one();
+    }
+#endif
+}
+
+bool DualCoreRunner::isRunning() const
+{
+    return running.load();
+}
+
+bool DualCoreRunner::isSupported()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return portNUM_PROCESSORS > 1;
+#else
+    return true;
+#endif
+}
+
+const LatencyHistogram &DualCoreRunner::getRealTimeLateness() const
+{
+    return realTimeLateness;
+}
+
+uint32_t DualCoreRunner::getRealTimeSteps() const
+{
+    return realTimeSteps.load(std::memory_order_relaxed);
+}
+
+uint32_t DualCoreRunner::getIoSteps() const
+{
+    return ioSteps.load(std::memory_order_relaxed);
+}
+
+uint32_t DualCoreRunner::getWorstRealTimeStepMicros() const
+{
+    return worstRealTimeStepMicros.load(std::memory_order_relaxed);
+}
+
+uint32_t DualCoreRunner::getWorstIoStepMicros() const
+{
+    return worstIoStepMicros.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,140 @@
+#ifndef DUAL_CORE_RUNNER_H
+#define DUAL_CORE_RUNNER_H
+
+/**
+ * @file DualCoreRunner.h
+ * @brief Declares the DualCoreRunner class and the ExecutionCore declaration.
+ *
+ * Optional execution model that replaces the single Arduino loop with two periodic tasks: a
+ * real-time task for sensing and actuation pinned to the APP CPU, and an I/O task for display,
+ * serial, WiFi and telemetry pinned to the PRO CPU next to the WiFi stack. Devices declare each
+ * component's ExecutionCore and exchange events, commands and snapshots through SPSC queues
+ * (see CoreMailbox.h), so a stalled UART or LCD never delays the sensing loop.
+ *
+ * On ESP32 the tasks are FreeRTOS tasks; elsewhere (Linux) they are std::threads, which keeps
+ * the same device code measurable on a host with wall-clock time.
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include "LatencyHistogram.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+/**
+ * @brief Core a component runs on when a device runs dual core.
+ */
+enum class ExecutionCore : uint8_t
+{
+    REAL_TIME, ///< Sensing and actuation; must never wait on I/O.
+    IO         ///< Display, serial, WiFi and telemetry.
+};
+
+/**
+ * @brief One pass of a core's work.
+ */
+typedef void (*CoreStep)(void *context);
+
+class DualCoreRunner
+{
+public:
+    static const int REAL_TIME_CORE = 1;     ///< APP CPU, where Arduino's loop() runs.
+    static const int IO_CORE = 0;            ///< PRO CPU, shared with the WiFi stack.
+    static const int REAL_TIME_PRIORITY = 3; ///< Above loop() (1) and the I2C worker (2).
+    static const int IO_PRIORITY = 1;
+    static const uint32_t STACK_BYTES = 4096;
+
+private:
+    CoreStep realTimeStep;
+    CoreStep ioStep;
+    void *context;
+    uint32_t realTimePeriodMicros;
+    uint32_t ioPeriodMicros;
+
+    std::atomic<bool> running;
+    std::atomic<uint32_t> realTimeSteps;
+    std::atomic<uint32_t> ioSteps;
+    std::atomic<uint32_t> worstRealTimeStepMicros;
+    std::atomic<uint32_t> worstIoStepMicros;
+    LatencyHistogram realTimeLateness; ///< Start of each real-time step after its slot; written by that task only.
+
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t realTimeTask;
+    TaskHandle_t ioTask;
+    std::atomic<int> activeTasks;
+
+    static void realTimeEntry(void *parameter);
+    static void ioEntry(void *parameter);
+#else
+    std::thread realTimeThread;
+    std::thread ioThread;
+    std::mutex wakeLock;
+    std::condition_variable wakeSignal;
+    bool wakePending;
+#endif
+
+    void runLoop(bool realTime);
+    static uint64_t nowMicros();
+    bool sleepUntil(uint64_t deadlineMicros, bool realTime);
+
+public:
+    /**
+     * @brief Constructs a stopped runner.
+     * @param realTimeStep Work for the real-time core, called every realTimePeriodMicros.
+     * @param ioStep Work for the I/O core, called every ioPeriodMicros.
+     * @param context Passed to both steps (usually the device).
+     * @param realTimePeriodMicros Period of the real-time task.
+     * @param ioPeriodMicros Period of the I/O task.
+     * @param latenessBudgetMicros p99 budget for how late a real-time step may start.
+     */
+    DualCoreRunner(CoreStep realTimeStep, CoreStep ioStep, void *context,
+                   uint32_t realTimePeriodMicros, uint32_t ioPeriodMicros, uint32_t latenessBudgetMicros);
+    ~DualCoreRunner();
+
+    /**
+     * @brief Starts both tasks.
+     * @return False when already running or the target has a single core; keep calling the
+     *         device from loop() in that case.
+     */
+    bool start();
+
+    /**
+     * @brief Stops both tasks after their current step and waits for them to exit.
+     */
+    void stop();
+
+    bool isRunning() const;
+
+    /**
+     * @brief Runs the real-time step now instead of at its next slot; the schedule is kept.
+     *
+     * For producers that finish work the real-time step consumes, so it does not wait up to a
+     * whole period. Safe from any task, not from an interrupt.
+     */
+    void wake();
+
+    /**
+     * @brief Checks whether two tasks can run in parallel on this target.
+     */
+    static bool isSupported();
+
+    /**
+     * @brief Gets how late real-time steps started relative to their period.
+     * @return Histogram owned by the real-time task; reads from other tasks are approximate.
+     */
+    const LatencyHistogram &getRealTimeLateness() const;
+
+    uint32_t getRealTimeSteps() const;
+    uint32_t getIoSteps() const;
+    uint32_t getWorstRealTimeStepMicros() const;
+    uint32_t getWorstIoStepMicros() const;
+};
+
+#endif // DUAL_CORE_RUNNER_H
@@ -0,0 +1,146 @@
+/**
+ * @file LatencyHistogram.cpp
+ * @brief Implements the LatencyHistogram class.
+ *
+ * Values below 8 us get one bucket each. Above that, a value's bucket is its highest set bit
+ * plus the next SUB_BITS bits, which keeps the relative bucket width at 1/8 or less.
+ */
+
+#include "LatencyHistogram.h"
+
+LatencyHistogram::LatencyHistogram(const char *name, uint32_t budgetMicros, uint16_t budgetPermille)
+    : name(name), budgetMicros(budgetMicros), budgetPermille(budgetPermille)
+{
+    reset();
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        counts[i] = 0;
+    }
+    count = 0;
+    maxMicros = 0;
+    overBudget = 0;
+}
+
+int LatencyHistogram::bucketOf(uint32_t micros)
+{
+    const uint32_t linear = 1UL << SUB_BITS;
+    if (micros > MAX_TRACKED)
+    {
+        micros = MAX_TRACKED;
+    }
+    if (micros < linear)
+    {
+        return (int)micros;
+    }
+
+    int msb = 31 - __builtin_clz(micros);
+    uint32_t top = micros >> (msb - SUB_BITS); // linear .. 2 * linear - 1
+    return (msb - SUB_BITS) * (int)linear + (int)top;
+}
+
+uint32_t LatencyHistogram::bucketUpperBound(int bucket)
+{
+    const int linear = 1 << SUB_BITS;
+    if (bucket < linear)
+    {
+        return (uint32_t)bucket;
+    }
+
+    int msb = bucket / linear + SUB_BITS - 1;
+    uint32_t top = (uint32_t)(linear + bucket % linear);
+    return ((top + 1) << (msb - SUB_BITS)) - 1;
+}
+
+void LatencyHistogram::record(uint32_t micros)
+{
+    counts[bucketOf(micros)]++;
+    count++;
+    if (micros > maxMicros)
+    {
+        maxMicros = micros;
+    }
+    if (micros > budgetMicros)
+    {
+        overBudget++;
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    if (other.maxMicros > maxMicros)
+    {
+        maxMicros = other.maxMicros;
+    }
+    overBudget += other.overBudget;
+}
+
+uint32_t LatencyHistogram::percentile(uint16_t permille) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the sample at this percentile, rounded up, at least 1
+    uint32_t rank = (uint32_t)(((uint64_t)count * permille + 999) / 1000);
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    uint32_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            uint32_t bound = bucketUpperBound(i);
+            return bound < maxMicros ? bound : maxMicros;
+        }
+    }
+    return maxMicros;
+}
+
+bool LatencyHistogram::meetsBudget() const
+{
+    return count == 0 || percentile(budgetPermille) <= budgetMicros;
+}
+
+const char *LatencyHistogram::getName() const
+{
+    return name;
+}
+
+uint32_t LatencyHistogram::getBudgetMicros() const
+{
+    return budgetMicros;
+}
+
+uint16_t LatencyHistogram::getBudgetPermille() const
+{
+    return budgetPermille;
+}
+
+uint32_t LatencyHistogram::getCount() const
+{
+    return count;
+}
+
+uint32_t LatencyHistogram::getMaxMicros() const
+{
+    return maxMicros;
+}
+
+uint32_t LatencyHistogram::getOverBudgetCount() const
+{
+    return overBudget;
+}
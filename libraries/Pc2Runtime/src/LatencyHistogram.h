@@ -0,0 +1,82 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+/**
+ * @file LatencyHistogram.h
+ * @brief Declares the LatencyHistogram class.
+ *
+ * Fixed-size log-linear histogram for stimulus-to-actuation latencies, with percentile queries
+ * and a latency budget (service level objective). Each power of two is split into 8 buckets,
+ * so a reported percentile is at most 12.5% above the true value. Recording is O(1) and never
+ * allocates, so it can run on every event of a device's main loop.
+ */
+
+#include <stdint.h>
+
+class LatencyHistogram
+{
+public:
+    static const int SUB_BITS = 3;                   ///< log2 of buckets per power of two.
+    static const int BUCKETS = 200;                  ///< Covers 0 to about 134 s in microseconds.
+    static const uint32_t MAX_TRACKED = 134217727UL; ///< Larger samples land in the last bucket.
+
+private:
+    const char *name;      ///< Label used in reports.
+    uint32_t budgetMicros; ///< Latency the budget percentile must stay within.
+    uint16_t budgetPermille; ///< Percentile the budget applies to (990 = p99).
+    uint32_t counts[BUCKETS];
+    uint32_t count;
+    uint32_t maxMicros;
+    uint32_t overBudget; ///< Samples individually above budgetMicros.
+
+    static int bucketOf(uint32_t micros);
+    static uint32_t bucketUpperBound(int bucket);
+
+public:
+    /**
+     * @brief Constructs a histogram with a latency budget.
+     * @param name Label for reports.
+     * @param budgetMicros Budget in microseconds.
+     * @param budgetPermille Percentile the budget applies to, in permille (default: p99).
+     */
+    LatencyHistogram(const char *name, uint32_t budgetMicros, uint16_t budgetPermille = 990);
+
+    /**
+     * @brief Records one latency sample.
+     * @param micros Latency in microseconds.
+     */
+    void record(uint32_t micros);
+
+    /**
+     * @brief Adds another histogram's samples, e.g. to aggregate many devices.
+     * @param other Histogram with the same budget; its over-budget count is taken as is.
+     */
+    void merge(const LatencyHistogram &other);
+
+    /**
+     * @brief Clears all samples, keeping name and budget.
+     */
+    void reset();
+
+    /**
+     * @brief Gets a percentile of the recorded latencies.
+     * @param permille Percentile in permille (500 = median, 990 = p99).
+     * @return Upper bound of the bucket holding that percentile, capped at the maximum seen; 0 when empty.
+     */
+    uint32_t percentile(uint16_t permille) const;
+
+    /**
+     * @brief Checks the budget percentile against the budget.
+     * @return True when empty or when the budget percentile is within budget.
+     */
+    bool meetsBudget() const;
+
+    const char *getName() const;
+    uint32_t getBudgetMicros() const;
+    uint16_t getBudgetPermille() const;
+    uint32_t getCount() const;
+    uint32_t getMaxMicros() const;
+    uint32_t getOverBudgetCount() const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,101 @@
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+/**
+ * @file LedPattern.h
+ * @brief Declares LED light patterns and their LEDC peripheral programs.
+ *
+ * A pattern (solid, blink, strobe, breathe) is translated once into an `LedcProgram`: the PWM
+ * frequency, resolution, duty and fade time the ESP32 LEDC peripheral needs to produce it in
+ * hardware. After that the LED runs without any CPU work per blink. The translation is plain
+ * arithmetic, so it can be checked on a host against a simulated peripheral.
+ *
+ * Blink and strobe patterns run the LEDC timer at the blink rate itself. On the classic ESP32
+ * the 1 MHz REF_TICK clock with a 10-bit duty reaches down to 1 Hz, which sets the slowest
+ * supported rate.
+ */
+
+#include <stdint.h>
+
+/**
+ * @brief Kinds of light pattern an Led can show.
+ */
+enum class LedPatternKind
+{
+    SOLID,   ///< Steady on or off, driven as plain GPIO.
+    BLINK,   ///< Square wave at the given rate and duty.
+    STROBE,  ///< Short flashes: a blink with a low duty cycle.
+    BREATHE  ///< Smooth hardware fade up and down over the period.
+};
+
+/**
+ * @brief A light pattern request.
+ */
+struct LedPattern
+{
+    LedPatternKind kind;  ///< Pattern shape.
+    uint16_t frequencyHz; ///< Blink/strobe rate in Hz (ignored for SOLID and BREATHE).
+    uint8_t dutyPercent;  ///< On-time share of each blink period.
+    uint16_t periodMs;    ///< Full breathing cycle (BREATHE only).
+
+    static LedPattern solid() { return LedPattern{LedPatternKind::SOLID, 0, 100, 0}; }
+    static LedPattern blink(uint16_t hz, uint8_t duty = 50) { return LedPattern{LedPatternKind::BLINK, hz, duty, 0}; }
+    static LedPattern strobe(uint16_t hz, uint8_t duty = 10) { return LedPattern{LedPatternKind::STROBE, hz, duty, 0}; }
+    static LedPattern breathe(uint16_t ms) { return LedPattern{LedPatternKind::BREATHE, 0, 100, ms}; }
+
+    bool operator==(const LedPattern &other) const
+    {
+        return kind == other.kind && frequencyHz == other.frequencyHz &&
+               dutyPercent == other.dutyPercent && periodMs == other.periodMs;
+    }
+    bool operator!=(const LedPattern &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief LEDC settings that realize a pattern in hardware.
+ */
+struct LedcProgram
+{
+    uint32_t frequencyHz;  ///< LEDC timer frequency; 0 means plain GPIO (SOLID).
+    uint8_t resolutionBits; ///< Duty resolution.
+    uint32_t duty;         ///< Duty at `resolutionBits`; the fade peak for BREATHE.
+    uint32_t fadeMs;       ///< Length of one fade ramp; 0 when the pattern does not fade.
+};
+
+static const uint8_t LEDC_PATTERN_RESOLUTION = 10;  ///< Duty resolution used for every pattern.
+static const uint16_t LEDC_MIN_BLINK_HZ = 1;        ///< Slowest rate the LEDC timer can generate.
+static const uint16_t LEDC_MAX_BLINK_HZ = 50;       ///< Faster than this no longer reads as blinking.
+static const uint32_t LEDC_BREATHE_CARRIER_HZ = 5000; ///< Flicker-free carrier for faded brightness.
+static const uint16_t LEDC_MIN_BREATHE_MS = 200;    ///< Shortest breathing cycle.
+
+/**
+ * @brief Translates a pattern into the LEDC program that produces it.
+ * @param pattern The requested pattern; out-of-range rates and duties are clamped.
+ * @return The peripheral program. A SOLID pattern yields frequencyHz == 0.
+ */
+inline LedcProgram compileLedPattern(const LedPattern &pattern)
+{
+    const uint32_t fullScale = 1UL << LEDC_PATTERN_RESOLUTION;
+
+    switch (pattern.kind)
+    {
+    case LedPatternKind::BLINK:
+    case LedPatternKind::STROBE:
+    {
+        uint32_t hz = pattern.frequencyHz;
+        hz = hz < LEDC_MIN_BLINK_HZ ? LEDC_MIN_BLINK_HZ : (hz > LEDC_MAX_BLINK_HZ ? LEDC_MAX_BLINK_HZ : hz);
+        uint32_t percent = pattern.dutyPercent;
+        percent = percent < 1 ? 1 : (percent > 99 ? 99 : percent);
+        return LedcProgram{hz, LEDC_PATTERN_RESOLUTION, fullScale * percent / 100, 0};
+    }
+    case LedPatternKind::BREATHE:
+    {
+        uint32_t period = pattern.periodMs < LEDC_MIN_BREATHE_MS ? LEDC_MIN_BREATHE_MS : pattern.periodMs;
+        return LedcProgram{LEDC_BREATHE_CARRIER_HZ, LEDC_PATTERN_RESOLUTION, fullScale - 1, period / 2};
+    }
+    default:
+        return LedcProgram{0, LEDC_PATTERN_RESOLUTION, 0, 0};
+    }
+}
+
+#endif // LED_PATTERN_H
@@ -0,0 +1,194 @@
+/**
+ * @file LedPatternDriver.cpp
+ * @brief Implements the LedPatternDriver class.
+ *
+ * Steady output is left to the framework Led; patterns detach the pin from plain GPIO and hand
+ * it to the ESP32 LEDC peripheral, which then blinks or fades it on its own.
+ */
+
+#include "LedPatternDriver.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <driver/gpio.h>
+#include <esp_rom_gpio.h>
+#include <soc/gpio_sig_map.h>
+#endif
+
+const Command LedPatternDriver::BLINK_COMMAND = Command(BLINK_COMMAND_ID);
+const Command LedPatternDriver::FAST_BLINK_COMMAND = Command(FAST_BLINK_COMMAND_ID);
+const Command LedPatternDriver::STROBE_COMMAND = Command(STROBE_COMMAND_ID);
+const Command LedPatternDriver::BREATHE_COMMAND = Command(BREATHE_COMMAND_ID);
+
+LedPatternDriver::LedPatternDriver(int pin, bool initialState, CommandHandler *commandHandler)
+    : Actuator(pin, commandHandler), led(pin, initialState), pattern(LedPattern::solid()),
+      pwmAttached(false), fadeDone(false), fadingUp(true), programCount(0) {}
+
+void LedPatternDriver::handle(Command command)
+{
+    if (command == Led::TOGGLE_LED_COMMAND)
+    {
+        setState(!getState());
+    }
+    else if (command == Led::TURN_ON_COMMAND)
+    {
+        setState(true);
+    }
+    else if (command == Led::TURN_OFF_COMMAND)
+    {
+        setState(false);
+    }
+    else if (command == BLINK_COMMAND)
+    {
+        setPattern(LedPattern::blink(1));
+    }
+    else if (command == FAST_BLINK_COMMAND)
+    {
+        setPattern(LedPattern::blink(4));
+    }
+    else if (command == STROBE_COMMAND)
+    {
+        setPattern(LedPattern::strobe(10));
+    }
+    else if (command == BREATHE_COMMAND)
+    {
+        setPattern(LedPattern::breathe(2000));
+    }
+    Actuator::handle(command); // Propagate to handler if set
+}
+
+bool LedPatternDriver::getState() const
+{
+    return led.getState();
+}
+
+void LedPatternDriver::setState(bool newState)
+{
+    pattern = LedPattern::solid();
+    apply(newState);
+}
+
+void LedPatternDriver::setPattern(const LedPattern &newPattern)
+{
+    if (getState() && pattern == newPattern)
+    {
+        return; // Already running in hardware
+    }
+    pattern = newPattern;
+    apply(true);
+}
+
+const LedPattern &LedPatternDriver::getPattern() const
+{
+    return pattern;
+}
+
+void LedPatternDriver::refresh()
+{
+    apply(getState());
+}
+
+uint32_t LedPatternDriver::getProgramCount() const
+{
+    return programCount;
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+
+void LedPatternDriver::apply(bool on)
+{
+    programCount++;
+    LedcProgram program = compileLedPattern(pattern);
+
+    if (pwmAttached)
+    {
+        ledcDetach(pin);
+        pwmAttached = false;
+        pinMode(pin, OUTPUT);
+    }
+
+    // Steady output, and the level a pattern starts from, go through the Led
+    led.setState(on);
+    if (!on || program.frequencyHz == 0)
+    {
+        return;
+    }
+
+    pwmAttached = ledcAttach(pin, program.frequencyHz, program.resolutionBits);
+    if (!pwmAttached)
+    {
+        // No free LEDC channel or timer: stay steady ON
+        pinMode(pin, OUTPUT);
+        led.setState(true);
+        return;
+    }
+
+    if (program.fadeMs > 0)
+    {
+        fadingUp = true;
+        startFade();
+    }
+    else
+    {
+        ledcWrite(pin, program.duty);
+    }
+}
+
+void LedPatternDriver::startFade()
+{
+    LedcProgram program = compileLedPattern(pattern);
+    fadeDone = false;
+    ledcFadeWithInterruptArg(pin, fadingUp ? 0 : program.duty, fadingUp ? program.duty : 0,
+                             program.fadeMs, onFadeDone, this);
+}
+
+void ARDUINO_ISR_ATTR LedPatternDriver::onFadeDone(void *arg)
+{
+    static_cast<LedPatternDriver *>(arg)->fadeDone = true;
+}
+
+void LedPatternDriver::update()
+{
+    // One restart per half breathing cycle; the ramp itself runs in hardware
+    if (pwmAttached && fadeDone && pattern.kind == LedPatternKind::BREATHE)
+    {
+        fadingUp = !fadingUp;
+        startFade();
+    }
+}
+
+#else
+
+void LedPatternDriver::apply(bool on)
+{
+    // No LEDC peripheral: patterns show as steady ON
+    programCount++;
+    led.setState(on);
+}
+
+void LedPatternDriver::startFade() {}
+
+void LedPatternDriver::onFadeDone(void *arg) {}
+
+void LedPatternDriver::update() {}
+
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32)
+
+void IRAM_ATTR LedPatternDriver::forceOn(int pin)
+{
+    // digitalWrite() refuses a pin the peripheral manager lists as LEDC, and
+    // ledcDetach() is not interrupt-safe. Routing the pin back to the GPIO
+    // output register in the matrix is: the LEDC channel keeps running unseen.
+    esp_rom_gpio_connect_out_signal(pin, SIG_GPIO_OUT_IDX, false, false);
+    gpio_set_level((gpio_num_t)pin, 1);
+}
+
+#else
+
+void LedPatternDriver::forceOn(int pin)
+{
+    digitalWrite(pin, HIGH);
+}
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef LED_PATTERN_DRIVER_H
+#define LED_PATTERN_DRIVER_H
+
+/**
+ * @file LedPatternDriver.h
+ * @brief Declares the LedPatternDriver class.
+ *
+ * An actuator that shows solid, blink, strobe and breathe patterns on one LED pin. Steady on
+ * and off go through the framework `Led`, unchanged; a pattern is programmed into the ESP32
+ * LEDC peripheral once per change, so a blinking LED costs no CPU time per toggle.
+ */
+
+#include <Arduino.h>
+#include "Actuator.h"
+#include "Led.h"
+#include "LedPattern.h"
+#include <stdint.h>
+
+class LedPatternDriver : public Actuator
+{
+private:
+    Led led;                ///< Steady on/off; also holds the on/off state while a pattern runs.
+    LedPattern pattern;     ///< Pattern shown while the LED is ON.
+    bool pwmAttached;       ///< True while the pin is routed to the LEDC peripheral.
+    volatile bool fadeDone; ///< Set from the fade-end interrupt of a BREATHE pattern.
+    bool fadingUp;          ///< Direction of the current BREATHE ramp.
+    uint32_t programCount;  ///< Number of times the output was (re)programmed.
+
+    /**
+     * @brief Drives the pin for the given state and the current pattern.
+     * @param on True to show the pattern, false for steady OFF.
+     */
+    void apply(bool on);
+
+    /**
+     * @brief Starts one BREATHE ramp in the direction given by `fadingUp`.
+     */
+    void startFade();
+
+    /**
+     * @brief Fade-end interrupt callback; only flags the ramp as finished.
+     * @param arg The driver whose ramp ended.
+     */
+    static void onFadeDone(void *arg);
+
+public:
+    // TURN_ON, TURN_OFF and TOGGLE_LED are the framework Led commands (ids 0-2)
+    static const int BLINK_COMMAND_ID = 3;      ///< Unique ID for slow blink (1 Hz) command.
+    static const int FAST_BLINK_COMMAND_ID = 4; ///< Unique ID for fast blink (4 Hz) command.
+    static const int STROBE_COMMAND_ID = 5;     ///< Unique ID for strobe (10 Hz, 10% duty) command.
+    static const int BREATHE_COMMAND_ID = 6;    ///< Unique ID for breathe (2 s cycle) command.
+    static const Command BLINK_COMMAND;         ///< Predefined command to blink slowly.
+    static const Command FAST_BLINK_COMMAND;    ///< Predefined command to blink fast.
+    static const Command STROBE_COMMAND;        ///< Predefined command to strobe.
+    static const Command BREATHE_COMMAND;       ///< Predefined command to breathe.
+
+    /**
+     * @brief Constructs a pattern driver and the Led it drives.
+     * @param pin The GPIO pin for the LED.
+     * @param initialState Initial steady state (default: false/OFF).
+     * @param commandHandler Optional handler to receive commands (default: nullptr).
+     */
+    LedPatternDriver(int pin, bool initialState = false, CommandHandler *commandHandler = nullptr);
+
+    /**
+     * @brief Handles the Led commands and the pattern commands.
+     * @param command The command to execute (e.g., Led::TURN_ON_COMMAND, STROBE_COMMAND).
+     */
+    void handle(Command command) override;
+
+    /**
+     * @brief Gets whether the LED is ON, steady or with a pattern.
+     * @return True if the LED is ON.
+     */
+    bool getState() const;
+
+    /**
+     * @brief Sets the LED steady on or off, ending any pattern.
+     * @param newState The new state (true = ON, false = OFF).
+     */
+    void setState(bool newState);
+
+    /**
+     * @brief Turns the LED ON with the given pattern.
+     *
+     * The peripheral is only reprogrammed when the pattern or state actually changes.
+     * Without the LEDC peripheral (non-ESP32 targets) every pattern shows as steady ON.
+     * @param newPattern The pattern to show.
+     */
+    void setPattern(const LedPattern &newPattern);
+
+    /**
+     * @brief Gets the pattern shown while the LED is ON.
+     * @return The current pattern.
+     */
+    const LedPattern &getPattern() const;
+
+    /**
+     * @brief Re-drives the pin from the current state and pattern.
+     * Use after forceOn() or anything else wrote the pin directly.
+     */
+    void refresh();
+
+    /**
+     * @brief Restarts the next BREATHE ramp once the previous one ended.
+     * Call periodically; it does nothing for other patterns.
+     */
+    void update();
+
+    /**
+     * @brief Gets how many times the output was programmed.
+     * @return Count of pin or LEDC reprogramming operations.
+     */
+    uint32_t getProgramCount() const;
+
+    /**
+     * @brief Drives a pin steady HIGH from an interrupt, even while LEDC owns it.
+     *
+     * Only the GPIO matrix routing and output level are touched, not the LEDC channel or the
+     * driver state, so the owning driver's refresh() hands the pin back to its pattern.
+     * @param pin The LED pin.
+     */
+    static void IRAM_ATTR forceOn(int pin);
+};
+
+#endif // LED_PATTERN_DRIVER_H
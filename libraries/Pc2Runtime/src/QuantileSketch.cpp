@@ -0,0 +1,102 @@
+/**
+ * @file QuantileSketch.cpp
+ * @brief Implements the QuantileSketch class.
+ *
+ * A bucket reports the value that splits it into equal relative errors, 2 * GAMMA^k / (GAMMA + 1)
+ * times MIN_VALUE, so no estimate is off by more than (GAMMA - 1) / (GAMMA + 1).
+ */
+
+#include "QuantileSketch.h"
+#include <math.h>
+
+QuantileSketch::QuantileSketch()
+{
+    reset();
+}
+
+void QuantileSketch::reset()
+{
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        counts[i] = 0;
+    }
+    zeroCount = 0;
+    count = 0;
+}
+
+int QuantileSketch::keyOf(float value)
+{
+    static const float INVERSE_LOG_GAMMA = 1.0f / logf(GAMMA);
+    if (!(value > MIN_VALUE)) // Also catches NaN
+    {
+        return -1;
+    }
+    int key = (int)ceilf(logf(value / MIN_VALUE) * INVERSE_LOG_GAMMA);
+    return key < BUCKETS ? key : BUCKETS - 1;
+}
+
+void QuantileSketch::add(float value)
+{
+    addKey(keyOf(value));
+}
+
+void QuantileSketch::addKey(int key)
+{
+    if (key < 0)
+    {
+        zeroCount++;
+    }
+    else
+    {
+        counts[key]++;
+    }
+    count++;
+}
+
+void QuantileSketch::merge(const QuantileSketch &other)
+{
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        counts[i] += other.counts[i];
+    }
+    zeroCount += other.zeroCount;
+    count += other.count;
+}
+
+float QuantileSketch::quantile(float q) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    if (q < 0)
+    {
+        q = 0;
+    }
+    if (q > 1)
+    {
+        q = 1;
+    }
+
+    // Nearest-rank: the smallest bucket holding more than q of the samples
+    uint32_t rank = (uint32_t)(q * (count - 1));
+    uint32_t seen = zeroCount;
+    if (seen > rank)
+    {
+        return 0;
+    }
+    for (int i = 0; i < BUCKETS; i++)
+    {
+        seen += counts[i];
+        if (seen > rank)
+        {
+            return MIN_VALUE * 2.0f * powf(GAMMA, (float)i) / (GAMMA + 1.0f);
+        }
+    }
+    return MIN_VALUE * powf(GAMMA, (float)(BUCKETS - 1));
+}
+
+uint32_t QuantileSketch::getCount() const
+{
+    return count;
+}
@@ -0,0 +1,65 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+/**
+ * @file QuantileSketch.h
+ * @brief Declares the QuantileSketch class.
+ *
+ * Streaming quantile estimate for positive sensor values in a fixed array of logarithmic
+ * buckets: bucket k holds values in (MIN_VALUE * GAMMA^(k-1), MIN_VALUE * GAMMA^k]. Every quantile
+ * is therefore within 2% of a true sample value, insertion is O(1), memory is fixed whatever the
+ * number of samples, and two sketches merge by adding their counts.
+ */
+
+#include <stdint.h>
+
+class QuantileSketch
+{
+public:
+    static const int BUCKETS = 300;              ///< Covers MIN_VALUE up to about 78000.
+    static constexpr float GAMMA = 1.0408f;      ///< Bucket growth: (GAMMA - 1) / (GAMMA + 1) = 2% error.
+    static constexpr float MIN_VALUE = 0.5f;     ///< Values at or below this count as zero.
+
+private:
+    uint32_t counts[BUCKETS];
+    uint32_t zeroCount; ///< Values at or below MIN_VALUE, including negatives.
+    uint32_t count;
+
+public:
+    QuantileSketch();
+
+    void reset();
+
+    /**
+     * @brief Adds one value.
+     */
+    void add(float value);
+
+    /**
+     * @brief Adds one value by its key; lets several sketches share one keyOf() call.
+     * @param key Result of keyOf().
+     */
+    void addKey(int key);
+
+    /**
+     * @brief Adds every sample of another sketch.
+     */
+    void merge(const QuantileSketch &other);
+
+    /**
+     * @brief Estimates a quantile.
+     * @param q Quantile from 0 to 1 (0.99 = p99).
+     * @return Estimate within 2% of a sample value; 0 when empty or in the zero bucket.
+     */
+    float quantile(float q) const;
+
+    uint32_t getCount() const;
+
+    /**
+     * @brief Gets the bucket of a value.
+     * @return -1 for the zero bucket, otherwise 0 to BUCKETS - 1.
+     */
+    static int keyOf(float value);
+};
+
+#endif // QUANTILE_SKETCH_H
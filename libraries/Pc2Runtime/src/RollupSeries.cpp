@@ -0,0 +1,267 @@
+/**
+ * @file RollupSeries.cpp
+ * @brief Implements the RollupSeries class.
+ *
+ * Hours and days start on minute boundaries, so a level can only end when the level below it
+ * ends too; advance() therefore walks up from minutes and stops at the first level still open.
+ */
+
+#include "RollupSeries.h"
+#include <stdio.h>
+
+const char *const RollupSeries::CSV_HEADER = "series,resolution,start_s,count,min,max,mean,p50,p90,p99";
+
+RollupClock::RollupClock()
+    : lastMillis(0), elapsedMillis(0), started(false)
+{
+}
+
+uint32_t RollupClock::seconds(uint32_t nowMillis)
+{
+    if (!started)
+    {
+        // Same seconds as nowMillis / 1000 until the first wrap
+        lastMillis = nowMillis;
+        elapsedMillis = nowMillis;
+        started = true;
+    }
+    int32_t delta = (int32_t)(nowMillis - lastMillis);
+    if (delta > 0)
+    {
+        elapsedMillis += (uint32_t)delta;
+        lastMillis = nowMillis;
+    }
+    return (uint32_t)(elapsedMillis / 1000);
+}
+
+RollupSeries::RollupSeries(const char *name)
+    : name(name), started(false)
+{
+    levels[0].seconds = 60;
+    levels[0].capacity = MINUTES_KEPT;
+    levels[0].slots = minuteSlots;
+    levels[1].seconds = 3600;
+    levels[1].capacity = HOURS_KEPT;
+    levels[1].slots = hourSlots;
+    levels[2].seconds = 86400;
+    levels[2].capacity = DAYS_KEPT;
+    levels[2].slots = daySlots;
+    for (Level &level : levels)
+    {
+        level.head = 0;
+        level.filled = 0;
+        resetWindow(level.window, 0);
+    }
+}
+
+void RollupSeries::resetWindow(Window &window, uint32_t start)
+{
+    window.start = start;
+    window.count = 0;
+    window.min = 0;
+    window.max = 0;
+    window.sum = 0;
+    window.sketch.reset();
+}
+
+void RollupSeries::add(uint32_t nowSeconds, float value)
+{
+    advance(nowSeconds);
+
+    Window &minute = levels[0].window;
+    if (minute.count == 0 || value < minute.min)
+    {
+        minute.min = value;
+    }
+    if (minute.count == 0 || value > minute.max)
+    {
+        minute.max = value;
+    }
+    minute.count++;
+    minute.sum += value;
+    minute.sketch.add(value);
+}
+
+void RollupSeries::advance(uint32_t nowSeconds)
+{
+    if (!started)
+    {
+        for (Level &level : levels)
+        {
+            level.window.start = nowSeconds - nowSeconds % level.seconds;
+        }
+        started = true;
+        return;
+    }
+
+    for (int i = 0; i < LEVELS; i++)
+    {
+        Level &level = levels[i];
+        uint32_t start = nowSeconds - nowSeconds % level.seconds;
+        if (start <= level.window.start)
+        {
+            break; // Still open, and so is every coarser level
+        }
+
+        uint32_t ended = level.window.start;
+        close(i);
+
+        // Windows without even an advance() call are kept as empty ones, at most a ring's worth
+        uint32_t missing = (start - ended) / level.seconds - 1;
+        if (missing > level.capacity)
+        {
+            missing = level.capacity;
+        }
+        for (uint32_t k = missing; k >= 1; k--)
+        {
+            RollupSummary empty = {start - k * level.seconds, 0, 0, 0, 0, 0, 0, 0};
+            push(level, empty);
+        }
+        resetWindow(level.window, start);
+    }
+}
+
+void RollupSeries::close(int index)
+{
+    Level &level = levels[index];
+    Window &window = level.window;
+
+    RollupSummary summary;
+    summarize(window.start, window.count, window.min, window.max, window.sum, window.sketch, summary);
+    push(level, summary);
+
+    // Cascade into the open window of the next resolution
+    if (index + 1 < LEVELS && window.count > 0)
+    {
+        Window &parent = levels[index + 1].window;
+        if (parent.count == 0 || window.min < parent.min)
+        {
+            parent.min = window.min;
+        }
+        if (parent.count == 0 || window.max > parent.max)
+        {
+            parent.max = window.max;
+        }
+        parent.count += window.count;
+        parent.sum += window.sum;
+        parent.sketch.merge(window.sketch);
+    }
+}
+
+void RollupSeries::push(Level &level, const RollupSummary &summary)
+{
+    level.slots[level.head] = summary;
+    level.head = (level.head + 1) % level.capacity;
+    if (level.filled < level.capacity)
+    {
+        level.filled++;
+    }
+}
+
+void RollupSeries::summarize(uint32_t start, uint32_t count, float min, float max, double sum,
+                             const QuantileSketch &sketch, RollupSummary &out)
+{
+    out.start = start;
+    out.count = count;
+    if (count == 0)
+    {
+        out.min = out.max = out.mean = out.p50 = out.p90 = out.p99 = 0;
+        return;
+    }
+    out.min = min;
+    out.max = max;
+    out.mean = (float)(sum / count);
+    out.p50 = sketch.quantile(0.5f);
+    out.p90 = sketch.quantile(0.9f);
+    out.p99 = sketch.quantile(0.99f);
+}
+
+bool RollupSeries::current(RollupResolution resolution, RollupSummary &out) const
+{
+    if (!started)
+    {
+        return false;
+    }
+
+    // The open window so far: its own cascaded totals plus every finer open window
+    int top = (int)resolution;
+    QuantileSketch sketch;
+    uint32_t count = 0;
+    float min = 0;
+    float max = 0;
+    double sum = 0;
+    for (int i = 0; i <= top; i++)
+    {
+        const Window &window = levels[i].window;
+        if (window.count == 0)
+        {
+            continue;
+        }
+        if (count == 0 || window.min < min)
+        {
+            min = window.min;
+        }
+        if (count == 0 || window.max > max)
+        {
+            max = window.max;
+        }
+        count += window.count;
+        sum += window.sum;
+        sketch.merge(window.sketch);
+    }
+    summarize(levels[top].window.start, count, min, max, sum, sketch, out);
+    return true;
+}
+
+bool RollupSeries::closed(RollupResolution resolution, uint8_t ago, RollupSummary &out) const
+{
+    const Level &level = levels[(int)resolution];
+    if (ago >= level.filled)
+    {
+        return false;
+    }
+    out = level.slots[(level.head + level.capacity - 1 - ago) % level.capacity];
+    return true;
+}
+
+uint8_t RollupSeries::getClosedCount(RollupResolution resolution) const
+{
+    return levels[(int)resolution].filled;
+}
+
+size_t RollupSeries::forEach(RollupResolution resolution, Visitor visit, void *context) const
+{
+    const Level &level = levels[(int)resolution];
+    for (uint8_t i = 0; i < level.filled; i++)
+    {
+        visit(resolution, level.slots[(level.head + level.capacity - level.filled + i) % level.capacity], context);
+    }
+    return level.filled;
+}
+
+const char *RollupSeries::getName() const
+{
+    return name;
+}
+
+int RollupSeries::formatCsv(RollupResolution resolution, const RollupSummary &summary, char *buffer, size_t size) const
+{
+    return snprintf(buffer, size, "%s,%s,%lu,%lu,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f",
+                    name, resolutionName(resolution), (unsigned long)summary.start, (unsigned long)summary.count,
+                    summary.min, summary.max, summary.mean, summary.p50, summary.p90, summary.p99);
+}
+
+const char *RollupSeries::resolutionName(RollupResolution resolution)
+{
+    switch (resolution)
+    {
+    case RollupResolution::MINUTE:
+        return "minute";
+    case RollupResolution::HOUR:
+        return "hour";
+    case RollupResolution::DAY:
+        return "day";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,174 @@
+#ifndef ROLLUP_SERIES_H
+#define ROLLUP_SERIES_H
+
+/**
+ * @file RollupSeries.h
+ * @brief Declares the RollupSeries class, the RollupResolution declaration and RollupSummary.
+ *
+ * Incremental per-minute, per-hour and per-day summaries of one sensor value: count, min, max,
+ * mean and p50/p90/p99. Samples only touch the open minute. When a window ends its summary is
+ * frozen into a fixed ring for that resolution, and its totals and quantile sketch cascade into
+ * the open window of the next resolution. A sample costs O(1), a window close a few hundred
+ * additions, and memory is fixed by the ring sizes whatever the uptime.
+ *
+ * Times come from the caller in seconds, so the series runs on any clock. The seconds must not
+ * wrap: millis() / 1000 falls back to zero after 49.7 days, so millisecond clocks go through a
+ * RollupClock first. Nothing is locked: one task adds samples, and reads from another task may
+ * see a window while it closes.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "QuantileSketch.h"
+
+/**
+ * @brief Window length of a rollup.
+ */
+enum class RollupResolution : uint8_t
+{
+    MINUTE,
+    HOUR,
+    DAY
+};
+
+/**
+ * @brief Summary of one window.
+ */
+struct RollupSummary
+{
+    uint32_t start; ///< Window start in seconds, aligned to its length.
+    uint32_t count; ///< Samples in the window; the other fields are 0 when none.
+    float min;
+    float max;
+    float mean;
+    float p50;
+    float p90;
+    float p99;
+};
+
+/**
+ * @brief Turns a wrapping 32-bit millisecond time (millis() or a sample stamp) into seconds that
+ *        keep counting past the wrap.
+ *
+ * Accumulates the wrap-safe difference between calls in 64 bits, so it needs a call at least
+ * every 24.8 days. A time that runs backwards keeps the last value.
+ */
+class RollupClock
+{
+private:
+    uint32_t lastMillis;
+    uint64_t elapsedMillis;
+    bool started;
+
+public:
+    RollupClock();
+
+    /**
+     * @brief Converts a millisecond time to seconds on the non-wrapping clock.
+     * @param nowMillis Time in milliseconds; the first call starts the clock at it.
+     */
+    uint32_t seconds(uint32_t nowMillis);
+};
+
+class RollupSeries
+{
+public:
+    static const uint8_t LEVELS = 3;
+    static const uint8_t MINUTES_KEPT = 60;
+    static const uint8_t HOURS_KEPT = 24;
+    static const uint8_t DAYS_KEPT = 30;
+    static const char *const CSV_HEADER; ///< Column names matching formatCsv().
+
+    /**
+     * @brief Receives closed windows, oldest first.
+     */
+    typedef void (*Visitor)(RollupResolution resolution, const RollupSummary &summary, void *context);
+
+private:
+    struct Window
+    {
+        uint32_t start;
+        uint32_t count;
+        float min;
+        float max;
+        double sum;
+        QuantileSketch sketch;
+    };
+
+    struct Level
+    {
+        uint32_t seconds;
+        uint8_t capacity;
+        RollupSummary *slots;
+        uint8_t head;   ///< Next slot to write.
+        uint8_t filled; ///< Closed windows kept, up to capacity.
+        Window window;  ///< Open window: finer levels cascade into it as they close.
+    };
+
+    const char *name;
+    RollupSummary minuteSlots[MINUTES_KEPT];
+    RollupSummary hourSlots[HOURS_KEPT];
+    RollupSummary daySlots[DAYS_KEPT];
+    Level levels[LEVELS];
+    bool started;
+
+    void close(int level);
+    void push(Level &level, const RollupSummary &summary);
+    static void resetWindow(Window &window, uint32_t start);
+    static void summarize(uint32_t start, uint32_t count, float min, float max, double sum,
+                          const QuantileSketch &sketch, RollupSummary &out);
+
+public:
+    /**
+     * @brief Constructs an empty series.
+     * @param name Label for reports and exports.
+     */
+    RollupSeries(const char *name);
+
+    /**
+     * @brief Adds one sample, closing any windows that ended before it.
+     * @param nowSeconds Time of the sample in seconds.
+     * @param value The sample.
+     */
+    void add(uint32_t nowSeconds, float value);
+
+    /**
+     * @brief Closes the windows that ended by now, so quiet periods still produce (empty) windows.
+     * @param nowSeconds Current time in seconds.
+     */
+    void advance(uint32_t nowSeconds);
+
+    /**
+     * @brief Summarizes the open window of a resolution so far.
+     * @return False before the first sample or advance().
+     */
+    bool current(RollupResolution resolution, RollupSummary &out) const;
+
+    /**
+     * @brief Gets a closed window.
+     * @param resolution Window length.
+     * @param ago 0 for the most recently closed window, 1 for the one before, ...
+     * @return False when that window is no longer (or not yet) kept.
+     */
+    bool closed(RollupResolution resolution, uint8_t ago, RollupSummary &out) const;
+
+    uint8_t getClosedCount(RollupResolution resolution) const;
+
+    /**
+     * @brief Visits every kept window of a resolution, oldest first.
+     * @return Number of windows visited.
+     */
+    size_t forEach(RollupResolution resolution, Visitor visit, void *context) const;
+
+    const char *getName() const;
+
+    /**
+     * @brief Formats a window as one CSV line (no newline), columns as in CSV_HEADER.
+     * @return Characters written, as snprintf.
+     */
+    int formatCsv(RollupResolution resolution, const RollupSummary &summary, char *buffer, size_t size) const;
+
+    static const char *resolutionName(RollupResolution resolution);
+};
+
+#endif // ROLLUP_SERIES_H
@@ -0,0 +1,264 @@
+/**
+ * @file SamplingClock.cpp
+ * @brief Implements the SamplingClock class.
+ *
+ * The timer interrupt only notifies the sampling task; the notification count tells the task
+ * how many slots passed, so a tick that arrives during a long acquisition is counted as skipped
+ * instead of being run late.
+ */
+
+#include "SamplingClock.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#elif defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+SamplingClock::SamplingClock(const char *jitterName, Acquisition acquire, void *context,
+                             uint32_t periodMicros, uint32_t jitterBudgetMicros)
+    : acquire(acquire), context(context), ready(nullptr), readyContext(nullptr), periodMicros(periodMicros),
+      jitter(jitterName, jitterBudgetMicros), skippedTicks(0), startMicros(0), ticks(0), started(false),
+      resumed(false)
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+      ,
+      timer(nullptr), task(nullptr)
+#endif
+{
+}
+
+SamplingClock::~SamplingClock()
+{
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (timer != nullptr)
+    {
+        timerEnd(timer);
+    }
+    if (task != nullptr)
+    {
+        vTaskDelete(task);
+    }
+#endif
+}
+
+void SamplingClock::setSampleReady(SampleReady ready, void *readyContext)
+{
+    this->ready = ready;
+    this->readyContext = readyContext;
+}
+
+bool SamplingClock::begin()
+{
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (timer != nullptr)
+    {
+        return true;
+    }
+    BaseType_t core = portNUM_PROCESSORS > 1 ? TASK_CORE : tskNO_AFFINITY;
+    if (xTaskCreatePinnedToCore(samplingLoop, "sampling", STACK_BYTES, this, TASK_PRIORITY, &task, core) != pdPASS)
+    {
+        task = nullptr;
+        return false;
+    }
+
+    timer = timerBegin(1000000); // 1 MHz: counts in microseconds
+    if (timer == nullptr)
+    {
+        vTaskDelete(task);
+        task = nullptr;
+        return false;
+    }
+    timerAttachInterruptArg(timer, onTick, this);
+
+    // The counter runs from timerBegin(); slot n is n periods after it read zero
+    ticks = 0;
+    startMicros = nowMicros() - timerRead(timer);
+    started = true;
+    timerAlarm(timer, periodMicros, true, 0);
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+void IRAM_ATTR SamplingClock::onTick(void *arg)
+{
+    SamplingClock *clock = static_cast<SamplingClock *>(arg);
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(clock->task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void SamplingClock::samplingLoop(void *parameter)
+{
+    SamplingClock *clock = static_cast<SamplingClock *>(parameter);
+    for (;;)
+    {
+        uint32_t pending = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (pending == 0)
+        {
+            continue;
+        }
+        uint64_t now = nowMicros();
+        if (clock->resumed.exchange(false, std::memory_order_acquire))
+        {
+            // Ticks stopped during light sleep; the tick lands on a slot, so round to it
+            uint64_t reached = (now - clock->startMicros + clock->periodMicros / 2) / clock->periodMicros;
+            if (reached > clock->ticks + pending)
+            {
+                pending = (uint32_t)(reached - clock->ticks);
+            }
+        }
+        // Only the latest slot is acquired; the others are already over
+        if (pending > 1)
+        {
+            clock->skippedTicks.fetch_add(pending - 1, std::memory_order_relaxed);
+        }
+        clock->ticks += pending;
+        clock->acquireSlot(clock->startMicros + clock->ticks * clock->periodMicros, now);
+    }
+}
+#endif
+
+void SamplingClock::poll()
+{
+    if (!isHardwareTimed())
+    {
+        poll(nowMicros());
+    }
+}
+
+void SamplingClock::poll(uint64_t nowMicros)
+{
+    if (!started)
+    {
+        startMicros = nowMicros;
+        ticks = 0;
+        started = true;
+    }
+
+    uint64_t slot = startMicros + ticks * periodMicros;
+    if (nowMicros < slot)
+    {
+        return;
+    }
+
+    // A loop that overslept a whole period skips to the latest slot, like the hardware path
+    uint64_t behind = (nowMicros - slot) / periodMicros;
+    if (behind > 0)
+    {
+        skippedTicks.fetch_add((uint32_t)behind, std::memory_order_relaxed);
+        ticks += behind;
+        slot += behind * periodMicros;
+    }
+    ticks++;
+    acquireSlot(slot, nowMicros);
+}
+
+void SamplingClock::acquireSlot(uint64_t slotMicros, uint64_t startedMicros)
+{
+    uint64_t late = startedMicros > slotMicros ? startedMicros - slotMicros : 0;
+    TimedSample sample;
+    sample.latenessMicros = late > LatencyHistogram::MAX_TRACKED ? LatencyHistogram::MAX_TRACKED : (uint32_t)late;
+    sample.scheduledMicros = slotMicros;
+    sample.value = acquire(context);
+
+    jitter.record(sample.latenessMicros);
+    if (samples.push(sample) && ready != nullptr)
+    {
+        ready(readyContext);
+    }
+}
+
+uint64_t SamplingClock::nowMicros()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return (uint64_t)esp_timer_get_time();
+#elif defined(ARDUINO)
+    // Other cores, the host's virtual-time core included: micros(), widened past its 32-bit wrap.
+    // Each task keeps its own epoch, as each polls its own clocks
+    static thread_local uint32_t last = 0;
+    static thread_local uint64_t epoch = 0;
+    uint32_t now = (uint32_t)micros();
+    if (now < last)
+    {
+        epoch += 1ULL << 32;
+    }
+    last = now;
+    return epoch + now;
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+void SamplingClock::resume()
+{
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (timer == nullptr)
+    {
+        return;
+    }
+    // The counter restarts from zero at every alarm: put it at the current phase of the period
+    timerWrite(timer, (nowMicros() - startMicros) % periodMicros);
+    resumed.store(true, std::memory_order_release);
+#endif
+}
+
+uint64_t SamplingClock::getNextSlotMicros() const
+{
+    uint64_t now = nowMicros();
+    if (!started)
+    {
+        return now;
+    }
+    if (!isHardwareTimed())
+    {
+        return startMicros + ticks * periodMicros;
+    }
+    // The sampling task owns ticks; the time alone says which slot comes next
+    return startMicros + ((now - startMicros) / periodMicros + 1) * periodMicros;
+}
+
+bool SamplingClock::take(TimedSample &sample)
+{
+    return samples.pop(sample);
+}
+
+bool SamplingClock::isHardwareTimed() const
+{
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    return timer != nullptr;
+#else
+    return false;
+#endif
+}
+
+uint32_t SamplingClock::getPending() const
+{
+    return samples.size();
+}
+
+uint32_t SamplingClock::getPeriodMicros() const
+{
+    return periodMicros;
+}
+
+const LatencyHistogram &SamplingClock::getJitter() const
+{
+    return jitter;
+}
+
+uint32_t SamplingClock::getSkippedTicks() const
+{
+    return skippedTicks.load(std::memory_order_relaxed);
+}
+
+uint32_t SamplingClock::getDroppedSamples() const
+{
+    return samples.getDropped();
+}
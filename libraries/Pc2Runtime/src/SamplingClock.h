@@ -0,0 +1,167 @@
+#ifndef SAMPLING_CLOCK_H
+#define SAMPLING_CLOCK_H
+
+/**
+ * @file SamplingClock.h
+ * @brief Declares the SamplingClock class and the TimedSample structure.
+ *
+ * Periodic sensor acquisition at exact periods. A hardware timer wakes a sampling task on every
+ * tick; the task runs the sensor's acquisition, stamps the result with the slot it was scheduled
+ * for and queues it, and the loop consumes completed samples with take(). Sample spacing then
+ * no longer depends on how long a loop pass takes, and filters and trends use slot times
+ * instead of the time the loop got around to reading.
+ *
+ * Without a hardware timer the same clock is loop-driven: poll() acquires when a slot is due.
+ * Both modes record how late each acquisition started after its slot, so the jitter of the two
+ * can be compared on the same sensor.
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include "LatencyHistogram.h"
+#include "SpscQueue.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <Arduino.h> // Defines ESP_ARDUINO_VERSION_MAJOR; every unit must see the same layout
+#endif
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+/**
+ * @brief One completed acquisition.
+ */
+struct TimedSample
+{
+    float value;              ///< What the acquisition returned.
+    uint64_t scheduledMicros; ///< Slot the sample belongs to: start + n * period.
+    uint32_t latenessMicros;  ///< Acquisition start after its slot (the jitter).
+};
+
+/**
+ * @brief Reads a sensor once. Runs on the sampling task when hardware-timed.
+ */
+typedef float (*Acquisition)(void *context);
+
+/**
+ * @brief Told that a sample was queued. Runs on whichever side acquired it.
+ */
+typedef void (*SampleReady)(void *context);
+
+class SamplingClock
+{
+public:
+    static const uint16_t QUEUE_CAPACITY = 32;
+    static const uint32_t STACK_BYTES = 4096;
+    static const int TASK_PRIORITY = 4; ///< Above the real-time task of DualCoreRunner (3).
+    static const int TASK_CORE = 1;     ///< APP CPU, away from the WiFi stack.
+
+private:
+    Acquisition acquire;
+    void *context;
+    SampleReady ready;
+    void *readyContext;
+    uint32_t periodMicros;
+
+    SpscQueue<TimedSample, QUEUE_CAPACITY> samples; ///< Sampling task (or poll()) to consumer.
+    LatencyHistogram jitter;                        ///< Written by whoever acquires.
+    std::atomic<uint32_t> skippedTicks;
+    uint64_t startMicros;
+    uint64_t ticks; ///< Slots acquired or skipped since start.
+    bool started;
+    std::atomic<bool> resumed; ///< Set by resume(); the next tick renumbers from the time.
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    hw_timer_t *timer;
+    TaskHandle_t task;
+
+    static void IRAM_ATTR onTick(void *arg);
+    static void samplingLoop(void *parameter);
+#endif
+
+    void acquireSlot(uint64_t slotMicros, uint64_t startedMicros);
+    static uint64_t nowMicros();
+
+public:
+    /**
+     * @brief Constructs a stopped, loop-driven clock.
+     * @param jitterName Label of the jitter histogram in reports.
+     * @param acquire Reads the sensor once.
+     * @param context Passed to acquire (usually the sensor or device).
+     * @param periodMicros Sampling period.
+     * @param jitterBudgetMicros p99 budget for how late an acquisition may start.
+     */
+    SamplingClock(const char *jitterName, Acquisition acquire, void *context,
+                  uint32_t periodMicros, uint32_t jitterBudgetMicros);
+    ~SamplingClock();
+
+    /**
+     * @brief Sets who to tell after each queued sample, so a consumer that sleeps between steps
+     *        can wake for it instead of finding it up to a period later. Call before begin().
+     * @param ready Called after each push; keep it short, it delays the next acquisition.
+     * @param readyContext Passed to ready.
+     */
+    void setSampleReady(SampleReady ready, void *readyContext);
+
+    /**
+     * @brief Starts the hardware timer and the sampling task.
+     * @return False when no timer or task is available; keep calling poll() in that case.
+     */
+    bool begin();
+
+    bool isHardwareTimed() const;
+
+    /**
+     * @brief Acquires from the caller when a slot is due. Does nothing while hardware-timed.
+     */
+    void poll();
+
+    /**
+     * @brief Same as poll(), on a clock supplied by the caller; hardware-free for simulations.
+     * @param nowMicros Current time in microseconds.
+     */
+    void poll(uint64_t nowMicros);
+
+    /**
+     * @brief Takes the oldest completed sample.
+     * @param sample Receives the sample.
+     * @return False when none is waiting.
+     */
+    bool take(TimedSample &sample);
+
+    /**
+     * @brief Realigns the hardware timer after light sleep, which stops its counter.
+     *
+     * Slots that fell inside the sleep are counted as skipped on the next tick.
+     */
+    void resume();
+
+    /**
+     * @brief Gets when the next slot is due, so an idle loop can be awake for it.
+     * @return Time in microseconds, on the same clock as micros().
+     */
+    uint64_t getNextSlotMicros() const;
+
+    uint32_t getPending() const;
+    uint32_t getPeriodMicros() const;
+
+    /**
+     * @brief Gets how late acquisitions started after their slot.
+     * @return Histogram written by the sampling side; reads from the loop are approximate.
+     */
+    const LatencyHistogram &getJitter() const;
+
+    /**
+     * @brief Gets the slots that passed while an acquisition was still running, or before poll().
+     */
+    uint32_t getSkippedTicks() const;
+
+    /**
+     * @brief Gets the samples lost because the consumer fell behind.
+     */
+    uint32_t getDroppedSamples() const;
+};
+
+#endif // SAMPLING_CLOCK_H
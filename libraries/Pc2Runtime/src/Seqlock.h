@@ -0,0 +1,114 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+/**
+ * @file Seqlock.h
+ * @brief Declares the Seqlock class template.
+ *
+ * Holds the latest value of a read model for one writer task and any number of reader tasks.
+ * The writer never waits: it makes the sequence odd, stores the value and makes the sequence
+ * even again. A reader copies the value between two loads of the sequence and retries when a
+ * write overlapped, so every read is one consistent version, in O(1) and without locking.
+ *
+ * The value is stored as relaxed atomic words, so an overlapping copy is a defined (if
+ * discarded) read rather than a data race.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied word by word");
+
+private:
+    static const size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence; ///< Odd while a write is in progress.
+    std::atomic<uint32_t> words[WORDS];
+    mutable std::atomic<uint32_t> retries; ///< Reads that overlapped a write.
+
+public:
+    Seqlock() : sequence(0), retries(0)
+    {
+        write(T());
+    }
+
+    /**
+     * @brief Publishes a new version. Writer task only.
+     * @param value The new value.
+     */
+    void write(const T &value)
+    {
+        uint32_t buffer[WORDS] = {};
+        memcpy(buffer, &value, sizeof(T));
+
+        uint32_t s = sequence.load(std::memory_order_relaxed);
+        sequence.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++)
+        {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the latest version. Any task; spins only while a write overlaps.
+     * @param value Receives the value.
+     */
+    void read(T &value) const
+    {
+        uint32_t buffer[WORDS];
+        for (;;)
+        {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0)
+            {
+                for (size_t i = 0; i < WORDS; i++)
+                {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before)
+                {
+                    memcpy(&value, buffer, sizeof(T));
+                    return;
+                }
+            }
+            retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Copies the latest version.
+     * @return The value.
+     */
+    T read() const
+    {
+        T value;
+        read(value);
+        return value;
+    }
+
+    /**
+     * @brief Gets how many versions have been written, so a reader can skip unchanged ones.
+     */
+    uint32_t getVersion() const
+    {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    /**
+     * @brief Gets the reads that had to retry because a write overlapped them.
+     */
+    uint32_t getRetries() const
+    {
+        return retries.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // SEQLOCK_H
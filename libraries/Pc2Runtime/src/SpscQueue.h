@@ -0,0 +1,97 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+/**
+ * @file SpscQueue.h
+ * @brief Declares the SpscQueue class template.
+ *
+ * Bounded lock-free queue for exactly one producer task and one consumer task, used to hand
+ * events, commands and snapshots from one core to the other. Each index is written by one side
+ * only, so push and pop never lock or block; release/acquire ordering on the indices publishes
+ * a slot's contents together with the index that exposes it.
+ */
+
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, uint16_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+private:
+    static const uint32_t MASK = CAPACITY - 1;
+
+    T slots[CAPACITY];
+    std::atomic<uint32_t> head;    ///< Next slot to read; written by the consumer only.
+    std::atomic<uint32_t> tail;    ///< Next slot to write; written by the producer only.
+    std::atomic<uint32_t> dropped; ///< Pushes rejected because the queue was full.
+
+public:
+    SpscQueue() : slots(), head(0), tail(0), dropped(0) {}
+
+    /**
+     * @brief Appends a value. Producer side only.
+     * @param value Value to copy into the queue.
+     * @return False, counting a drop, when the queue is full.
+     */
+    bool push(const T &value)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == CAPACITY)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[t & MASK] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest value. Consumer side only.
+     * @param value Receives the value.
+     * @return False when the queue is empty.
+     */
+    bool pop(T &value)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = slots[h & MASK];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Drains the queue, keeping only the newest value. Consumer side only.
+     * @param value Receives the newest value; untouched when the queue is empty.
+     * @return True if at least one value was taken.
+     */
+    bool popLatest(T &value)
+    {
+        bool any = false;
+        while (pop(value))
+        {
+            any = true;
+        }
+        return any;
+    }
+
+    /**
+     * @brief Gets the number of queued values; exact only from the producer or consumer.
+     */
+    uint32_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    uint32_t getDropped() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // SPSC_QUEUE_H
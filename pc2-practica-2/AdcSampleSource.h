@@ -0,0 +1,34 @@
+#ifndef ADC_SAMPLE_SOURCE_H
+#define ADC_SAMPLE_SOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class SamplingClock;
+
+// Supplier of raw 12-bit conversions for GasAdcFrontEnd. Neither call may
+// wait for the converter: available() reports what can be handed over right
+// now and read() copies at most that many conversions. Free of Arduino
+// headers, so the front end runs on a host with fake sources; the ESP32
+// sources are in AdcSources.h.
+class AdcSampleSource
+{
+public:
+    virtual void begin() = 0;
+    virtual size_t available() const = 0;
+    virtual size_t read(uint16_t *dst, size_t maxSamples) = 0;
+    // True when conversions continue between calls, so the clocks must too
+    virtual bool runsInBackground() const { return false; }
+    // When the next conversion is due, for sources the loop must be awake for
+    virtual bool getNextSampleDue(unsigned long &dueMicros) const { return false; }
+    // Called after light sleep stopped the peripheral clocks
+    virtual void resume() {}
+    // Called once per poll before available(); loop-driven sources acquire here
+    virtual void service() {}
+    // Time of the last conversion read(), for sources that sample on a clock
+    virtual bool getSampleTime(unsigned long &timestampMillis) const { return false; }
+    virtual const SamplingClock *getClock() const { return nullptr; }
+    virtual ~AdcSampleSource() = default;
+};
+
+#endif
@@ -0,0 +1,202 @@
+#include "AdcSources.h"
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+#include <esp_adc/adc_continuous.h>
+#endif
+
+PolledAdcSource::PolledAdcSource(int pin, size_t burstSize)
+    : pin(pin), burstSize(burstSize) {}
+
+void PolledAdcSource::begin()
+{
+    pinMode(pin, INPUT);
+}
+
+size_t PolledAdcSource::available() const
+{
+    // One burst per poll keeps the loop cost bounded
+    return burstSize;
+}
+
+size_t PolledAdcSource::read(uint16_t *dst, size_t maxSamples)
+{
+    size_t count = maxSamples < burstSize ? maxSamples : burstSize;
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = analogRead(pin);
+    }
+    return count;
+}
+
+ClockedAdcSource::ClockedAdcSource(int pin, uint32_t periodMicros)
+    : pin(pin), clock("ADC jitter", acquire, this, periodMicros, JITTER_BUDGET_US),
+      lastSampleMillis(0), sampled(false) {}
+
+float ClockedAdcSource::acquire(void *context)
+{
+    return analogRead(static_cast<ClockedAdcSource *>(context)->pin);
+}
+
+void ClockedAdcSource::begin()
+{
+    pinMode(pin, INPUT);
+    if (!clock.begin())
+    {
+        Serial.println("ADC sampling timer unavailable, sampling from the loop");
+    }
+}
+
+void ClockedAdcSource::service()
+{
+    clock.poll();
+}
+
+size_t ClockedAdcSource::available() const
+{
+    return clock.getPending();
+}
+
+size_t ClockedAdcSource::read(uint16_t *dst, size_t maxSamples)
+{
+    size_t count = 0;
+    TimedSample sample;
+    while (count < maxSamples && clock.take(sample))
+    {
+        dst[count++] = (uint16_t)sample.value;
+        // Same wrap as millis(), which esp_timer also drives
+        lastSampleMillis = (unsigned long)(sample.scheduledMicros / 1000);
+        sampled = true;
+    }
+    return count;
+}
+
+bool ClockedAdcSource::getNextSampleDue(unsigned long &dueMicros) const
+{
+    // The timer stops in light sleep: wake just ahead of each slot instead of
+    // holding the CPU awake. Same wrap as micros(), which esp_timer also drives
+    dueMicros = (unsigned long)(clock.getNextSlotMicros() - WAKE_LEAD_US);
+    return true;
+}
+
+void ClockedAdcSource::resume()
+{
+    clock.resume();
+}
+
+bool ClockedAdcSource::getSampleTime(unsigned long &timestampMillis) const
+{
+    timestampMillis = lastSampleMillis;
+    return sampled;
+}
+
+const SamplingClock *ClockedAdcSource::getClock() const
+{
+    return &clock;
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+
+uint16_t ContinuousAdcSource::ring[RING_SIZE];
+std::atomic<size_t> ContinuousAdcSource::head(0);
+std::atomic<size_t> ContinuousAdcSource::tail(0);
+std::atomic<uint32_t> ContinuousAdcSource::overruns(0);
+TaskHandle_t ContinuousAdcSource::drainTask = nullptr;
+
+void ARDUINO_ISR_ATTR ContinuousAdcSource::onFrameComplete()
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(drainTask, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void ContinuousAdcSource::drainLoop(void *parameter)
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        adc_continuous_data_t *result = nullptr;
+        if (!analogContinuousRead(&result, 0))
+        {
+            continue;
+        }
+
+        size_t at = head.load(std::memory_order_relaxed);
+        size_t next = (at + 1) % RING_SIZE;
+        if (next == tail.load(std::memory_order_acquire))
+        {
+            // Loop fell behind; the producer never touches tail
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        ring[at] = result[0].avg_read_raw;
+        head.store(next, std::memory_order_release);
+    }
+}
+
+ContinuousAdcSource::ContinuousAdcSource(uint8_t pin, uint32_t conversionRateHz)
+    : pin(pin), conversionRateHz(conversionRateHz) {}
+
+ContinuousAdcSource::~ContinuousAdcSource()
+{
+    analogContinuousStop();
+    analogContinuousDeinit();
+    if (drainTask != nullptr)
+    {
+        vTaskDelete(drainTask);
+        drainTask = nullptr;
+    }
+}
+
+void ContinuousAdcSource::begin()
+{
+    xTaskCreate(drainLoop, "adc-drain", 2048, nullptr, configMAX_PRIORITIES - 2, &drainTask);
+
+    uint8_t pins[] = {pin};
+    analogContinuousSetWidth(12);
+    analogContinuous(pins, 1, CONVERSIONS_PER_FRAME, conversionRateHz, &onFrameComplete);
+    analogContinuousStart();
+}
+
+size_t ContinuousAdcSource::available() const
+{
+    return (head.load(std::memory_order_acquire) + RING_SIZE - tail.load(std::memory_order_relaxed)) % RING_SIZE;
+}
+
+size_t ContinuousAdcSource::read(uint16_t *dst, size_t maxSamples)
+{
+    size_t count = 0;
+    size_t at = tail.load(std::memory_order_relaxed);
+    size_t end = head.load(std::memory_order_acquire);
+    while (count < maxSamples && at != end)
+    {
+        dst[count++] = ring[at];
+        at = (at + 1) % RING_SIZE;
+    }
+    // Hands the slots back only after they were copied
+    tail.store(at, std::memory_order_release);
+    return count;
+}
+
+uint32_t ContinuousAdcSource::getOverruns() const
+{
+    return overruns.load(std::memory_order_relaxed);
+}
+
+bool ContinuousAdcSource::supportsPin(uint8_t pin)
+{
+    // The classic ESP32 digital controller only drives ADC1
+    adc_unit_t unit;
+    adc_channel_t channel;
+    if (adc_continuous_io_to_channel(pin, &unit, &channel) != ESP_OK)
+    {
+        return false;
+    }
+#if CONFIG_IDF_TARGET_ESP32
+    return unit == ADC_UNIT_1;
+#else
+    return true;
+#endif
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef ADC_SOURCES_H
+#define ADC_SOURCES_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "AdcSampleSource.h"
+#include "SamplingClock.h"
+
+// Fallback for cores without the continuous driver or the timer API.
+// Takes a short burst of analogRead() conversions per call.
+class PolledAdcSource : public AdcSampleSource
+{
+private:
+    int pin;
+    size_t burstSize;
+
+public:
+    PolledAdcSource(int pin, size_t burstSize = 16);
+    void begin() override;
+    size_t available() const override;
+    size_t read(uint16_t *dst, size_t maxSamples) override;
+};
+
+// One conversion per SamplingClock slot, for pins the continuous driver
+// cannot reach. Conversions are evenly spaced whatever the loop does and
+// carry their slot time, so the decimated blocks do too.
+class ClockedAdcSource : public AdcSampleSource
+{
+private:
+    int pin;
+    SamplingClock clock;
+    unsigned long lastSampleMillis;
+    bool sampled;
+
+    static float acquire(void *context);
+
+public:
+    static const uint32_t DEFAULT_PERIOD_US = 6250;   // 160 Hz: 10 blocks/s at 16x oversampling
+    static const uint32_t JITTER_BUDGET_US = 500;
+    static const uint32_t WAKE_LEAD_US = 1000;        // Light-sleep exit latency plus margin
+
+    ClockedAdcSource(int pin, uint32_t periodMicros = DEFAULT_PERIOD_US);
+    void begin() override;
+    void service() override;
+    size_t available() const override;
+    size_t read(uint16_t *dst, size_t maxSamples) override;
+    bool getNextSampleDue(unsigned long &dueMicros) const override;
+    void resume() override;
+    bool getSampleTime(unsigned long &timestampMillis) const override;
+    const SamplingClock *getClock() const override;
+};
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// DMA-backed continuous conversion through the ESP32 ADC digital controller.
+// The driver fills its frames in the background and reduces each one to a
+// hardware-averaged sample; a small drain task moves those into a ring that
+// the loop empties through read(). Only one instance may exist.
+class ContinuousAdcSource : public AdcSampleSource
+{
+private:
+    static const size_t RING_SIZE = 128;
+
+    uint8_t pin;
+    uint32_t conversionRateHz;
+    // Drain task writes head and the slot before it, the loop writes tail:
+    // release on the writer's index, acquire on the other side's
+    static uint16_t ring[RING_SIZE];
+    static std::atomic<size_t> head;
+    static std::atomic<size_t> tail;
+    static std::atomic<uint32_t> overruns;
+    static TaskHandle_t drainTask;
+
+    static void onFrameComplete();
+    static void drainLoop(void *parameter);
+
+public:
+    static const uint32_t CONVERSIONS_PER_FRAME = 16;
+
+    ContinuousAdcSource(uint8_t pin, uint32_t conversionRateHz = 8000);
+    ~ContinuousAdcSource();
+    void begin() override;
+    size_t available() const override;
+    size_t read(uint16_t *dst, size_t maxSamples) override;
+    bool runsInBackground() const override { return true; }
+
+    uint32_t getOverruns() const;
+
+    static bool supportsPin(uint8_t pin);
+};
+#endif
+
+#endif
@@ -1,13 +1,21 @@
 #include "DisplayManager.h"
 #include <Arduino.h>
 
-DisplayManager::DisplayManager(uint8_t address) : lastUpdate(0)
+const Command DisplayManager::REFRESH_COMMAND = Command(REFRESH_COMMAND_ID);
+const Command DisplayManager::CLEAR_COMMAND = Command(CLEAR_COMMAND_ID);
+
+DisplayManager::DisplayManager(uint8_t address, I2cBusManager *bus, CommandHandler *commandHandler)
+    // I2C device: no GPIO of its own
+    : Actuator(-1, commandHandler), bus(bus), address(address), lastUpdate(0), lastFlushMicros(0),
+      shownValid(false), redrawCount(0), skippedCount(0)
 {
     lcd = new LiquidCrystal_I2C(address, COLS, ROWS);
+    lcdSink = new Pcf8574LcdSink(bus, address);
 }
 
 DisplayManager::~DisplayManager()
 {
+    delete lcdSink;
     delete lcd;
 }
 
@@ -16,38 +24,55 @@ void DisplayManager::initialize()
     lcd->init();
     lcd->begin(COLS, ROWS);
     lcd->backlight();
-    clear();
+
+    // The only hardware clear; from here on the frame buffer knows the screen
+    // and every update goes through the bus manager queue
+    lcd->clear();
+    frame.assumeBlank();
+    frame.clear();
+    bus->negotiateClock(address, Pcf8574LcdSink::MAX_CLOCK_HZ);
 }
 
 void DisplayManager::showStartupMessage()
 {
-    clear();
-    lcd->setCursor(2, 1);
-    lcd->print("GLP SecureSense Pro");
-    lcd->setCursor(4, 2);
-    lcd->print("Protech Innovations");
+    shownValid = false;
+    frame.clear();
+    frame.printAt(2, 1, "GLP SecureSense Pro");
+    frame.printAt(4, 2, "Protech Innovations");
+    flush(true);
     delay(2000);
 
-    clear();
-    lcd->setCursor(6, 1);
-    lcd->print("Initializing");
-    lcd->setCursor(7, 2);
-    lcd->print("System...");
+    frame.clear();
+    frame.printAt(6, 1, "Initializing");
+    frame.printAt(7, 2, "System...");
+    flush(true);
     delay(1000);
 }
 
 void DisplayManager::showCalibrationStatus(float r0Value)
 {
-    clear();
-    lcd->setCursor(4, 1);
-    lcd->print("Calibrating...");
-    lcd->setCursor(2, 2);
-    lcd->print("R0 = ");
-    lcd->print(r0Value, 2);
+    shownValid = false;
+    frame.clear();
+    frame.printAt(4, 1, "Calibrating...");
+    line.clear();
+    line.append("R0 = ").appendFixed(r0Value, 2);
+    frame.printAt(2, 2, line.c_str());
+    flush(true);
     delay(1000);
 }
 
-void DisplayManager::updateDisplay(float ppm, int percentage, GasLevel level, String status)
+bool DisplayManager::isUpdateDue() const
+{
+    return millis() - lastUpdate >= UPDATE_INTERVAL;
+}
+
+unsigned long DisplayManager::millisUntilUpdate() const
+{
+    unsigned long elapsed = millis() - lastUpdate;
+    return elapsed >= UPDATE_INTERVAL ? 0 : UPDATE_INTERVAL - elapsed;
+}
+
+void DisplayManager::updateDisplay(const GasReading &reading, const char *status)
 {
     unsigned long currentTime = millis();
     if (currentTime - lastUpdate < UPDATE_INTERVAL)
@@ -55,86 +80,164 @@ void DisplayManager::updateDisplay(float ppm, int percentage, GasLevel level, St
         return;
     }
 
-    clear();
+    lastUpdate = currentTime;
+
+    // A transfer that failed since the last flush left the screen unknown
+    if (lcdSink->takeLost())
+    {
+        frame.invalidate();
+        shownValid = false;
+    }
+
+    if (!captureShownValues(reading, status))
+    {
+        skippedCount++;
+        return;
+    }
+
+    frame.clear();
     displayHeader();
-    displayGasData(ppm, percentage);
-    displayStatus(level, status);
+    displayGasData();
+    displayStatus();
     displayTimestamp();
-
-    lastUpdate = currentTime;
+    flush();
+    redrawCount++;
 }
 
-void DisplayManager::showErrorMessage(String error)
+void DisplayManager::showErrorMessage(const char *error)
 {
-    clear();
-    lcd->setCursor(0, 1);
-    lcd->print("ERROR:");
-    lcd->setCursor(0, 2);
-    lcd->print(error);
+    shownValid = false;
+    frame.clear();
+    frame.printAt(0, 1, "ERROR:");
+    frame.printAt(0, 2, error);
+    flush();
 }
 
 void DisplayManager::clear()
 {
-    lcd->clear();
+    shownValid = false;
+    frame.clear();
+    flush();
 }
 
-void DisplayManager::displayHeader()
+void DisplayManager::handle(Command command)
 {
-    lcd->setCursor(0, 0);
-    lcd->print("=== GLP MONITOR ===");
+    if (command == REFRESH_COMMAND)
+    {
+        // Redraw everything on the next update, e.g. after an LCD glitch
+        shownValid = false;
+        lastUpdate = millis() - UPDATE_INTERVAL;
+        frame.invalidate();
+    }
+    else if (command == CLEAR_COMMAND)
+    {
+        clear();
+    }
+    Actuator::handle(command);
 }
 
-void DisplayManager::displayGasData(float ppm, int percentage)
+uint16_t DisplayManager::getLastFlushBytes() const
 {
-    lcd->setCursor(0, 1);
-    lcd->print("LPG: ");
-    lcd->print(formatPPM(ppm));
-    lcd->print(" PPM");
+    return frame.getLastFlushBytes();
+}
 
-    lcd->setCursor(0, 2);
-    lcd->print("Level: ");
-    lcd->print(percentage);
-    lcd->print("%");
+unsigned long DisplayManager::getLastFlushMicros() const
+{
+    return lastFlushMicros;
 }
 
-void DisplayManager::displayStatus(GasLevel level, String status)
+uint32_t DisplayManager::getTotalFlushBytes() const
 {
-    lcd->setCursor(0, 3);
-    lcd->print("Status: ");
-    lcd->print(getLevelIndicator(level));
-    lcd->print(" ");
-    lcd->print(status);
+    return frame.getTotalFlushBytes();
 }
 
-void DisplayManager::displayTimestamp()
+uint32_t DisplayManager::getRedrawCount() const
 {
-    unsigned long seconds = millis() / 1000;
-    unsigned long minutes = seconds / 60;
-    seconds = seconds % 60;
+    return redrawCount;
+}
 
-    lcd->setCursor(14, 1);
-    if (minutes < 10)
-        lcd->print("0");
-    lcd->print(minutes);
-    lcd->print(":");
-    if (seconds < 10)
-        lcd->print("0");
-    lcd->print(seconds);
+uint32_t DisplayManager::getSkippedCount() const
+{
+    return skippedCount;
 }
 
-String DisplayManager::formatPPM(float ppm)
+void DisplayManager::flush(bool waitForBus)
 {
-    if (ppm < 1000)
+    // Measures what the caller pays: encoding and enqueueing, not the wire
+    unsigned long start = micros();
+    frame.flush(*lcdSink);
+    lastFlushMicros = micros() - start;
+
+    // flush() already took the rows as shown; if the queue refused some of
+    // them, forget the screen so the next update rewrites it all
+    if (lcdSink->takeLost())
     {
-        return String((int)ppm);
+        frame.invalidate();
+        shownValid = false;
     }
-    else
+
+    if (waitForBus)
+    {
+        bus->waitIdle(200);
+    }
+}
+
+bool DisplayManager::captureShownValues(const GasReading &reading, const char *status)
+{
+    FixedText<8> ppmText;
+    ppmText.appendKilo(reading.ppm);
+    unsigned long seconds = millis() / 1000;
+
+    if (shownValid && strcmp(ppmText.c_str(), shown.ppmText.c_str()) == 0 &&
+        reading.percentage == shown.percentage && reading.level == shown.level &&
+        status == shown.status && seconds == shown.seconds)
     {
-        return String(ppm / 1000.0, 1) + "K";
+        return false;
     }
+
+    shown.ppmText = ppmText;
+    shown.percentage = reading.percentage;
+    shown.level = reading.level;
+    shown.status = status;
+    shown.seconds = seconds;
+    shownValid = true;
+    return true;
+}
+
+void DisplayManager::displayHeader()
+{
+    frame.printAt(0, 0, "=== GLP MONITOR ===");
+}
+
+void DisplayManager::displayGasData()
+{
+    line.clear();
+    line.append("LPG: ").append(shown.ppmText.c_str()).append(" PPM");
+    frame.printAt(0, 1, line.c_str());
+
+    line.clear();
+    line.append("Level: ").appendInt(shown.percentage).append('%');
+    frame.printAt(0, 2, line.c_str());
+}
+
+void DisplayManager::displayStatus()
+{
+    line.clear();
+    line.append("Status: ").append(getLevelIndicator(shown.level)).append(' ').append(shown.status);
+    frame.printAt(0, 3, line.c_str());
+}
+
+void DisplayManager::displayTimestamp()
+{
+    unsigned long minutes = shown.seconds / 60;
+    unsigned long seconds = shown.seconds % 60;
+
+    line.clear();
+    line.appendInt<2>(minutes, TextAlign::RIGHT, '0').append(':').appendInt<2>(seconds, TextAlign::RIGHT, '0');
+    frame.printAt(14, 1, line.c_str());
 }
 
-String DisplayManager::getLevelIndicator(GasLevel level)
+const char *DisplayManager::getLevelIndicator(GasLevel level)
 {
     switch (level)
     {
@@ -2,35 +2,75 @@
 #define DISPLAY_MANAGER_H
 
 #include <LiquidCrystal_I2C.h>
+#include "Actuator.h"
 #include "GasSensor.h"
+#include "LcdFrameBuffer.h"
+#include "Pcf8574LcdSink.h"
+#include "FixedText.h"
 
-class DisplayManager
+// The values currently on screen, in the exact form they were rendered. A
+// reading that renders the same way causes no frame work and no bus traffic.
+struct ShownValues
+{
+    FixedText<8> ppmText;
+    int percentage;
+    GasLevel level;
+    const char *status;
+    unsigned long seconds;
+};
+
+class DisplayManager : public Actuator
 {
 private:
-    LiquidCrystal_I2C *lcd;
-    static const int ROWS = 4;
-    static const int COLS = 20;
+    LiquidCrystal_I2C *lcd; // Start-up initialization only
+    I2cBusManager *bus;
+    Pcf8574LcdSink *lcdSink;
+    uint8_t address;
+    LcdFrameBuffer frame;
+    FixedText<LcdFrameBuffer::COLS + 1> line;
+    static const int ROWS = LcdFrameBuffer::ROWS;
+    static const int COLS = LcdFrameBuffer::COLS;
     unsigned long lastUpdate;
+    unsigned long lastFlushMicros;
+    ShownValues shown;
+    bool shownValid;
+    uint32_t redrawCount;
+    uint32_t skippedCount;
     static const unsigned long UPDATE_INTERVAL = 500;
 
 public:
-    DisplayManager(uint8_t address);
+    static const int REFRESH_COMMAND_ID = 30;
+    static const int CLEAR_COMMAND_ID = 31;
+    static const Command REFRESH_COMMAND;
+    static const Command CLEAR_COMMAND;
+
+    DisplayManager(uint8_t address, I2cBusManager *bus, CommandHandler *commandHandler = nullptr);
     ~DisplayManager();
 
     void initialize();
     void showStartupMessage();
     void showCalibrationStatus(float r0Value);
-    void updateDisplay(float ppm, int percentage, GasLevel level, String status);
-    void showErrorMessage(String error);
+    bool isUpdateDue() const;
+    unsigned long millisUntilUpdate() const;
+    void updateDisplay(const GasReading &reading, const char *status);
+    void showErrorMessage(const char *error);
     void clear();
+    void handle(Command command) override;
+
+    uint16_t getLastFlushBytes() const;
+    unsigned long getLastFlushMicros() const;
+    uint32_t getTotalFlushBytes() const;
+    uint32_t getRedrawCount() const;
+    uint32_t getSkippedCount() const;
 
 private:
+    void flush(bool waitForBus = false);
+    bool captureShownValues(const GasReading &reading, const char *status);
     void displayHeader();
-    void displayGasData(float ppm, int percentage);
-    void displayStatus(GasLevel level, String status);
+    void displayGasData();
+    void displayStatus();
     void displayTimestamp();
-    String formatPPM(float ppm);
-    String getLevelIndicator(GasLevel level);
+    const char *getLevelIndicator(GasLevel level);
 };
 
 #endif
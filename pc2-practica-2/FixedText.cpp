@@ -0,0 +1,125 @@
+#include "FixedText.h"
+
+namespace text_format
+{
+    size_t formatInt(char *dst, size_t capacity, long value)
+    {
+        if (capacity == 0)
+        {
+            return 0;
+        }
+
+        char digits[21];
+        size_t count = 0;
+        unsigned long magnitude = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+        do
+        {
+            digits[count++] = '0' + magnitude % 10;
+            magnitude /= 10;
+        } while (magnitude > 0);
+
+        size_t length = 0;
+        if (value < 0 && length < capacity - 1)
+        {
+            dst[length++] = '-';
+        }
+        while (count > 0 && length < capacity - 1)
+        {
+            dst[length++] = digits[--count];
+        }
+        dst[length] = '\0';
+        return length;
+    }
+
+    size_t formatFixed(char *dst, size_t capacity, float value, uint8_t decimals)
+    {
+        if (capacity == 0)
+        {
+            return 0;
+        }
+        if (decimals > 6)
+        {
+            decimals = 6;
+        }
+
+        long scale = 1;
+        for (uint8_t i = 0; i < decimals; i++)
+        {
+            scale *= 10;
+        }
+
+        bool negative = value < 0;
+        float magnitude = negative ? -value : value;
+        unsigned long scaled = (unsigned long)(magnitude * scale + 0.5f);
+        unsigned long whole = scaled / scale;
+        unsigned long fraction = scaled % scale;
+
+        size_t length = 0;
+        if (negative && scaled != 0 && length < capacity - 1)
+        {
+            dst[length++] = '-';
+        }
+        length += formatInt(dst + length, capacity - length, (long)whole);
+
+        if (decimals > 0 && length < capacity - 1)
+        {
+            dst[length++] = '.';
+            for (long place = scale / 10; place > 0 && length < capacity - 1; place /= 10)
+            {
+                dst[length++] = '0' + (fraction / place) % 10;
+            }
+        }
+        dst[length] = '\0';
+        return length;
+    }
+
+    size_t formatKilo(char *dst, size_t capacity, float value)
+    {
+        if (value < 1000)
+        {
+            return formatInt(dst, capacity, (long)value);
+        }
+
+        size_t length = formatFixed(dst, capacity, value / 1000.0f, 1);
+        if (length < capacity - 1)
+        {
+            dst[length++] = 'K';
+            dst[length] = '\0';
+        }
+        return length;
+    }
+
+    size_t pad(char *dst, size_t capacity, size_t length, uint8_t width, TextAlign align, char fill)
+    {
+        if (width >= capacity)
+        {
+            width = capacity - 1;
+        }
+        if (length >= width)
+        {
+            return length;
+        }
+
+        size_t gap = width - length;
+        if (align == TextAlign::RIGHT)
+        {
+            for (size_t i = length + 1; i-- > 0;)
+            {
+                dst[i + gap] = dst[i];
+            }
+            for (size_t i = 0; i < gap; i++)
+            {
+                dst[i] = fill;
+            }
+        }
+        else
+        {
+            for (size_t i = length; i < width; i++)
+            {
+                dst[i] = fill;
+            }
+            dst[width] = '\0';
+        }
+        return width;
+    }
+}
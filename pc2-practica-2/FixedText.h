@@ -0,0 +1,123 @@
+#ifndef FIXED_TEXT_H
+#define FIXED_TEXT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum class TextAlign
+{
+    LEFT,
+    RIGHT
+};
+
+// Formatting primitives over caller-provided storage. They never allocate,
+// always NUL-terminate and truncate instead of overflowing; the return value
+// is the number of characters written.
+namespace text_format
+{
+    size_t formatInt(char *dst, size_t capacity, long value);
+    size_t formatFixed(char *dst, size_t capacity, float value, uint8_t decimals);
+    // Below 1000 as an integer, otherwise thousands with one decimal and "K"
+    size_t formatKilo(char *dst, size_t capacity, float value);
+    size_t pad(char *dst, size_t capacity, size_t length, uint8_t width, TextAlign align, char fill);
+}
+
+// Fixed-capacity, NUL-terminated text buffer for display and log lines.
+// Field widths are template arguments so an impossible layout (a field wider
+// than the whole buffer) fails to compile instead of truncating at runtime.
+template <size_t N>
+class FixedText
+{
+    static_assert(N > 1, "FixedText needs room for at least one character");
+
+private:
+    char data[N];
+    size_t length;
+
+    template <uint8_t WIDTH>
+    FixedText &appendField(const char *field, size_t fieldLength, TextAlign align, char fill)
+    {
+        static_assert(WIDTH < N, "field width exceeds FixedText capacity");
+        char padded[WIDTH > 0 ? WIDTH + 1 : 1];
+        if (WIDTH == 0 || fieldLength >= WIDTH)
+        {
+            return append(field);
+        }
+        for (size_t i = 0; i <= fieldLength; i++)
+        {
+            padded[i] = field[i];
+        }
+        text_format::pad(padded, sizeof(padded), fieldLength, WIDTH, align, fill);
+        return append(padded);
+    }
+
+public:
+    FixedText() : length(0) { data[0] = '\0'; }
+
+    void clear()
+    {
+        length = 0;
+        data[0] = '\0';
+    }
+
+    FixedText &append(const char *text)
+    {
+        while (*text && length < N - 1)
+        {
+            data[length++] = *text++;
+        }
+        data[length] = '\0';
+        return *this;
+    }
+
+    FixedText &append(char c)
+    {
+        if (length < N - 1)
+        {
+            data[length++] = c;
+            data[length] = '\0';
+        }
+        return *this;
+    }
+
+    template <uint8_t WIDTH = 0>
+    FixedText &appendInt(long value, TextAlign align = TextAlign::RIGHT, char fill = ' ')
+    {
+        char field[21];
+        size_t fieldLength = text_format::formatInt(field, sizeof(field), value);
+        return appendField<WIDTH>(field, fieldLength, align, fill);
+    }
+
+    template <uint8_t WIDTH = 0>
+    FixedText &appendFixed(float value, uint8_t decimals, TextAlign align = TextAlign::RIGHT, char fill = ' ')
+    {
+        char field[20];
+        size_t fieldLength = text_format::formatFixed(field, sizeof(field), value, decimals);
+        return appendField<WIDTH>(field, fieldLength, align, fill);
+    }
+
+    template <uint8_t WIDTH = 0>
+    FixedText &appendKilo(float value, TextAlign align = TextAlign::RIGHT, char fill = ' ')
+    {
+        char field[20];
+        size_t fieldLength = text_format::formatKilo(field, sizeof(field), value);
+        return appendField<WIDTH>(field, fieldLength, align, fill);
+    }
+
+    template <uint8_t WIDTH>
+    FixedText &appendPadded(const char *text, TextAlign align = TextAlign::LEFT, char fill = ' ')
+    {
+        size_t textLength = 0;
+        while (text[textLength])
+        {
+            textLength++;
+        }
+        return appendField<WIDTH>(text, textLength, align, fill);
+    }
+
+    const char *c_str() const { return data; }
+    size_t size() const { return length; }
+    static constexpr size_t capacity() { return N - 1; }
+};
+
+#endif
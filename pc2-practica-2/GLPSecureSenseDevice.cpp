@@ -1,18 +1,40 @@
 #include "GLPSecureSenseDevice.h"
+#include "SamplingClock.h"
 #include <Arduino.h>
 
-GLPSecureSenseDevice::GLPSecureSenseDevice() : lastSerialOutput(0)
+GLPSecureSenseDevice::GLPSecureSenseDevice()
+    : alarmLatchSeen(false), lastSerialOutput(0), lastHistoryRecord(0),
+      criticalToLedLatency("critical->LED", CRITICAL_TO_LED_BUDGET_US),
+      d0ConfirmLatency("D0 confirm", D0_CONFIRM_BUDGET_US), passStartMicros(0),
+      loopBudget(LOOP_BUDGET_US, MAX_DEFER_US),
+      runner(realTimeStep, ioStep, this, REAL_TIME_PERIOD_US, IO_PERIOD_US, LATENESS_BUDGET_US),
+      projected(), projectionChanged(true), shown(), power(ACTIVE_MA, IDLE_MA, SLEEP_MA, HEATER_MA)
 {
-    gasSensor = new GasSensor(GAS_ANALOG_PIN, GAS_DIGITAL_PIN);
+    gasSensor = new GasSensor(GAS_ANALOG_PIN, GAS_DIGITAL_PIN, this);
+    // Outputs get no command handler: handle() routes commands down to them,
+    // and propagating back up to the device would loop
     ledIndicator = new LedIndicator(GREEN_LED_PIN, YELLOW_LED_PIN, RED_LED_PIN);
-    displayManager = new DisplayManager(LCD_ADDRESS);
+    i2cBus = new I2cBusManager();
+    displayManager = new DisplayManager(LCD_ADDRESS, i2cBus);
+    alarmLatch = new GasAlarmLatch(GAS_DIGITAL_PIN, RED_LED_PIN, GAS_SHUTOFF_PIN);
+#if defined(ARDUINO_ARCH_ESP32)
+    historyStorage = new LittleFsSegmentStorage("/history");
+#else
+    historyStorage = nullptr;
+#endif
+    history = new GasHistory(historyStorage);
 }
 
 GLPSecureSenseDevice::~GLPSecureSenseDevice()
 {
+    runner.stop();
     delete gasSensor;
     delete ledIndicator;
     delete displayManager;
+    delete alarmLatch;
+    delete i2cBus;
+    delete history;
+    delete historyStorage;
 }
 
 void GLPSecureSenseDevice::initialize()
@@ -23,7 +45,8 @@ void GLPSecureSenseDevice::initialize()
     Serial.println("Protech Innovations, Inc.");
     Serial.println("Initializing components...");
 
-    // Initialize display and show startup message
+    // Initialize the shared I2C bus, then the display on it
+    i2cBus->begin();
     displayManager->initialize();
     displayManager->showStartupMessage();
 
@@ -39,20 +62,262 @@ void GLPSecureSenseDevice::initialize()
     // Calibrate sensor
     calibrateSensor();
 
+    // Reading history; without flash only the open segment is kept, in RAM
+    if (history->begin())
+    {
+        Serial.print("History: ");
+        Serial.print(history->getStoredSegments());
+        Serial.print(" segments on flash, log clock resumes at ");
+        Serial.print(history->getLastTime());
+        Serial.println(" s");
+    }
+    else
+    {
+        Serial.println("History storage unavailable, keeping recent readings in RAM only");
+    }
+
+    // Arm the D0 fast path once the LED test no longer drives the pins
+    alarmLatch->initialize();
+    power.addWakePin(GAS_DIGITAL_PIN, true, GasAlarmLatch::onWake);
+
     Serial.println("System ready for operation!");
 }
 
 void GLPSecureSenseDevice::run()
 {
-    updateSensorReadings();
-    updateDisplay();
-    updateLEDs();
-    sendSerialData();
+    // Single-core pass: both sides in turn, under one loop budget
+    unsigned long start = micros();
+    power.beginPass(start);
+    loopBudget.beginPass(start);
+    runCore(ExecutionCore::REAL_TIME);
+    runCore(ExecutionCore::IO);
+    loopBudget.endPass(micros());
+}
+
+void GLPSecureSenseDevice::idle()
+{
+    // Wake for whichever timer is due first; the D0 pin can end it earlier
+    unsigned long now = micros();
+    power.offerDeadline(passStartMicros + SENSE_PERIOD_US);
+    power.offerDeadline(now + displayManager->millisUntilUpdate() * 1000UL);
+    power.offerDeadline(now + millisUntilSerial() * 1000UL);
+    power.offerDeadline(now + millisUntilHistory() * 1000UL);
+
+    // Timed sampling wakes for its slots instead of holding the CPU awake
+    unsigned long sampleDue;
+    if (gasSensor->getNextSampleDue(sampleDue))
+    {
+        power.offerDeadline(sampleDue);
+    }
+
+    // Light sleep would stop LEDC patterns, queued I2C transfers and DMA sampling
+    if (ledIndicator->hasActivePattern() || !i2cBus->isIdle() || gasSensor->samplesInBackground())
+    {
+        power.hold();
+    }
+    if (power.idle() == IdleMode::LIGHT_SLEEP)
+    {
+        gasSensor->resumeSampling();
+    }
+}
+
+void GLPSecureSenseDevice::runCore(ExecutionCore core)
+{
+    // LEDs follow the sensor's level events raised inside update(); the
+    // display only redraws when a shown value changed. Sensing and alarm
+    // always run; the rest is only offered to the budget when it has work due
+    if (core == ExecutionCore::REAL_TIME)
+    {
+        passStartMicros = micros();
+    }
+    if (core == SENSOR_CORE)
+    {
+        runStage(LoopStage::SENSE, SENSOR_CORE, &GLPSecureSenseDevice::updateSensorReadings);
+    }
+    if (core == ALARM_CORE)
+    {
+        runStage(LoopStage::ALARM, ALARM_CORE, &GLPSecureSenseDevice::updateAlarmLatch);
+    }
+    if (core == ExecutionCore::REAL_TIME)
+    {
+        publishStatus();
+    }
+
+    if (core == ExecutionCore::IO)
+    {
+        status.read(shown);
+    }
+    if (core == DISPLAY_CORE && displayManager->isUpdateDue())
+    {
+        runStage(LoopStage::DISPLAY, DISPLAY_CORE, &GLPSecureSenseDevice::updateDisplay);
+    }
+    if (core == SERIAL_CORE && isSerialDue())
+    {
+        runStage(LoopStage::SERIAL_LOG, SERIAL_CORE, &GLPSecureSenseDevice::sendSerialData);
+    }
+    if (core == BUS_CORE && i2cBus->getPending() > 0)
+    {
+        runStage(LoopStage::BUS, BUS_CORE, &GLPSecureSenseDevice::serviceBus);
+    }
+    if (core == HISTORY_CORE && isHistoryDue())
+    {
+        runStage(LoopStage::HISTORY, HISTORY_CORE, &GLPSecureSenseDevice::recordHistory);
+    }
+}
+
+bool GLPSecureSenseDevice::startDualCore()
+{
+    if (!runner.start())
+    {
+        Serial.println("Dual-core mode unavailable, running from loop()");
+        return false;
+    }
+    Serial.print("Dual-core mode: real-time on core ");
+    Serial.print(DualCoreRunner::REAL_TIME_CORE);
+    Serial.print(", I/O on core ");
+    Serial.println(DualCoreRunner::IO_CORE);
+    return true;
+}
+
+bool GLPSecureSenseDevice::isDualCore() const
+{
+    return runner.isRunning();
+}
+
+void GLPSecureSenseDevice::realTimeStep(void *context)
+{
+    static_cast<GLPSecureSenseDevice *>(context)->runCore(ExecutionCore::REAL_TIME);
+}
+
+void GLPSecureSenseDevice::ioStep(void *context)
+{
+    // The loop budget belongs to the I/O task once the cores are split
+    GLPSecureSenseDevice *device = static_cast<GLPSecureSenseDevice *>(context);
+    device->loopBudget.beginPass(micros());
+    device->runCore(ExecutionCore::IO);
+    device->loopBudget.endPass(micros());
+}
+
+void GLPSecureSenseDevice::runStage(LoopStage stage, ExecutionCore core, void (GLPSecureSenseDevice::*work)())
+{
+    // Real-time stages on their own core are timed by the runner instead
+    if (core != ExecutionCore::IO && runner.isRunning())
+    {
+        (this->*work)();
+        return;
+    }
+    if (!loopBudget.shouldRun(stage, micros()))
+    {
+        return;
+    }
+    loopBudget.beginStage(stage, micros());
+    (this->*work)();
+    loopBudget.endStage(micros());
+}
+
+void GLPSecureSenseDevice::on(Event event)
+{
+    if (event == GasSensor::LEVEL_SAFE_EVENT ||
+        event == GasSensor::LEVEL_MODERATE_EVENT ||
+        event == GasSensor::LEVEL_CRITICAL_EVENT ||
+        event == GasSensor::PRE_CRITICAL_STARTED_EVENT ||
+        event == GasSensor::PRE_CRITICAL_ENDED_EVENT)
+    {
+        // While the D0 latch holds the red LED, the latch decides
+        if (alarmLatchSeen)
+        {
+            return;
+        }
+
+        const GasReading &reading = gasSensor->getReading();
+        ledIndicator->handle(LedIndicator::commandFor(reading.level, reading.isPreCritical()));
+
+        if (event == GasSensor::LEVEL_CRITICAL_EVENT)
+        {
+            criticalToLedLatency.record(micros() - passStartMicros);
+        }
+    }
+
+    // Alarm projection; an alarm already running (pre-critical) keeps its start
+    if (event == GasSensor::LEVEL_CRITICAL_EVENT)
+    {
+        projected.criticalAlarms++;
+        beginAlarm();
+    }
+    else if (event == GasSensor::PRE_CRITICAL_STARTED_EVENT)
+    {
+        projected.preCriticalAlarms++;
+        beginAlarm();
+    }
+    else if (event == GasSensor::LEVEL_SAFE_EVENT || event == GasSensor::LEVEL_MODERATE_EVENT ||
+             event == GasSensor::PRE_CRITICAL_ENDED_EVENT)
+    {
+        const GasReading &reading = gasSensor->getReading();
+        projected.alarmActive = reading.level == GasLevel::CRITICAL || reading.isPreCritical();
+        projectionChanged = true;
+    }
+}
+
+void GLPSecureSenseDevice::beginAlarm()
+{
+    if (!projected.alarmActive)
+    {
+        projected.alarmActive = true;
+        projected.lastAlarmMillis = millis();
+        projected.lastAlarmPeakPpm = 0;
+    }
+    projectionChanged = true;
+}
+
+void GLPSecureSenseDevice::publishStatus()
+{
+    // Only new conversions and alarm changes produce a new version
+    const GasReading &reading = gasSensor->getReading();
+    if (!projectionChanged && reading.timestamp == projected.reading.timestamp)
+    {
+        return;
+    }
+    projected.reading = reading;
+    projected.secondsToCritical = gasSensor->secondsToCritical();
+    if (projected.alarmActive && reading.ppm > projected.lastAlarmPeakPpm)
+    {
+        projected.lastAlarmPeakPpm = reading.ppm;
+    }
+    projected.latched = alarmLatchSeen;
+    projected.shutoffActive = alarmLatch->isShutoffActive();
+    status.write(projected);
+    projectionChanged = false;
+}
+
+GasSnapshot GLPSecureSenseDevice::getStatus() const
+{
+    return status.read();
+}
+
+void GLPSecureSenseDevice::handle(Command command)
+{
+    if (command == LedIndicator::SHOW_SAFE_COMMAND ||
+        command == LedIndicator::SHOW_MODERATE_COMMAND ||
+        command == LedIndicator::SHOW_CRITICAL_COMMAND ||
+        command == LedIndicator::SHOW_PRE_CRITICAL_COMMAND ||
+        command == LedIndicator::ALL_OFF_COMMAND)
+    {
+        ledIndicator->handle(command);
+    }
+
+    if (command == DisplayManager::REFRESH_COMMAND ||
+        command == DisplayManager::CLEAR_COMMAND)
+    {
+        displayManager->handle(command);
+    }
 }
 
 void GLPSecureSenseDevice::initializeSerial()
 {
-    Serial.begin(9600);
+    // A reading block takes about a second to send; without a driver buffer Serial
+    // would block once the 128-byte FIFO fills, and sensing with it
+    Serial.setTxBufferSize(SERIAL_TX_BUFFER);
+    Serial.begin(SERIAL_BAUD);
     while (!Serial)
     {
         ; // Wait for serial port to connect
@@ -90,50 +355,190 @@ void GLPSecureSenseDevice::updateSensorReadings()
 
 void GLPSecureSenseDevice::updateDisplay()
 {
-    float ppm = gasSensor->readPPM();
-    int percentage = gasSensor->readPercentage();
-    GasLevel level = gasSensor->getGasLevel();
-    String status = gasSensor->getStatusText();
+    displayManager->updateDisplay(shown.reading, GasSensor::statusText(shown.reading));
+}
+
+void GLPSecureSenseDevice::updateAlarmLatch()
+{
+    const GasReading &reading = gasSensor->getReading();
+    bool judged = alarmLatch->confirm(reading);
+    bool latched = alarmLatch->isLatched();
 
-    displayManager->updateDisplay(ppm, percentage, level, status);
+    if (latched && !alarmLatchSeen)
+    {
+        // Edge seen, no post-edge conversion yet: the ISR already lit red,
+        // bring the other LEDs in line with it
+        ledIndicator->handle(LedIndicator::SHOW_CRITICAL_COMMAND);
+        ledIndicator->resync();
+        projected.criticalAlarms++;
+        beginAlarm();
+    }
+    else if (!latched && (alarmLatchSeen || judged))
+    {
+        // Confirmed or cleared: hand the LEDs back to the level events. An
+        // edge that came after the last pass's conversion is judged here
+        // before isLatched() ever showed it; the ISR still forced red on
+        d0ConfirmLatency.record(alarmLatch->getLastConfirmLatencyUs());
+        ledIndicator->handle(LedIndicator::commandFor(reading.level, reading.isPreCritical()));
+        ledIndicator->resync();
+        projected.alarmActive = reading.level == GasLevel::CRITICAL || reading.isPreCritical();
+    }
+    if (latched != alarmLatchSeen)
+    {
+        projectionChanged = true;
+    }
+    alarmLatchSeen = latched;
+}
+
+bool GLPSecureSenseDevice::isSerialDue() const
+{
+    // A block waits for the previous ones to drain rather than blocking the pass
+    return millis() - lastSerialOutput >= SERIAL_INTERVAL && Serial.availableForWrite() >= SERIAL_LOG_BYTES;
 }
 
-void GLPSecureSenseDevice::updateLEDs()
+unsigned long GLPSecureSenseDevice::millisUntilSerial() const
 {
-    GasLevel level = gasSensor->getGasLevel();
-    ledIndicator->updateStatus(level);
+    unsigned long elapsed = millis() - lastSerialOutput;
+    if (elapsed < SERIAL_INTERVAL)
+    {
+        return SERIAL_INTERVAL - elapsed;
+    }
+    int room = Serial.availableForWrite();
+    return room >= SERIAL_LOG_BYTES ? 0 : (SERIAL_LOG_BYTES - room) * 10000UL / SERIAL_BAUD + 1;
 }
 
 void GLPSecureSenseDevice::sendSerialData()
 {
-    unsigned long currentTime = millis();
-    if (currentTime - lastSerialOutput < SERIAL_INTERVAL)
+    logSensorData(shown);
+
+    lastSerialOutput = millis();
+}
+
+void GLPSecureSenseDevice::serviceBus()
+{
+    i2cBus->service();
+}
+
+bool GLPSecureSenseDevice::isHistoryDue() const
+{
+    return millis() - lastHistoryRecord >= HISTORY_INTERVAL;
+}
+
+unsigned long GLPSecureSenseDevice::millisUntilHistory() const
+{
+    unsigned long elapsed = millis() - lastHistoryRecord;
+    return elapsed >= HISTORY_INTERVAL ? 0 : HISTORY_INTERVAL - elapsed;
+}
+
+void GLPSecureSenseDevice::recordHistory()
+{
+    // Records the shown snapshot; a deferred pass just leaves a longer gap
+    lastHistoryRecord = millis();
+    history->record(lastHistoryRecord, shown.reading.ppm);
+
+    // During an incident the open segment goes to flash within seconds
+    if (shown.reading.level != GasLevel::SAFE || shown.reading.isPreCritical())
     {
-        return;
+        history->checkpoint(INCIDENT_CHECKPOINT_S);
     }
+}
 
-    float ppm = gasSensor->readPPM();
-    int percentage = gasSensor->readPercentage();
-    GasLevel level = gasSensor->getGasLevel();
+void GLPSecureSenseDevice::printHistory(uint32_t fromTime, uint32_t toTime)
+{
+    Serial.println("time_s,ppm");
+    size_t count = history->query(fromTime, toTime, printHistorySample, nullptr);
+    Serial.print("# ");
+    Serial.print(count);
+    Serial.println(" samples");
+}
 
-    logSensorData(ppm, percentage, level);
+void GLPSecureSenseDevice::printHistorySample(uint32_t time, float ppm, void *context)
+{
+    Serial.print(time);
+    Serial.print(",");
+    Serial.println(ppm, 0);
+}
 
-    lastSerialOutput = currentTime;
+void GLPSecureSenseDevice::logHistory()
+{
+    Serial.print("History: ");
+    Serial.print(history->getStoredSegments());
+    Serial.print(" segments, ");
+    Serial.print(history->getStoredBytes() / 1024);
+    Serial.print(" KB, ");
+    Serial.print(history->getBitsPerSample(), 1);
+    Serial.print(" bits/sample, ");
+    Serial.print(history->getSegmentWrites());
+    Serial.print(" flash appends (");
+    Serial.print(history->getBytesWritten() / 1024);
+    Serial.print(" KB)");
+    Serial.println(history->isPersistent() ? "" : " (RAM only)");
 }
 
-void GLPSecureSenseDevice::logSensorData(float ppm, int percentage, GasLevel level)
+void GLPSecureSenseDevice::printRollups(RollupResolution resolution)
 {
+    // Written by the sensor stage; on two cores a window may close mid-export
+    const RollupSeries &rollup = gasSensor->getPpmRollup();
+    Serial.println(RollupSeries::CSV_HEADER);
+    rollup.forEach(resolution, printRollup, this);
+
+    RollupSummary open;
+    if (rollup.current(resolution, open))
+    {
+        printRollup(resolution, open, this);
+    }
+}
+
+void GLPSecureSenseDevice::printRollup(RollupResolution resolution, const RollupSummary &summary, void *context)
+{
+    char line[128];
+    GLPSecureSenseDevice *device = static_cast<GLPSecureSenseDevice *>(context);
+    device->gasSensor->getPpmRollup().formatCsv(resolution, summary, line, sizeof(line));
+    Serial.println(line);
+}
+
+void GLPSecureSenseDevice::logRollups()
+{
+    RollupSummary minute;
+    if (!gasSensor->getPpmRollup().current(RollupResolution::MINUTE, minute) || minute.count == 0)
+    {
+        return;
+    }
+    Serial.print("PPM this minute: mean ");
+    Serial.print(minute.mean, 1);
+    Serial.print(", min ");
+    Serial.print(minute.min, 1);
+    Serial.print(", max ");
+    Serial.print(minute.max, 1);
+    Serial.print(", p90 ");
+    Serial.print(minute.p90, 1);
+    Serial.print(" (");
+    Serial.print(minute.count);
+    Serial.println(" samples)");
+}
+
+GasHistory &GLPSecureSenseDevice::getHistory()
+{
+    return *history;
+}
+
+void GLPSecureSenseDevice::logSensorData(const GasSnapshot &snapshot)
+{
+    // Counters of real-time components are read without locking; they are
+    // word-sized statistics, so at worst one update stale
+    const GasReading &reading = snapshot.reading;
+
     Serial.println("=== GLP SecureSense Pro Reading ===");
     Serial.print("LPG Concentration: ");
-    Serial.print(ppm);
+    Serial.print(reading.ppm);
     Serial.println(" PPM");
 
     Serial.print("Gas Level: ");
-    Serial.print(percentage);
+    Serial.print(reading.percentage);
     Serial.println("%");
 
     Serial.print("Safety Level: ");
-    switch (level)
+    switch (reading.level)
     {
     case GasLevel::SAFE:
         Serial.println("SAFE (< 200 PPM)");
@@ -146,7 +551,212 @@ void GLPSecureSenseDevice::logSensorData(float ppm, int percentage, GasLevel lev
         break;
     }
 
+    const GasLevelClassifier &classifier = gasSensor->getLevelClassifier();
+    Serial.print("Level transitions: ");
+    Serial.print(classifier.getTransitions());
+    Serial.print(" applied, ");
+    Serial.print(classifier.getSuppressedTransitions());
+    Serial.println(" suppressed by hysteresis");
+
+    Serial.print("Trend: ");
+    Serial.print(reading.trendPpmPerSecond, 1);
+    Serial.println(" PPM/s");
+    if (reading.isPreCritical())
+    {
+        Serial.print("PRE-CRITICAL WARNING: ");
+        Serial.print(reading.riseAlarm == RiseAlarm::FAST_RISE ? "fast rise" : "sustained rise");
+        float eta = snapshot.secondsToCritical;
+        if (eta >= 0)
+        {
+            Serial.print(", ~");
+            Serial.print(eta, 0);
+            Serial.print(" s to 500 PPM");
+        }
+        Serial.println();
+    }
+
+    GasSpeciesTable &species = gasSensor->getSpecies();
+    Serial.print("Species PPM:");
+    for (int i = 0; i < species.size(); i++)
+    {
+        Serial.print(" ");
+        Serial.print(species.getName(i));
+        Serial.print("=");
+        Serial.print(reading.speciesPpm[i], 0);
+        if (reading.speciesAlarms & (1UL << i))
+        {
+            Serial.print("!");
+        }
+    }
+    Serial.println();
+
     Serial.print("Digital Threshold: ");
-    Serial.println(gasSensor->isDigitalHigh() ? "HIGH" : "LOW");
+    Serial.println(reading.digitalHigh ? "HIGH" : "LOW");
+
+    Serial.print("D0 Alarm: ");
+    Serial.print(alarmLatch->getEdgeCount());
+    Serial.print(" edges, ");
+    Serial.print(alarmLatch->getConfirmedCount());
+    Serial.print(" confirmed, ");
+    Serial.print(alarmLatch->getClearedCount());
+    Serial.print(" cleared, worst confirm ");
+    Serial.print(alarmLatch->getWorstConfirmLatencyUs() / 1000.0, 1);
+    Serial.println(" ms");
+    Serial.print("LCD: ");
+    Serial.print(displayManager->getLastFlushBytes());
+    Serial.print(" bytes queued in ");
+    Serial.print(displayManager->getLastFlushMicros());
+    Serial.println(" us last flush");
+
+    Serial.print("Outputs: ");
+    Serial.print(ledIndicator->getGpioWrites());
+    Serial.print(" LED writes, ");
+    Serial.print(displayManager->getRedrawCount());
+    Serial.print(" redraws, ");
+    Serial.print(displayManager->getSkippedCount());
+    Serial.println(" unchanged frames skipped");
+
+    Serial.print("I2C: ");
+    Serial.print(i2cBus->getClock() / 1000);
+    Serial.print(" kHz, ");
+    Serial.print(i2cBus->isBlocking() ? "blocking" : "queued");
+    Serial.print(", ");
+    Serial.print(i2cBus->getCompleted());
+    Serial.print(" ok, ");
+    Serial.print(i2cBus->getFailed());
+    Serial.print(" failed, ");
+    Serial.print(i2cBus->getDropped());
+    Serial.print(" dropped, max caller ");
+    Serial.print(i2cBus->getMaxCallerMicros());
+    Serial.println(" us");
+
+    logLatency(criticalToLedLatency);
+    logLatency(d0ConfirmLatency);
+    logLoopBudget();
+    logLatency(runner.getRealTimeLateness());
+    logPower();
+    logHistory();
+    logRollups();
+
+    Serial.print("Alarms: ");
+    Serial.print(snapshot.criticalAlarms);
+    Serial.print(" critical, ");
+    Serial.print(snapshot.preCriticalAlarms);
+    Serial.print(" pre-critical");
+    if (snapshot.lastAlarmMillis != 0)
+    {
+        Serial.print(", last ");
+        Serial.print((millis() - snapshot.lastAlarmMillis) / 1000);
+        Serial.print(" s ago, peak ");
+        Serial.print(snapshot.lastAlarmPeakPpm, 0);
+        Serial.print(" PPM");
+        Serial.print(snapshot.alarmActive ? " (active)" : "");
+    }
+    Serial.println();
+
+    if (snapshot.shutoffActive)
+    {
+        Serial.println("GAS SHUTOFF ACTIVE - manual reset required");
+    }
+
+    const GasAdcFrontEnd &adc = gasSensor->getAdcFrontEnd();
+    Serial.print("ADC: ");
+    Serial.print(adc.getOversampling());
+    Serial.print("x oversampling, ");
+    Serial.print(adc.getEffectiveSampleRate(), 1);
+    Serial.print(" Hz effective, noise floor ");
+    Serial.print(adc.getNoiseFloor(), 2);
+    Serial.println(" counts");
+
+    const SamplingClock *clock = gasSensor->getSamplingClock();
+    if (clock != nullptr)
+    {
+        logLatency(clock->getJitter());
+        Serial.print("ADC clock: ");
+        Serial.print(clock->isHardwareTimed() ? "timer, " : "loop, ");
+        Serial.print(clock->getSkippedTicks());
+        Serial.print(" slots skipped, ");
+        Serial.print(clock->getDroppedSamples());
+        Serial.println(" samples dropped");
+    }
     Serial.println("=====================================");
 }
+
+void GLPSecureSenseDevice::logLatency(const LatencyHistogram &slo)
+{
+    if (slo.getCount() == 0)
+    {
+        return;
+    }
+    Serial.print("SLO ");
+    Serial.print(slo.getName());
+    Serial.print(": p50 ");
+    Serial.print(slo.percentile(500) / 1000.0, 1);
+    Serial.print(" ms, p99 ");
+    Serial.print(slo.percentile(990) / 1000.0, 1);
+    Serial.print(" ms (budget ");
+    Serial.print(slo.getBudgetMicros() / 1000.0, 1);
+    Serial.print(" ms) ");
+    Serial.println(slo.meetsBudget() ? "OK" : "MISSED");
+}
+
+bool GLPSecureSenseDevice::meetsLatencyBudgets() const
+{
+    return criticalToLedLatency.meetsBudget() && d0ConfirmLatency.meetsBudget();
+}
+
+void GLPSecureSenseDevice::logLoopBudget()
+{
+    static const LoopStage sheddable[] = {LoopStage::DISPLAY, LoopStage::SERIAL_LOG, LoopStage::BUS,
+                                          LoopStage::HISTORY};
+
+    Serial.print("Loop: ");
+    Serial.print(loopBudget.getLastPassMicros());
+    Serial.print(" us last, ");
+    Serial.print(loopBudget.getWorstPassMicros());
+    Serial.print(" us worst, budget ");
+    Serial.print(loopBudget.getBudgetMicros());
+    Serial.print(" us, ");
+    Serial.print(loopBudget.getOverrunCount());
+    Serial.print(" overruns, shed");
+    for (LoopStage stage : sheddable)
+    {
+        Serial.print(" ");
+        Serial.print(LoopBudgetMonitor::stageName(stage));
+        Serial.print("=");
+        Serial.print(loopBudget.getShedCount(stage));
+    }
+    Serial.println();
+}
+
+const LoopBudgetMonitor &GLPSecureSenseDevice::getLoopBudget() const
+{
+    return loopBudget;
+}
+
+const DualCoreRunner &GLPSecureSenseDevice::getRunner() const
+{
+    return runner;
+}
+
+void GLPSecureSenseDevice::logPower()
+{
+    Serial.print("Power: ");
+    Serial.print(power.getDutyCycle() * 100, 1);
+    Serial.print("% awake, ~");
+    Serial.print(power.getAverageMilliamps() - power.getAlwaysOnMilliamps(), 1);
+    Serial.print(" mA MCU + ");
+    Serial.print(power.getAlwaysOnMilliamps(), 0);
+    Serial.print(" mA heater, ");
+    Serial.print(power.getSleepCount());
+    Serial.print(" sleeps, ");
+    Serial.print(power.getEarlyWakeCount());
+    Serial.print(" woken by D0, ");
+    Serial.print(power.getHeldCount());
+    Serial.println(" passes kept awake");
+}
+
+const PowerManager &GLPSecureSenseDevice::getPowerManager() const
+{
+    return power;
+}
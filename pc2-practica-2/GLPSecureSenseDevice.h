@@ -1,16 +1,45 @@
 #ifndef GLP_SECURE_SENSE_DEVICE_H
 #define GLP_SECURE_SENSE_DEVICE_H
 
+#include "Device.h"
 #include "GasSensor.h"
 #include "LedIndicator.h"
 #include "DisplayManager.h"
+#include "GasAlarmLatch.h"
+#include "I2cBusManager.h"
+#include "LatencyHistogram.h"
+#include "LoopBudgetMonitor.h"
+#include "DualCoreRunner.h"
+#include "Seqlock.h"
+#include "PowerManager.h"
+#include "GasHistory.h"
 
-class GLPSecureSenseDevice
+// Read model of the device: the latest reading plus an alarm projection
+// kept up to date from level events and the D0 latch. Any task answers
+// status queries from it without touching the sensor or the outputs.
+struct GasSnapshot
+{
+    GasReading reading;
+    float secondsToCritical;
+    uint32_t criticalAlarms;       // Entries into CRITICAL, by level or by the D0 latch
+    uint32_t preCriticalAlarms;    // Rate-of-rise warnings started
+    unsigned long lastAlarmMillis; // Start of the latest alarm, 0 before the first
+    float lastAlarmPeakPpm;        // Highest PPM while the latest alarm lasted
+    bool alarmActive;
+    bool latched;
+    bool shutoffActive;
+};
+
+class GLPSecureSenseDevice : public Device
 {
 private:
     GasSensor *gasSensor;
     LedIndicator *ledIndicator;
     DisplayManager *displayManager;
+    GasAlarmLatch *alarmLatch;
+    I2cBusManager *i2cBus;
+    SegmentStorage *historyStorage;
+    GasHistory *history;
 
     // Pin definitions
     static const int GAS_ANALOG_PIN = 4;
@@ -18,10 +47,57 @@ private:
     static const int GREEN_LED_PIN = 25;
     static const int YELLOW_LED_PIN = 26;
     static const int RED_LED_PIN = 27;
+    static const int GAS_SHUTOFF_PIN = -1; // Optional valve/relay output, -1 = not fitted
     static const uint8_t LCD_ADDRESS = 0x27;
 
+    bool alarmLatchSeen;
     unsigned long lastSerialOutput;
+    unsigned long lastHistoryRecord;
+
+    // Latency SLOs: CRITICAL conversion to red LED, and D0 edge to confirmation
+    LatencyHistogram criticalToLedLatency;
+    LatencyHistogram d0ConfirmLatency;
+    unsigned long passStartMicros;
+    static const uint32_t CRITICAL_TO_LED_BUDGET_US = 5000;
+    static const uint32_t D0_CONFIRM_BUDGET_US = 300000; // A few conversion periods
     static const unsigned long SERIAL_INTERVAL = 1000;
+    static const unsigned long SERIAL_BAUD = 115200; // A reading block is ~1 KB: at 9600 baud the UART never drained
+    static const size_t SERIAL_TX_BUFFER = 2048; // Driver buffer, so logging never waits on the UART
+    static const int SERIAL_LOG_BYTES = 1536;    // Room the longest reading block needs, alarm lines included
+    static const unsigned long HISTORY_INTERVAL = 1000; // 1 Hz history
+    static const uint32_t INCIDENT_CHECKPOINT_S = 10;   // History checkpoint age while not SAFE
+
+    // Per-pass time budget; display, serial, bus and history work is deferred past it
+    LoopBudgetMonitor loopBudget;
+    static const uint32_t LOOP_BUDGET_US = 20000;
+    static const uint32_t MAX_DEFER_US = 2000000;
+
+    // Optional dual-core split; display and logging only see the read model
+    DualCoreRunner runner;
+    GasSnapshot projected;        // Real-time side, updated as events arrive
+    bool projectionChanged;
+    Seqlock<GasSnapshot> status;  // Published read model, readable from any task
+    GasSnapshot shown;            // I/O side copy for this pass
+    static const uint32_t REAL_TIME_PERIOD_US = 100000;
+    static const uint32_t IO_PERIOD_US = 100000;
+    static const uint32_t LATENESS_BUDGET_US = 5000;
+
+    // Battery operation: between passes, sleep until the next deadline
+    PowerManager power;
+    static const uint32_t SENSE_PERIOD_US = 100000; // One ADC block per pass
+    static constexpr float ACTIVE_MA = 40.0f;       // ESP32 at 240 MHz, radio off
+    static constexpr float IDLE_MA = 20.0f;         // delay(): CPU waiting, clocks running
+    static constexpr float SLEEP_MA = 0.8f;         // Light sleep
+    static constexpr float HEATER_MA = 150.0f;      // MQ-2 heater, always on
+
+public:
+    // Core each stage runs on once startDualCore() succeeds
+    static constexpr ExecutionCore SENSOR_CORE = ExecutionCore::REAL_TIME;
+    static constexpr ExecutionCore ALARM_CORE = ExecutionCore::REAL_TIME;
+    static constexpr ExecutionCore DISPLAY_CORE = ExecutionCore::IO;
+    static constexpr ExecutionCore SERIAL_CORE = ExecutionCore::IO;
+    static constexpr ExecutionCore BUS_CORE = ExecutionCore::IO;
+    static constexpr ExecutionCore HISTORY_CORE = ExecutionCore::IO; // Flash writes block
 
 public:
     GLPSecureSenseDevice();
@@ -29,16 +105,50 @@ public:
 
     void initialize();
     void run();
+    void idle();
+    void runCore(ExecutionCore core);
+    bool startDualCore();
+    bool isDualCore() const;
+
+    void on(Event event) override;
+    void handle(Command command) override;
+
+    bool meetsLatencyBudgets() const;
+    const LoopBudgetMonitor &getLoopBudget() const;
+    const DualCoreRunner &getRunner() const;
+    const PowerManager &getPowerManager() const;
+    GasHistory &getHistory();
+    GasSnapshot getStatus() const;
+    void printHistory(uint32_t fromTime, uint32_t toTime);
+    void printRollups(RollupResolution resolution);
 
 private:
     void initializeSerial();
     void calibrateSensor();
     void performSystemTest();
     void updateSensorReadings();
+    static void realTimeStep(void *context);
+    static void ioStep(void *context);
+    void runStage(LoopStage stage, ExecutionCore core, void (GLPSecureSenseDevice::*work)());
     void updateDisplay();
-    void updateLEDs();
+    void updateAlarmLatch();
+    void beginAlarm();
+    void publishStatus();
+    bool isSerialDue() const;
+    unsigned long millisUntilSerial() const;
     void sendSerialData();
-    void logSensorData(float ppm, int percentage, GasLevel level);
+    void serviceBus();
+    bool isHistoryDue() const;
+    unsigned long millisUntilHistory() const;
+    void recordHistory();
+    static void printHistorySample(uint32_t time, float ppm, void *context);
+    static void printRollup(RollupResolution resolution, const RollupSummary &summary, void *context);
+    void logSensorData(const GasSnapshot &snapshot);
+    void logLatency(const LatencyHistogram &slo);
+    void logLoopBudget();
+    void logPower();
+    void logHistory();
+    void logRollups();
 };
 
 #endif
@@ -0,0 +1,145 @@
+#include "GasAdcFrontEnd.h"
+#include <math.h>
+
+GasAdcFrontEnd::GasAdcFrontEnd(AdcSampleSource *source, uint16_t oversampling)
+    : source(source), fill{}, oversampling(1), published(false),
+      average(0), noiseFloor(0), blockTimeMillis(0), blockTimed(false), effectiveRateHz(0), conversionRateHz(0),
+      windowStartMicros(0), conversionsInWindow(0), blocksInWindow(0),
+      totalBlocks(0)
+{
+    setOversampling(oversampling);
+}
+
+void GasAdcFrontEnd::begin()
+{
+    source->begin();
+}
+
+bool GasAdcFrontEnd::setOversampling(uint16_t ratio)
+{
+    // Powers of two keep the decimation a shift on targets without an FPU
+    if (ratio == 0 || ratio > MAX_OVERSAMPLING || (ratio & (ratio - 1)) != 0)
+    {
+        return false;
+    }
+    oversampling = ratio;
+    fill = Block{};
+    return true;
+}
+
+bool GasAdcFrontEnd::poll(unsigned long nowMicros)
+{
+    uint16_t samples[32];
+    bool publishedNow = false;
+    source->service();
+    size_t budget = source->available();
+
+    while (budget > 0)
+    {
+        size_t wanted = oversampling - fill.count;
+        if (wanted > budget)
+        {
+            wanted = budget;
+        }
+        if (wanted > sizeof(samples) / sizeof(samples[0]))
+        {
+            wanted = sizeof(samples) / sizeof(samples[0]);
+        }
+
+        size_t got = source->read(samples, wanted);
+        if (got == 0)
+        {
+            break;
+        }
+        budget -= got;
+
+        for (size_t i = 0; i < got; i++)
+        {
+            uint32_t value = samples[i] > ADC_MAX ? ADC_MAX : samples[i];
+            fill.sum += value;
+            fill.sumSquares += (uint64_t)value * value;
+        }
+        fill.count += got;
+        conversionsInWindow += got;
+
+        if (fill.count >= oversampling)
+        {
+            publish();
+            publishedNow = true;
+        }
+    }
+
+    unsigned long window = nowMicros - windowStartMicros;
+    if (window >= RATE_WINDOW_US)
+    {
+        conversionRateHz = conversionsInWindow * 1e6f / window;
+        effectiveRateHz = blocksInWindow * 1e6f / window;
+        conversionsInWindow = 0;
+        blocksInWindow = 0;
+        windowStartMicros = nowMicros;
+    }
+
+    return publishedNow;
+}
+
+void GasAdcFrontEnd::publish()
+{
+    float mean = (float)fill.sum / fill.count;
+    float variance = (float)fill.sumSquares / fill.count - mean * mean;
+    if (variance < 0)
+    {
+        variance = 0;
+    }
+
+    average = mean;
+    // Standard error of the decimated value, in ADC counts
+    noiseFloor = sqrtf(variance / fill.count);
+    // The block ends with the conversion just read
+    blockTimed = source->getSampleTime(blockTimeMillis);
+
+    fill = Block{};
+    blocksInWindow++;
+    totalBlocks++;
+    published = true;
+}
+
+bool GasAdcFrontEnd::hasSample() const
+{
+    return published;
+}
+
+float GasAdcFrontEnd::getAverage() const
+{
+    return average;
+}
+
+float GasAdcFrontEnd::getNoiseFloor() const
+{
+    return noiseFloor;
+}
+
+bool GasAdcFrontEnd::getBlockTime(unsigned long &timestampMillis) const
+{
+    timestampMillis = blockTimeMillis;
+    return blockTimed;
+}
+
+float GasAdcFrontEnd::getEffectiveSampleRate() const
+{
+    return effectiveRateHz;
+}
+
+float GasAdcFrontEnd::getConversionRate() const
+{
+    return conversionRateHz;
+}
+
+uint16_t GasAdcFrontEnd::getOversampling() const
+{
+    return oversampling;
+}
+
+uint32_t GasAdcFrontEnd::getBlockCount() const
+{
+    return totalBlocks;
+}
@@ -0,0 +1,61 @@
+#ifndef GAS_ADC_FRONT_END_H
+#define GAS_ADC_FRONT_END_H
+
+#include "AdcSampleSource.h"
+
+// Oversampling/decimation stage between an AdcSampleSource and GasSensor.
+// Conversions accumulate into one block; a full block is reduced to its
+// average and noise floor, which the consumer reads until the next one, so
+// it always sees a complete average. Hardware-free: feed it any source and
+// any clock.
+class GasAdcFrontEnd
+{
+private:
+    struct Block
+    {
+        uint32_t sum;
+        uint64_t sumSquares;
+        uint16_t count;
+    };
+
+    AdcSampleSource *source;
+    Block fill;
+    uint16_t oversampling;
+    bool published;
+
+    float average;
+    float noiseFloor;
+    unsigned long blockTimeMillis;
+    bool blockTimed;
+    float effectiveRateHz;
+    float conversionRateHz;
+    unsigned long windowStartMicros;
+    uint32_t conversionsInWindow;
+    uint32_t blocksInWindow;
+    uint32_t totalBlocks;
+
+    static const unsigned long RATE_WINDOW_US = 1000000UL;
+
+    void publish();
+
+public:
+    static const uint16_t MAX_OVERSAMPLING = 256;
+    static const uint16_t ADC_MAX = 4095;
+
+    GasAdcFrontEnd(AdcSampleSource *source, uint16_t oversampling = 16);
+
+    void begin();
+    bool setOversampling(uint16_t ratio);
+    bool poll(unsigned long nowMicros);
+
+    bool hasSample() const;
+    float getAverage() const;
+    float getNoiseFloor() const;
+    bool getBlockTime(unsigned long &timestampMillis) const;
+    float getEffectiveSampleRate() const;
+    float getConversionRate() const;
+    uint16_t getOversampling() const;
+    uint32_t getBlockCount() const;
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "GasAlarmLatch.h"
+#include "LedPatternDriver.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+
+// The edge interrupt may run on the other core: masking interrupts is not enough
+static portMUX_TYPE latchLock = portMUX_INITIALIZER_UNLOCKED;
+#define LATCH_ENTER() portENTER_CRITICAL_SAFE(&latchLock)
+#define LATCH_EXIT() portEXIT_CRITICAL_SAFE(&latchLock)
+#else
+#define LATCH_ENTER() noInterrupts()
+#define LATCH_EXIT() interrupts()
+#endif
+
+GasAlarmLatch *GasAlarmLatch::instance = nullptr;
+
+GasAlarmLatch::GasAlarmLatch(int thresholdPin, int alarmLedPin, int shutoffPin)
+    : thresholdPin(thresholdPin), alarmLedPin(alarmLedPin), shutoffPin(shutoffPin),
+      latched(false), edgeMicros(0), edgeMillis(0), edgeCount(0), shutoffActive(false),
+      lastConfirmLatencyUs(0), worstConfirmLatencyUs(0), confirmedCount(0), clearedCount(0) {}
+
+GasAlarmLatch::~GasAlarmLatch()
+{
+    if (instance == this)
+    {
+        detachInterrupt(digitalPinToInterrupt(thresholdPin));
+        instance = nullptr;
+    }
+}
+
+void GasAlarmLatch::initialize()
+{
+    pinMode(thresholdPin, INPUT);
+    if (shutoffPin >= 0)
+    {
+        pinMode(shutoffPin, OUTPUT);
+        digitalWrite(shutoffPin, LOW);
+    }
+
+    instance = this;
+    attachInterrupt(digitalPinToInterrupt(thresholdPin), onThresholdEdge, RISING);
+
+    // Gas already above the comparator threshold produces no edge
+    if (digitalRead(thresholdPin) == HIGH)
+    {
+        trip();
+    }
+}
+
+void IRAM_ATTR GasAlarmLatch::onThresholdEdge()
+{
+    if (instance != nullptr)
+    {
+        instance->trip();
+    }
+}
+
+void GasAlarmLatch::onWake()
+{
+    // Edge seen as a light-sleep wake-up while the pin interrupt was parked
+    if (instance != nullptr && digitalRead(instance->thresholdPin) == HIGH)
+    {
+        instance->trip();
+    }
+}
+
+void IRAM_ATTR GasAlarmLatch::trip()
+{
+    // The red LED may be strobing from LEDC, which ignores digitalWrite()
+    LedPatternDriver::forceOn(alarmLedPin);
+    if (shutoffPin >= 0)
+    {
+        digitalWrite(shutoffPin, HIGH);
+        shutoffActive = true;
+    }
+    LATCH_ENTER();
+    edgeCount++;
+    if (!latched)
+    {
+        edgeMicros = micros();
+        edgeMillis = millis();
+        latched = true;
+    }
+    LATCH_EXIT();
+}
+
+bool GasAlarmLatch::confirm(const GasReading &reading)
+{
+    // Returns true when this reading judged an edge. Read and clear in one
+    // step: an edge right after this latches afresh with its own times
+    // instead of being cleared unseen
+    LATCH_ENTER();
+    unsigned long edgeAtMicros = edgeMicros;
+    // Only a conversion taken after the edge may judge it
+    bool judged = latched && (long)(reading.timestamp - edgeMillis) >= 0;
+    if (judged)
+    {
+        latched = false;
+    }
+    LATCH_EXIT();
+    if (!judged)
+    {
+        return false;
+    }
+
+    unsigned long latency = micros() - edgeAtMicros;
+    lastConfirmLatencyUs = latency;
+    if (latency > worstConfirmLatencyUs)
+    {
+        worstConfirmLatencyUs = latency;
+    }
+
+    if (reading.level == GasLevel::CRITICAL)
+    {
+        // The LED keeps following the classification from here on
+        confirmedCount++;
+    }
+    else
+    {
+        // Comparator tripped but PPM is below CRITICAL: the LED owner
+        // re-drives the pin once isLatched() drops
+        clearedCount++;
+    }
+    return true;
+}
+
+void GasAlarmLatch::resetShutoff()
+{
+    // The shutoff output is never released automatically
+    if (shutoffPin >= 0)
+    {
+        digitalWrite(shutoffPin, LOW);
+    }
+    shutoffActive = false;
+}
+
+bool GasAlarmLatch::isLatched() const
+{
+    return latched;
+}
+
+bool GasAlarmLatch::isShutoffActive() const
+{
+    return shutoffActive;
+}
+
+uint32_t GasAlarmLatch::getEdgeCount() const
+{
+    return edgeCount;
+}
+
+uint32_t GasAlarmLatch::getConfirmedCount() const
+{
+    return confirmedCount;
+}
+
+uint32_t GasAlarmLatch::getClearedCount() const
+{
+    return clearedCount;
+}
+
+unsigned long GasAlarmLatch::getLastConfirmLatencyUs() const
+{
+    return lastConfirmLatencyUs;
+}
+
+unsigned long GasAlarmLatch::getWorstConfirmLatencyUs() const
+{
+    return worstConfirmLatencyUs;
+}
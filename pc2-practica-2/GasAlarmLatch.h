@@ -0,0 +1,52 @@
+#ifndef GAS_ALARM_LATCH_H
+#define GAS_ALARM_LATCH_H
+
+#include <Arduino.h>
+#include "GasSensor.h"
+
+// Fast path for the MQ-2 D0 comparator. A rising edge drives the critical
+// LED (and the optional shutoff output) straight from the interrupt, ahead
+// of any PPM computation, display or logging. The regular classification
+// then confirms or clears the alarm through confirm().
+class GasAlarmLatch
+{
+private:
+    static GasAlarmLatch *instance;
+
+    int thresholdPin;
+    int alarmLedPin;
+    int shutoffPin;
+
+    volatile bool latched;
+    volatile unsigned long edgeMicros;
+    volatile unsigned long edgeMillis;
+    volatile uint32_t edgeCount;
+    volatile bool shutoffActive;
+
+    unsigned long lastConfirmLatencyUs;
+    unsigned long worstConfirmLatencyUs;
+    uint32_t confirmedCount;
+    uint32_t clearedCount;
+
+    static void IRAM_ATTR onThresholdEdge();
+    void IRAM_ATTR trip();
+
+public:
+    GasAlarmLatch(int thresholdPin, int alarmLedPin, int shutoffPin = -1);
+    ~GasAlarmLatch();
+
+    void initialize();
+    static void onWake();
+    bool confirm(const GasReading &reading);
+    void resetShutoff();
+
+    bool isLatched() const;
+    bool isShutoffActive() const;
+    uint32_t getEdgeCount() const;
+    uint32_t getConfirmedCount() const;
+    uint32_t getClearedCount() const;
+    unsigned long getLastConfirmLatencyUs() const;
+    unsigned long getWorstConfirmLatencyUs() const;
+};
+
+#endif
@@ -0,0 +1,541 @@
+#include "GasHistory.h"
+#include <string.h>
+
+GasHistory::GasHistory(SegmentStorage *storage, uint16_t maxSegments)
+    : storage(storage), maxSegments(maxSegments < 2 ? 2 : maxSegments), persistent(false),
+      bitPosition(0), checkpointBits(0), segmentStored(false),
+      firstSequence(0), openSequence(0), checkpointTime(0), dirty(false),
+      previousTime(0), previousDelta(1), previousValue(0),
+      clockSeconds(0), clockMillis(0), clockStarted(false),
+      appended(0), appendedBits(0), segmentWrites(0), bytesWritten(0)
+{
+    startSegment();
+}
+
+bool GasHistory::begin()
+{
+    persistent = storage != nullptr && storage->begin();
+    firstSequence = 0;
+    openSequence = 0;
+    startSegment();
+    if (!persistent)
+    {
+        return false;
+    }
+
+    uint32_t first, next;
+    if (storage->range(first, next))
+    {
+        firstSequence = first;
+        openSequence = next - 1;
+
+        // The log clock continues after the newest stored sample
+        SegmentHeader newest;
+        bool intact = false;
+        if (load(openSequence, page, intact))
+        {
+            memcpy(&newest, page, HEADER_BYTES);
+            if (newest.count > 0)
+            {
+                clockSeconds = newest.lastTime + 1;
+            }
+        }
+
+        // Keep filling the newest segment unless it is full or its tail is damaged,
+        // since appending after a torn checkpoint would hide everything after it
+        if (!intact || !resume())
+        {
+            openSequence = next;
+            startSegment();
+        }
+    }
+    return true;
+}
+
+void GasHistory::startSegment()
+{
+    memset(page, 0, sizeof(page));
+    header = SegmentHeader{MAGIC, 0, 0, 0, 0, 0};
+    bitPosition = 0;
+    checkpointBits = 0;
+    segmentStored = false;
+    dirty = false;
+}
+
+bool GasHistory::load(uint32_t sequence, uint8_t *segment, bool &intact)
+{
+    // A stored segment is its header followed by one record per checkpoint;
+    // replaying the records rebuilds the image decode() expects. intact is
+    // false when the file ends inside a record.
+    memset(segment, 0, SEGMENT_BYTES);
+    intact = false;
+    SegmentHeader stored;
+    if (!readHeader(sequence, stored))
+    {
+        return false;
+    }
+
+    size_t offset = HEADER_BYTES;
+    while (true)
+    {
+        CheckpointRecord record;
+        size_t got = storage->read(sequence, offset, (uint8_t *)&record, RECORD_BYTES);
+        if (got == 0)
+        {
+            intact = true;
+            break;
+        }
+        if (got < RECORD_BYTES || record.count < stored.count ||
+            record.bitLength < stored.bitLength || record.bitLength > PAYLOAD_BITS)
+        {
+            break;
+        }
+
+        // The first byte is the previous checkpoint's partial byte, now with more bits
+        size_t from = stored.bitLength / 8;
+        size_t length = (record.bitLength + 7) / 8 - from;
+        uint8_t *dst = segment + HEADER_BYTES + from;
+        uint8_t kept = *dst;
+        if (length > 0 && storage->read(sequence, offset + RECORD_BYTES, dst, length) != length)
+        {
+            *dst = kept;
+            memset(dst + 1, 0, length - 1);
+            break;
+        }
+        offset += RECORD_BYTES + length;
+        stored.count = record.count;
+        stored.bitLength = record.bitLength;
+        stored.lastTime = record.lastTime;
+    }
+    memcpy(segment, &stored, HEADER_BYTES);
+    return true;
+}
+
+bool GasHistory::resume()
+{
+    // Continues the segment load() left in page
+    memcpy(&header, page, HEADER_BYTES);
+    DecodeState state;
+    decode(page, 0, 0, nullptr, nullptr, &state);
+    if (header.count == 0 || state.bitPosition + MAX_SAMPLE_BITS > PAYLOAD_BITS)
+    {
+        return false;
+    }
+    bitPosition = state.bitPosition;
+    checkpointBits = bitPosition;
+    segmentStored = true;
+    previousTime = state.time;
+    previousDelta = state.delta;
+    previousValue = state.value;
+    checkpointTime = header.lastTime;
+    return true;
+}
+
+uint32_t GasHistory::timeAt(unsigned long nowMillis)
+{
+    // Whole seconds since the last call; unsigned differences survive the millis() wrap
+    if (!clockStarted)
+    {
+        clockMillis = nowMillis;
+        clockStarted = true;
+    }
+    unsigned long seconds = (nowMillis - clockMillis) / 1000;
+    clockSeconds += seconds;
+    clockMillis += seconds * 1000;
+    return clockSeconds;
+}
+
+void GasHistory::record(unsigned long nowMillis, float ppm)
+{
+    append(timeAt(nowMillis), ppm);
+}
+
+void GasHistory::append(uint32_t time, float ppm)
+{
+    // The log never runs backwards; a repeated second costs one bit
+    if (header.count > 0 && time < previousTime)
+    {
+        time = previousTime;
+    }
+    if (bitPosition + MAX_SAMPLE_BITS > PAYLOAD_BITS || header.count == 0xFFFF)
+    {
+        seal();
+    }
+
+    uint32_t before = bitPosition;
+    encode(time, quantize(ppm));
+    appended++;
+    appendedBits += bitPosition - before;
+
+    checkpoint(CHECKPOINT_INTERVAL_S);
+}
+
+void GasHistory::writeBits(uint32_t value, uint8_t bits)
+{
+    uint8_t *payload = page + HEADER_BYTES;
+    for (int i = bits - 1; i >= 0; i--)
+    {
+        if ((value >> i) & 1)
+        {
+            payload[bitPosition >> 3] |= 0x80 >> (bitPosition & 7);
+        }
+        bitPosition++;
+    }
+}
+
+void GasHistory::encode(uint32_t time, uint16_t value)
+{
+    if (header.count == 0)
+    {
+        header.firstTime = time;
+        checkpointTime = time;
+        writeBits(value, 16);
+        previousDelta = 1; // The expected 1 Hz cadence
+    }
+    else
+    {
+        // Delta of delta: 0 while the cadence holds
+        uint32_t delta = time - previousTime;
+        int64_t dod = (int64_t)delta - previousDelta;
+        if (dod == 0)
+        {
+            writeBits(0, 1);
+        }
+        else if (dod >= -8 && dod <= 7)
+        {
+            writeBits(0x2, 2);
+            writeBits((uint32_t)dod & 0xF, 4);
+        }
+        else if (dod >= -128 && dod <= 127)
+        {
+            writeBits(0x6, 3);
+            writeBits((uint32_t)dod & 0xFF, 8);
+        }
+        else if (dod >= -32768 && dod <= 32767)
+        {
+            writeBits(0xE, 4);
+            writeBits((uint32_t)dod & 0xFFFF, 16);
+        }
+        else
+        {
+            writeBits(0xF, 4);
+            writeBits(delta, 32);
+        }
+        previousDelta = delta;
+
+        // Zigzag change of the quantized value: small either way, 0 while steady
+        int32_t change = (int32_t)value - previousValue;
+        uint32_t zigzag = ((uint32_t)change << 1) ^ (uint32_t)(change >> 31);
+        if (zigzag == 0)
+        {
+            writeBits(0, 1);
+        }
+        else if (zigzag < 8)
+        {
+            writeBits(0x2, 2);
+            writeBits(zigzag, 3);
+        }
+        else if (zigzag < 256)
+        {
+            writeBits(0x6, 3);
+            writeBits(zigzag, 8);
+        }
+        else if (zigzag < 4096)
+        {
+            writeBits(0xE, 4);
+            writeBits(zigzag, 12);
+        }
+        else
+        {
+            writeBits(0xF, 4);
+            writeBits(zigzag, 17);
+        }
+    }
+
+    previousTime = time;
+    previousValue = value;
+    header.lastTime = time;
+    header.count++;
+    header.bitLength = bitPosition;
+    dirty = true;
+}
+
+bool GasHistory::checkpoint(uint32_t maxAgeSeconds)
+{
+    if (!dirty || header.lastTime - checkpointTime < maxAgeSeconds)
+    {
+        return false;
+    }
+    return writeOpen();
+}
+
+bool GasHistory::flush()
+{
+    return dirty && writeOpen();
+}
+
+bool GasHistory::writeOpen()
+{
+    if (!persistent)
+    {
+        return false;
+    }
+    // Only what changed since the last checkpoint: the header once, then a
+    // record and the payload from the byte that held the last stored bit
+    size_t length = 0;
+    if (!segmentStored)
+    {
+        SegmentHeader created = SegmentHeader{MAGIC, 0, 0, 0, header.firstTime, header.firstTime};
+        memcpy(scratch, &created, HEADER_BYTES);
+        length = HEADER_BYTES;
+    }
+    CheckpointRecord record = CheckpointRecord{header.count, header.bitLength, header.lastTime};
+    memcpy(scratch + length, &record, RECORD_BYTES);
+    length += RECORD_BYTES;
+    size_t from = checkpointBits / 8;
+    size_t payload = (bitPosition + 7) / 8 - from;
+    memcpy(scratch + length, page + HEADER_BYTES + from, payload);
+    length += payload;
+
+    if (!storage->append(openSequence, scratch, length))
+    {
+        return false;
+    }
+    segmentWrites++;
+    bytesWritten += length;
+    segmentStored = true;
+    checkpointBits = bitPosition;
+    dirty = false;
+    checkpointTime = header.lastTime;
+    return true;
+}
+
+void GasHistory::seal()
+{
+    writeOpen();
+    openSequence++;
+    if (persistent)
+    {
+        // Circular: the oldest segment makes room for the new open one
+        while (openSequence + 1 - firstSequence > maxSegments)
+        {
+            storage->remove(firstSequence++);
+        }
+    }
+    else
+    {
+        firstSequence = openSequence;
+    }
+    startSegment();
+}
+
+bool GasHistory::readHeader(uint32_t sequence, SegmentHeader &out)
+{
+    return storage->read(sequence, 0, (uint8_t *)&out, HEADER_BYTES) == HEADER_BYTES && out.magic == MAGIC;
+}
+
+size_t GasHistory::query(uint32_t fromTime, uint32_t toTime, Visitor visit, void *context)
+{
+    size_t visited = 0;
+
+    if (persistent)
+    {
+        // Segments are in time order and a stored header only holds its start:
+        // binary search the first segment starting at fromTime or later, then
+        // step back to the one that may still reach it
+        uint32_t low = firstSequence;
+        uint32_t high = openSequence;
+        while (low < high)
+        {
+            uint32_t middle = low + (high - low) / 2;
+            SegmentHeader candidate;
+            if (!readHeader(middle, candidate) || candidate.firstTime < fromTime)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+        if (low > firstSequence)
+        {
+            low--;
+        }
+
+        for (uint32_t sequence = low; sequence < openSequence; sequence++)
+        {
+            bool intact;
+            if (!load(sequence, scratch, intact))
+            {
+                continue;
+            }
+            SegmentHeader stored;
+            memcpy(&stored, scratch, HEADER_BYTES);
+            if (stored.firstTime > toTime)
+            {
+                return visited;
+            }
+            visited += decode(scratch, fromTime, toTime, visit, context, nullptr);
+        }
+    }
+
+    // The open segment in RAM is newer than its last checkpoint
+    if (header.count > 0 && header.firstTime <= toTime && header.lastTime >= fromTime)
+    {
+        memcpy(page, &header, HEADER_BYTES);
+        visited += decode(page, fromTime, toTime, visit, context, nullptr);
+    }
+    return visited;
+}
+
+uint32_t GasHistory::readBits(const uint8_t *payload, uint32_t &position, uint8_t bits)
+{
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bits; i++)
+    {
+        value = (value << 1) | ((payload[position >> 3] >> (7 - (position & 7))) & 1);
+        position++;
+    }
+    return value;
+}
+
+uint8_t GasHistory::readPrefix(const uint8_t *payload, uint32_t &position)
+{
+    // 0, 10, 110, 1110 or 1111
+    uint8_t ones = 0;
+    while (ones < 4 && readBits(payload, position, 1))
+    {
+        ones++;
+    }
+    return ones;
+}
+
+size_t GasHistory::decode(const uint8_t *segment, uint32_t fromTime, uint32_t toTime,
+                          Visitor visit, void *context, DecodeState *end)
+{
+    static const uint8_t DOD_BITS[] = {0, 4, 8, 16, 32};
+    static const uint8_t CHANGE_BITS[] = {0, 3, 8, 12, 17};
+
+    SegmentHeader stored;
+    memcpy(&stored, segment, HEADER_BYTES);
+    const uint8_t *payload = segment + HEADER_BYTES;
+
+    uint32_t position = 0;
+    uint32_t time = stored.firstTime;
+    uint32_t delta = 1;
+    uint16_t value = 0;
+    size_t visited = 0;
+
+    for (uint16_t i = 0; i < stored.count; i++)
+    {
+        if (i == 0)
+        {
+            value = readBits(payload, position, 16);
+        }
+        else
+        {
+            uint8_t code = readPrefix(payload, position);
+            if (code == 4)
+            {
+                delta = readBits(payload, position, 32);
+            }
+            else if (code > 0)
+            {
+                uint8_t bits = DOD_BITS[code];
+                uint32_t raw = readBits(payload, position, bits);
+                int32_t dod = (int32_t)(raw << (32 - bits)) >> (32 - bits);
+                delta += dod;
+            }
+            time += delta;
+
+            code = readPrefix(payload, position);
+            if (code > 0)
+            {
+                uint32_t zigzag = readBits(payload, position, CHANGE_BITS[code]);
+                int32_t change = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+                value = (uint16_t)(value + change);
+            }
+        }
+
+        if (end == nullptr && time > toTime)
+        {
+            break;
+        }
+        if (visit != nullptr && time >= fromTime && time <= toTime)
+        {
+            visit(time, value, context);
+            visited++;
+        }
+    }
+
+    if (end != nullptr)
+    {
+        *end = DecodeState{position, time, delta, value};
+    }
+    return visited;
+}
+
+uint16_t GasHistory::quantize(float ppm)
+{
+    if (ppm <= 0)
+    {
+        return 0;
+    }
+    if (ppm >= MAX_QUANTIZED)
+    {
+        return MAX_QUANTIZED;
+    }
+    return (uint16_t)(ppm + 0.5f);
+}
+
+bool GasHistory::isPersistent() const
+{
+    return persistent;
+}
+
+bool GasHistory::isEmpty() const
+{
+    return header.count == 0 && firstSequence == openSequence;
+}
+
+uint32_t GasHistory::getFirstTime()
+{
+    SegmentHeader oldest;
+    if (persistent && firstSequence < openSequence && readHeader(firstSequence, oldest))
+    {
+        return oldest.firstTime;
+    }
+    return header.firstTime;
+}
+
+uint32_t GasHistory::getLastTime() const
+{
+    return header.count > 0 ? header.lastTime : clockSeconds;
+}
+
+uint32_t GasHistory::getStoredSegments() const
+{
+    return openSequence - firstSequence + (header.count > 0 ? 1 : 0);
+}
+
+uint32_t GasHistory::getStoredBytes() const
+{
+    // Sealed segments are counted as full
+    return (openSequence - firstSequence) * SEGMENT_BYTES + HEADER_BYTES + (bitPosition + 7) / 8;
+}
+
+uint32_t GasHistory::getSegmentWrites() const
+{
+    return segmentWrites;
+}
+
+uint32_t GasHistory::getBytesWritten() const
+{
+    return bytesWritten;
+}
+
+float GasHistory::getBitsPerSample() const
+{
+    return appended == 0 ? 0 : (float)appendedBits / appended;
+}
@@ -0,0 +1,127 @@
+#ifndef GAS_HISTORY_H
+#define GAS_HISTORY_H
+
+#include <Arduino.h>
+#include "SegmentStorage.h"
+
+// Append-only, circular time series of PPM readings on flash. Samples are
+// packed into 4 KB segments: timestamps as delta-of-delta seconds (one bit
+// when the cadence holds) and PPM quantized to whole units, stored as the
+// change from the previous value (one bit when it holds). The open segment
+// is checkpointed every few minutes and when it fills; each checkpoint
+// appends only the bytes encoded since the previous one, and the oldest
+// segment is removed once the store is full. Segments carry their start
+// time, so queries skip straight to the span they need.
+class GasHistory
+{
+public:
+    static const size_t SEGMENT_BYTES = 4096;
+    static const uint16_t DEFAULT_MAX_SEGMENTS = 96;   // 384 KB
+    static const uint32_t CHECKPOINT_INTERVAL_S = 600; // Open segment age before it is checkpointed
+    static const uint16_t MAX_QUANTIZED = 65535;
+
+    typedef void (*Visitor)(uint32_t time, float ppm, void *context);
+
+private:
+    struct SegmentHeader
+    {
+        uint16_t magic;
+        uint16_t count;
+        uint16_t bitLength;
+        uint16_t reserved;
+        uint32_t firstTime;
+        uint32_t lastTime;
+    };
+
+    // Appended by each checkpoint, followed by the payload from the byte
+    // that held the previous checkpoint's last bit
+    struct CheckpointRecord
+    {
+        uint16_t count;
+        uint16_t bitLength;
+        uint32_t lastTime;
+    };
+
+    struct DecodeState
+    {
+        uint32_t bitPosition;
+        uint32_t time;
+        uint32_t delta;
+        uint16_t value;
+    };
+
+    static const uint16_t MAGIC = 0x4748;
+    static const size_t HEADER_BYTES = sizeof(SegmentHeader);
+    static const size_t RECORD_BYTES = sizeof(CheckpointRecord);
+    static const uint32_t PAYLOAD_BITS = (SEGMENT_BYTES - HEADER_BYTES) * 8;
+    static const uint32_t MAX_SAMPLE_BITS = 4 + 32 + 4 + 17;
+
+    SegmentStorage *storage;
+    uint16_t maxSegments;
+    bool persistent;
+
+    uint8_t page[SEGMENT_BYTES];                   // Open segment, header first
+    uint8_t scratch[SEGMENT_BYTES + RECORD_BYTES]; // Stored segments and checkpoint appends
+    SegmentHeader header;
+    uint32_t bitPosition;
+    uint32_t checkpointBits; // Payload bits already in storage
+    bool segmentStored;      // The open segment's header is in storage
+    uint32_t firstSequence;
+    uint32_t openSequence;
+    uint32_t checkpointTime;
+    bool dirty;
+
+    // Encoder state, restored from the open segment on begin()
+    uint32_t previousTime;
+    uint32_t previousDelta;
+    uint16_t previousValue;
+
+    // Log clock: seconds that keep counting across reboots
+    uint32_t clockSeconds;
+    unsigned long clockMillis;
+    bool clockStarted;
+
+    uint32_t appended;
+    uint32_t appendedBits;
+    uint32_t segmentWrites;
+    uint32_t bytesWritten;
+
+    void startSegment();
+    void writeBits(uint32_t value, uint8_t bits);
+    void encode(uint32_t time, uint16_t value);
+    bool writeOpen();
+    void seal();
+    bool resume();
+    bool load(uint32_t sequence, uint8_t *segment, bool &intact);
+    bool readHeader(uint32_t sequence, SegmentHeader &out);
+    static uint32_t readBits(const uint8_t *payload, uint32_t &position, uint8_t bits);
+    static uint8_t readPrefix(const uint8_t *payload, uint32_t &position);
+    static size_t decode(const uint8_t *segment, uint32_t fromTime, uint32_t toTime,
+                         Visitor visit, void *context, DecodeState *end);
+
+public:
+    GasHistory(SegmentStorage *storage, uint16_t maxSegments = DEFAULT_MAX_SEGMENTS);
+
+    bool begin();
+    uint32_t timeAt(unsigned long nowMillis);
+    void record(unsigned long nowMillis, float ppm);
+    void append(uint32_t time, float ppm);
+    bool checkpoint(uint32_t maxAgeSeconds);
+    bool flush();
+
+    size_t query(uint32_t fromTime, uint32_t toTime, Visitor visit, void *context);
+
+    bool isPersistent() const;
+    bool isEmpty() const;
+    uint32_t getFirstTime();
+    uint32_t getLastTime() const;
+    uint32_t getStoredSegments() const;
+    uint32_t getStoredBytes() const;
+    uint32_t getSegmentWrites() const;
+    uint32_t getBytesWritten() const;
+    float getBitsPerSample() const;
+
+    static uint16_t quantize(float ppm);
+};
+
+#endif
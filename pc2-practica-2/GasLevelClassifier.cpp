@@ -0,0 +1,131 @@
+#include "GasLevelClassifier.h"
+
+GasLevelClassifier::GasLevelClassifier(float safeThreshold, float criticalThreshold)
+    : safeThreshold(safeThreshold), criticalThreshold(criticalThreshold),
+      safeBand(20), criticalBand(50), dwellMs{0, 5000, 10000}
+{
+    reset();
+}
+
+void GasLevelClassifier::reset()
+{
+    level = GasLevel::SAFE;
+    rawLevel = GasLevel::SAFE;
+    started = false;
+    stepDownPending = false;
+    stepDownSince = 0;
+    rawTransitions = 0;
+    transitions = 0;
+}
+
+void GasLevelClassifier::setBands(float safeBandPpm, float criticalBandPpm)
+{
+    safeBand = safeBandPpm;
+    criticalBand = criticalBandPpm;
+}
+
+void GasLevelClassifier::setDwell(GasLevel level, unsigned long ms)
+{
+    dwellMs[(int)level] = ms;
+}
+
+GasLevel GasLevelClassifier::classifyRaw(float ppm) const
+{
+    if (ppm < safeThreshold)
+    {
+        return GasLevel::SAFE;
+    }
+    else if (ppm < criticalThreshold)
+    {
+        return GasLevel::MODERATE;
+    }
+    else
+    {
+        return GasLevel::CRITICAL;
+    }
+}
+
+GasLevel GasLevelClassifier::stepDownTarget(float ppm) const
+{
+    if (ppm < safeThreshold - safeBand)
+    {
+        return GasLevel::SAFE;
+    }
+    else if (ppm < criticalThreshold - criticalBand)
+    {
+        return GasLevel::MODERATE;
+    }
+    else
+    {
+        return GasLevel::CRITICAL;
+    }
+}
+
+GasLevel GasLevelClassifier::update(float ppm, unsigned long timestamp)
+{
+    GasLevel raw = classifyRaw(ppm);
+    if (started && raw != rawLevel)
+    {
+        rawTransitions++;
+    }
+    rawLevel = raw;
+
+    if (!started)
+    {
+        // The first sample is taken as is
+        started = true;
+        level = raw;
+        return level;
+    }
+
+    if (raw > level)
+    {
+        // Escalation is never damped
+        level = raw;
+        stepDownPending = false;
+        transitions++;
+        return level;
+    }
+
+    GasLevel target = stepDownTarget(ppm);
+    if (target >= level)
+    {
+        // Back inside the band: the step-down has to start over
+        stepDownPending = false;
+        return level;
+    }
+
+    if (!stepDownPending)
+    {
+        stepDownPending = true;
+        stepDownSince = timestamp;
+    }
+
+    if (timestamp - stepDownSince >= dwellMs[(int)level])
+    {
+        level = target;
+        stepDownPending = false;
+        transitions++;
+    }
+    return level;
+}
+
+GasLevel GasLevelClassifier::getLevel() const
+{
+    return level;
+}
+
+uint32_t GasLevelClassifier::getRawTransitions() const
+{
+    return rawTransitions;
+}
+
+uint32_t GasLevelClassifier::getTransitions() const
+{
+    return transitions;
+}
+
+uint32_t GasLevelClassifier::getSuppressedTransitions() const
+{
+    return rawTransitions > transitions ? rawTransitions - transitions : 0;
+}
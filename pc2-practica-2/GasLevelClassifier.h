@@ -0,0 +1,55 @@
+#ifndef GAS_LEVEL_CLASSIFIER_H
+#define GAS_LEVEL_CLASSIFIER_H
+
+#include <stdint.h>
+
+enum class GasLevel
+{
+    SAFE,     // < 200 PPM
+    MODERATE, // 200-500 PPM
+    CRITICAL  // > 500 PPM
+};
+
+// Level classification with hysteresis. Escalation happens on the first
+// sample over a threshold, so CRITICAL is never delayed. De-escalation needs
+// the PPM to stay below the threshold minus its band for the current
+// level's dwell time, which stops a reading hovering around 200 or 500 PPM
+// from flipping the level (and every output behind it) on each sample.
+class GasLevelClassifier
+{
+private:
+    static const int LEVEL_COUNT = 3;
+
+    float safeThreshold;
+    float criticalThreshold;
+    float safeBand;
+    float criticalBand;
+    unsigned long dwellMs[LEVEL_COUNT];
+
+    GasLevel level;
+    GasLevel rawLevel;
+    bool started;
+    bool stepDownPending;
+    unsigned long stepDownSince;
+
+    uint32_t rawTransitions;
+    uint32_t transitions;
+
+    GasLevel stepDownTarget(float ppm) const;
+
+public:
+    GasLevelClassifier(float safeThreshold, float criticalThreshold);
+
+    void reset();
+    GasLevel update(float ppm, unsigned long timestamp);
+    void setBands(float safeBandPpm, float criticalBandPpm);
+    void setDwell(GasLevel level, unsigned long ms);
+
+    GasLevel classifyRaw(float ppm) const;
+    GasLevel getLevel() const;
+    uint32_t getRawTransitions() const;
+    uint32_t getTransitions() const;
+    uint32_t getSuppressedTransitions() const;
+};
+
+#endif
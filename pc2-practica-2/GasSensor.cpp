@@ -1,28 +1,72 @@
 #include "GasSensor.h"
+#include "AdcSources.h"
 #include <Arduino.h>
 
 const float GasSensor::RATIO_MQ2_CLEAN_AIR = 9.83;
 
-GasSensor::GasSensor(int analogPin, int digitalPin)
-    : analogPin(analogPin), digitalPin(digitalPin)
+// MQ-2 LPG regression (datasheet fit used by MQUnifiedsensor): PPM = 574.25 * ratio^-2.222
+static constexpr Mq2CurveTable LPG_CURVE(574.25, -2.222);
+static_assert(LPG_CURVE.maxRelativeError() < 0.001, "LPG curve table exceeds 0.1% interpolation error");
+
+// The other species' curves from the same reference table, on the same nodes
+static constexpr Mq2CurveTable PROPANE_CURVE(658.71, -2.168);
+static constexpr Mq2CurveTable H2_CURVE(987.99, -2.162);
+static constexpr Mq2CurveTable CO_CURVE(36974, -3.109);
+static constexpr Mq2CurveTable ALCOHOL_CURVE(3616.1, -2.675);
+static_assert(PROPANE_CURVE.maxRelativeError() < 0.001, "propane curve table exceeds 0.1% interpolation error");
+static_assert(H2_CURVE.maxRelativeError() < 0.001, "H2 curve table exceeds 0.1% interpolation error");
+static_assert(CO_CURVE.maxRelativeError() < 0.002, "CO curve table exceeds 0.2% interpolation error");
+static_assert(ALCOHOL_CURVE.maxRelativeError() < 0.002, "alcohol curve table exceeds 0.2% interpolation error");
+const float GasSensor::VOLTAGE_RESOLUTION = 3.3;
+
+const Event GasSensor::LEVEL_SAFE_EVENT = Event(LEVEL_SAFE_EVENT_ID);
+const Event GasSensor::LEVEL_MODERATE_EVENT = Event(LEVEL_MODERATE_EVENT_ID);
+const Event GasSensor::LEVEL_CRITICAL_EVENT = Event(LEVEL_CRITICAL_EVENT_ID);
+const Event GasSensor::PRE_CRITICAL_STARTED_EVENT = Event(PRE_CRITICAL_STARTED_EVENT_ID);
+const Event GasSensor::PRE_CRITICAL_ENDED_EVENT = Event(PRE_CRITICAL_ENDED_EVENT_ID);
+
+GasSensor::GasSensor(int analogPin, int digitalPin, EventHandler *eventHandler)
+    : Sensor(analogPin, eventHandler), trendDetector(TREND_WINDOW_MS),
+      levelClassifier(SAFE_THRESHOLD, CRITICAL_THRESHOLD), ppmRollup("ppm"), digitalPin(digitalPin),
+      reading{0, 0, GasLevel::SAFE, false, 0, 0, RiseAlarm::STEADY, {}, 0}, levelAnnounced(false)
 {
-    mq2Sensor = new MQUnifiedsensor("ESP-32", 3.3, 12, analogPin, "MQ-2");
+    registerDefaultSpecies();
+
+    mq2Sensor = new MQUnifiedsensor("ESP-32", VOLTAGE_RESOLUTION, 12, analogPin, "MQ-2");
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (ContinuousAdcSource::supportsPin(analogPin))
+    {
+        adcSource = new ContinuousAdcSource(analogPin);
+    }
+    else
+    {
+        adcSource = new ClockedAdcSource(analogPin);
+    }
+#else
+    adcSource = new PolledAdcSource(analogPin, DEFAULT_OVERSAMPLING);
+#endif
+    adcFrontEnd = new GasAdcFrontEnd(adcSource, DEFAULT_OVERSAMPLING);
 }
 
 GasSensor::~GasSensor()
 {
+    delete adcFrontEnd;
+    delete adcSource;
     delete mq2Sensor;
 }
 
 void GasSensor::initialize()
 {
-    // Set Parameters to detect PPM concentration for LPG
+    // Set Parameters to detect PPM concentration for LPG. PPM is evaluated
+    // from LPG_CURVE; the library keeps the same coefficients for debugging.
     mq2Sensor->setRegressionMethod(1);
-    mq2Sensor->setA(574.25);
-    mq2Sensor->setB(-2.222);
+    mq2Sensor->setA(LPG_CURVE.getA());
+    mq2Sensor->setB(LPG_CURVE.getB());
 
-    // MQ2 Init
+    // MQ2 Init; conversions come from the ADC front-end, not the library
     mq2Sensor->init();
+    adcFrontEnd->begin();
 
     // Digital pin setup
     pinMode(digitalPin, INPUT);
@@ -35,7 +79,8 @@ void GasSensor::calibrate()
 
     for (int i = 1; i <= 10; i++)
     {
-        mq2Sensor->update();
+        waitForFrontEndSample();
+        mq2Sensor->externalADCUpdate(frontEndVoltage());
         calcR0 += mq2Sensor->calibrate(RATIO_MQ2_CLEAN_AIR);
         Serial.print(".");
     }
@@ -62,25 +107,160 @@ void GasSensor::calibrate()
 
 void GasSensor::update()
 {
-    mq2Sensor->update();
-    mq2Sensor->readSensor();
+    // Never waits on the ADC: without a fresh decimated block the previous
+    // reading stands for this tick and nothing is published
+    if (adcFrontEnd->poll(micros()))
+    {
+        GasLevel previousLevel = reading.level;
+        bool wasPreCritical = reading.isPreCritical();
+
+        float voltage = frontEndVoltage();
+        mq2Sensor->externalADCUpdate(voltage);
+        float ratio = resistanceRatio(voltage);
+        float ppm = LPG_CURVE.evaluate(ratio);
+        reading.speciesAlarms = species.evaluate(ratio, reading.speciesPpm);
+
+        int percentage = (int)(voltage * 100 / VOLTAGE_RESOLUTION);
+        percentage = constrain(percentage, 0, 100);
+
+        reading.ppm = ppm;
+        reading.percentage = percentage;
+        // Clocked sources give the block's sample time, so the trend sees even spacing
+        if (!adcFrontEnd->getBlockTime(reading.timestamp))
+        {
+            reading.timestamp = millis();
+        }
+        reading.level = levelClassifier.update(ppm, reading.timestamp);
+        reading.riseAlarm = trendDetector.update(reading.timestamp, ppm);
+        reading.trendPpmPerSecond = trendDetector.getSlope();
+        reading.digitalHigh = digitalRead(digitalPin) == HIGH;
+        ppmRollup.add(rollupClock.seconds(reading.timestamp), ppm);
+
+        publishTransitions(previousLevel, wasPreCritical);
+    }
+}
+
+void GasSensor::publishTransitions(GasLevel previousLevel, bool wasPreCritical)
+{
+    // The first conversion always announces its level so outputs start in sync
+    if (!levelAnnounced || reading.level != previousLevel)
+    {
+        levelAnnounced = true;
+        on(levelEvent(reading.level));
+    }
+
+    bool preCritical = reading.isPreCritical();
+    if (preCritical != wasPreCritical)
+    {
+        on(preCritical ? PRE_CRITICAL_STARTED_EVENT : PRE_CRITICAL_ENDED_EVENT);
+    }
+}
+
+const GasReading &GasSensor::getReading() const
+{
+    return reading;
+}
+
+const GasAdcFrontEnd &GasSensor::getAdcFrontEnd() const
+{
+    return *adcFrontEnd;
+}
+
+bool GasSensor::setOversampling(uint16_t ratio)
+{
+    return adcFrontEnd->setOversampling(ratio);
+}
+
+GasSpeciesTable &GasSensor::getSpecies()
+{
+    return species;
+}
+
+void GasSensor::registerDefaultSpecies()
+{
+    // MQ-2 curves from the MQUnifiedsensor reference table. Thresholds:
+    // LPG/propane at the CRITICAL level, CO at the 50 PPM exposure limit,
+    // H2 and alcohol at 1000 PPM, far below their explosive limits
+    species.addSpecies("LPG", LPG_CURVE, CRITICAL_THRESHOLD);
+    species.addSpecies("Propane", PROPANE_CURVE, CRITICAL_THRESHOLD);
+    species.addSpecies("H2", H2_CURVE, 1000);
+    species.addSpecies("CO", CO_CURVE, 50);
+    species.addSpecies("Alcohol", ALCOHOL_CURVE, 1000);
+}
+
+GasLevelClassifier &GasSensor::getLevelClassifier()
+{
+    return levelClassifier;
+}
+
+GasTrendDetector &GasSensor::getTrendDetector()
+{
+    return trendDetector;
+}
+
+const RollupSeries &GasSensor::getPpmRollup() const
+{
+    return ppmRollup;
+}
+
+float GasSensor::secondsToCritical() const
+{
+    return trendDetector.secondsUntil(reading.ppm, CRITICAL_THRESHOLD);
 }
 
-float GasSensor::readPPM()
+float GasSensor::frontEndVoltage() const
 {
-    return mq2Sensor->readSensorR();
+    return adcFrontEnd->getAverage() * VOLTAGE_RESOLUTION / GasAdcFrontEnd::ADC_MAX;
 }
 
-int GasSensor::readPercentage()
+float GasSensor::resistanceRatio(float voltage) const
 {
-    int gasValue = analogRead(analogPin);
-    return map(gasValue, 0, 4095, 0, 100);
+    // Same divider model as MQUnifiedsensor::readSensor(); no output
+    // voltage reads as the clean-air end of the curve
+    if (voltage <= 0)
+    {
+        return Mq2CurveTable::maxInput();
+    }
+    float rl = mq2Sensor->getRL();
+    float rs = (VOLTAGE_RESOLUTION * rl) / voltage - rl;
+    if (rs < 0)
+    {
+        rs = 0;
+    }
+    return rs / mq2Sensor->getR0();
 }
 
-GasLevel GasSensor::getGasLevel()
+const Mq2CurveTable &GasSensor::lpgCurve()
 {
-    float ppm = readPPM();
+    return LPG_CURVE;
+}
 
+void GasSensor::waitForFrontEndSample()
+{
+    // Only used during calibration, where blocking is acceptable
+    while (!adcFrontEnd->poll(micros()))
+    {
+        delay(1);
+    }
+}
+
+float GasSensor::readPPM() const
+{
+    return reading.ppm;
+}
+
+int GasSensor::readPercentage() const
+{
+    return reading.percentage;
+}
+
+GasLevel GasSensor::getGasLevel() const
+{
+    return reading.level;
+}
+
+GasLevel GasSensor::classify(float ppm)
+{
     if (ppm < SAFE_THRESHOLD)
     {
         return GasLevel::SAFE;
@@ -95,16 +275,58 @@ GasLevel GasSensor::getGasLevel()
     }
 }
 
-bool GasSensor::isDigitalHigh()
+Event GasSensor::levelEvent(GasLevel level)
 {
-    return digitalRead(digitalPin) == HIGH;
+    switch (level)
+    {
+    case GasLevel::MODERATE:
+        return LEVEL_MODERATE_EVENT;
+    case GasLevel::CRITICAL:
+        return LEVEL_CRITICAL_EVENT;
+    default:
+        return LEVEL_SAFE_EVENT;
+    }
 }
 
-String GasSensor::getStatusText()
+bool GasSensor::isDigitalHigh() const
 {
-    GasLevel level = getGasLevel();
+    return reading.digitalHigh;
+}
 
-    switch (level)
+bool GasSensor::samplesInBackground() const
+{
+    return adcSource->runsInBackground();
+}
+
+bool GasSensor::getNextSampleDue(unsigned long &dueMicros) const
+{
+    return adcSource->getNextSampleDue(dueMicros);
+}
+
+void GasSensor::resumeSampling()
+{
+    adcSource->resume();
+}
+
+const SamplingClock *GasSensor::getSamplingClock() const
+{
+    // Only clocked sources have one; the continuous driver is paced by the ADC itself
+    return adcSource->getClock();
+}
+
+const char *GasSensor::getStatusText() const
+{
+    return statusText(reading);
+}
+
+const char *GasSensor::statusText(const GasReading &reading)
+{
+    if (reading.isPreCritical())
+    {
+        return "RISING";
+    }
+
+    switch (reading.level)
     {
     case GasLevel::SAFE:
         return "SAFE";
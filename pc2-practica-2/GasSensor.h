@@ -2,36 +2,100 @@
 #define GAS_SENSOR_H
 
 #include <MQUnifiedsensor.h>
+#include "Sensor.h"
+#include "GasAdcFrontEnd.h"
+#include "GasTrendDetector.h"
+#include "GasSpeciesTable.h"
+#include "GasLevelClassifier.h"
+#include "RollupSeries.h"
 
-enum class GasLevel
+// Immutable result of one GasSensor::update() pass. Every consumer in a
+// tick reads the same values, so display, LEDs and log always agree.
+struct GasReading
 {
-    SAFE,     // < 200 PPM
-    MODERATE, // 200-500 PPM
-    CRITICAL  // > 500 PPM
+    float ppm;
+    int percentage;
+    GasLevel level;
+    bool digitalHigh;
+    unsigned long timestamp;
+    float trendPpmPerSecond;
+    RiseAlarm riseAlarm;
+    float speciesPpm[GasSpeciesTable::MAX_SPECIES]; // Indexed as GasSensor::getSpecies()
+    uint32_t speciesAlarms;                         // Bit i set when species i is over its threshold
+
+    // Rate-of-rise alarm while the level itself is not yet CRITICAL
+    bool isPreCritical() const { return riseAlarm != RiseAlarm::STEADY && level != GasLevel::CRITICAL; }
 };
 
-class GasSensor
+// Publishes level transitions as events; consumers react to those instead
+// of re-reading the level every loop pass.
+class GasSensor : public Sensor
 {
 private:
     MQUnifiedsensor *mq2Sensor;
-    int analogPin;
+    AdcSampleSource *adcSource;
+    GasAdcFrontEnd *adcFrontEnd;
+    GasTrendDetector trendDetector;
+    GasSpeciesTable species;
+    GasLevelClassifier levelClassifier;
+    RollupClock rollupClock; // Rollup seconds that survive the millis() wrap
+    RollupSeries ppmRollup;  // Minute/hour/day summaries of every conversion
     int digitalPin;
+    GasReading reading;
+    bool levelAnnounced;
     static const float RATIO_MQ2_CLEAN_AIR;
+    static const float VOLTAGE_RESOLUTION;
     static const int SAFE_THRESHOLD = 200;
     static const int CRITICAL_THRESHOLD = 500;
+    static const unsigned long TREND_WINDOW_MS = 10000;
+    static const uint16_t DEFAULT_OVERSAMPLING = 16;
+
+    float frontEndVoltage() const;
+    float resistanceRatio(float voltage) const;
+    void registerDefaultSpecies();
+    void waitForFrontEndSample();
+    void publishTransitions(GasLevel previousLevel, bool wasPreCritical);
 
 public:
-    GasSensor(int analogPin, int digitalPin);
+    static const int LEVEL_SAFE_EVENT_ID = 20;
+    static const int LEVEL_MODERATE_EVENT_ID = 21;
+    static const int LEVEL_CRITICAL_EVENT_ID = 22;
+    static const int PRE_CRITICAL_STARTED_EVENT_ID = 23;
+    static const int PRE_CRITICAL_ENDED_EVENT_ID = 24;
+    static const Event LEVEL_SAFE_EVENT;
+    static const Event LEVEL_MODERATE_EVENT;
+    static const Event LEVEL_CRITICAL_EVENT;
+    static const Event PRE_CRITICAL_STARTED_EVENT;
+    static const Event PRE_CRITICAL_ENDED_EVENT;
+
+    GasSensor(int analogPin, int digitalPin, EventHandler *eventHandler = nullptr);
     ~GasSensor();
 
     void initialize();
     void calibrate();
     void update();
-    float readPPM();
-    int readPercentage();
-    GasLevel getGasLevel();
-    bool isDigitalHigh();
-    String getStatusText();
+    const GasReading &getReading() const;
+    const GasAdcFrontEnd &getAdcFrontEnd() const;
+    bool setOversampling(uint16_t ratio);
+    GasTrendDetector &getTrendDetector();
+    GasSpeciesTable &getSpecies();
+    GasLevelClassifier &getLevelClassifier();
+    const RollupSeries &getPpmRollup() const;
+    float secondsToCritical() const;
+    float readPPM() const;
+    int readPercentage() const;
+    GasLevel getGasLevel() const;
+    bool isDigitalHigh() const;
+    bool samplesInBackground() const;
+    bool getNextSampleDue(unsigned long &dueMicros) const;
+    void resumeSampling();
+    const SamplingClock *getSamplingClock() const;
+    const char *getStatusText() const;
+
+    static const char *statusText(const GasReading &reading);
+    static GasLevel classify(float ppm);
+    static Event levelEvent(GasLevel level);
+    static const Mq2CurveTable &lpgCurve();
 };
 
 #endif
@@ -0,0 +1,84 @@
+#include "GasSpeciesTable.h"
+#include <string.h>
+
+GasSpeciesTable::GasSpeciesTable() : count(0) {}
+
+int GasSpeciesTable::addSpecies(const char *name, const Mq2CurveTable &curve, float alarmThresholdPpm)
+{
+    if (count >= MAX_SPECIES)
+    {
+        return -1;
+    }
+    names[count] = name;
+    curves[count] = &curve;
+    alarmPpm[count] = alarmThresholdPpm;
+    return count++;
+}
+
+void GasSpeciesTable::setAlarmThreshold(int index, float ppm)
+{
+    if (index >= 0 && index < count)
+    {
+        alarmPpm[index] = ppm;
+    }
+}
+
+uint32_t GasSpeciesTable::evaluate(float ratio, float *ppm) const
+{
+    uint32_t alarms = 0;
+
+    if (!(ratio > 0))
+    {
+        // Saturated sensor: report every species at its alarm level
+        for (int i = 0; i < count; i++)
+        {
+            ppm[i] = alarmPpm[i];
+            alarms |= 1UL << i;
+        }
+        return alarms;
+    }
+
+    float fraction;
+    int segment = Mq2CurveTable::locate(ratio, fraction);
+    for (int i = 0; i < count; i++)
+    {
+        ppm[i] = curves[i]->interpolate(segment, fraction);
+    }
+    for (int i = 0; i < count; i++)
+    {
+        alarms |= (uint32_t)(ppm[i] >= alarmPpm[i]) << i;
+    }
+    return alarms;
+}
+
+int GasSpeciesTable::size() const
+{
+    return count;
+}
+
+const char *GasSpeciesTable::getName(int index) const
+{
+    return (index >= 0 && index < count) ? names[index] : "";
+}
+
+const Mq2CurveTable *GasSpeciesTable::getCurve(int index) const
+{
+    return (index >= 0 && index < count) ? curves[index] : nullptr;
+}
+
+float GasSpeciesTable::getAlarmThreshold(int index) const
+{
+    return (index >= 0 && index < count) ? alarmPpm[index] : 0;
+}
+
+int GasSpeciesTable::indexOf(const char *name) const
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
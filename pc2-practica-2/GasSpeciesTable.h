@@ -0,0 +1,44 @@
+#ifndef GAS_SPECIES_TABLE_H
+#define GAS_SPECIES_TABLE_H
+
+#include <stdint.h>
+#include "PowerLawTable.h"
+
+// Rs/R0 from 0.125 to 16 (roughly 58000 down to 1 PPM LPG), 32 nodes per octave
+typedef PowerLawTable<-3, 4, 32> Mq2CurveTable;
+
+// Per-species MQ regression curves (PPM = a * (Rs/R0)^b), each tabulated at
+// compile time by Mq2CurveTable, stored as a structure of arrays. One Rs/R0
+// measurement is fanned out to every species in a single pass: all tables
+// share their nodes, so the segment is located once and each species then
+// costs one linear interpolation.
+class GasSpeciesTable
+{
+public:
+    static const int MAX_SPECIES = 8;
+
+private:
+    const char *names[MAX_SPECIES];
+    const Mq2CurveTable *curves[MAX_SPECIES];
+    float alarmPpm[MAX_SPECIES];
+    int count;
+
+public:
+    GasSpeciesTable();
+
+    // The curve must outlive the table; a static constexpr one lives in flash
+    int addSpecies(const char *name, const Mq2CurveTable &curve, float alarmThresholdPpm);
+    void setAlarmThreshold(int index, float ppm);
+
+    // Fills ppm[0..size()) and returns a bit mask of species at or above
+    // their alarm threshold
+    uint32_t evaluate(float ratio, float *ppm) const;
+
+    int size() const;
+    const char *getName(int index) const;
+    const Mq2CurveTable *getCurve(int index) const;
+    float getAlarmThreshold(int index) const;
+    int indexOf(const char *name) const;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "GasTrendDetector.h"
+
+GasTrendDetector::GasTrendDetector(unsigned long windowMs)
+    : windowMs(windowMs), risingRate(5), fastRate(20), minPpm(100)
+{
+    // Window / bucket + 1 partial bucket at each end must fit the ring
+    bucketMs = (windowMs + CAPACITY - 3) / (CAPACITY - 2);
+    if (bucketMs == 0)
+    {
+        bucketMs = 1;
+    }
+    reset();
+}
+
+void GasTrendDetector::reset()
+{
+    head = 0;
+    count = 0;
+    epoch = 0;
+    sumT = sumY = sumTT = sumTY = 0;
+    slope = 0;
+    alarm = RiseAlarm::STEADY;
+}
+
+void GasTrendDetector::setRateAlarms(float risingPpmPerSecond, float fastPpmPerSecond, float minPpm)
+{
+    risingRate = risingPpmPerSecond;
+    fastRate = fastPpmPerSecond;
+    this->minPpm = minPpm;
+}
+
+void GasTrendDetector::add(const Sample &sample)
+{
+    double t = (long)(sample.timestamp - epoch) / 1000.0;
+    sumT += t;
+    sumY += sample.ppm;
+    sumTT += t * t;
+    sumTY += t * sample.ppm;
+}
+
+void GasTrendDetector::remove(const Sample &sample)
+{
+    double t = (long)(sample.timestamp - epoch) / 1000.0;
+    sumT -= t;
+    sumY -= sample.ppm;
+    sumTT -= t * t;
+    sumTY -= t * sample.ppm;
+}
+
+void GasTrendDetector::rebase(unsigned long newEpoch)
+{
+    // Keeps t small so the sums do not lose precision over long uptimes;
+    // O(CAPACITY) but runs once a minute
+    epoch = newEpoch;
+    sumT = sumY = sumTT = sumTY = 0;
+    for (int i = 0; i < count; i++)
+    {
+        add(samples[(head - count + i + CAPACITY) % CAPACITY]);
+    }
+}
+
+RiseAlarm GasTrendDetector::update(unsigned long timestamp, float ppm)
+{
+    if (count == 0)
+    {
+        epoch = timestamp;
+    }
+
+    // Drop samples that left the window, then make room in the ring
+    while (count > 0)
+    {
+        const Sample &oldest = samples[(head - count + CAPACITY) % CAPACITY];
+        if (timestamp - oldest.timestamp <= windowMs && count < CAPACITY)
+        {
+            break;
+        }
+        remove(oldest);
+        count--;
+    }
+
+    Sample *newest = count > 0 ? &samples[(head - 1 + CAPACITY) % CAPACITY] : nullptr;
+    if (newest != nullptr && timestamp - newest->bucket < bucketMs)
+    {
+        // Same bucket: fold into its running means
+        remove(*newest);
+        newest->merged++;
+        newest->timestamp += (long)(timestamp - newest->timestamp) / newest->merged;
+        newest->ppm += (ppm - newest->ppm) / newest->merged;
+        add(*newest);
+    }
+    else
+    {
+        Sample sample = {timestamp, ppm, timestamp - timestamp % bucketMs, 1};
+        samples[head] = sample;
+        head = (head + 1) % CAPACITY;
+        count++;
+        add(sample);
+    }
+
+    if (timestamp - epoch >= REBASE_INTERVAL_MS)
+    {
+        rebase(samples[(head - count + CAPACITY) % CAPACITY].timestamp);
+    }
+
+    double denominator = count * sumTT - sumT * sumT;
+    slope = (count >= MIN_SAMPLES && denominator > 1e-9) ? (float)((count * sumTY - sumT * sumY) / denominator) : 0;
+
+    if (!spansEnough() || ppm < minPpm)
+    {
+        alarm = RiseAlarm::STEADY;
+    }
+    else if (slope >= fastRate)
+    {
+        alarm = RiseAlarm::FAST_RISE;
+    }
+    else if (slope >= risingRate)
+    {
+        alarm = RiseAlarm::SUSTAINED_RISE;
+    }
+    else
+    {
+        alarm = RiseAlarm::STEADY;
+    }
+    return alarm;
+}
+
+bool GasTrendDetector::spansEnough() const
+{
+    // A slope over a sliver of the window is mostly noise
+    if (count < MIN_SAMPLES)
+    {
+        return false;
+    }
+    const Sample &oldest = samples[(head - count + CAPACITY) % CAPACITY];
+    const Sample &newest = samples[(head - 1 + CAPACITY) % CAPACITY];
+    return newest.timestamp - oldest.timestamp >= windowMs / 2;
+}
+
+float GasTrendDetector::getSlope() const
+{
+    return slope;
+}
+
+RiseAlarm GasTrendDetector::getAlarm() const
+{
+    return alarm;
+}
+
+float GasTrendDetector::secondsUntil(float currentPpm, float targetPpm) const
+{
+    if (currentPpm >= targetPpm)
+    {
+        return 0;
+    }
+    if (slope <= 0)
+    {
+        return -1;
+    }
+    return (targetPpm - currentPpm) / slope;
+}
+
+int GasTrendDetector::getSampleCount() const
+{
+    return count;
+}
@@ -0,0 +1,74 @@
+#ifndef GAS_TREND_DETECTOR_H
+#define GAS_TREND_DETECTOR_H
+
+#include <stdint.h>
+
+enum class RiseAlarm
+{
+    STEADY,
+    SUSTAINED_RISE, // Rise above the warning rate
+    FAST_RISE       // Leak-like rise, expect CRITICAL soon
+};
+
+// Least-squares slope of PPM over a sliding time window. Samples live in a
+// fixed ring and the regression sums are updated incrementally, so each
+// sample costs O(1) and nothing is allocated. Timestamps are supplied by
+// the caller, which keeps the detector free of any hardware clock.
+//
+// The ring holds one entry per time bucket of window / (CAPACITY - 2), and
+// samples that land in the newest entry's bucket are averaged into it. The
+// whole window therefore fits whatever the sample rate: the continuous ADC
+// delivers about 31 blocks/s, which would otherwise fill the ring in 4 s.
+class GasTrendDetector
+{
+private:
+    struct Sample
+    {
+        unsigned long timestamp; // Mean time of the samples merged here
+        float ppm;               // Their mean PPM
+        unsigned long bucket;    // Start of the bucket they fell in
+        uint16_t merged;
+    };
+
+    static const int CAPACITY = 128;
+    static const int MIN_SAMPLES = 5;
+    static const unsigned long REBASE_INTERVAL_MS = 60000;
+
+    Sample samples[CAPACITY];
+    int head;
+    int count;
+    unsigned long windowMs;
+    unsigned long bucketMs;
+    unsigned long epoch;
+
+    // Sums over the window, with t in seconds relative to epoch
+    double sumT;
+    double sumY;
+    double sumTT;
+    double sumTY;
+
+    float risingRate;
+    float fastRate;
+    float minPpm;
+    float slope;
+    RiseAlarm alarm;
+
+    void add(const Sample &sample);
+    void remove(const Sample &sample);
+    void rebase(unsigned long newEpoch);
+    bool spansEnough() const;
+
+public:
+    GasTrendDetector(unsigned long windowMs = 10000);
+
+    void reset();
+    RiseAlarm update(unsigned long timestamp, float ppm);
+    void setRateAlarms(float risingPpmPerSecond, float fastPpmPerSecond, float minPpm);
+
+    float getSlope() const;
+    RiseAlarm getAlarm() const;
+    float secondsUntil(float currentPpm, float targetPpm) const;
+    int getSampleCount() const;
+};
+
+#endif
@@ -0,0 +1,295 @@
+#include "I2cBusManager.h"
+#include <Wire.h>
+
+I2cBusManager::I2cBusManager()
+    : clockHz(100000), negotiated(false), blocking(false), started(false),
+      completed(0), failed(0), dropped(0), busyMicros(0), maxCallerMicros(0)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    for (uint8_t i = 0; i < PRIORITY_LEVELS; i++)
+    {
+        queues[i] = nullptr;
+    }
+    workSignal = nullptr;
+    worker = nullptr;
+    transferring = false;
+#else
+    for (uint8_t i = 0; i < PRIORITY_LEVELS; i++)
+    {
+        head[i] = 0;
+        count[i] = 0;
+    }
+#endif
+}
+
+I2cBusManager::~I2cBusManager()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    if (worker != nullptr)
+    {
+        vTaskDelete(worker);
+    }
+    for (uint8_t i = 0; i < PRIORITY_LEVELS; i++)
+    {
+        if (queues[i] != nullptr)
+        {
+            vQueueDelete(queues[i]);
+        }
+    }
+    if (workSignal != nullptr)
+    {
+        vSemaphoreDelete(workSignal);
+    }
+#endif
+}
+
+void I2cBusManager::begin()
+{
+    if (started)
+    {
+        return;
+    }
+    Wire.begin();
+    Wire.setClock(clockHz);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    for (uint8_t i = 0; i < PRIORITY_LEVELS; i++)
+    {
+        queues[i] = xQueueCreate(QUEUE_DEPTH, sizeof(I2cTransaction));
+    }
+    workSignal = xSemaphoreCreateCounting(PRIORITY_LEVELS * QUEUE_DEPTH, 0);
+    xTaskCreate(workerLoop, "i2c-bus", 3072, this, 2, &worker);
+#endif
+    started = true;
+}
+
+uint32_t I2cBusManager::negotiateClock(uint8_t address, uint32_t maxClockHz)
+{
+    // Call while the bus is idle. Fast mode must ACK repeatedly to be kept;
+    // the PCF8574 is only specified for 100 kHz, so marginal LCD backpacks
+    // fall back here instead of corrupting characters later.
+    static const uint32_t candidates[] = {400000, 100000};
+    uint32_t accepted = 100000;
+    waitIdle(100);
+
+    for (uint32_t candidate : candidates)
+    {
+        if (candidate > maxClockHz)
+        {
+            continue;
+        }
+        Wire.setClock(candidate);
+
+        bool ok = true;
+        for (int attempt = 0; attempt < 3 && ok; attempt++)
+        {
+            Wire.beginTransmission(address);
+            ok = Wire.endTransmission() == 0;
+        }
+        if (ok)
+        {
+            accepted = candidate;
+            break;
+        }
+    }
+
+    // The shared bus runs at the slowest speed any peripheral accepted
+    clockHz = (negotiated && clockHz < accepted) ? clockHz : accepted;
+    negotiated = true;
+    Wire.setClock(clockHz);
+    return accepted;
+}
+
+bool I2cBusManager::enqueue(uint8_t address, const uint8_t *data, uint8_t length, I2cPriority priority)
+{
+    unsigned long start = micros();
+    bool accepted = true;
+
+    I2cTransaction transaction;
+    transaction.address = address;
+    transaction.length = length > I2cTransaction::MAX_PAYLOAD ? I2cTransaction::MAX_PAYLOAD : length;
+    memcpy(transaction.data, data, transaction.length);
+
+    uint8_t level = (uint8_t)priority;
+    if (blocking || !started)
+    {
+        transfer(transaction);
+    }
+    else
+    {
+#if defined(ARDUINO_ARCH_ESP32)
+        accepted = xQueueSend(queues[level], &transaction, 0) == pdTRUE;
+        if (accepted)
+        {
+            xSemaphoreGive(workSignal);
+        }
+#else
+        accepted = count[level] < QUEUE_DEPTH;
+        if (accepted)
+        {
+            pending[level][(head[level] + count[level]) % QUEUE_DEPTH] = transaction;
+            count[level]++;
+        }
+#endif
+        if (!accepted)
+        {
+            dropped++;
+        }
+    }
+
+    unsigned long elapsed = micros() - start;
+    if (elapsed > maxCallerMicros)
+    {
+        maxCallerMicros = elapsed;
+    }
+    return accepted;
+}
+
+bool I2cBusManager::takeNext(I2cTransaction &transaction)
+{
+    for (uint8_t level = 0; level < PRIORITY_LEVELS; level++)
+    {
+#if defined(ARDUINO_ARCH_ESP32)
+        if (xQueueReceive(queues[level], &transaction, 0) == pdTRUE)
+        {
+            return true;
+        }
+#else
+        if (count[level] > 0)
+        {
+            transaction = pending[level][head[level]];
+            head[level] = (head[level] + 1) % QUEUE_DEPTH;
+            count[level]--;
+            return true;
+        }
+#endif
+    }
+    return false;
+}
+
+void I2cBusManager::transfer(const I2cTransaction &transaction)
+{
+    unsigned long start = micros();
+    Wire.beginTransmission(transaction.address);
+    Wire.write(transaction.data, transaction.length);
+    if (Wire.endTransmission() == 0)
+    {
+        completed++;
+    }
+    else
+    {
+        failed++;
+    }
+    busyMicros += micros() - start;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void I2cBusManager::workerLoop(void *parameter)
+{
+    I2cBusManager *bus = static_cast<I2cBusManager *>(parameter);
+    I2cTransaction transaction;
+
+    for (;;)
+    {
+        xSemaphoreTake(bus->workSignal, portMAX_DELAY);
+        bus->transferring = true;
+        if (bus->takeNext(transaction))
+        {
+            bus->transfer(transaction);
+        }
+        bus->transferring = false;
+    }
+}
+#endif
+
+void I2cBusManager::service()
+{
+#if !defined(ARDUINO_ARCH_ESP32)
+    unsigned long start = micros();
+    I2cTransaction transaction;
+    while (micros() - start < SERVICE_SLICE_US && takeNext(transaction))
+    {
+        transfer(transaction);
+    }
+#endif
+}
+
+bool I2cBusManager::isIdle() const
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return getPending() == 0 && !transferring;
+#else
+    return getPending() == 0;
+#endif
+}
+
+void I2cBusManager::waitIdle(unsigned long timeoutMs)
+{
+    unsigned long start = millis();
+    while (!isIdle() && millis() - start < timeoutMs)
+    {
+        service();
+        delay(1);
+    }
+}
+
+void I2cBusManager::setBlocking(bool enabled)
+{
+    if (enabled)
+    {
+        waitIdle(100);
+    }
+    blocking = enabled;
+}
+
+bool I2cBusManager::isBlocking() const
+{
+    return blocking;
+}
+
+uint32_t I2cBusManager::getClock() const
+{
+    return clockHz;
+}
+
+uint32_t I2cBusManager::getCompleted() const
+{
+    return completed;
+}
+
+uint32_t I2cBusManager::getFailed() const
+{
+    return failed;
+}
+
+uint32_t I2cBusManager::getDropped() const
+{
+    return dropped;
+}
+
+uint32_t I2cBusManager::getBusyMicros() const
+{
+    return busyMicros;
+}
+
+unsigned long I2cBusManager::getMaxCallerMicros() const
+{
+    return maxCallerMicros;
+}
+
+size_t I2cBusManager::getPending() const
+{
+    size_t total = 0;
+    for (uint8_t level = 0; level < PRIORITY_LEVELS; level++)
+    {
+#if defined(ARDUINO_ARCH_ESP32)
+        if (queues[level] != nullptr)
+        {
+            total += uxQueueMessagesWaiting(queues[level]);
+        }
+#else
+        total += count[level];
+#endif
+    }
+    return total;
+}
@@ -0,0 +1,97 @@
+#ifndef I2C_BUS_MANAGER_H
+#define I2C_BUS_MANAGER_H
+
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+enum class I2cPriority : uint8_t
+{
+    HIGH_PRIORITY,
+    NORMAL_PRIORITY,
+    LOW_PRIORITY
+};
+
+// One queued write to a 7-bit address. Payload is kept small enough to fit
+// any Wire transmit buffer.
+struct I2cTransaction
+{
+    static const uint8_t MAX_PAYLOAD = 30;
+
+    uint8_t address;
+    uint8_t length;
+    uint8_t data[MAX_PAYLOAD];
+};
+
+// Owns the Wire bus after start-up. Peripherals enqueue write transactions
+// and return immediately; a dedicated FreeRTOS task performs the transfers,
+// always draining higher priorities first. Without FreeRTOS, service() runs
+// them from the loop, a slice per call, so a slow bus spreads a redraw over
+// passes instead of stretching one. Blocking mode executes each transaction
+// inside enqueue(), for comparison with the queued path.
+class I2cBusManager
+{
+public:
+    static const uint8_t PRIORITY_LEVELS = 3;
+    static const uint8_t QUEUE_DEPTH = 32;
+    static const uint32_t SERVICE_SLICE_US = 5000; // Loop time service() may spend per call
+
+private:
+    uint32_t clockHz;
+    bool negotiated;
+    bool blocking;
+    bool started;
+
+    volatile uint32_t completed;
+    volatile uint32_t failed;
+    volatile uint32_t dropped;
+    volatile uint32_t busyMicros;
+    unsigned long maxCallerMicros;
+
+#if defined(ARDUINO_ARCH_ESP32)
+    QueueHandle_t queues[PRIORITY_LEVELS];
+    SemaphoreHandle_t workSignal;
+    TaskHandle_t worker;
+    volatile bool transferring;
+
+    static void workerLoop(void *parameter);
+#else
+    I2cTransaction pending[PRIORITY_LEVELS][QUEUE_DEPTH];
+    uint8_t head[PRIORITY_LEVELS];
+    uint8_t count[PRIORITY_LEVELS];
+#endif
+
+    bool takeNext(I2cTransaction &transaction);
+    void transfer(const I2cTransaction &transaction);
+
+public:
+    I2cBusManager();
+    ~I2cBusManager();
+
+    void begin();
+    uint32_t negotiateClock(uint8_t address, uint32_t maxClockHz = 400000);
+
+    bool enqueue(uint8_t address, const uint8_t *data, uint8_t length,
+                 I2cPriority priority = I2cPriority::NORMAL_PRIORITY);
+    void service();
+    bool isIdle() const;
+    void waitIdle(unsigned long timeoutMs);
+
+    void setBlocking(bool enabled);
+    bool isBlocking() const;
+
+    uint32_t getClock() const;
+    uint32_t getCompleted() const;
+    uint32_t getFailed() const;
+    uint32_t getDropped() const;
+    uint32_t getBusyMicros() const;
+    unsigned long getMaxCallerMicros() const;
+    size_t getPending() const;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "LcdFrameBuffer.h"
+#include <string.h>
+
+LcdFrameBuffer::LcdFrameBuffer()
+    : frontValid(false), cursorCol(0), cursorRow(0),
+      lastFlushBytes(0), lastFlushCursorMoves(0), totalFlushBytes(0)
+{
+    clear();
+    memset(front, ' ', sizeof(front));
+}
+
+void LcdFrameBuffer::clear()
+{
+    memset(back, ' ', sizeof(back));
+    cursorCol = 0;
+    cursorRow = 0;
+}
+
+void LcdFrameBuffer::setCursor(uint8_t col, uint8_t row)
+{
+    cursorCol = col;
+    cursorRow = row;
+}
+
+void LcdFrameBuffer::print(char c)
+{
+    // Text past the right edge is clipped, not wrapped
+    if (cursorRow < ROWS && cursorCol < COLS)
+    {
+        back[cursorRow][cursorCol] = c;
+    }
+    cursorCol++;
+}
+
+void LcdFrameBuffer::print(const char *text)
+{
+    while (*text)
+    {
+        print(*text++);
+    }
+}
+
+void LcdFrameBuffer::printAt(uint8_t col, uint8_t row, const char *text)
+{
+    setCursor(col, row);
+    print(text);
+}
+
+void LcdFrameBuffer::invalidate()
+{
+    frontValid = false;
+}
+
+void LcdFrameBuffer::assumeBlank()
+{
+    memset(front, ' ', sizeof(front));
+    frontValid = true;
+}
+
+uint16_t LcdFrameBuffer::flush(LcdSink &sink)
+{
+    uint16_t bytes = 0;
+    uint16_t moves = 0;
+    // Where the LCD's own cursor sits; 0xFF = unknown
+    uint8_t lcdCol = 0xFF;
+    uint8_t lcdRow = 0xFF;
+
+    for (uint8_t row = 0; row < ROWS; row++)
+    {
+        uint8_t col = 0;
+        while (col < COLS)
+        {
+            if (frontValid && back[row][col] == front[row][col])
+            {
+                col++;
+                continue;
+            }
+
+            // Extend the run over changed cells and small unchanged gaps
+            uint8_t start = col;
+            uint8_t end = col + 1;
+            uint8_t scan = end;
+            while (scan < COLS)
+            {
+                if (!frontValid || back[row][scan] != front[row][scan])
+                {
+                    end = scan + 1;
+                }
+                else if (scan - end >= MERGE_GAP)
+                {
+                    break;
+                }
+                scan++;
+            }
+
+            if (lcdRow != row || lcdCol != start)
+            {
+                sink.setCursor(start, row);
+                moves++;
+                bytes++;
+            }
+            sink.write(&back[row][start], end - start);
+            bytes += end - start;
+            memcpy(&front[row][start], &back[row][start], end - start);
+
+            lcdRow = row;
+            lcdCol = end;
+            col = end;
+        }
+    }
+
+    sink.commit();
+    frontValid = true;
+    lastFlushBytes = bytes;
+    lastFlushCursorMoves = moves;
+    totalFlushBytes += bytes;
+    return bytes;
+}
+
+uint16_t LcdFrameBuffer::getLastFlushBytes() const
+{
+    return lastFlushBytes;
+}
+
+uint16_t LcdFrameBuffer::getLastFlushCursorMoves() const
+{
+    return lastFlushCursorMoves;
+}
+
+uint32_t LcdFrameBuffer::getTotalFlushBytes() const
+{
+    return totalFlushBytes;
+}
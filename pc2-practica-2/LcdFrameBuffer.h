@@ -0,0 +1,63 @@
+#ifndef LCD_FRAME_BUFFER_H
+#define LCD_FRAME_BUFFER_H
+
+#include <stdint.h>
+
+// Minimal character-LCD interface the frame buffer flushes through. Lets the
+// diff engine run against a real LiquidCrystal_I2C or a fake on the host.
+class LcdSink
+{
+public:
+    virtual void setCursor(uint8_t col, uint8_t row) = 0;
+    virtual void write(const char *text, uint8_t length) = 0;
+    // End of one flush; buffering sinks send what they have collected
+    virtual void commit() {}
+    virtual ~LcdSink() = default;
+};
+
+// 20x4 RAM copy of the screen. Renders draw into the back buffer; flush()
+// diffs it against what the LCD is known to show and sends only the changed
+// character runs, with a cursor move only where a run does not continue
+// from the previous one.
+class LcdFrameBuffer
+{
+public:
+    static const uint8_t COLS = 20;
+    static const uint8_t ROWS = 4;
+
+private:
+    // Rewriting up to this many unchanged cells is cheaper than a cursor move
+    static const uint8_t MERGE_GAP = 1;
+
+    char back[ROWS][COLS];
+    char front[ROWS][COLS];
+    bool frontValid;
+    uint8_t cursorCol;
+    uint8_t cursorRow;
+
+    uint16_t lastFlushBytes;
+    uint16_t lastFlushCursorMoves;
+    uint32_t totalFlushBytes;
+
+public:
+    LcdFrameBuffer();
+
+    void clear();
+    void setCursor(uint8_t col, uint8_t row);
+    void print(const char *text);
+    void print(char c);
+    void printAt(uint8_t col, uint8_t row, const char *text);
+
+    // Forget what the LCD shows, e.g. after a hardware clear or reset
+    void invalidate();
+    // Mark the LCD as blank after a hardware clear
+    void assumeBlank();
+
+    uint16_t flush(LcdSink &sink);
+
+    uint16_t getLastFlushBytes() const;
+    uint16_t getLastFlushCursorMoves() const;
+    uint32_t getTotalFlushBytes() const;
+};
+
+#endif
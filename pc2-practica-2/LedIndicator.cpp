@@ -1,40 +1,59 @@
 #include "LedIndicator.h"
 #include <Arduino.h>
 
-LedIndicator::LedIndicator(int greenPin, int yellowPin, int redPin)
-    : greenPin(greenPin), yellowPin(yellowPin), redPin(redPin) {}
+const Command LedIndicator::SHOW_SAFE_COMMAND = Command(SHOW_SAFE_COMMAND_ID);
+const Command LedIndicator::SHOW_MODERATE_COMMAND = Command(SHOW_MODERATE_COMMAND_ID);
+const Command LedIndicator::SHOW_CRITICAL_COMMAND = Command(SHOW_CRITICAL_COMMAND_ID);
+const Command LedIndicator::SHOW_PRE_CRITICAL_COMMAND = Command(SHOW_PRE_CRITICAL_COMMAND_ID);
+const Command LedIndicator::ALL_OFF_COMMAND = Command(ALL_OFF_COMMAND_ID);
+
+LedIndicator::LedIndicator(int greenPin, int yellowPin, int redPin, CommandHandler *commandHandler)
+    // The pins belong to the three LED drivers, none to the indicator itself
+    : Actuator(-1, commandHandler), greenLed(greenPin), yellowLed(yellowPin), redLed(redPin) {}
 
 void LedIndicator::initialize()
 {
-    pinMode(greenPin, OUTPUT);
-    pinMode(yellowPin, OUTPUT);
-    pinMode(redPin, OUTPUT);
     turnOffAll();
 }
 
-void LedIndicator::updateStatus(GasLevel level)
+void LedIndicator::handle(Command command)
 {
-    turnOffAll();
-
-    switch (level)
+    if (command == SHOW_SAFE_COMMAND)
     {
-    case GasLevel::SAFE:
-        digitalWrite(greenPin, HIGH);
-        break;
-    case GasLevel::MODERATE:
-        digitalWrite(yellowPin, HIGH);
-        break;
-    case GasLevel::CRITICAL:
-        digitalWrite(redPin, HIGH);
-        break;
+        show(Led::TURN_ON_COMMAND, Led::TURN_OFF_COMMAND, Led::TURN_OFF_COMMAND);
+    }
+    else if (command == SHOW_MODERATE_COMMAND)
+    {
+        show(Led::TURN_OFF_COMMAND, Led::TURN_ON_COMMAND, Led::TURN_OFF_COMMAND);
+    }
+    else if (command == SHOW_CRITICAL_COMMAND)
+    {
+        show(Led::TURN_OFF_COMMAND, Led::TURN_OFF_COMMAND, LedPatternDriver::STROBE_COMMAND);
+    }
+    else if (command == SHOW_PRE_CRITICAL_COMMAND)
+    {
+        // Fast rise ahead of the CRITICAL threshold: yellow plus a blinking red
+        show(Led::TURN_OFF_COMMAND, Led::TURN_ON_COMMAND, LedPatternDriver::FAST_BLINK_COMMAND);
+    }
+    else if (command == ALL_OFF_COMMAND)
+    {
+        show(Led::TURN_OFF_COMMAND, Led::TURN_OFF_COMMAND, Led::TURN_OFF_COMMAND);
     }
+    Actuator::handle(command);
+}
+
+void LedIndicator::resync()
+{
+    // Re-drive every pin from the driver states, e.g. after the alarm ISR
+    // forced the red pin on behind the driver's back
+    greenLed.refresh();
+    yellowLed.refresh();
+    redLed.refresh();
 }
 
 void LedIndicator::turnOffAll()
 {
-    digitalWrite(greenPin, LOW);
-    digitalWrite(yellowPin, LOW);
-    digitalWrite(redPin, LOW);
+    handle(ALL_OFF_COMMAND);
 }
 
 void LedIndicator::testSequence()
@@ -42,15 +61,68 @@ void LedIndicator::testSequence()
     turnOffAll();
     delay(200);
 
-    digitalWrite(greenPin, HIGH);
+    drive(greenLed, Led::TURN_ON_COMMAND);
     delay(500);
-    digitalWrite(greenPin, LOW);
+    drive(greenLed, Led::TURN_OFF_COMMAND);
 
-    digitalWrite(yellowPin, HIGH);
+    drive(yellowLed, Led::TURN_ON_COMMAND);
     delay(500);
-    digitalWrite(yellowPin, LOW);
+    drive(yellowLed, Led::TURN_OFF_COMMAND);
 
-    digitalWrite(redPin, HIGH);
+    drive(redLed, LedPatternDriver::STROBE_COMMAND);
     delay(500);
-    digitalWrite(redPin, LOW);
+    drive(redLed, Led::TURN_OFF_COMMAND);
+}
+
+uint32_t LedIndicator::getGpioWrites() const
+{
+    // Pin writes and LEDC programs; a running pattern costs nothing more
+    return greenLed.getProgramCount() + yellowLed.getProgramCount() + redLed.getProgramCount();
+}
+
+Command LedIndicator::commandFor(GasLevel level, bool preCritical)
+{
+    if (preCritical)
+    {
+        return SHOW_PRE_CRITICAL_COMMAND;
+    }
+
+    switch (level)
+    {
+    case GasLevel::MODERATE:
+        return SHOW_MODERATE_COMMAND;
+    case GasLevel::CRITICAL:
+        return SHOW_CRITICAL_COMMAND;
+    default:
+        return SHOW_SAFE_COMMAND;
+    }
+}
+
+void LedIndicator::drive(LedPatternDriver &led, Command command)
+{
+    // The driver skips an unchanged pattern by itself; steady on/off is checked here
+    if (command == Led::TURN_OFF_COMMAND && !led.getState())
+    {
+        return;
+    }
+    if (command == Led::TURN_ON_COMMAND && led.getState() && led.getPattern() == LedPattern::solid())
+    {
+        return;
+    }
+    led.handle(command);
+}
+
+void LedIndicator::show(Command green, Command yellow, Command red)
+{
+    drive(greenLed, green);
+    drive(yellowLed, yellow);
+    drive(redLed, red);
+}
+
+bool LedIndicator::hasActivePattern() const
+{
+    // Blinks and fades run from the LEDC clock, which stops in light sleep
+    return greenLed.getPattern().kind != LedPatternKind::SOLID ||
+           yellowLed.getPattern().kind != LedPatternKind::SOLID ||
+           redLed.getPattern().kind != LedPatternKind::SOLID;
 }
@@ -1,21 +1,47 @@
 #ifndef LED_INDICATOR_H
 #define LED_INDICATOR_H
 
+#include "Actuator.h"
+#include "LedPatternDriver.h"
 #include "GasSensor.h"
 
-class LedIndicator
+// Green/yellow/red status lamp driven by commands. Each LED is only written
+// when its state actually changes, so a steady level costs no GPIO traffic.
+// CRITICAL strobes the red LED and pre-critical blinks it; both run in the
+// LEDC peripheral once programmed.
+class LedIndicator : public Actuator
 {
 private:
-    int greenPin;
-    int yellowPin;
-    int redPin;
+    LedPatternDriver greenLed;
+    LedPatternDriver yellowLed;
+    LedPatternDriver redLed;
+
+    void drive(LedPatternDriver &led, Command command);
+    void show(Command green, Command yellow, Command red);
 
 public:
-    LedIndicator(int greenPin, int yellowPin, int redPin);
+    static const int SHOW_SAFE_COMMAND_ID = 40;
+    static const int SHOW_MODERATE_COMMAND_ID = 41;
+    static const int SHOW_CRITICAL_COMMAND_ID = 42;
+    static const int SHOW_PRE_CRITICAL_COMMAND_ID = 43;
+    static const int ALL_OFF_COMMAND_ID = 44;
+    static const Command SHOW_SAFE_COMMAND;
+    static const Command SHOW_MODERATE_COMMAND;
+    static const Command SHOW_CRITICAL_COMMAND;
+    static const Command SHOW_PRE_CRITICAL_COMMAND;
+    static const Command ALL_OFF_COMMAND;
+
+    LedIndicator(int greenPin, int yellowPin, int redPin, CommandHandler *commandHandler = nullptr);
     void initialize();
-    void updateStatus(GasLevel level);
+    void handle(Command command) override;
+    void resync();
     void turnOffAll();
     void testSequence();
+
+    uint32_t getGpioWrites() const;
+    bool hasActivePattern() const;
+
+    static Command commandFor(GasLevel level, bool preCritical);
 };
 
 #endif
@@ -0,0 +1,170 @@
+#include "LoopBudgetMonitor.h"
+
+LoopBudgetMonitor::LoopBudgetMonitor(uint32_t budgetMicros, uint32_t maxDeferMicros)
+    : budgetMicros(budgetMicros), maxDeferMicros(maxDeferMicros), passStart(0), stageStart(0),
+      currentStage(LoopStage::SENSE), inStage(false), lastPassMicros(0), worstPassMicros(0),
+      passCount(0), overrunCount(0)
+{
+    for (int i = 0; i < STAGES; i++)
+    {
+        lastStageMicros[i] = 0;
+        worstStageMicros[i] = 0;
+        expectedStageMicros[i] = 0;
+        shedCount[i] = 0;
+        lastRun[i] = 0;
+    }
+}
+
+bool LoopBudgetMonitor::isCritical(LoopStage stage)
+{
+    return stage == LoopStage::SENSE || stage == LoopStage::ALARM;
+}
+
+void LoopBudgetMonitor::beginPass(unsigned long nowMicros)
+{
+    passStart = nowMicros;
+}
+
+bool LoopBudgetMonitor::shouldRun(LoopStage stage, unsigned long nowMicros)
+{
+    int i = (int)stage;
+    if (isCritical(stage))
+    {
+        return true;
+    }
+
+    uint32_t elapsed = nowMicros - passStart;
+    if (elapsed + expectedStageMicros[i] <= budgetMicros)
+    {
+        return true;
+    }
+
+    // Over budget, but a stage deferred for too long runs anyway
+    if (nowMicros - lastRun[i] >= maxDeferMicros)
+    {
+        return true;
+    }
+
+    shedCount[i]++;
+    return false;
+}
+
+void LoopBudgetMonitor::beginStage(LoopStage stage, unsigned long nowMicros)
+{
+    currentStage = stage;
+    stageStart = nowMicros;
+    inStage = true;
+}
+
+void LoopBudgetMonitor::endStage(unsigned long nowMicros)
+{
+    if (!inStage)
+    {
+        return;
+    }
+    inStage = false;
+
+    int i = (int)currentStage;
+    uint32_t spent = nowMicros - stageStart;
+    lastStageMicros[i] = spent;
+    lastRun[i] = nowMicros;
+    if (spent > worstStageMicros[i])
+    {
+        worstStageMicros[i] = spent;
+    }
+
+    // Stages are usually cheap with an occasional expensive pass (an LCD
+    // redraw, a log dump); predict with a peak that decays by 1/16 per run
+    uint32_t decayed = expectedStageMicros[i] - expectedStageMicros[i] / 16;
+    expectedStageMicros[i] = spent > decayed ? spent : decayed;
+}
+
+void LoopBudgetMonitor::endPass(unsigned long nowMicros)
+{
+    lastPassMicros = nowMicros - passStart;
+    passCount++;
+    if (lastPassMicros > worstPassMicros)
+    {
+        worstPassMicros = lastPassMicros;
+    }
+    if (lastPassMicros > budgetMicros)
+    {
+        overrunCount++;
+    }
+}
+
+void LoopBudgetMonitor::setBudget(uint32_t budgetMicros)
+{
+    this->budgetMicros = budgetMicros;
+}
+
+uint32_t LoopBudgetMonitor::getBudgetMicros() const
+{
+    return budgetMicros;
+}
+
+uint32_t LoopBudgetMonitor::getLastPassMicros() const
+{
+    return lastPassMicros;
+}
+
+uint32_t LoopBudgetMonitor::getWorstPassMicros() const
+{
+    return worstPassMicros;
+}
+
+uint32_t LoopBudgetMonitor::getPassCount() const
+{
+    return passCount;
+}
+
+uint32_t LoopBudgetMonitor::getOverrunCount() const
+{
+    return overrunCount;
+}
+
+uint32_t LoopBudgetMonitor::getStageMicros(LoopStage stage) const
+{
+    return lastStageMicros[(int)stage];
+}
+
+uint32_t LoopBudgetMonitor::getWorstStageMicros(LoopStage stage) const
+{
+    return worstStageMicros[(int)stage];
+}
+
+uint32_t LoopBudgetMonitor::getShedCount(LoopStage stage) const
+{
+    return shedCount[(int)stage];
+}
+
+uint32_t LoopBudgetMonitor::getTotalShedCount() const
+{
+    uint32_t total = 0;
+    for (int i = 0; i < STAGES; i++)
+    {
+        total += shedCount[i];
+    }
+    return total;
+}
+
+const char *LoopBudgetMonitor::stageName(LoopStage stage)
+{
+    switch (stage)
+    {
+    case LoopStage::SENSE:
+        return "sense";
+    case LoopStage::ALARM:
+        return "alarm";
+    case LoopStage::DISPLAY:
+        return "display";
+    case LoopStage::SERIAL_LOG:
+        return "serial";
+    case LoopStage::BUS:
+        return "bus";
+    case LoopStage::HISTORY:
+        return "history";
+    default:
+        return "?";
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef LOOP_BUDGET_MONITOR_H
+#define LOOP_BUDGET_MONITOR_H
+
+#include <stdint.h>
+
+enum class LoopStage
+{
+    SENSE,      // Critical: ADC, classification, level events
+    ALARM,      // Critical: D0 latch and LED outputs
+    DISPLAY,    // Sheddable: LCD frame
+    SERIAL_LOG, // Sheddable: status log on the UART
+    BUS,        // Sheddable: I2C queue service on targets without a bus task
+    HISTORY,    // Sheddable: reading history on flash
+    COUNT
+};
+
+// Times each stage of a loop pass against a per-pass budget. Before a
+// sheddable stage runs, shouldRun() predicts whether it would push the pass
+// over budget and, if so, defers it to a later pass. A deferred stage is
+// forced to run once it has waited maxDeferMicros, so it is delayed but
+// never starved. Critical stages always run. Times come from the caller.
+class LoopBudgetMonitor
+{
+private:
+    static const int STAGES = (int)LoopStage::COUNT;
+
+    uint32_t budgetMicros;
+    uint32_t maxDeferMicros;
+
+    unsigned long passStart;
+    unsigned long stageStart;
+    LoopStage currentStage;
+    bool inStage;
+
+    uint32_t lastPassMicros;
+    uint32_t worstPassMicros;
+    uint32_t passCount;
+    uint32_t overrunCount;
+
+    uint32_t lastStageMicros[STAGES];
+    uint32_t worstStageMicros[STAGES];
+    uint32_t expectedStageMicros[STAGES]; // Decaying peak, used for prediction
+    uint32_t shedCount[STAGES];
+    unsigned long lastRun[STAGES];
+
+    static bool isCritical(LoopStage stage);
+
+public:
+    LoopBudgetMonitor(uint32_t budgetMicros, uint32_t maxDeferMicros);
+
+    void beginPass(unsigned long nowMicros);
+    bool shouldRun(LoopStage stage, unsigned long nowMicros);
+    void beginStage(LoopStage stage, unsigned long nowMicros);
+    void endStage(unsigned long nowMicros);
+    void endPass(unsigned long nowMicros);
+
+    void setBudget(uint32_t budgetMicros);
+    uint32_t getBudgetMicros() const;
+    uint32_t getLastPassMicros() const;
+    uint32_t getWorstPassMicros() const;
+    uint32_t getPassCount() const;
+    uint32_t getOverrunCount() const;
+    uint32_t getStageMicros(LoopStage stage) const;
+    uint32_t getWorstStageMicros(LoopStage stage) const;
+    uint32_t getShedCount(LoopStage stage) const;
+    uint32_t getTotalShedCount() const;
+
+    static const char *stageName(LoopStage stage);
+};
+
+#endif
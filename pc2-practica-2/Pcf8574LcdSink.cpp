@@ -0,0 +1,65 @@
+#include "Pcf8574LcdSink.h"
+
+Pcf8574LcdSink::Pcf8574LcdSink(I2cBusManager *bus, uint8_t address, I2cPriority priority)
+    : bus(bus), address(address), priority(priority), length(0), lcdBytes(0),
+      lost(false), seenFailures(bus->getFailed()) {}
+
+void Pcf8574LcdSink::setCursor(uint8_t col, uint8_t row)
+{
+    static const uint8_t rowOffsets[] = {0x00, 0x40, 0x14, 0x54};
+    send(SET_DDRAM_ADDRESS | (col + rowOffsets[row & 3]), 0);
+}
+
+void Pcf8574LcdSink::write(const char *text, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        send((uint8_t)text[i], RS_BIT);
+    }
+}
+
+void Pcf8574LcdSink::commit()
+{
+    if (length > 0)
+    {
+        if (!bus->enqueue(address, buffer, length, priority))
+        {
+            lost = true;
+        }
+        length = 0;
+    }
+}
+
+void Pcf8574LcdSink::send(uint8_t value, uint8_t mode)
+{
+    // Never split one LCD byte across two transactions
+    if ((size_t)(length + EXPANDER_BYTES_PER_LCD_BYTE) > sizeof(buffer))
+    {
+        commit();
+    }
+    pushNibble((value & 0xF0) | mode);
+    pushNibble(((value << 4) & 0xF0) | mode);
+    lcdBytes++;
+}
+
+void Pcf8574LcdSink::pushNibble(uint8_t nibble)
+{
+    uint8_t value = nibble | BACKLIGHT_BIT;
+    buffer[length++] = value;
+    buffer[length++] = value | EN_BIT;
+    buffer[length++] = value;
+}
+
+bool Pcf8574LcdSink::takeLost()
+{
+    uint32_t failures = bus->getFailed();
+    bool result = lost || failures != seenFailures;
+    lost = false;
+    seenFailures = failures;
+    return result;
+}
+
+uint32_t Pcf8574LcdSink::getLcdBytes() const
+{
+    return lcdBytes;
+}
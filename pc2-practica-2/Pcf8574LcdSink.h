@@ -0,0 +1,52 @@
+#ifndef PCF8574_LCD_SINK_H
+#define PCF8574_LCD_SINK_H
+
+#include "LcdFrameBuffer.h"
+#include "I2cBusManager.h"
+
+// Encodes frame buffer output into the HD44780 4-bit protocol spoken through
+// a PCF8574 I2C backpack and hands it to the bus manager as queued writes,
+// so a display refresh never waits on the wire. Each LCD byte is two nibbles
+// of three expander writes (data, data|EN, data); a whole transaction of
+// these is sent per enqueue. The LCD must already be initialized.
+class Pcf8574LcdSink : public LcdSink
+{
+public:
+    // The PCF8574 is only specified up to standard mode
+    static const uint32_t MAX_CLOCK_HZ = 100000;
+
+private:
+    static const uint8_t RS_BIT = 0x01;
+    static const uint8_t EN_BIT = 0x04;
+    static const uint8_t BACKLIGHT_BIT = 0x08;
+    static const uint8_t SET_DDRAM_ADDRESS = 0x80;
+    static const uint8_t EXPANDER_BYTES_PER_LCD_BYTE = 6;
+
+    I2cBusManager *bus;
+    uint8_t address;
+    I2cPriority priority;
+    uint8_t buffer[I2cTransaction::MAX_PAYLOAD];
+    uint8_t length;
+    uint32_t lcdBytes;
+    bool lost;             // A commit the queue rejected since takeLost()
+    uint32_t seenFailures; // Bus failures at the last takeLost()
+
+    void send(uint8_t value, uint8_t mode);
+    void pushNibble(uint8_t nibble);
+
+public:
+    Pcf8574LcdSink(I2cBusManager *bus, uint8_t address, I2cPriority priority = I2cPriority::LOW_PRIORITY);
+
+    void setCursor(uint8_t col, uint8_t row) override;
+    void write(const char *text, uint8_t length) override;
+    void commit() override;
+
+    // True once after output may not have reached the LCD: a commit was
+    // rejected, or a transfer on the bus failed since the last call. The
+    // bus is shared, so another peripheral's failure also counts
+    bool takeLost();
+
+    uint32_t getLcdBytes() const;
+};
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef POWER_LAW_TABLE_H
+#define POWER_LAW_TABLE_H
+
+#include <math.h>
+
+// Compile-time tabulation of y = a * x^b, the regression used for MQ-series
+// Rs/R0 -> PPM curves. Nodes are spaced linearly inside each power-of-two
+// octave of x, so the segment index falls out of frexpf() and evaluation is
+// a lookup plus one linear interpolation. Requires C++14 constexpr.
+namespace power_law_detail
+{
+    constexpr double LN2 = 0.693147180559945309417;
+
+    constexpr double constLog(double x)
+    {
+        int exponent = 0;
+        while (x >= 2.0)
+        {
+            x /= 2.0;
+            exponent++;
+        }
+        while (x < 1.0)
+        {
+            x *= 2.0;
+            exponent--;
+        }
+        // atanh series, z <= 1/3 on [1, 2)
+        double z = (x - 1.0) / (x + 1.0);
+        double z2 = z * z;
+        double term = z;
+        double sum = 0.0;
+        for (int k = 1; k < 64; k += 2)
+        {
+            sum += term / k;
+            term *= z2;
+        }
+        return 2.0 * sum + exponent * LN2;
+    }
+
+    constexpr double constExp(double y)
+    {
+        int k = (int)(y / LN2 + (y >= 0 ? 0.5 : -0.5));
+        double r = y - k * LN2;
+        double term = 1.0;
+        double sum = 1.0;
+        for (int n = 1; n < 30; n++)
+        {
+            term *= r / n;
+            sum += term;
+        }
+        for (; k > 0; k--)
+        {
+            sum *= 2.0;
+        }
+        for (; k < 0; k++)
+        {
+            sum /= 2.0;
+        }
+        return sum;
+    }
+
+    constexpr double constPow(double x, double b)
+    {
+        return constExp(b * constLog(x));
+    }
+
+    constexpr double constPow2(int exponent)
+    {
+        double value = 1.0;
+        for (; exponent > 0; exponent--)
+        {
+            value *= 2.0;
+        }
+        for (; exponent < 0; exponent++)
+        {
+            value /= 2.0;
+        }
+        return value;
+    }
+}
+
+template <int MIN_EXPONENT, int MAX_EXPONENT, int SEGMENTS_PER_OCTAVE>
+class PowerLawTable
+{
+public:
+    static constexpr int OCTAVES = MAX_EXPONENT - MIN_EXPONENT;
+    static constexpr int SIZE = OCTAVES * SEGMENTS_PER_OCTAVE + 1;
+
+    static_assert(OCTAVES > 0, "table must span at least one octave");
+    static_assert(SEGMENTS_PER_OCTAVE > 0, "need at least one segment per octave");
+
+    constexpr PowerLawTable(double a, double b) : a(a), b(b), values{}
+    {
+        for (int i = 0; i < SIZE; i++)
+        {
+            values[i] = (float)(a * power_law_detail::constPow(nodeAt(i), b));
+        }
+    }
+
+    // Input x of node i: octave base times 1 + segment / SEGMENTS_PER_OCTAVE
+    static constexpr double nodeAt(int i)
+    {
+        return power_law_detail::constPow2(MIN_EXPONENT + i / SEGMENTS_PER_OCTAVE) *
+               (1.0 + (double)(i % SEGMENTS_PER_OCTAVE) / SEGMENTS_PER_OCTAVE);
+    }
+
+    static constexpr double minInput()
+    {
+        return power_law_detail::constPow2(MIN_EXPONENT);
+    }
+
+    static constexpr double maxInput()
+    {
+        return power_law_detail::constPow2(MAX_EXPONENT);
+    }
+
+    float evaluate(float x) const
+    {
+        if (x != x)
+        {
+            return 0;
+        }
+        float fraction;
+        int index = locate(x, fraction);
+        return interpolate(index, fraction);
+    }
+
+    // Segment of x and its position in it; the same for every table of
+    // this shape, so several curves can share one lookup
+    static int locate(float x, float &fraction)
+    {
+        // Zero or below-range input is the saturated end of the curve
+        if (!(x > (float)minInput()))
+        {
+            fraction = 0;
+            return 0;
+        }
+        if (x >= (float)maxInput())
+        {
+            fraction = 1;
+            return SIZE - 2;
+        }
+
+        int exponent;
+        float mantissa = frexpf(x, &exponent); // x = mantissa * 2^exponent, mantissa in [0.5, 1)
+        float position = (mantissa * 2.0f - 1.0f) * SEGMENTS_PER_OCTAVE;
+        int segment = (int)position;
+        fraction = position - segment;
+        return (exponent - 1 - MIN_EXPONENT) * SEGMENTS_PER_OCTAVE + segment;
+    }
+
+    float interpolate(int index, float fraction) const
+    {
+        return values[index] + fraction * (values[index + 1] - values[index]);
+    }
+
+    // Worst relative interpolation error, probed at every segment midpoint
+    // (where linear interpolation of a convex curve deviates most)
+    constexpr double maxRelativeError() const
+    {
+        double worst = 0.0;
+        for (int i = 0; i < SIZE - 1; i++)
+        {
+            double x = (nodeAt(i) + nodeAt(i + 1)) / 2.0;
+            double exact = a * power_law_detail::constPow(x, b);
+            double interpolated = (values[i] + values[i + 1]) / 2.0;
+            double error = (interpolated - exact) / exact;
+            if (error < 0)
+            {
+                error = -error;
+            }
+            if (error > worst)
+            {
+                worst = error;
+            }
+        }
+        return worst;
+    }
+
+    constexpr double getA() const { return a; }
+    constexpr double getB() const { return b; }
+
+private:
+    double a;
+    double b;
+    float values[SIZE];
+};
+
+#endif
@@ -0,0 +1,253 @@
+#include "PowerManager.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#endif
+
+PowerManager::PowerManager(float activeMilliamps, float idleMilliamps, float sleepMilliamps, float alwaysOnMilliamps)
+    : wakePinCount(0), passStart(0), nextDeadline(0), hasDeadline(false), held(false),
+      activeMilliamps(activeMilliamps), idleMilliamps(idleMilliamps), sleepMilliamps(sleepMilliamps),
+      alwaysOnMilliamps(alwaysOnMilliamps), activeMicros(0), idleMicros(0), sleepMicros(0),
+      sleepCount(0), earlyWakeCount(0), heldCount(0), uartRoomWhenIdle(0)
+{
+}
+
+bool PowerManager::addWakePin(int pin, bool wakeHigh, void (*onWake)())
+{
+    if (pin < 0 || wakePinCount >= MAX_WAKE_PINS)
+    {
+        return false;
+    }
+    wakePins[wakePinCount++] = {pin, wakeHigh, onWake};
+    return true;
+}
+
+void PowerManager::beginPass(unsigned long nowMicros)
+{
+    passStart = nowMicros;
+    hasDeadline = false;
+    held = false;
+}
+
+void PowerManager::offerDeadline(unsigned long dueMicros)
+{
+    // micros() wraps at 32 bits on every core, whatever the width of unsigned long
+    if (!hasDeadline || (int32_t)((uint32_t)dueMicros - (uint32_t)nextDeadline) < 0)
+    {
+        nextDeadline = dueMicros;
+        hasDeadline = true;
+    }
+}
+
+void PowerManager::hold()
+{
+    held = true;
+}
+
+IdleMode PowerManager::plan(unsigned long nowMicros, uint32_t &windowMicros) const
+{
+    windowMicros = MAX_WINDOW_US;
+    if (hasDeadline)
+    {
+        int32_t remaining = (int32_t)((uint32_t)nextDeadline - (uint32_t)nowMicros);
+        if (remaining <= 0)
+        {
+            windowMicros = 0;
+            return IdleMode::NONE;
+        }
+        if ((uint32_t)remaining < windowMicros)
+        {
+            windowMicros = remaining;
+        }
+    }
+    if (held || windowMicros < MIN_LIGHT_SLEEP_US)
+    {
+        return IdleMode::DELAY;
+    }
+    return IdleMode::LIGHT_SLEEP;
+}
+
+void PowerManager::account(uint32_t activeMicros, IdleMode mode, uint32_t waitedMicros, bool wokeEarly)
+{
+    this->activeMicros += activeMicros;
+    if (mode == IdleMode::LIGHT_SLEEP)
+    {
+        sleepMicros += waitedMicros;
+        sleepCount++;
+        if (wokeEarly)
+        {
+            earlyWakeCount++;
+        }
+    }
+    else
+    {
+        idleMicros += waitedMicros;
+    }
+    if (held)
+    {
+        heldCount++;
+    }
+}
+
+IdleMode PowerManager::idle()
+{
+    uint32_t window;
+    unsigned long start = micros();
+    IdleMode mode = plan(start, window);
+    if (mode == IdleMode::LIGHT_SLEEP && isUartBusy())
+    {
+        // The UART stops with its clock. Flushing first could outlast the window and
+        // hold up the next pass, so queued output keeps this window awake instead
+        held = true;
+        mode = IdleMode::DELAY;
+    }
+
+    bool wokeEarly = false;
+    if (mode == IdleMode::LIGHT_SLEEP)
+    {
+        wokeEarly = sleepFor(window);
+    }
+    else if (mode == IdleMode::DELAY)
+    {
+        delay(window / 1000);
+        delayMicroseconds(window % 1000);
+    }
+
+    account(start - passStart, mode, micros() - start, wokeEarly);
+    return mode;
+}
+
+bool PowerManager::isUartBusy()
+{
+    // Room only grows while output drains, so the most ever seen is the empty FIFO
+    int room = Serial.availableForWrite();
+    if (room > uartRoomWhenIdle)
+    {
+        uartRoomWhenIdle = room;
+    }
+    return room < uartRoomWhenIdle;
+}
+
+bool PowerManager::sleepFor(uint32_t windowMicros)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    bool armed[MAX_WAKE_PINS];
+    for (uint8_t i = 0; i < wakePinCount; i++)
+    {
+        const WakePin &wake = wakePins[i];
+        gpio_num_t gpio = (gpio_num_t)wake.pin;
+
+        // A pin already at its wake level would end every sleep at once; its
+        // owner has seen that level through the edge interrupt anyway
+        armed[i] = digitalRead(wake.pin) != (wake.wakeHigh ? HIGH : LOW);
+        if (armed[i])
+        {
+            // Wake-up needs a level trigger, which would storm the edge
+            // handler after waking: park the interrupt while asleep
+            gpio_intr_disable(gpio);
+            gpio_wakeup_enable(gpio, wake.wakeHigh ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+        }
+    }
+    esp_sleep_enable_gpio_wakeup();
+    esp_sleep_enable_timer_wakeup(windowMicros);
+
+    esp_light_sleep_start();
+    bool wokeEarly = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+
+    for (uint8_t i = 0; i < wakePinCount; i++)
+    {
+        if (!armed[i])
+        {
+            continue;
+        }
+        const WakePin &wake = wakePins[i];
+        gpio_num_t gpio = (gpio_num_t)wake.pin;
+        gpio_wakeup_disable(gpio);
+        gpio_set_intr_type(gpio, wake.wakeHigh ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE);
+        gpio_intr_enable(gpio);
+
+        // The edge came while the interrupt was parked: deliver it now
+        if (wokeEarly && wake.onWake != nullptr && digitalRead(wake.pin) == (wake.wakeHigh ? HIGH : LOW))
+        {
+            wake.onWake();
+        }
+    }
+    return wokeEarly;
+#else
+    // No light sleep here: wait in 1 ms steps and end early when a wake pin
+    // reaches its level. The edge interrupts stay armed, so onWake() is not needed
+    bool armed[MAX_WAKE_PINS];
+    for (uint8_t i = 0; i < wakePinCount; i++)
+    {
+        armed[i] = digitalRead(wakePins[i].pin) != (wakePins[i].wakeHigh ? HIGH : LOW);
+    }
+    unsigned long start = micros();
+    for (;;)
+    {
+        uint32_t waited = micros() - start;
+        if (waited >= windowMicros)
+        {
+            return false;
+        }
+        uint32_t left = windowMicros - waited;
+        if (left >= 1000)
+        {
+            delay(1);
+        }
+        else
+        {
+            delayMicroseconds(left);
+        }
+        for (uint8_t i = 0; i < wakePinCount; i++)
+        {
+            if (armed[i] && digitalRead(wakePins[i].pin) == (wakePins[i].wakeHigh ? HIGH : LOW))
+            {
+                return true;
+            }
+        }
+    }
+#endif
+}
+
+float PowerManager::getDutyCycle() const
+{
+    uint64_t total = activeMicros + idleMicros + sleepMicros;
+    return total > 0 ? (float)activeMicros / total : 1.0f;
+}
+
+float PowerManager::getAverageMilliamps() const
+{
+    uint64_t total = activeMicros + idleMicros + sleepMicros;
+    if (total == 0)
+    {
+        return activeMilliamps + alwaysOnMilliamps;
+    }
+    float charge = activeMicros * activeMilliamps + idleMicros * idleMilliamps + sleepMicros * sleepMilliamps;
+    return charge / total + alwaysOnMilliamps;
+}
+
+float PowerManager::getAlwaysOnMilliamps() const
+{
+    return alwaysOnMilliamps;
+}
+
+uint64_t PowerManager::getSleepMicros() const
+{
+    return sleepMicros;
+}
+
+uint32_t PowerManager::getSleepCount() const
+{
+    return sleepCount;
+}
+
+uint32_t PowerManager::getEarlyWakeCount() const
+{
+    return earlyWakeCount;
+}
+
+uint32_t PowerManager::getHeldCount() const
+{
+    return heldCount;
+}
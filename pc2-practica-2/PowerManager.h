@@ -0,0 +1,81 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+enum class IdleMode : uint8_t
+{
+    NONE,       // Next deadline already due
+    DELAY,      // Window too short, or a peripheral needs its clock
+    LIGHT_SLEEP // CPU and peripheral clocks stopped until the deadline
+};
+
+// Replaces the fixed delay() between loop passes. During a pass the device
+// offers the deadlines of its timers and holds off light sleep while some
+// peripheral needs its clock; idle() then waits until the earliest deadline,
+// in light sleep when the window pays for the wake-up. Registered pins end a
+// sleep early. plan() and account() take times from the caller, so windows
+// and duty cycle can be checked against any clock.
+class PowerManager
+{
+public:
+    static const uint8_t MAX_WAKE_PINS = 4;
+    static const uint32_t MIN_LIGHT_SLEEP_US = 5000; // Entry/exit cost plus margin
+    static const uint32_t MAX_WINDOW_US = 1000000;   // Without deadlines, check in this often
+
+private:
+    struct WakePin
+    {
+        int pin;
+        bool wakeHigh;
+        void (*onWake)();
+    };
+
+    WakePin wakePins[MAX_WAKE_PINS];
+    uint8_t wakePinCount;
+
+    unsigned long passStart;
+    unsigned long nextDeadline;
+    bool hasDeadline;
+    bool held;
+
+    // Rough ESP32 supply currents for each state, in mA
+    float activeMilliamps;
+    float idleMilliamps;
+    float sleepMilliamps;
+    float alwaysOnMilliamps; // Loads that never sleep (MQ-2 heater)
+
+    uint64_t activeMicros;
+    uint64_t idleMicros;
+    uint64_t sleepMicros;
+    uint32_t sleepCount;
+    uint32_t earlyWakeCount;
+    uint32_t heldCount;
+    int uartRoomWhenIdle; // Serial.availableForWrite() with nothing queued
+
+    bool isUartBusy();
+    bool sleepFor(uint32_t windowMicros);
+
+public:
+    PowerManager(float activeMilliamps, float idleMilliamps, float sleepMilliamps, float alwaysOnMilliamps);
+
+    bool addWakePin(int pin, bool wakeHigh, void (*onWake)() = nullptr);
+
+    void beginPass(unsigned long nowMicros);
+    void offerDeadline(unsigned long dueMicros);
+    void hold();
+
+    IdleMode plan(unsigned long nowMicros, uint32_t &windowMicros) const;
+    void account(uint32_t activeMicros, IdleMode mode, uint32_t waitedMicros, bool wokeEarly);
+    IdleMode idle();
+
+    float getDutyCycle() const;
+    float getAverageMilliamps() const;
+    float getAlwaysOnMilliamps() const;
+    uint64_t getSleepMicros() const;
+    uint32_t getSleepCount() const;
+    uint32_t getEarlyWakeCount() const;
+    uint32_t getHeldCount() const;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "SegmentStorage.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <LittleFS.h>
+
+LittleFsSegmentStorage::LittleFsSegmentStorage(const char *directory)
+    : directory(directory) {}
+
+void LittleFsSegmentStorage::pathOf(uint32_t sequence, char *path, size_t size) const
+{
+    snprintf(path, size, "%s/%08lx", directory, (unsigned long)sequence);
+}
+
+bool LittleFsSegmentStorage::begin()
+{
+    // Formats an empty or corrupt partition on first use
+    if (!LittleFS.begin(true))
+    {
+        return false;
+    }
+    return LittleFS.exists(directory) || LittleFS.mkdir(directory);
+}
+
+bool LittleFsSegmentStorage::range(uint32_t &first, uint32_t &next)
+{
+    File dir = LittleFS.open(directory);
+    if (!dir || !dir.isDirectory())
+    {
+        return false;
+    }
+
+    bool any = false;
+    for (File file = dir.openNextFile(); file; file = dir.openNextFile())
+    {
+        char *end = nullptr;
+        uint32_t sequence = strtoul(file.name(), &end, 16);
+        if (end == file.name() || *end != '\0')
+        {
+            continue;
+        }
+        if (!any || sequence < first)
+        {
+            first = sequence;
+        }
+        if (!any || sequence >= next)
+        {
+            next = sequence + 1;
+        }
+        any = true;
+    }
+    return any;
+}
+
+bool LittleFsSegmentStorage::append(uint32_t sequence, const uint8_t *data, size_t length)
+{
+    char path[32];
+    pathOf(sequence, path, sizeof(path));
+    File file = LittleFS.open(path, "a");
+    if (!file)
+    {
+        return false;
+    }
+    size_t written = file.write(data, length);
+    file.close();
+    return written == length;
+}
+
+size_t LittleFsSegmentStorage::read(uint32_t sequence, size_t offset, uint8_t *dst, size_t length)
+{
+    char path[32];
+    pathOf(sequence, path, sizeof(path));
+    File file = LittleFS.open(path, "r");
+    if (!file || !file.seek(offset))
+    {
+        return 0;
+    }
+    size_t got = file.read(dst, length);
+    file.close();
+    return got;
+}
+
+bool LittleFsSegmentStorage::remove(uint32_t sequence)
+{
+    char path[32];
+    pathOf(sequence, path, sizeof(path));
+    return LittleFS.remove(path);
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SEGMENT_STORAGE_H
+#define SEGMENT_STORAGE_H
+
+#include <Arduino.h>
+
+// Persistent home of GasHistory segments. Segments are numbered by a
+// sequence that only grows and a segment only grows at its end, so a
+// backend never patches flash in place and leaves wear levelling to the
+// file system underneath.
+class SegmentStorage
+{
+public:
+    virtual bool begin() = 0;
+    // Lowest and one past the highest stored sequence; false when empty
+    virtual bool range(uint32_t &first, uint32_t &next) = 0;
+    // Adds to the end of a segment, creating it when missing
+    virtual bool append(uint32_t sequence, const uint8_t *data, size_t length) = 0;
+    virtual size_t read(uint32_t sequence, size_t offset, uint8_t *dst, size_t length) = 0;
+    virtual bool remove(uint32_t sequence) = 0;
+    virtual ~SegmentStorage() = default;
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// One LittleFS file per segment under a directory. An append only commits
+// when the file is closed, so a reset mid-append keeps the previous length.
+class LittleFsSegmentStorage : public SegmentStorage
+{
+private:
+    const char *directory;
+
+    void pathOf(uint32_t sequence, char *path, size_t size) const;
+
+public:
+    LittleFsSegmentStorage(const char *directory);
+
+    bool begin() override;
+    bool range(uint32_t &first, uint32_t &next) override;
+    bool append(uint32_t sequence, const uint8_t *data, size_t length) override;
+    size_t read(uint32_t sequence, size_t offset, uint8_t *dst, size_t length) override;
+    bool remove(uint32_t sequence) override;
+};
+#endif
+
+#endif
@@ -5,9 +5,26 @@
 // Copyright 2023 Angel Velasquez
 
 #include "wokwi-api.h"
+#include "mq2_stimulus.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+// Stimulus sources, selected by the "mode" attribute
+#define MODE_SLIDERS 0   // A0 follows the gas slider (original behaviour)
+#define MODE_SYNTHETIC 1 // A0 follows an mq2_wave_t built from the attributes
+#define MODE_TRACE 2     // A0 replays the embedded binary trace
+
+// A recorded trace can be embedded by placing its bytes, as a C initializer
+// list, in mq2_trace.inc next to this file
+#if defined(__has_include)
+#if __has_include("mq2_trace.inc")
+#define HAVE_EMBEDDED_TRACE 1
+static const uint8_t embedded_trace[] = {
+#include "mq2_trace.inc"
+};
+#endif
+#endif
+
 // Chip State Values
 typedef struct {
   pin_t pin_a0;
@@ -15,7 +32,13 @@ typedef struct {
   pin_t pin_vcc;
   pin_t pin_gnd;
   uint32_t gas_attr;
-  uint32_t threshold_attr; 
+  uint32_t threshold_attr;
+  uint32_t time_scale_attr;
+  uint32_t mode_attr;
+  uint32_t sample_ms;
+  double stimulus_ms; // Waveform clock, advanced by sample_ms * time_scale per tick
+  mq2_wave_t wave;
+  mq2_trace_t trace;
 } chip_state_t;
 
 // Pre-declare Timer Event
@@ -25,32 +48,76 @@ void chip_init() {
 
   // Chip State Configuration
   chip_state_t *chip = malloc(sizeof(chip_state_t));
-  
+
   // Setup Chip Pins
   chip->pin_a0 = pin_init("A0", ANALOG);
   chip->gas_attr = attr_init("gas", 10);
   chip->threshold_attr = attr_init("threshold", 50);
   chip->pin_d0 = pin_init("D0", OUTPUT_LOW);
   chip->pin_vcc = pin_init("VCC", INPUT_PULLDOWN);
-  chip->pin_gnd = pin_init("GND", INPUT_PULLUP);  
-  
+  chip->pin_gnd = pin_init("GND", INPUT_PULLUP);
+
+  // Stimulus Configuration
+  chip->mode_attr = attr_init("mode", MODE_SLIDERS);
+  chip->sample_ms = attr_read(attr_init("sample_ms", 100));
+  if (chip->sample_ms == 0) {
+    chip->sample_ms = 1;
+  }
+  chip->time_scale_attr = attr_init_float("time_scale", 1.0);
+  chip->stimulus_ms = 0;
+
+  chip->wave.kind = (mq2_wave_kind_t)attr_read(attr_init("waveform", MQ2_WAVE_LEAK));
+  chip->wave.base_ppm = attr_read_float(attr_init_float("base_ppm", 0));
+  chip->wave.peak_ppm = attr_read_float(attr_init_float("peak_ppm", 1000));
+  chip->wave.start_ms = attr_read(attr_init("start_ms", 30000));
+  chip->wave.rise_ms = attr_read(attr_init("rise_ms", 60000));
+  chip->wave.noise_ppm = attr_read_float(attr_init_float("noise_ppm", 0));
+  chip->wave.seed = attr_read(attr_init("seed", 1));
+
+  chip->trace.count = 0;
+#ifdef HAVE_EMBEDDED_TRACE
+  int status = mq2_trace_open(&chip->trace, embedded_trace, sizeof(embedded_trace));
+  if (status != MQ2_TRACE_OK) {
+    printf("mq2: embedded trace rejected (%d)\n", status);
+    chip->trace.count = 0;
+  }
+#endif
+
   // Timer Event Configuration
   const timer_config_t timer_config = {
     .callback = chip_timer_event,
     .user_data = chip,
   };
 
-  // Timer Initialization and Start
+  // Timer Initialization and Start (period in microseconds)
   timer_t timer_id = timer_init(&timer_config);
-  timer_start(timer_id, 1000, true);
+  timer_start(timer_id, chip->sample_ms * 1000, true);
 
 }
 
+// A0 voltage for the current tick
+static float stimulus_voltage(chip_state_t *chip) {
+  uint32_t mode = attr_read(chip->mode_attr);
+  if (mode == MODE_SLIDERS) {
+    return (attr_read_float(chip->gas_attr))*5.0/100;
+  }
+
+  // time_scale > 1 plays the waveform faster than simulated real time
+  float scale = attr_read_float(chip->time_scale_attr);
+  chip->stimulus_ms += chip->sample_ms * (scale > 0 ? scale : 1.0f);
+  uint32_t t_ms = (uint32_t)chip->stimulus_ms;
+
+  // Without a valid embedded trace, trace mode falls back to the waveform
+  float ppm = (mode == MODE_TRACE && chip->trace.count > 0) ? mq2_trace_ppm(&chip->trace, t_ms)
+                                                            : mq2_wave_ppm(&chip->wave, t_ms);
+  return mq2_ppm_to_voltage(ppm);
+}
+
 // Timer Event Handler
 void chip_timer_event(void *user_data) {
 
   chip_state_t *chip = (chip_state_t*)user_data;
-  float voltage = (attr_read_float(chip->gas_attr))*5.0/100;
+  float voltage = stimulus_voltage(chip);
   float threshold_v = (attr_read_float(chip->threshold_attr))*5.0/100;
   if (pin_read(chip->pin_vcc) && !pin_read(chip->pin_gnd)) {
     pin_dac_write(chip->pin_a0, voltage);
@@ -61,4 +128,3 @@ void chip_timer_event(void *user_data) {
   }
 
 }
-
@@ -0,0 +1,225 @@
+// MQ-2 stimulus library - header only, plain C99.
+//
+// Shared by the Wokwi custom chip (mq2.chip.c) and host-side tools, so a
+// waveform replayed in the simulator and one fed straight into GasSensor on
+// a host produce the same PPM and voltage sequence.
+//
+// Trace format (little-endian):
+//   offset 0  char[4]  magic "MQ2T"
+//   offset 4  uint8    version (1)
+//   offset 5  uint8    reserved, 0
+//   offset 6  uint16   sample period in ms
+//   offset 8  uint32   sample count
+//   offset 12 uint16[] PPM samples, 1 PPM per LSB
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef MQ2_STIMULUS_H
+#define MQ2_STIMULUS_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MQ2_TRACE_HEADER_SIZE 12
+#define MQ2_TRACE_VERSION 1
+
+// Electrical model, matching the firmware (3.3 V divider, RL = 10k, MQ-2 LPG
+// curve PPM = 574.25 * (Rs/R0)^-2.222). Clean air reads as Rs/R0 = 9.83,
+// the ratio GasSensor::calibrate() expects.
+#define MQ2_VCC 3.3f
+#define MQ2_RL_KOHM 10.0f
+#define MQ2_R0_KOHM 10.0f
+#define MQ2_LPG_A 574.25f
+#define MQ2_LPG_B -2.222f
+#define MQ2_CLEAN_AIR_RATIO 9.83f
+
+// ---- Trace reading and writing ----
+
+typedef struct {
+  const uint8_t *samples;
+  uint32_t count;
+  uint16_t sample_ms;
+} mq2_trace_t;
+
+enum {
+  MQ2_TRACE_OK = 0,
+  MQ2_TRACE_TOO_SHORT = -1,
+  MQ2_TRACE_BAD_MAGIC = -2,
+  MQ2_TRACE_BAD_VERSION = -3,
+  MQ2_TRACE_TRUNCATED = -4
+};
+
+static inline uint16_t mq2_get_u16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t mq2_get_u32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void mq2_put_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void mq2_put_u32(uint8_t *p, uint32_t v) {
+  mq2_put_u16(p, (uint16_t)v);
+  mq2_put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+// Validates a trace held in memory; the samples are read in place.
+static inline int mq2_trace_open(mq2_trace_t *trace, const uint8_t *data, size_t length) {
+  if (length < MQ2_TRACE_HEADER_SIZE) {
+    return MQ2_TRACE_TOO_SHORT;
+  }
+  if (data[0] != 'M' || data[1] != 'Q' || data[2] != '2' || data[3] != 'T') {
+    return MQ2_TRACE_BAD_MAGIC;
+  }
+  if (data[4] != MQ2_TRACE_VERSION) {
+    return MQ2_TRACE_BAD_VERSION;
+  }
+  uint32_t count = mq2_get_u32(data + 8);
+  if ((length - MQ2_TRACE_HEADER_SIZE) / 2 < count) {
+    return MQ2_TRACE_TRUNCATED;
+  }
+  trace->samples = data + MQ2_TRACE_HEADER_SIZE;
+  trace->count = count;
+  trace->sample_ms = mq2_get_u16(data + 6);
+  return MQ2_TRACE_OK;
+}
+
+// PPM at trace time t_ms, linearly interpolated; holds the last sample.
+static inline float mq2_trace_ppm(const mq2_trace_t *trace, uint32_t t_ms) {
+  if (trace->count == 0) {
+    return 0;
+  }
+  uint32_t period = trace->sample_ms ? trace->sample_ms : 1;
+  uint32_t index = t_ms / period;
+  if (index + 1 >= trace->count) {
+    return mq2_get_u16(trace->samples + 2 * (trace->count - 1));
+  }
+  float a = mq2_get_u16(trace->samples + 2 * index);
+  float b = mq2_get_u16(trace->samples + 2 * (index + 1));
+  return a + (b - a) * (float)(t_ms % period) / period;
+}
+
+static inline uint32_t mq2_trace_duration_ms(const mq2_trace_t *trace) {
+  return trace->count * (uint32_t)trace->sample_ms;
+}
+
+// Bytes needed for a trace of count samples.
+static inline size_t mq2_trace_size(uint32_t count) {
+  return MQ2_TRACE_HEADER_SIZE + 2 * (size_t)count;
+}
+
+static inline void mq2_trace_write_header(uint8_t *buffer, uint16_t sample_ms, uint32_t count) {
+  buffer[0] = 'M';
+  buffer[1] = 'Q';
+  buffer[2] = '2';
+  buffer[3] = 'T';
+  buffer[4] = MQ2_TRACE_VERSION;
+  buffer[5] = 0;
+  mq2_put_u16(buffer + 6, sample_ms);
+  mq2_put_u32(buffer + 8, count);
+}
+
+static inline void mq2_trace_write_sample(uint8_t *buffer, uint32_t index, float ppm) {
+  if (ppm < 0) {
+    ppm = 0;
+  }
+  if (ppm > 65535) {
+    ppm = 65535;
+  }
+  mq2_put_u16(buffer + MQ2_TRACE_HEADER_SIZE + 2 * index, (uint16_t)(ppm + 0.5f));
+}
+
+// ---- Synthetic waveforms ----
+
+typedef enum {
+  MQ2_WAVE_LEAK,  // base, then exponential approach to peak (time constant rise_ms)
+  MQ2_WAVE_DRIFT, // base plus (peak - base) spread linearly over rise_ms, then held
+  MQ2_WAVE_NOISE, // base only; use noise_ppm for the signal
+  MQ2_WAVE_STEP   // base, then peak from start_ms on
+} mq2_wave_kind_t;
+
+typedef struct {
+  mq2_wave_kind_t kind;
+  float base_ppm;
+  float peak_ppm;
+  uint32_t start_ms;
+  uint32_t rise_ms;
+  float noise_ppm; // Standard deviation of added noise, any kind
+  uint32_t seed;   // Noise state; same seed, same sequence
+} mq2_wave_t;
+
+// xorshift32, uniform in [0, 1)
+static inline float mq2_uniform(uint32_t *state) {
+  uint32_t x = *state ? *state : 0x9E3779B9u;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+// Approximately normal: sum of four uniforms, scaled to unit variance
+static inline float mq2_gaussian(uint32_t *state) {
+  float sum = mq2_uniform(state) + mq2_uniform(state) + mq2_uniform(state) + mq2_uniform(state);
+  return (sum - 2.0f) * 1.7320508f;
+}
+
+// PPM at waveform time t_ms. Advances the noise state when noise_ppm > 0.
+static inline float mq2_wave_ppm(mq2_wave_t *wave, uint32_t t_ms) {
+  float ppm = wave->base_ppm;
+  float delta = wave->peak_ppm - wave->base_ppm;
+
+  if (t_ms >= wave->start_ms) {
+    float elapsed = (float)(t_ms - wave->start_ms);
+    float rise = wave->rise_ms ? (float)wave->rise_ms : 1.0f;
+    switch (wave->kind) {
+      case MQ2_WAVE_LEAK:
+        ppm += delta * (1.0f - expf(-elapsed / rise));
+        break;
+      case MQ2_WAVE_DRIFT:
+        ppm += delta * (elapsed < rise ? elapsed / rise : 1.0f);
+        break;
+      case MQ2_WAVE_STEP:
+        ppm += delta;
+        break;
+      case MQ2_WAVE_NOISE:
+        break;
+    }
+  }
+
+  if (wave->noise_ppm > 0) {
+    ppm += wave->noise_ppm * mq2_gaussian(&wave->seed);
+  }
+  return ppm < 0 ? 0 : ppm;
+}
+
+// Renders a waveform into a trace buffer of mq2_trace_size(count) bytes.
+static inline void mq2_wave_render(mq2_wave_t *wave, uint8_t *buffer, uint16_t sample_ms, uint32_t count) {
+  mq2_trace_write_header(buffer, sample_ms, count);
+  for (uint32_t i = 0; i < count; i++) {
+    mq2_trace_write_sample(buffer, i, mq2_wave_ppm(wave, i * (uint32_t)sample_ms));
+  }
+}
+
+// ---- Sensor model ----
+
+// A0 voltage the MQ-2 module outputs at a given LPG concentration. Anything
+// below the clean-air point reads as clean air, so calibration stays finite.
+static inline float mq2_ppm_to_voltage(float ppm) {
+  float ratio = MQ2_CLEAN_AIR_RATIO;
+  if (ppm > 0) {
+    ratio = powf(ppm / MQ2_LPG_A, 1.0f / MQ2_LPG_B);
+    if (ratio > MQ2_CLEAN_AIR_RATIO) {
+      ratio = MQ2_CLEAN_AIR_RATIO;
+    }
+  }
+  float rs = ratio * MQ2_R0_KOHM;
+  return MQ2_VCC * MQ2_RL_KOHM / (rs + MQ2_RL_KOHM);
+}
+
+#endif // MQ2_STIMULUS_H
@@ -19,6 +19,10 @@
 #include <MQUnifiedsensor.h>
 #include "GLPSecureSenseDevice.h"
 
+// Sensing/LEDs and display/serial on separate cores (mains-powered units).
+// false keeps one loop that light-sleeps between passes (battery units).
+#define RUN_DUAL_CORE false
+
 // Global device instance
 GLPSecureSenseDevice *glpDevice;
 
@@ -27,13 +31,24 @@ void setup()
   // Create and initialize the GLP SecureSense Pro device
   glpDevice = new GLPSecureSenseDevice();
   glpDevice->initialize();
+
+  if (RUN_DUAL_CORE)
+  {
+    glpDevice->startDualCore();
+  }
 }
 
 void loop()
 {
-  // Run the main device operations
+  // Run the main device operations, unless they run in their own tasks
+  if (glpDevice->isDualCore())
+  {
+    delay(100);
+    return;
+  }
+
   glpDevice->run();
 
-  // Small delay to prevent overwhelming the system
-  delay(100);
+  // Sleep until the next sensor, display or log deadline
+  glpDevice->idle();
 }
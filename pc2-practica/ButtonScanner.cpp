@@ -0,0 +1,233 @@
+/**
+ * @file ButtonScanner.cpp
+ * @brief Implements the ButtonScanner class.
+ *
+ * The timer interrupt only copies the GPIO input register into a lock-free queue; debouncing
+ * and gesture detection run in service(), so event handlers never execute in interrupt context.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include "ButtonScanner.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#endif
+
+ButtonScanner::ButtonScanner(EventHandler *eventHandler)
+    // The pins belong to the scanned inputs, none to the scanner itself
+    : Sensor(-1, eventHandler),
+      inputMask(0),
+      debounced(0),
+      count0(0xFFFFFFFFUL),
+      count1(0xFFFFFFFFUL),
+      consumed(0),
+      clickOpen(0),
+      pressedAt(),
+      releasedAt(),
+      ticks(0),
+      worstServiceMicros(0)
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+      ,
+      timer(nullptr)
+#endif
+{
+}
+
+ButtonScanner::~ButtonScanner()
+{
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (timer != nullptr)
+    {
+        timerEnd(timer);
+    }
+#endif
+}
+
+bool ButtonScanner::addPin(uint8_t gpio)
+{
+    if (gpio >= MAX_INPUTS)
+    {
+        return false;
+    }
+    pinMode(gpio, INPUT_PULLUP);
+    inputMask |= 1UL << gpio;
+    return true;
+}
+
+void ButtonScanner::begin()
+{
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (timer == nullptr)
+    {
+        timer = timerBegin(1000000); // 1 MHz: alarm counts in microseconds
+        if (timer != nullptr)
+        {
+            timerAttachInterruptArg(timer, onTick, this);
+            timerAlarm(timer, TICK_US, true, 0);
+        }
+    }
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+void IRAM_ATTR ButtonScanner::onTick(void *arg)
+{
+    ButtonScanner *scanner = static_cast<ButtonScanner *>(arg);
+    PortSample sample = {REG_READ(GPIO_IN_REG), scanner->ticks};
+    scanner->ticks = sample.tick + 1;
+    scanner->samples.push(sample);
+}
+#endif
+
+void ButtonScanner::service()
+{
+    unsigned long start = micros();
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    if (timer != nullptr)
+    {
+        PortSample sample;
+        while (samples.pop(sample))
+        {
+            scan(sample.levels, sample.tick * (TICK_US / 1000));
+        }
+    }
+    else
+#endif
+    {
+        ticks = ticks + 1;
+        scan(readLevels(), millis());
+    }
+
+    uint32_t spent = micros() - start;
+    if (spent > worstServiceMicros)
+    {
+        worstServiceMicros = spent;
+    }
+}
+
+uint32_t ButtonScanner::readLevels() const
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return REG_READ(GPIO_IN_REG);
+#else
+    uint32_t levels = 0;
+    for (uint32_t bits = inputMask; bits != 0; bits &= bits - 1)
+    {
+        uint8_t input = __builtin_ctz(bits);
+        if (digitalRead(input) == HIGH)
+        {
+            levels |= 1UL << input;
+        }
+    }
+    return levels;
+#endif
+}
+
+void ButtonScanner::scan(uint32_t levels, uint32_t nowMillis)
+{
+    // Vertical counters: each input's 2-bit counter is spread over count0 and
+    // count1, so one bitwise pass advances all of them. A counter resets when
+    // the sample matches the debounced state and wraps, flipping that state,
+    // after four samples in a row that disagree with it.
+    uint32_t sample = ~levels & inputMask; // Active low: a low pin is pressed
+    uint32_t changed = debounced ^ sample;
+    count0 = ~(count0 & changed);
+    count1 = count0 ^ (count1 & changed);
+    changed &= count0 & count1;
+    debounced ^= changed;
+
+    // Only inputs that flipped this tick are visited
+    for (uint32_t bits = changed & debounced; bits != 0; bits &= bits - 1)
+    {
+        uint8_t input = __builtin_ctz(bits);
+        uint32_t bit = 1UL << input;
+        pressedAt[input] = nowMillis;
+        consumed &= ~bit;
+        emit(ButtonGesture::PRESS, input);
+
+        if ((clickOpen & bit) && nowMillis - releasedAt[input] <= DOUBLE_CLICK_MS)
+        {
+            consumed |= bit;
+            emit(ButtonGesture::DOUBLE_CLICK, input);
+        }
+        clickOpen &= ~bit;
+    }
+
+    for (uint32_t bits = changed & ~debounced; bits != 0; bits &= bits - 1)
+    {
+        uint8_t input = __builtin_ctz(bits);
+        uint32_t bit = 1UL << input;
+        emit(ButtonGesture::RELEASE, input);
+
+        // A press that became a long press or a double click starts no new click
+        if (!(consumed & bit))
+        {
+            clickOpen |= bit;
+            releasedAt[input] = nowMillis;
+        }
+    }
+
+    // Held inputs that have not produced a gesture yet
+    for (uint32_t bits = debounced & ~consumed; bits != 0; bits &= bits - 1)
+    {
+        uint8_t input = __builtin_ctz(bits);
+        if (nowMillis - pressedAt[input] >= LONG_PRESS_MS)
+        {
+            consumed |= 1UL << input;
+            emit(ButtonGesture::LONG_PRESS, input);
+        }
+    }
+}
+
+void ButtonScanner::emit(ButtonGesture gesture, uint8_t input)
+{
+    on(eventFor(gesture, input));
+}
+
+uint32_t ButtonScanner::getPressed() const
+{
+    return debounced;
+}
+
+bool ButtonScanner::isPressed(uint8_t input) const
+{
+    return input < MAX_INPUTS && (debounced & (1UL << input)) != 0;
+}
+
+uint32_t ButtonScanner::getTicks() const
+{
+    return ticks;
+}
+
+uint32_t ButtonScanner::getDroppedSamples() const
+{
+    return samples.getDropped();
+}
+
+uint32_t ButtonScanner::getWorstServiceMicros() const
+{
+    return worstServiceMicros;
+}
+
+Event ButtonScanner::eventFor(ButtonGesture gesture, uint8_t input)
+{
+    return Event(EVENT_ID_BASE + (int)gesture * MAX_INPUTS + input);
+}
+
+bool ButtonScanner::decode(Event event, ButtonGesture &gesture, uint8_t &input)
+{
+    int offset = event.id - EVENT_ID_BASE;
+    if (offset < 0 || offset >= 4 * MAX_INPUTS)
+    {
+        return false;
+    }
+    gesture = (ButtonGesture)(offset / MAX_INPUTS);
+    input = (uint8_t)(offset % MAX_INPUTS);
+    return true;
+}
@@ -0,0 +1,131 @@
+#ifndef BUTTON_SCANNER_H
+#define BUTTON_SCANNER_H
+
+/**
+ * @file ButtonScanner.h
+ * @brief Declares the ButtonScanner class.
+ *
+ * A sensor class in the Modest IoT Nano-framework for panels with many push buttons. A hardware
+ * timer samples the whole GPIO input register every tick; the loop then debounces all inputs at
+ * once with 2-bit vertical counters (one bitwise pass per tick, whatever the number of buttons)
+ * and turns the debounced edges into press, release, long-press and double-click events.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include "Sensor.h"
+#include "SpscQueue.h"
+#include <stdint.h>
+
+#include <Arduino.h>
+
+/**
+ * @brief What a button did; combined with the input number into the event id.
+ */
+enum class ButtonGesture : uint8_t
+{
+    PRESS,       ///< Debounced press.
+    RELEASE,     ///< Debounced release.
+    LONG_PRESS,  ///< Held for LONG_PRESS_MS; raised once per press.
+    DOUBLE_CLICK ///< Second press within DOUBLE_CLICK_MS of a release.
+};
+
+class ButtonScanner : public Sensor
+{
+public:
+    static const uint8_t MAX_INPUTS = 32;         ///< One bit per GPIO 0-31.
+    static const int EVENT_ID_BASE = 100;         ///< Ids 100-227: EVENT_ID_BASE + gesture * 32 + input.
+    static const uint32_t TICK_US = 5000;         ///< Sample period; four agreeing samples debounce (20 ms).
+    static const uint32_t LONG_PRESS_MS = 800;    ///< Hold time for LONG_PRESS.
+    static const uint32_t DOUBLE_CLICK_MS = 300;  ///< Release-to-press gap for DOUBLE_CLICK.
+
+private:
+    /**
+     * @brief One raw port sample taken by the timer.
+     */
+    struct PortSample
+    {
+        uint32_t levels; ///< GPIO input register, bit n = GPIO n.
+        uint32_t tick;   ///< Tick number, so processing later keeps sampling time.
+    };
+
+    uint32_t inputMask; ///< Configured inputs.
+    uint32_t debounced; ///< Debounced pressed state, bit per input.
+    uint32_t count0;    ///< Vertical counter, low bit of each input's counter.
+    uint32_t count1;    ///< Vertical counter, high bit of each input's counter.
+    uint32_t consumed;  ///< Inputs whose current press already raised LONG_PRESS or DOUBLE_CLICK.
+    uint32_t clickOpen; ///< Inputs released once and waiting for a second press.
+    uint32_t pressedAt[MAX_INPUTS];
+    uint32_t releasedAt[MAX_INPUTS];
+
+    SpscQueue<PortSample, 16> samples; ///< Timer interrupt to loop.
+    volatile uint32_t ticks;
+    uint32_t worstServiceMicros;
+
+#if defined(ARDUINO_ARCH_ESP32) && ESP_ARDUINO_VERSION_MAJOR >= 3
+    hw_timer_t *timer;
+    static void IRAM_ATTR onTick(void *arg);
+#endif
+
+    uint32_t readLevels() const;
+    void emit(ButtonGesture gesture, uint8_t input);
+
+public:
+    /**
+     * @brief Constructs a scanner with no inputs.
+     * @param eventHandler Optional handler to receive button events (default: nullptr).
+     */
+    ButtonScanner(EventHandler *eventHandler = nullptr);
+    ~ButtonScanner();
+
+    /**
+     * @brief Adds an active-low button, configured as INPUT_PULLUP.
+     * @param gpio GPIO number 0-31.
+     * @return False if the GPIO cannot be scanned.
+     */
+    bool addPin(uint8_t gpio);
+
+    /**
+     * @brief Starts the sampling timer. Without one, service() samples once per call.
+     */
+    void begin();
+
+    /**
+     * @brief Debounces all queued samples and raises the resulting events. Call from the loop.
+     */
+    void service();
+
+    /**
+     * @brief Processes one sample. Hardware-free: feed it any levels and clock.
+     * @param levels Input levels, bit n = input n; a low bit is a pressed button.
+     * @param nowMillis Time of the sample in milliseconds.
+     */
+    void scan(uint32_t levels, uint32_t nowMillis);
+
+    /**
+     * @brief Gets the debounced pressed state.
+     * @return Bit n set while input n is pressed.
+     */
+    uint32_t getPressed() const;
+
+    bool isPressed(uint8_t input) const;
+    uint32_t getTicks() const;
+    uint32_t getDroppedSamples() const;
+    uint32_t getWorstServiceMicros() const;
+
+    /**
+     * @brief Builds the event for a gesture on an input.
+     */
+    static Event eventFor(ButtonGesture gesture, uint8_t input);
+
+    /**
+     * @brief Splits a button event into gesture and input.
+     * @return False if the event does not come from a ButtonScanner.
+     */
+    static bool decode(Event event, ButtonGesture &gesture, uint8_t &input);
+};
+
+#endif // BUTTON_SCANNER_H
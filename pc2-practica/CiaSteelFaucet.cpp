@@ -18,21 +18,50 @@
 
 #include "CiaSteelFaucet.h"
 #include <Arduino.h>
+#include <stdarg.h>
 
 CiaSteelFaucet::CiaSteelFaucet(const char *wifiSSID, const char *wifiPassword)
     : proximitydetector(ULTRASOUND_TRIG_PIN, ULTRASOUND_ECHO_PIN, PROXIMITY_THRESHOLD_CM, this),
-      waterValve(RELAY_PIN, false, this),
-      statusLed(LED_PIN, false, this),
+      waterValve(RELAY_PIN),
+      statusLed(LED_PIN),
+      proximityClock("proximity jitter", acquireDistance, this, PROXIMITY_PERIOD_US, PROXIMITY_JITTER_BUDGET_US),
       lastStatusUpdate(0),
       statusUpdateInterval(STATUS_UPDATE_INTERVAL_MS),
+      handToValveLatency("hand->valve", HAND_TO_VALVE_BUDGET_US),
+      valveCloseLatency("valve close", VALVE_CLOSE_BUDGET_US),
+      statusLatency("status", STATUS_BUDGET_US),
+      measuring(false),
+      measurementStartMicros(0),
+      valveCloseDueMillis(0),
+      runner(realTimeStep, ioStep, this, REAL_TIME_PERIOD_US, CONSOLE_PERIOD_US, REAL_TIME_LATENESS_BUDGET_US),
+      realTimeEvents(this),
+      realTimeCommands(this),
+      projected{-1.0f, false, false, false, false, 0, 0, 0},
+      projectionChanged(true),
+#if defined(ARDUINO_ARCH_ESP32)
+      journalStorage("/journal"),
+      journal(&journalStorage, VALVE_OPEN_DURATION_MS),
+#else
+      journal(nullptr, VALVE_OPEN_DURATION_MS),
+#endif
       ssid(wifiSSID),
       password(wifiPassword),
-      wifiConnected(false)
+      wifiConnected(false),
+      ipAddress{},
+      httpServer(HTTP_PORT),
+      statusResponse("200 OK", "application/json", STATUS_BODY_BYTES),
+      metricsResponse("200 OK", "text/plain; version=0.0.4", METRICS_BODY_BYTES),
+      renderedStatusVersion(0),
+      lastMetricsRender(0),
+      httpServing(false)
 {
 }
 
 void CiaSteelFaucet::initialize()
 {
+    // Without a driver buffer Serial blocks once the 128-byte FIFO is full, and on a single
+    // core a status block would hold up the valve for as long as the UART takes to send it
+    Serial.setTxBufferSize(CONSOLE_TX_BUFFER_BYTES);
     Serial.begin(115200);
     delay(1000); // Allow serial to initialize
 
@@ -44,8 +73,22 @@ void CiaSteelFaucet::initialize()
         initializeWiFi();
     }
 
-    // Device is now active - turn on status LED
-    statusLed.setState(true);
+    // Measurements run on the timer's sampling task, which wakes the real-time step for each
+    // one. A single core has no such step: the loop measures inline, so a sample never waits
+    // out a loop delay before the valve opens
+    proximityClock.setSampleReady(onDistanceReady, this);
+    if (!DualCoreRunner::isSupported() || !proximityClock.begin())
+    {
+        Serial.println("Sampling timer unavailable. Measuring from the loop.");
+    }
+
+    // Device is now active: LED, valve and proximity as they were before the reset
+    restoreState();
+
+    if (wifiConnected)
+    {
+        startHttp();
+    }
 
     Serial.println("Moen Cia Steel Faucet initialized successfully.");
     Serial.println("MotionSense Wave™ technology is now active.");
@@ -57,45 +100,379 @@ void CiaSteelFaucet::initialize()
 
 void CiaSteelFaucet::update()
 {
-    // Check for proximity events
-    proximitydetector.checkProximity();
+    runCore(ExecutionCore::REAL_TIME);
+    runCore(ExecutionCore::IO);
+}
+
+void CiaSteelFaucet::runCore(ExecutionCore core)
+{
+    if (core == ExecutionCore::REAL_TIME)
+    {
+        realTimeEvents.deliver();
+        realTimeCommands.deliver();
+    }
+    if (core == PROXIMITY_CORE)
+    {
+        measureProximity();
+    }
+    if (core == VALVE_CORE)
+    {
+        updateValve();
+    }
+    if (core == ExecutionCore::REAL_TIME)
+    {
+        // Re-arms a BREATHE ramp; other patterns need nothing per pass
+        statusLed.update();
+        publishStatus();
+    }
+    if (core == CONSOLE_CORE)
+    {
+        updateConsole();
+    }
+    if (core == JOURNAL_CORE)
+    {
+        persistJournal();
+    }
+    if (core == HTTP_CORE && httpServing && !httpServer.isRunning())
+    {
+        refreshResponses();
+        httpServer.service(millis(), 0);
+    }
+}
 
-    // Update water valve timer
+bool CiaSteelFaucet::startDualCore()
+{
+    if (!runner.start())
+    {
+        Serial.println("Dual-core mode unavailable. Running from loop().");
+        return false;
+    }
+    Serial.printf("Dual-core mode: real-time on core %d, I/O on core %d.\n",
+                  DualCoreRunner::REAL_TIME_CORE, DualCoreRunner::IO_CORE);
+    return true;
+}
+
+bool CiaSteelFaucet::isDualCore() const
+{
+    return runner.isRunning();
+}
+
+void CiaSteelFaucet::submit(Event event)
+{
+    if (runner.isRunning())
+    {
+        realTimeEvents.on(event);
+    }
+    else
+    {
+        on(event);
+    }
+}
+
+void CiaSteelFaucet::submit(Command command)
+{
+    if (runner.isRunning())
+    {
+        realTimeCommands.handle(command);
+    }
+    else
+    {
+        handle(command);
+    }
+}
+
+void CiaSteelFaucet::realTimeStep(void *context)
+{
+    static_cast<CiaSteelFaucet *>(context)->runCore(ExecutionCore::REAL_TIME);
+}
+
+void CiaSteelFaucet::ioStep(void *context)
+{
+    static_cast<CiaSteelFaucet *>(context)->runCore(ExecutionCore::IO);
+}
+
+float CiaSteelFaucet::acquireDistance(void *context)
+{
+    return static_cast<CiaSteelFaucet *>(context)->proximitydetector.measureDistance();
+}
+
+void CiaSteelFaucet::onDistanceReady(void *context)
+{
+    // Does nothing until dual-core mode runs; the loop polls the clock itself
+    static_cast<CiaSteelFaucet *>(context)->runner.wake();
+}
+
+void CiaSteelFaucet::measureProximity()
+{
+    // Evaluate every completed sample; on() records the latency while measuring is set
+    proximityClock.poll();
+    TimedSample sample;
+    while (proximityClock.take(sample))
+    {
+        measurementStartMicros = (unsigned long)(sample.scheduledMicros + sample.latenessMicros);
+        measuring = true;
+        proximitydetector.evaluateDistance(sample.value, (unsigned long)(sample.scheduledMicros / 1000));
+        measuring = false;
+        if (sample.value > 0 && sample.value != projected.distance)
+        {
+            projected.distance = sample.value;
+            projectionChanged = true;
+        }
+    }
+}
+
+void CiaSteelFaucet::updateValve()
+{
+    bool timerWasActive = waterValve.isTimerActive();
     waterValve.updateTimer();
+    if (timerWasActive && !waterValve.getState())
+    {
+        valveCloseLatency.record((millis() - valveCloseDueMillis) * 1000UL);
+        projected.valveOpen = false;
+        projected.valveTimed = false;
+        projectionChanged = true;
+    }
+}
+
+void CiaSteelFaucet::publishStatus()
+{
+    // One new version per real-time pass at most, and none when nothing changed
+    if (projectionChanged)
+    {
+        statusView.write(projected);
+        projectionChanged = false;
+    }
+}
+
+void CiaSteelFaucet::updateConsole()
+{
+    Event event(0);
+    while (consoleEvents.take(event))
+    {
+        logEvent(event);
+    }
 
     // Print status periodically
-    if (millis() - lastStatusUpdate >= statusUpdateInterval)
+    unsigned long sinceStatus = millis() - lastStatusUpdate;
+    if (sinceStatus >= statusUpdateInterval)
     {
+        statusLatency.record((sinceStatus - statusUpdateInterval) * 1000UL);
         printStatus();
         lastStatusUpdate = millis();
     }
 }
 
+void CiaSteelFaucet::restoreState()
+{
+    if (journal.begin())
+    {
+        Serial.printf("Journal: state restored, %lu records replayed in %lu us.\n",
+                      (unsigned long)journal.getReplayed(), (unsigned long)journal.getRestoreMicros());
+    }
+    else
+    {
+        Serial.println("Journal storage unavailable. State is kept in RAM only.");
+    }
+
+    unsigned long now = millis();
+    FaucetState state = journal.getState();
+
+    // Fail safe: a timed opening belonged to a hand that is gone or will be seen again, and
+    // the time spent without power is unknown, so it stays closed. Only manual opening and
+    // closing are restored. The close is journaled so the next boot starts from it
+    waterValve.closeValve();
+    if (state.valveOpen && state.valveTimed)
+    {
+        journalEntry(JournalKind::COMMAND, RelayModule::CLOSE_VALVE_COMMAND_ID);
+        Serial.println("Journal: timed valve was open at reset. Closed.");
+    }
+    else if (state.valveOpen)
+    {
+        waterValve.openValve();
+    }
+    statusLed.handle(Command(state.ledCommand));
+    proximitydetector.restoreRange(state.inRange != 0, now);
+
+    projected.inRange = state.inRange != 0;
+    projected.valveOpen = waterValve.getState();
+    projected.valveTimed = waterValve.isTimerActive();
+    projected.ledOn = statusLed.getState();
+    projected.activations = state.activations;
+    projected.commands = state.commands;
+    projectionChanged = true;
+    publishStatus();
+}
+
+void CiaSteelFaucet::journalEntry(JournalKind kind, int id)
+{
+    JournalEntry entry;
+    entry.kind = kind;
+    entry.id = (int16_t)id;
+    entry.timeMillis = journal.timeAt(millis());
+    journalEntries.push(entry);
+}
+
+void CiaSteelFaucet::persistJournal()
+{
+    // One storage append per pass for everything the real-time core queued
+    JournalEntry entry;
+    while (journalEntries.pop(entry))
+    {
+        journal.append(entry.kind, entry.id, entry.timeMillis);
+    }
+    journal.flush();
+}
+
+bool CiaSteelFaucet::startHttp()
+{
+    httpServer.addRoute("/status", &statusResponse);
+    httpServer.addRoute("/metrics", &metricsResponse);
+    if (!httpServer.begin())
+    {
+        Serial.println("HTTP server unavailable.");
+        return false;
+    }
+    refreshResponses();
+    httpServing = true;
+
+    // Its own task answers without waiting for the I/O period; otherwise the I/O step serves
+    bool ownTask = httpServer.start(refreshHttp, this);
+    Serial.printf("HTTP: http://%s:%u/status and /metrics (%s)\n", ipAddress, (unsigned)HTTP_PORT,
+                  ownTask ? "server task" : "I/O loop");
+    return true;
+}
+
+void CiaSteelFaucet::refreshHttp(void *context)
+{
+    static_cast<CiaSteelFaucet *>(context)->refreshResponses();
+}
+
+void CiaSteelFaucet::refreshResponses()
+{
+    // Runs where the server runs; a refused render (both buffers being sent) is retried next pass
+    uint32_t version = statusView.getVersion();
+    if (version != renderedStatusVersion && statusResponse.render(renderStatus, this))
+    {
+        renderedStatusVersion = version;
+    }
+    unsigned long now = millis();
+    if ((now - lastMetricsRender >= METRICS_REFRESH_MS || lastMetricsRender == 0) &&
+        metricsResponse.render(renderMetrics, this))
+    {
+        lastMetricsRender = now;
+    }
+}
+
+size_t CiaSteelFaucet::renderStatus(char *body, size_t capacity, void *context)
+{
+    FaucetStatus status = static_cast<CiaSteelFaucet *>(context)->statusView.read();
+    return snprintf(body, capacity,
+                    "{\"distance_cm\":%.1f,\"in_range\":%s,\"valve\":\"%s\",\"valve_timed\":%s,\"led\":%s,"
+                    "\"activations\":%lu,\"commands\":%lu,\"last_activation_ms\":%lu}\n",
+                    status.distance, status.inRange ? "true" : "false", status.valveOpen ? "open" : "closed",
+                    status.valveTimed ? "true" : "false", status.ledOn ? "true" : "false",
+                    (unsigned long)status.activations, (unsigned long)status.commands,
+                    (unsigned long)status.lastActivationMillis);
+}
+
+/**
+ * @brief snprintf at an offset, tolerating an offset past the end so the total length still comes out.
+ */
+static size_t appendf(char *body, size_t capacity, size_t used, const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    int written = vsnprintf(used < capacity ? body + used : nullptr, used < capacity ? capacity - used : 0,
+                            format, arguments);
+    va_end(arguments);
+    return used + (written > 0 ? written : 0);
+}
+
+size_t CiaSteelFaucet::renderMetrics(char *body, size_t capacity, void *context)
+{
+    // Histograms and counters of other tasks are read without locking, as in printLatencyReport()
+    CiaSteelFaucet *device = static_cast<CiaSteelFaucet *>(context);
+    FaucetStatus status = device->statusView.read();
+    size_t used = 0;
+    used = appendf(body, capacity, used, "faucet_uptime_seconds %lu\n", millis() / 1000UL);
+    used = appendf(body, capacity, used, "faucet_activations_total %lu\n", (unsigned long)status.activations);
+    used = appendf(body, capacity, used, "faucet_commands_total %lu\n", (unsigned long)status.commands);
+    used = appendf(body, capacity, used, "faucet_valve_open %d\n", status.valveOpen ? 1 : 0);
+    used = appendf(body, capacity, used, "faucet_in_range %d\n", status.inRange ? 1 : 0);
+
+    const LatencyHistogram *slos[] = {&device->handToValveLatency, &device->valveCloseLatency,
+                                      &device->statusLatency, &device->runner.getRealTimeLateness(),
+                                      &device->proximityClock.getJitter()};
+    for (const LatencyHistogram *slo : slos)
+    {
+        used = appendf(body, capacity, used, "faucet_latency_p99_seconds{slo=\"%s\"} %.6f\n",
+                       slo->getName(), slo->percentile(990) / 1000000.0);
+        used = appendf(body, capacity, used, "faucet_latency_budget_met{slo=\"%s\"} %d\n",
+                       slo->getName(), slo->meetsBudget() ? 1 : 0);
+    }
+    used = appendf(body, capacity, used, "faucet_proximity_skipped_slots_total %lu\n",
+                   (unsigned long)device->proximityClock.getSkippedTicks());
+    used = appendf(body, capacity, used, "faucet_journal_write_amplification %.3f\n",
+                   device->journal.getWriteAmplification());
+    used = appendf(body, capacity, used, "faucet_http_connections_accepted_total %lu\n",
+                   (unsigned long)device->httpServer.getAccepted());
+    used = appendf(body, capacity, used, "faucet_http_responses_total %lu\n",
+                   (unsigned long)device->httpServer.getServed());
+    return used;
+}
+
 void CiaSteelFaucet::on(Event event)
 {
+    // Actuate here, on the real-time core; the console logs the event later
     if (event == UltrasoundSensor::PROXIMITY_DETECTED_EVENT)
     {
-        Serial.println(">>> Proximity detected! Hand approaching faucet.");
-
         // Turn on LED to indicate detection
         statusLed.setState(true);
 
         // Open water valve for 5 seconds
         waterValve.openValveTimed(VALVE_OPEN_DURATION_MS);
+        valveCloseDueMillis = millis() + VALVE_OPEN_DURATION_MS;
+        if (measuring)
+        {
+            handToValveLatency.record(micros() - measurementStartMicros);
+        }
 
+        projected.inRange = true;
+        projected.valveOpen = true;
+        projected.valveTimed = true;
+        projected.ledOn = true;
+        projected.activations++;
+        projected.lastActivationMillis = millis();
+        projectionChanged = true;
+    }
+    else if (event == UltrasoundSensor::PROXIMITY_LOST_EVENT)
+    {
+        projected.inRange = false;
+        projectionChanged = true;
+    }
+    // On PROXIMITY_LOST_EVENT the LED stays on (device remains active) and
+    // the water valve closes automatically after its timer expires
+    journalEntry(JournalKind::EVENT, event.id);
+    consoleEvents.on(event);
+}
+
+void CiaSteelFaucet::logEvent(Event event)
+{
+    if (event == UltrasoundSensor::PROXIMITY_DETECTED_EVENT)
+    {
+        Serial.println(">>> Proximity detected! Hand approaching faucet.");
         Serial.println(">>> Water valve opened for 5 seconds.");
     }
     else if (event == UltrasoundSensor::PROXIMITY_LOST_EVENT)
     {
         Serial.println(">>> Proximity lost. Hand moved away from faucet.");
-
-        // Keep LED on (device remains active)
-        // Water valve will close automatically after timer expires
     }
 }
 
 void CiaSteelFaucet::handle(Command command)
 {
+    journalEntry(JournalKind::COMMAND, command.id);
+
     // Handle any external commands if needed
     // For now, relay commands to water valve
     if (command == RelayModule::OPEN_VALVE_COMMAND ||
@@ -108,10 +485,20 @@ void CiaSteelFaucet::handle(Command command)
     // Handle LED commands
     if (command == Led::TURN_ON_COMMAND ||
         command == Led::TURN_OFF_COMMAND ||
-        command == Led::TOGGLE_LED_COMMAND)
+        command == Led::TOGGLE_LED_COMMAND ||
+        command == LedPatternDriver::BLINK_COMMAND ||
+        command == LedPatternDriver::FAST_BLINK_COMMAND ||
+        command == LedPatternDriver::STROBE_COMMAND ||
+        command == LedPatternDriver::BREATHE_COMMAND)
     {
         statusLed.handle(command);
     }
+
+    projected.valveOpen = waterValve.getState();
+    projected.valveTimed = waterValve.isTimerActive();
+    projected.ledOn = statusLed.getState();
+    projected.commands++;
+    projectionChanged = true;
 }
 
 void CiaSteelFaucet::printWelcomeMessage()
@@ -142,8 +529,10 @@ void CiaSteelFaucet::printWelcomeMessage()
 
 void CiaSteelFaucet::printStatus()
 {
-    float distance = proximitydetector.getLastDistance();
-    const char *valveState = waterValve.getStateString();
+    // Answered from the read model, never from the components directly
+    FaucetStatus status = statusView.read();
+    float distance = status.distance;
+    const char *valveState = status.valveOpen ? "open" : "closed";
 
     Serial.println("--- Moen Cia Steel Faucet Status ---");
 
@@ -162,27 +551,115 @@ void CiaSteelFaucet::printStatus()
     }
 
     Serial.printf("Water Valve: %s", valveState);
-    if (waterValve.isTimerActive())
+    if (status.valveTimed)
     {
         Serial.print(" [TIMED]");
     }
     Serial.println();
 
-    Serial.printf("Status LED: %s\n", statusLed.getState() ? "ON" : "OFF");
+    Serial.printf("Status LED: %s\n", status.ledOn ? "ON" : "OFF");
+    Serial.printf("Activations: %lu", (unsigned long)status.activations);
+    if (status.lastActivationMillis != 0)
+    {
+        Serial.printf(", last %lu s ago", (unsigned long)((millis() - status.lastActivationMillis) / 1000));
+    }
+    Serial.println();
 
     if (wifiConnected)
     {
-        Serial.printf("WiFi: Connected to %s (IP: %s)\n", ssid, WiFi.localIP().toString().c_str());
+        Serial.printf("WiFi: Connected to %s (IP: %s)\n", ssid, ipAddress);
+        if (httpServing)
+        {
+            Serial.printf("HTTP: %u open connections, %lu responses\n", (unsigned)httpServer.getOpenConnections(),
+                          (unsigned long)httpServer.getServed());
+        }
     }
     else
     {
         Serial.println("WiFi: Not connected");
     }
 
+    printLatencyReport();
+    printRollupSummary();
+
+    Serial.printf("Journal: %lu records persisted, write amplification %.2f%s\n",
+                  (unsigned long)journal.getPersistedState().sequence,
+                  journal.getWriteAmplification(), journal.isPersistent() ? "" : " (RAM only)");
+
     Serial.println("------------------------------------");
     Serial.println();
 }
 
+void CiaSteelFaucet::printLatencyReport()
+{
+    // Histograms recorded on the real-time core are read here without locking;
+    // their counters are word-sized, so a report is at worst one sample stale
+    const LatencyHistogram *slos[] = {&handToValveLatency, &valveCloseLatency, &statusLatency,
+                                      &runner.getRealTimeLateness(), &proximityClock.getJitter()};
+    for (const LatencyHistogram *slo : slos)
+    {
+        if (slo->getCount() == 0)
+        {
+            continue;
+        }
+        Serial.printf("SLO %s: p50 %.1f ms, p99 %.1f ms (budget %.1f ms) %s, %lu samples\n",
+                      slo->getName(),
+                      slo->percentile(500) / 1000.0,
+                      slo->percentile(990) / 1000.0,
+                      slo->getBudgetMicros() / 1000.0,
+                      slo->meetsBudget() ? "OK" : "MISSED",
+                      (unsigned long)slo->getCount());
+    }
+    if (proximityClock.getSkippedTicks() > 0)
+    {
+        Serial.printf("Proximity sampling: %lu slots skipped (%s)\n", (unsigned long)proximityClock.getSkippedTicks(),
+                      proximityClock.isHardwareTimed() ? "timer" : "loop");
+    }
+}
+
+void CiaSteelFaucet::printRollupSummary()
+{
+    // Rollups are written on the real-time core; a window may close while it is read
+    RollupSummary distance;
+    if (proximitydetector.getDistanceRollup().current(RollupResolution::MINUTE, distance) && distance.count > 0)
+    {
+        Serial.printf("Distance this minute: mean %.1f cm, min %.1f, max %.1f, p90 %.1f (%lu readings)\n",
+                      distance.mean, distance.min, distance.max, distance.p90, (unsigned long)distance.count);
+    }
+    RollupSummary hour;
+    if (proximitydetector.getActivationRollup().current(RollupResolution::HOUR, hour))
+    {
+        Serial.printf("Activations this hour: %lu, mean dwell %.1f s, p90 %.1f s\n",
+                      (unsigned long)hour.count, hour.mean, hour.p90);
+    }
+}
+
+void CiaSteelFaucet::printRollups(RollupResolution resolution)
+{
+    const RollupSeries *series[] = {&proximitydetector.getDistanceRollup(),
+                                    &proximitydetector.getActivationRollup()};
+    char line[128];
+    Serial.println(RollupSeries::CSV_HEADER);
+    for (const RollupSeries *rollup : series)
+    {
+        for (uint8_t ago = rollup->getClosedCount(resolution); ago > 0; ago--)
+        {
+            RollupSummary summary;
+            if (rollup->closed(resolution, ago - 1, summary))
+            {
+                rollup->formatCsv(resolution, summary, line, sizeof(line));
+                Serial.println(line);
+            }
+        }
+        RollupSummary open;
+        if (rollup->current(resolution, open))
+        {
+            rollup->formatCsv(resolution, open, line, sizeof(line));
+            Serial.println(line);
+        }
+    }
+}
+
 void CiaSteelFaucet::initializeWiFi()
 {
     Serial.printf("Connecting to WiFi network: %s", ssid);
@@ -200,9 +677,10 @@ void CiaSteelFaucet::initializeWiFi()
     if (WiFi.status() == WL_CONNECTED)
     {
         wifiConnected = true;
+        snprintf(ipAddress, sizeof(ipAddress), "%s", WiFi.localIP().toString().c_str());
         Serial.println();
         Serial.println("WiFi connected successfully!");
-        Serial.printf("IP Address: %s\n", WiFi.localIP().toString().c_str());
+        Serial.printf("IP Address: %s\n", ipAddress);
         Serial.println("Ready for Smart Water Network integration.");
     }
     else
@@ -224,11 +702,46 @@ RelayModule &CiaSteelFaucet::getWaterValve()
     return waterValve;
 }
 
-Led &CiaSteelFaucet::getStatusLed()
+LedPatternDriver &CiaSteelFaucet::getStatusLed()
 {
     return statusLed;
 }
 
+const DualCoreRunner &CiaSteelFaucet::getRunner() const
+{
+    return runner;
+}
+
+const LatencyHistogram &CiaSteelFaucet::getHandToValveLatency() const
+{
+    return handToValveLatency;
+}
+
+const SamplingClock &CiaSteelFaucet::getProximityClock() const
+{
+    return proximityClock;
+}
+
+const FaucetJournal &CiaSteelFaucet::getJournal() const
+{
+    return journal;
+}
+
+const StatusServer &CiaSteelFaucet::getHttpServer() const
+{
+    return httpServer;
+}
+
+FaucetStatus CiaSteelFaucet::getStatus() const
+{
+    return statusView.read();
+}
+
+bool CiaSteelFaucet::meetsLatencyBudgets() const
+{
+    return handToValveLatency.meetsBudget() && valveCloseLatency.meetsBudget() && statusLatency.meetsBudget();
+}
+
 bool CiaSteelFaucet::isWiFiConnected() const
 {
     return wifiConnected;
@@ -22,23 +22,92 @@
 #include "Device.h"
 #include "UltrasoundSensor.h"
 #include "RelayModule.h"
-#include "Led.h"
+#include "LedPatternDriver.h"
+#include "LatencyHistogram.h"
+#include "CoreMailbox.h"
+#include "DualCoreRunner.h"
+#include "SpscQueue.h"
+#include "Seqlock.h"
+#include "SamplingClock.h"
+#include "FaucetJournal.h"
+#include "StatusServer.h"
 #include <WiFi.h>
 
+/**
+ * @brief Read model of the faucet, kept up to date as events and commands are handled.
+ *
+ * Status queries from any task are answered from it without touching the components.
+ */
+struct FaucetStatus
+{
+    float distance;                ///< Last measured distance in cm, negative when there is no reading.
+    bool inRange;                  ///< True while a hand is within the threshold.
+    bool valveOpen;                ///< Water valve state.
+    bool valveTimed;               ///< True while the valve timer runs.
+    bool ledOn;                    ///< Status LED state.
+    uint32_t activations;          ///< Proximity detections, kept across resets by the journal.
+    uint32_t commands;             ///< Commands handled, kept across resets by the journal.
+    uint32_t lastActivationMillis; ///< millis() of the latest detection, 0 before the first since boot.
+};
+
+/**
+ * @brief An event or command the real-time core acted on, queued for the journal.
+ */
+struct JournalEntry
+{
+    JournalKind kind;    ///< Event or command.
+    int16_t id;          ///< Its ID.
+    uint32_t timeMillis; ///< Log clock when it was acted on.
+};
+
 class CiaSteelFaucet : public Device
 {
 private:
     UltrasoundSensor proximitydetector; ///< Ultrasound sensor for proximity detection
     RelayModule waterValve;             ///< Relay module for water valve control
-    Led statusLed;                      ///< Blue LED for device status indication
+    LedPatternDriver statusLed;         ///< Blue LED for device status indication
+    SamplingClock proximityClock;       ///< Paces ultrasound measurements at PROXIMITY_PERIOD_US
 
     unsigned long lastStatusUpdate;     ///< Last time status was printed to console
     unsigned long statusUpdateInterval; ///< Interval for status updates (2.5 seconds)
 
+    // Latency SLOs, measured on the device
+    LatencyHistogram handToValveLatency; ///< Start of the detecting measurement to valve open
+    LatencyHistogram valveCloseLatency;  ///< Timed close due to valve actually closed
+    LatencyHistogram statusLatency;      ///< Status due to status printed
+    bool measuring;                      ///< True while a proximity sample is evaluated
+    unsigned long measurementStartMicros; ///< When the evaluated sample's measurement started
+    unsigned long valveCloseDueMillis;   ///< When the timed valve should close
+
+    // Dual-core execution (optional); nothing crosses cores except through these queues
+    DualCoreRunner runner;
+    EventMailbox consoleEvents;               ///< Real-time core to console: events to log
+    EventMailbox realTimeEvents;              ///< Other tasks to real-time core: injected events
+    CommandMailbox realTimeCommands;          ///< Other tasks to real-time core: commands
+    FaucetStatus projected;                   ///< Read model, real-time side
+    bool projectionChanged;                   ///< Projected differs from the published version
+    Seqlock<FaucetStatus> statusView;         ///< Published read model, readable from any task
+
+    // Event-sourced persistence: the real-time core queues what it acted on, the I/O core writes it
+#if defined(ARDUINO_ARCH_ESP32)
+    LittleFsJournalStorage journalStorage;
+#endif
+    FaucetJournal journal;
+    SpscQueue<JournalEntry, 32> journalEntries; ///< Real-time core to journal: records to persist
+
     // WiFi configuration
     const char *ssid;
     const char *password;
     bool wifiConnected;
+    char ipAddress[16]; ///< Dotted address, set once when WiFi connects
+
+    // HTTP status and metrics, rendered when their data changes and sent as is
+    StatusServer httpServer;
+    HttpResponse statusResponse;   ///< GET /status: the read model as JSON
+    HttpResponse metricsResponse;  ///< GET /metrics: counters and SLOs, Prometheus text format
+    uint32_t renderedStatusVersion; ///< Read model version in statusResponse
+    unsigned long lastMetricsRender;
+    bool httpServing;
 
 public:
     // Pin definitions for ESP32
@@ -52,6 +121,32 @@ public:
     static const unsigned long VALVE_OPEN_DURATION_MS = 5000;    ///< 5 seconds valve open time
     static const unsigned long STATUS_UPDATE_INTERVAL_MS = 2500; ///< 2.5 seconds status update
 
+    // Latency budgets (p99), in microseconds
+    static const uint32_t HAND_TO_VALVE_BUDGET_US = 50000; ///< Echo timeout (30 ms) plus margin
+    static const uint32_t VALVE_CLOSE_BUDGET_US = 100000;  ///< Two loop periods
+    static const uint32_t STATUS_BUDGET_US = 100000;       ///< Two loop periods
+
+    // Proximity sampling
+    static const uint32_t PROXIMITY_PERIOD_US = 60000;        ///< HC-SR04 measurement cycle
+    static const uint32_t PROXIMITY_JITTER_BUDGET_US = 1000;  ///< p99 start of a measurement after its slot
+
+    // Core each component runs on once startDualCore() succeeds
+    static constexpr ExecutionCore PROXIMITY_CORE = ExecutionCore::REAL_TIME; ///< Ultrasound measurement and events
+    static constexpr ExecutionCore VALVE_CORE = ExecutionCore::REAL_TIME;     ///< Valve timer
+    static constexpr ExecutionCore CONSOLE_CORE = ExecutionCore::IO;          ///< Event log and status printing
+    static constexpr ExecutionCore JOURNAL_CORE = ExecutionCore::IO;          ///< Flash writes block
+    static constexpr ExecutionCore HTTP_CORE = ExecutionCore::IO;             ///< HTTP when it has no task of its own
+    static const uint32_t REAL_TIME_PERIOD_US = 50000;        ///< Same rate as the single-core loop
+    static const uint32_t CONSOLE_PERIOD_US = 100000;         ///< Console polling period
+    static const size_t CONSOLE_TX_BUFFER_BYTES = 2048;       ///< Holds a whole status block, so printing never waits on the UART
+    static const uint32_t REAL_TIME_LATENESS_BUDGET_US = 5000; ///< p99 start lateness of real-time steps
+
+    // HTTP endpoint
+    static const uint16_t HTTP_PORT = 80;
+    static const size_t STATUS_BODY_BYTES = 256;
+    static const size_t METRICS_BODY_BYTES = 1536;
+    static const unsigned long METRICS_REFRESH_MS = 1000; ///< Metrics change constantly; re-rendered at most this often
+
     /**
      * @brief Constructs a CiaSteelFaucet device.
      * @param wifiSSID WiFi network name (optional for offline operation).
@@ -67,10 +162,43 @@ public:
 
     /**
      * @brief Main update loop for the device.
-     * Should be called in Arduino loop() function.
+     * Should be called in Arduino loop() function while not running dual core.
      */
     void update();
 
+    /**
+     * @brief Runs the components declared for one core, once.
+     * @param core The core whose components to run.
+     */
+    void runCore(ExecutionCore core);
+
+    /**
+     * @brief Moves the device from loop() onto a real-time task and an I/O task on separate cores.
+     * Call after initialize(); afterwards loop() must no longer call update().
+     * @return True if both tasks started; false keeps the single-core loop.
+     */
+    bool startDualCore();
+
+    /**
+     * @brief Checks whether the device runs on its own dual-core tasks.
+     * @return True after a successful startDualCore().
+     */
+    bool isDualCore() const;
+
+    /**
+     * @brief Delivers an event from outside the sensors, on the real-time core.
+     * Queued when running dual core (one producer task); handled immediately otherwise.
+     * @param event The event to deliver.
+     */
+    void submit(Event event);
+
+    /**
+     * @brief Delivers a command from outside the device, on the real-time core.
+     * Queued when running dual core (one producer task); handled immediately otherwise.
+     * @param command The command to deliver.
+     */
+    void submit(Command command);
+
     /**
      * @brief Handles events from sensors (proximity detection).
      * @param event The event to process.
@@ -93,11 +221,39 @@ public:
      */
     void printStatus();
 
+    /**
+     * @brief Prints latency percentiles against their budgets to console.
+     */
+    void printLatencyReport();
+
+    /**
+     * @brief Prints the current minute of distance readings and activations to console.
+     */
+    void printRollupSummary();
+
+    /**
+     * @brief Exports the kept distance and activation windows of one resolution as CSV.
+     * @param resolution Window length to export.
+     */
+    void printRollups(RollupResolution resolution);
+
     /**
      * @brief Initializes WiFi connection.
      */
     void initializeWiFi();
 
+    /**
+     * @brief Starts the HTTP server with /status and /metrics. Called by initialize() once WiFi is up.
+     * @return False when the port cannot be opened.
+     */
+    bool startHttp();
+
+    /**
+     * @brief Gets the HTTP server, for connection and request counts.
+     * @return Reference to the server.
+     */
+    const StatusServer &getHttpServer() const;
+
     /**
      * @brief Gets the proximity sensor reference.
      * @return Reference to the ultrasound sensor.
@@ -112,15 +268,69 @@ public:
 
     /**
      * @brief Gets the status LED reference.
-     * @return Reference to the LED.
+     * @return Reference to the LED driver.
+     */
+    LedPatternDriver &getStatusLed();
+
+    /**
+     * @brief Gets the hand-to-valve latency histogram.
+     * @return Reference to the histogram.
      */
-    Led &getStatusLed();
+    const LatencyHistogram &getHandToValveLatency() const;
+
+    /**
+     * @brief Gets the proximity sampling clock, for its jitter statistics.
+     * @return Reference to the clock.
+     */
+    const SamplingClock &getProximityClock() const;
+
+    /**
+     * @brief Gets the state journal, for the rebuilt state and restore statistics.
+     * @return Reference to the journal; its state is owned by JOURNAL_CORE.
+     */
+    const FaucetJournal &getJournal() const;
+
+    /**
+     * @brief Gets the current status from the read model. Safe from any task, O(1).
+     * @return A consistent copy of the latest version.
+     */
+    FaucetStatus getStatus() const;
+
+    /**
+     * @brief Checks whether every latency SLO currently meets its budget.
+     * @return True if all budgets are met.
+     */
+    bool meetsLatencyBudgets() const;
+
+    /**
+     * @brief Gets the dual-core runner, for step counts and real-time lateness.
+     * @return Reference to the runner.
+     */
+    const DualCoreRunner &getRunner() const;
 
     /**
      * @brief Checks if WiFi is connected.
      * @return True if WiFi is connected, false otherwise.
      */
     bool isWiFiConnected() const;
+
+private:
+    static void realTimeStep(void *context);
+    static void ioStep(void *context);
+    static float acquireDistance(void *context);
+    static void onDistanceReady(void *context);
+    void measureProximity();
+    void updateValve();
+    void publishStatus();
+    void updateConsole();
+    void restoreState();
+    void journalEntry(JournalKind kind, int id);
+    void persistJournal();
+    static void refreshHttp(void *context);
+    void refreshResponses();
+    static size_t renderStatus(char *body, size_t capacity, void *context);
+    static size_t renderMetrics(char *body, size_t capacity, void *context);
+    void logEvent(Event event);
 };
 
 #endif // CIA_STEEL_FAUCET_H
@@ -0,0 +1,314 @@
+/**
+ * @file FaucetJournal.cpp
+ * @brief Implements the FaucetJournal class.
+ *
+ * A snapshot is written before the log is emptied, and records carry sequences, so a reset
+ * between the two only leaves records the snapshot already covers; replay skips them.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include "FaucetJournal.h"
+#include "UltrasoundSensor.h"
+#include "RelayModule.h"
+#include "LedPatternDriver.h"
+#include <Arduino.h>
+#include <stddef.h>
+
+FaucetJournal::FaucetJournal(JournalStorage *storage, uint32_t valveOpenMillis)
+    : storage(storage), valveOpenMillis(valveOpenMillis), persistent(false),
+      state(initialState()), persisted(initialState()), batched(0), logRecords(0), clockOffset(0),
+      appended(0), lost(0), gap(false), replayed(0), restoreMicros(0), storageWrites(0), bytesWritten(0)
+{
+}
+
+FaucetState FaucetJournal::initialState()
+{
+    // The device turns the status LED on when it starts
+    FaucetState initial = {};
+    initial.ledCommand = Led::TURN_ON_COMMAND_ID;
+    return initial;
+}
+
+bool FaucetJournal::begin()
+{
+    persistent = storage != nullptr && storage->begin();
+    if (persistent)
+    {
+        unsigned long start = micros();
+        if (!restore())
+        {
+            // Torn tail: snapshot what replayed cleanly so new records follow it
+            writeSnapshot(state);
+        }
+        restoreMicros = micros() - start;
+    }
+    persisted = state;
+
+    // The log clock continues after the last record; time without power is not counted
+    clockOffset = state.timeMillis;
+    return persistent;
+}
+
+bool FaucetJournal::restore()
+{
+    SnapshotImage image;
+    if (storage->readSnapshot((uint8_t *)&image, sizeof(image)) == sizeof(image) &&
+        image.magic == MAGIC && image.checksum == checksumOf(&image.state, sizeof(image.state)))
+    {
+        state = image.state;
+    }
+
+    JournalRecord records[BATCH_RECORDS];
+    size_t offset = 0;
+    for (;;)
+    {
+        size_t got = storage->readLog(offset, (uint8_t *)records, sizeof(records));
+        size_t count = got / sizeof(JournalRecord);
+        for (size_t i = 0; i < count; i++)
+        {
+            const JournalRecord &record = records[i];
+            if (record.checksum != checksumOf(&record, offsetof(JournalRecord, checksum)) ||
+                (record.sequence > state.sequence && record.sequence != state.sequence + 1))
+            {
+                return false;
+            }
+            if (record.sequence <= state.sequence)
+            {
+                continue; // Already in the snapshot
+            }
+            apply(state, record, valveOpenMillis);
+            logRecords++;
+            replayed++;
+        }
+        if (got < sizeof(records))
+        {
+            return got == count * sizeof(JournalRecord);
+        }
+        offset += got;
+    }
+}
+
+uint32_t FaucetJournal::timeAt(unsigned long nowMillis) const
+{
+    return clockOffset + (uint32_t)nowMillis;
+}
+
+void FaucetJournal::append(JournalKind kind, int16_t id, uint32_t timeMillis)
+{
+    if (batched == BATCH_RECORDS && !flush())
+    {
+        // Storage is failing; keep the state and drop the oldest unwritten record. The log now
+        // has a gap, so the next write is a snapshot that covers it
+        batched--;
+        for (uint8_t i = 0; i < batched; i++)
+        {
+            batch[i] = batch[i + 1];
+        }
+        lost++;
+        gap = true;
+    }
+
+    JournalRecord &record = batch[batched++];
+    record.sequence = state.sequence + 1;
+    record.timeMillis = timeMillis;
+    record.id = id;
+    record.kind = kind;
+    record.reserved = 0;
+    record.checksum = checksumOf(&record, offsetof(JournalRecord, checksum));
+
+    apply(state, record, valveOpenMillis);
+    appended++;
+}
+
+bool FaucetJournal::flush()
+{
+    if (batched == 0)
+    {
+        return true;
+    }
+    if (!persistent)
+    {
+        batched = 0;
+        persisted = state;
+        return true;
+    }
+
+    if (gap)
+    {
+        // Replay stops at a gap in the sequence; the snapshot replaces the log instead
+        if (!writeSnapshot(state))
+        {
+            return false;
+        }
+        gap = false;
+        batched = 0;
+        persisted = state;
+        return true;
+    }
+
+    size_t length = batched * sizeof(JournalRecord);
+    if (!storage->append((const uint8_t *)batch, length))
+    {
+        return false;
+    }
+    storageWrites++;
+    bytesWritten += length;
+    logRecords += batched;
+    batched = 0;
+    persisted = state;
+
+    if (logRecords >= SNAPSHOT_INTERVAL)
+    {
+        writeSnapshot(state);
+    }
+    return true;
+}
+
+bool FaucetJournal::writeSnapshot(const FaucetState &snapshot)
+{
+    SnapshotImage image;
+    image.magic = MAGIC;
+    image.state = snapshot;
+    image.checksum = checksumOf(&image.state, sizeof(image.state));
+    if (!storage->writeSnapshot((const uint8_t *)&image, sizeof(image)))
+    {
+        return false;
+    }
+    storageWrites++;
+    bytesWritten += sizeof(image);
+
+    // Only after the snapshot is safe; records left behind by a reset here are skipped on replay
+    if (storage->clearLog())
+    {
+        logRecords = 0;
+    }
+    return true;
+}
+
+void FaucetJournal::expire(FaucetState &state, uint32_t timeMillis)
+{
+    if (state.valveTimed && (int32_t)(timeMillis - state.valveCloseAt) >= 0)
+    {
+        state.valveOpen = 0;
+        state.valveTimed = 0;
+    }
+}
+
+void FaucetJournal::apply(FaucetState &state, const JournalRecord &record, uint32_t valveOpenMillis)
+{
+    expire(state, record.timeMillis);
+    state.sequence = record.sequence;
+    state.timeMillis = record.timeMillis;
+
+    if (record.kind == JournalKind::EVENT)
+    {
+        if (record.id == UltrasoundSensor::PROXIMITY_DETECTED_EVENT_ID)
+        {
+            state.inRange = 1;
+            state.activations++;
+            state.ledCommand = Led::TURN_ON_COMMAND_ID;
+            state.valveOpen = 1;
+            state.valveTimed = 1;
+            state.valveCloseAt = record.timeMillis + valveOpenMillis;
+        }
+        else if (record.id == UltrasoundSensor::PROXIMITY_LOST_EVENT_ID)
+        {
+            state.inRange = 0;
+        }
+        return;
+    }
+
+    state.commands++;
+    switch (record.id)
+    {
+    case RelayModule::OPEN_VALVE_COMMAND_ID:
+        state.valveOpen = 1;
+        state.valveTimed = 0;
+        break;
+    case RelayModule::CLOSE_VALVE_COMMAND_ID:
+        state.valveOpen = 0;
+        state.valveTimed = 0;
+        break;
+    case RelayModule::OPEN_VALVE_TIMED_COMMAND_ID:
+        state.valveOpen = 1;
+        state.valveTimed = 1;
+        state.valveCloseAt = record.timeMillis + valveOpenMillis;
+        break;
+    case Led::TOGGLE_LED_COMMAND_ID:
+        state.ledCommand = state.ledCommand == Led::TURN_OFF_COMMAND_ID ? Led::TURN_ON_COMMAND_ID
+                                                                        : Led::TURN_OFF_COMMAND_ID;
+        break;
+    case Led::TURN_ON_COMMAND_ID:
+    case Led::TURN_OFF_COMMAND_ID:
+    case LedPatternDriver::BLINK_COMMAND_ID:
+    case LedPatternDriver::FAST_BLINK_COMMAND_ID:
+    case LedPatternDriver::STROBE_COMMAND_ID:
+    case LedPatternDriver::BREATHE_COMMAND_ID:
+        state.ledCommand = record.id;
+        break;
+    default:
+        break;
+    }
+}
+
+uint32_t FaucetJournal::checksumOf(const void *data, size_t length)
+{
+    // FNV-1a
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+const FaucetState &FaucetJournal::getState() const
+{
+    return state;
+}
+
+const FaucetState &FaucetJournal::getPersistedState() const
+{
+    return persisted;
+}
+
+bool FaucetJournal::isPersistent() const
+{
+    return persistent;
+}
+
+uint32_t FaucetJournal::getAppended() const
+{
+    return appended;
+}
+
+uint32_t FaucetJournal::getLost() const
+{
+    return lost;
+}
+
+uint32_t FaucetJournal::getReplayed() const
+{
+    return replayed;
+}
+
+uint32_t FaucetJournal::getRestoreMicros() const
+{
+    return restoreMicros;
+}
+
+uint32_t FaucetJournal::getStorageWrites() const
+{
+    return storageWrites;
+}
+
+float FaucetJournal::getWriteAmplification() const
+{
+    uint32_t recordBytes = (appended - batched) * sizeof(JournalRecord);
+    return recordBytes == 0 ? 0.0f : (float)bytesWritten / recordBytes;
+}
@@ -0,0 +1,189 @@
+#ifndef FAUCET_JOURNAL_H
+#define FAUCET_JOURNAL_H
+
+/**
+ * @file FaucetJournal.h
+ * @brief Declares the FaucetJournal class, the FaucetState and JournalRecord structures.
+ *
+ * Event-sourced persistence of the faucet. Every event and command the device acts on is
+ * appended to a journal on flash; FaucetState is what those records add up to, computed by
+ * apply() without touching any hardware. Every SNAPSHOT_INTERVAL records the state is written
+ * as a snapshot and the log is emptied, so a boot restores the snapshot and replays a short tail
+ * instead of the whole history.
+ *
+ * Times are on a log clock that continues after the last journaled record, because millis()
+ * restarts on every boot.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "JournalStorage.h"
+
+/**
+ * @brief What a journal record carries.
+ */
+enum class JournalKind : uint8_t
+{
+    EVENT = 1,
+    COMMAND = 2
+};
+
+/**
+ * @brief One journaled event or command, as stored on flash.
+ */
+struct JournalRecord
+{
+    uint32_t sequence;   ///< 1 for the first record ever, then one more per record.
+    uint32_t timeMillis; ///< Log clock when the device acted on it.
+    int16_t id;          ///< Event or command ID.
+    JournalKind kind;
+    uint8_t reserved;
+    uint32_t checksum; ///< Over the fields above; a torn append fails it.
+};
+
+/**
+ * @brief Faucet state rebuilt from the journal.
+ */
+struct FaucetState
+{
+    uint32_t sequence;          ///< Last record applied, 0 before any.
+    uint32_t timeMillis;        ///< Log clock of that record.
+    uint32_t valveCloseAt;      ///< Log clock at which a timed valve closes.
+    uint32_t activations;       ///< Proximity detections so far.
+    uint32_t commands;          ///< Commands applied so far.
+    int16_t ledCommand;         ///< Last LED command that set a state or pattern (toggles resolved).
+    uint8_t valveOpen;          ///< 1 while the valve is open.
+    uint8_t valveTimed;         ///< 1 while the valve timer runs.
+    uint8_t inRange;            ///< 1 while a hand is within the threshold.
+    uint8_t reserved[3];
+};
+
+class FaucetJournal
+{
+public:
+    static const uint16_t SNAPSHOT_INTERVAL = 64; ///< Records in the log before a snapshot replaces them.
+    static const uint8_t BATCH_RECORDS = 16;      ///< Records buffered before flush() is forced.
+
+private:
+    struct SnapshotImage
+    {
+        uint32_t magic;
+        FaucetState state;
+        uint32_t checksum;
+    };
+
+    static const uint32_t MAGIC = 0x464A5331; ///< "FJS1"
+
+    JournalStorage *storage;
+    uint32_t valveOpenMillis;
+    bool persistent;
+
+    FaucetState state;     ///< Every record appended so far, flushed or not.
+    FaucetState persisted; ///< Every record on flash.
+    JournalRecord batch[BATCH_RECORDS];
+    uint8_t batched;
+    uint32_t logRecords; ///< Records in the log since the last snapshot.
+    uint32_t clockOffset;
+
+    uint32_t appended;
+    uint32_t lost; ///< Records dropped from a full batch while storage failed.
+    bool gap;      ///< Records were lost; the next write must be a snapshot.
+    uint32_t replayed;
+    uint32_t restoreMicros;
+    uint32_t storageWrites;
+    uint32_t bytesWritten;
+
+    bool restore();
+    bool writeSnapshot(const FaucetState &snapshot);
+    static uint32_t checksumOf(const void *data, size_t length);
+
+public:
+    /**
+     * @brief Constructs a journal.
+     * @param storage Backend, or nullptr to keep state in RAM only.
+     * @param valveOpenMillis How long a detection or OPEN_VALVE_TIMED command opens the valve.
+     */
+    FaucetJournal(JournalStorage *storage, uint32_t valveOpenMillis);
+
+    /**
+     * @brief Mounts the storage and restores the state: snapshot, then the log tail after it.
+     *
+     * A torn or corrupt tail ends the replay and is replaced by a fresh snapshot, so later
+     * appends are not stranded behind it.
+     * @return False when the journal is RAM only.
+     */
+    bool begin();
+
+    /**
+     * @brief Converts millis() to the log clock.
+     */
+    uint32_t timeAt(unsigned long nowMillis) const;
+
+    /**
+     * @brief Applies a record to the state and buffers it for flash.
+     *
+     * When the batch is full and cannot be flushed, the oldest buffered record is dropped from
+     * the batch (still counted in the state) and the next successful flush writes a snapshot
+     * instead of the log, so replay never meets the gap.
+     * @param kind Event or command.
+     * @param id Its ID.
+     * @param timeMillis Log clock when the device acted on it.
+     */
+    void append(JournalKind kind, int16_t id, uint32_t timeMillis);
+
+    /**
+     * @brief Writes the buffered records in one append, then a snapshot when one is due; after
+     * records were lost, writes a snapshot of the state instead.
+     * @return False when the storage rejected a write (records stay buffered).
+     */
+    bool flush();
+
+    /**
+     * @brief Gets the state as of the last appended record.
+     */
+    const FaucetState &getState() const;
+
+    /**
+     * @brief Gets the state as of the last record on flash; what a reset would restore.
+     */
+    const FaucetState &getPersistedState() const;
+
+    bool isPersistent() const;
+    uint32_t getAppended() const;
+    uint32_t getLost() const;
+    uint32_t getReplayed() const;
+    uint32_t getRestoreMicros() const;
+    uint32_t getStorageWrites() const;
+
+    /**
+     * @brief Gets bytes written to storage (log and snapshots) per byte of journal record.
+     */
+    float getWriteAmplification() const;
+
+    /**
+     * @brief Gets the state of a faucet that has seen no records.
+     */
+    static FaucetState initialState();
+
+    /**
+     * @brief Adds one record to a state. Pure, so replay and live operation agree.
+     * @param state State to update.
+     * @param record Record to add.
+     * @param valveOpenMillis How long a detection or OPEN_VALVE_TIMED command opens the valve.
+     */
+    static void apply(FaucetState &state, const JournalRecord &record, uint32_t valveOpenMillis);
+
+    /**
+     * @brief Closes a timed valve whose time is up.
+     * @param state State to update.
+     * @param timeMillis Log clock now.
+     */
+    static void expire(FaucetState &state, uint32_t timeMillis);
+};
+
+#endif // FAUCET_JOURNAL_H
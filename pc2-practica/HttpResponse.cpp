@@ -0,0 +1,110 @@
+/**
+ * @file HttpResponse.cpp
+ * @brief Implements the HttpResponse class.
+ *
+ * The body is rendered first, at HEADER_BYTES; the headers, which need its length, are then
+ * written so that they end right where the body starts, and the response is sent from there.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include "HttpResponse.h"
+#include <stdio.h>
+#include <string.h>
+
+HttpResponse::HttpResponse(const char *status, const char *contentType, size_t bodyBytes)
+    : status(status), contentType(contentType), bodyBytes(bodyBytes), current(0), renders(0), refused(0)
+{
+    for (Slot &slot : slots)
+    {
+        slot.buffer = new char[HEADER_BYTES + bodyBytes];
+        slot.offset = HEADER_BYTES;
+        slot.length = 0;
+        slot.readers = 0;
+    }
+    render("");
+}
+
+HttpResponse::~HttpResponse()
+{
+    for (Slot &slot : slots)
+    {
+        delete[] slot.buffer;
+    }
+}
+
+bool HttpResponse::render(BodyRenderer renderer, void *context)
+{
+    uint8_t next = current ^ 1;
+    Slot &slot = slots[next];
+    if (slot.readers > 0)
+    {
+        refused++;
+        return false;
+    }
+
+    // snprintf-style renderers also write a terminator, hence the byte kept back
+    size_t body = renderer(slot.buffer + HEADER_BYTES, bodyBytes, context);
+    if (body >= bodyBytes)
+    {
+        refused++;
+        return false;
+    }
+
+    char header[HEADER_BYTES];
+    int headerLength = snprintf(header, sizeof(header),
+                                "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nCache-Control: no-cache\r\n\r\n",
+                                status, contentType, (unsigned)body);
+    if (headerLength <= 0 || (size_t)headerLength >= sizeof(header))
+    {
+        refused++;
+        return false;
+    }
+    slot.offset = HEADER_BYTES - headerLength;
+    memcpy(slot.buffer + slot.offset, header, headerLength);
+    slot.length = headerLength + body;
+
+    current = next;
+    renders++;
+    return true;
+}
+
+static size_t renderText(char *body, size_t capacity, void *context)
+{
+    return snprintf(body, capacity, "%s", static_cast<const char *>(context));
+}
+
+bool HttpResponse::render(const char *text)
+{
+    return render(renderText, const_cast<char *>(text));
+}
+
+uint8_t HttpResponse::acquire(const char *&data, size_t &length)
+{
+    Slot &slot = slots[current];
+    slot.readers++;
+    data = slot.buffer + slot.offset;
+    length = slot.length;
+    return current;
+}
+
+void HttpResponse::release(uint8_t slot)
+{
+    if (slots[slot].readers > 0)
+    {
+        slots[slot].readers--;
+    }
+}
+
+uint32_t HttpResponse::getRenders() const
+{
+    return renders;
+}
+
+uint32_t HttpResponse::getRefused() const
+{
+    return refused;
+}
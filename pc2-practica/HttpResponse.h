@@ -0,0 +1,101 @@
+#ifndef HTTP_RESPONSE_H
+#define HTTP_RESPONSE_H
+
+/**
+ * @file HttpResponse.h
+ * @brief Declares the HttpResponse class and the BodyRenderer callback.
+ *
+ * A complete HTTP response, status line to body, kept ready to send in a buffer allocated once.
+ * The owner renders it when the data behind it changes; the StatusServer then sends the same
+ * bytes to every client that asks, with no formatting or allocation per request.
+ *
+ * There are two buffers: a render goes into the one no client is reading and then becomes
+ * current, so a slow client finishes the version it started. A render while both are in use is
+ * refused and can simply be retried.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Writes a response body.
+ * @param body Where to write.
+ * @param capacity Bytes available at body.
+ * @param context Passed through from render().
+ * @return Bytes the body needs, as snprintf; more than capacity means it did not fit.
+ */
+typedef size_t (*BodyRenderer)(char *body, size_t capacity, void *context);
+
+class HttpResponse
+{
+public:
+    static const size_t HEADER_BYTES = 128; ///< Room reserved for the status line and headers.
+
+private:
+    struct Slot
+    {
+        char *buffer;    ///< HEADER_BYTES, then the body.
+        size_t offset;   ///< Start of the response; headers end at HEADER_BYTES.
+        size_t length;   ///< Header and body bytes.
+        uint8_t readers; ///< Connections sending from this slot.
+    };
+
+    const char *status;
+    const char *contentType;
+    size_t bodyBytes;
+    Slot slots[2];
+    uint8_t current;
+    uint32_t renders;
+    uint32_t refused;
+
+public:
+    /**
+     * @brief Allocates both buffers; nothing is allocated afterwards.
+     * @param status Status line after "HTTP/1.1 ", e.g. "200 OK".
+     * @param contentType Content-Type header value.
+     * @param bodyBytes Largest body.
+     */
+    HttpResponse(const char *status, const char *contentType, size_t bodyBytes);
+    ~HttpResponse();
+
+    HttpResponse(const HttpResponse &) = delete;
+    HttpResponse &operator=(const HttpResponse &) = delete;
+
+    /**
+     * @brief Renders a new version of the response.
+     * @param renderer Writes the body.
+     * @param context Passed to renderer.
+     * @return False when the body did not fit or both buffers are being sent (nothing changes).
+     */
+    bool render(BodyRenderer renderer, void *context);
+
+    /**
+     * @brief Renders a fixed body.
+     * @param text Body text.
+     * @return As render().
+     */
+    bool render(const char *text);
+
+    /**
+     * @brief Pins the current version for one send. Server side.
+     * @param data Receives the first byte of the response.
+     * @param length Receives its length.
+     * @return Slot to pass to release().
+     */
+    uint8_t acquire(const char *&data, size_t &length);
+
+    /**
+     * @brief Unpins a version once its send finished or was abandoned. Server side.
+     */
+    void release(uint8_t slot);
+
+    uint32_t getRenders() const;
+    uint32_t getRefused() const;
+};
+
+#endif // HTTP_RESPONSE_H
@@ -0,0 +1,98 @@
+/**
+ * @file JournalStorage.cpp
+ * @brief Implements the LittleFS journal storage.
+ *
+ * LittleFS commits a file when it is closed, so an append interrupted by a reset loses at most
+ * that append, and the snapshot rename is atomic.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include "JournalStorage.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <LittleFS.h>
+
+LittleFsJournalStorage::LittleFsJournalStorage(const char *directory)
+    : directory(directory)
+{
+    snprintf(logPath, sizeof(logPath), "%s/log", directory);
+    snprintf(snapshotPath, sizeof(snapshotPath), "%s/snapshot", directory);
+    snprintf(pendingPath, sizeof(pendingPath), "%s/snapshot.new", directory);
+}
+
+bool LittleFsJournalStorage::begin()
+{
+    // Formats an empty or corrupt partition on first use
+    if (!LittleFS.begin(true))
+    {
+        return false;
+    }
+    return LittleFS.exists(directory) || LittleFS.mkdir(directory);
+}
+
+bool LittleFsJournalStorage::append(const uint8_t *data, size_t length)
+{
+    File file = LittleFS.open(logPath, "a");
+    if (!file)
+    {
+        return false;
+    }
+    size_t written = file.write(data, length);
+    file.close();
+    return written == length;
+}
+
+size_t LittleFsJournalStorage::readLog(size_t offset, uint8_t *dst, size_t length)
+{
+    if (!LittleFS.exists(logPath))
+    {
+        return 0;
+    }
+    File file = LittleFS.open(logPath, "r");
+    if (!file || !file.seek(offset))
+    {
+        return 0;
+    }
+    size_t got = file.read(dst, length);
+    file.close();
+    return got;
+}
+
+bool LittleFsJournalStorage::clearLog()
+{
+    return !LittleFS.exists(logPath) || LittleFS.remove(logPath);
+}
+
+bool LittleFsJournalStorage::writeSnapshot(const uint8_t *data, size_t length)
+{
+    File file = LittleFS.open(pendingPath, "w");
+    if (!file)
+    {
+        return false;
+    }
+    size_t written = file.write(data, length);
+    file.close();
+    return written == length && LittleFS.rename(pendingPath, snapshotPath);
+}
+
+size_t LittleFsJournalStorage::readSnapshot(uint8_t *dst, size_t length)
+{
+    if (!LittleFS.exists(snapshotPath))
+    {
+        return 0;
+    }
+    File file = LittleFS.open(snapshotPath, "r");
+    if (!file)
+    {
+        return 0;
+    }
+    size_t got = file.read(dst, length);
+    file.close();
+    return got;
+}
+
+#endif
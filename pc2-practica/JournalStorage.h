@@ -0,0 +1,90 @@
+#ifndef JOURNAL_STORAGE_H
+#define JOURNAL_STORAGE_H
+
+/**
+ * @file JournalStorage.h
+ * @brief Declares the JournalStorage interface and its LittleFS implementation.
+ *
+ * Persistent home of the FaucetJournal: an append-only log of records and one snapshot that is
+ * always replaced whole. Keeping the backend behind an interface lets the journal run on a host
+ * flash stand-in for restore and wear measurements.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+class JournalStorage
+{
+public:
+    /**
+     * @brief Mounts the backend.
+     * @return False when nothing can be persisted.
+     */
+    virtual bool begin() = 0;
+
+    /**
+     * @brief Appends bytes to the end of the log.
+     * @return True when all of them were written.
+     */
+    virtual bool append(const uint8_t *data, size_t length) = 0;
+
+    /**
+     * @brief Reads part of the log.
+     * @return Bytes read; fewer than asked at the end of the log.
+     */
+    virtual size_t readLog(size_t offset, uint8_t *dst, size_t length) = 0;
+
+    /**
+     * @brief Empties the log, once a snapshot covers it.
+     */
+    virtual bool clearLog() = 0;
+
+    /**
+     * @brief Replaces the snapshot. A reset during the write must leave the previous one intact.
+     */
+    virtual bool writeSnapshot(const uint8_t *data, size_t length) = 0;
+
+    /**
+     * @brief Reads the snapshot.
+     * @return Bytes read, 0 when there is none.
+     */
+    virtual size_t readSnapshot(uint8_t *dst, size_t length) = 0;
+
+    virtual ~JournalStorage() = default;
+};
+
+#if defined(ARDUINO_ARCH_ESP32)
+/**
+ * @brief Journal files in a LittleFS directory: "log", and "snapshot" written through a
+ * temporary file and renamed over the old one.
+ */
+class LittleFsJournalStorage : public JournalStorage
+{
+private:
+    const char *directory;
+    char logPath[32];
+    char snapshotPath[32];
+    char pendingPath[32];
+
+public:
+    /**
+     * @brief Constructs the storage.
+     * @param directory Directory of the journal files, e.g. "/journal".
+     */
+    LittleFsJournalStorage(const char *directory);
+
+    bool begin() override;
+    bool append(const uint8_t *data, size_t length) override;
+    size_t readLog(size_t offset, uint8_t *dst, size_t length) override;
+    bool clearLog() override;
+    bool writeSnapshot(const uint8_t *data, size_t length) override;
+    size_t readSnapshot(uint8_t *dst, size_t length) override;
+};
+#endif
+
+#endif // JOURNAL_STORAGE_H
@@ -50,10 +50,15 @@ void RelayModule::handle(Command command)
 }
 
 void RelayModule::openValveTimed(unsigned long durationMs)
+{
+    openValveTimed(durationMs, millis());
+}
+
+void RelayModule::openValveTimed(unsigned long durationMs, unsigned long nowMs)
 {
     state = true;
     digitalWrite(pin, HIGH);
-    timerStartTime = millis();
+    timerStartTime = nowMs;
     timerDuration = durationMs;
     timerActive = true;
 }
@@ -74,7 +79,12 @@ void RelayModule::closeValve()
 
 void RelayModule::updateTimer()
 {
-    if (timerActive && (millis() - timerStartTime >= timerDuration))
+    updateTimer(millis());
+}
+
+void RelayModule::updateTimer(unsigned long nowMs)
+{
+    if (timerActive && (nowMs - timerStartTime >= timerDuration))
     {
         closeValve(); // Timer expired, close valve
     }
@@ -57,6 +57,13 @@ public:
      */
     void openValveTimed(unsigned long durationMs);
 
+    /**
+     * @brief Opens the water valve for a specified duration, starting at a given time.
+     * @param durationMs Duration to keep valve open in milliseconds.
+     * @param nowMs Current time in milliseconds on the caller's clock.
+     */
+    void openValveTimed(unsigned long durationMs, unsigned long nowMs);
+
     /**
      * @brief Opens the water valve indefinitely.
      */
@@ -72,6 +79,13 @@ public:
      */
     void updateTimer();
 
+    /**
+     * @brief Updates the timed operation status against a supplied clock.
+     * Lets a test or simulation drive the timer from a virtual clock instead of millis().
+     * @param nowMs Current time in milliseconds on the same clock as openValveTimed().
+     */
+    void updateTimer(unsigned long nowMs);
+
     /**
      * @brief Gets the current state of the relay.
      * @return True if valve is OPEN, false if CLOSED.
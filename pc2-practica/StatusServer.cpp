@@ -0,0 +1,483 @@
+/**
+ * @file StatusServer.cpp
+ * @brief Implements the StatusServer class.
+ *
+ * One select() covers the listener and every connection. A connection either reads a request
+ * or sends a response, never both, so a client that pipelines requests is answered in order and
+ * one that stops reading only holds its own slot.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include "StatusServer.h"
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <lwip/sockets.h>
+#include <esp_timer.h>
+#else
+#include <chrono>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // lwIP raises no SIGPIPE
+#endif
+
+StatusServer::StatusServer(uint16_t port)
+    : port(port), listener(-1), routeCount(0),
+      notFound("404 Not Found", "text/plain", 32), badRequest("400 Bad Request", "text/plain", 32),
+      accepted(0), served(0), timedOut(0), failed(0),
+      refresh(nullptr), refreshContext(nullptr), running(false)
+#if defined(ARDUINO_ARCH_ESP32)
+      ,
+      task(nullptr)
+#endif
+{
+    for (Connection &connection : connections)
+    {
+        connection.socket = -1;
+        connection.response = nullptr;
+        connection.received = 0;
+    }
+    notFound.render("not found\n");
+    badRequest.render("bad request\n");
+}
+
+StatusServer::~StatusServer()
+{
+    stop();
+    for (Connection &connection : connections)
+    {
+        if (connection.socket >= 0)
+        {
+            closeConnection(connection);
+        }
+    }
+    if (listener >= 0)
+    {
+        close(listener);
+    }
+}
+
+bool StatusServer::addRoute(const char *path, HttpResponse *response)
+{
+    if (routeCount == MAX_ROUTES)
+    {
+        return false;
+    }
+    routes[routeCount].path = path;
+    routes[routeCount].response = response;
+    routeCount++;
+    return true;
+}
+
+bool StatusServer::begin()
+{
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        return false;
+    }
+    int yes = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    socklen_t addressLength = sizeof(address);
+    if (bind(listener, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(listener, MAX_CONNECTIONS) < 0 ||
+        getsockname(listener, (struct sockaddr *)&address, &addressLength) < 0)
+    {
+        close(listener);
+        listener = -1;
+        return false;
+    }
+    port = ntohs(address.sin_port);
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL, 0) | O_NONBLOCK);
+    return true;
+}
+
+bool StatusServer::start(ServerRefresh refresh, void *context)
+{
+    if (listener < 0 || running.load())
+    {
+        return false;
+    }
+    this->refresh = refresh;
+    refreshContext = context;
+    running.store(true);
+#if defined(ARDUINO_ARCH_ESP32)
+    BaseType_t core = portNUM_PROCESSORS > 1 ? TASK_CORE : tskNO_AFFINITY;
+    if (xTaskCreatePinnedToCore(taskEntry, "http", STACK_BYTES, this, TASK_PRIORITY, &task, core) != pdPASS)
+    {
+        task = nullptr;
+        running.store(false);
+        return false;
+    }
+#else
+    thread = std::thread(&StatusServer::runLoop, this);
+#endif
+    return true;
+}
+
+void StatusServer::stop()
+{
+    running.store(false);
+#if !defined(ARDUINO_ARCH_ESP32)
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+#endif
+}
+
+bool StatusServer::isRunning() const
+{
+    return running.load();
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+void StatusServer::taskEntry(void *parameter)
+{
+    static_cast<StatusServer *>(parameter)->runLoop();
+    vTaskDelete(nullptr);
+}
+#endif
+
+void StatusServer::runLoop()
+{
+    while (running.load())
+    {
+        if (refresh != nullptr)
+        {
+            refresh(refreshContext);
+        }
+        service(nowMillis(), WAIT_MS);
+    }
+}
+
+void StatusServer::service(uint32_t nowMillis, uint32_t waitMillis)
+{
+    fd_set readable;
+    fd_set writable;
+    FD_ZERO(&readable);
+    FD_ZERO(&writable);
+    int highest = -1;
+
+    // A full pool leaves new clients in the listen backlog
+    if (listener >= 0 && getOpenConnections() < MAX_CONNECTIONS)
+    {
+        FD_SET(listener, &readable);
+        highest = listener;
+    }
+    for (Connection &connection : connections)
+    {
+        if (connection.socket < 0)
+        {
+            continue;
+        }
+        FD_SET(connection.socket, connection.response != nullptr ? &writable : &readable);
+        if (connection.socket > highest)
+        {
+            highest = connection.socket;
+        }
+    }
+    if (highest < 0)
+    {
+        return;
+    }
+
+    struct timeval timeout;
+    timeout.tv_sec = waitMillis / 1000;
+    timeout.tv_usec = (waitMillis % 1000) * 1000;
+    if (select(highest + 1, &readable, &writable, nullptr, &timeout) < 0)
+    {
+        return;
+    }
+
+    if (listener >= 0 && FD_ISSET(listener, &readable))
+    {
+        acceptPending(nowMillis);
+    }
+    for (Connection &connection : connections)
+    {
+        if (connection.socket < 0)
+        {
+            continue;
+        }
+        bool ready = FD_ISSET(connection.socket, &readable) || FD_ISSET(connection.socket, &writable);
+        if (ready)
+        {
+            bool open = connection.response != nullptr ? sendPending(connection) : receive(connection);
+            if (!open)
+            {
+                continue;
+            }
+            connection.lastActivity = nowMillis;
+        }
+        serviceConnection(connection, nowMillis);
+    }
+}
+
+void StatusServer::acceptPending(uint32_t nowMillis)
+{
+    for (Connection &connection : connections)
+    {
+        if (connection.socket >= 0)
+        {
+            continue;
+        }
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0)
+        {
+            return;
+        }
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL, 0) | O_NONBLOCK);
+        int yes = 1;
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+        connection.socket = client;
+        connection.response = nullptr;
+        connection.received = 0;
+        connection.requests = 0;
+        connection.lastActivity = nowMillis;
+        accepted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StatusServer::serviceConnection(Connection &connection, uint32_t nowMillis)
+{
+    // Answer every complete request in the buffer, in order, until a send would block
+    while (connection.response == nullptr && startResponse(connection))
+    {
+        if (!sendPending(connection))
+        {
+            return;
+        }
+    }
+    if (connection.response == nullptr && nowMillis - connection.lastActivity >= IDLE_TIMEOUT_MS)
+    {
+        timedOut.fetch_add(1, std::memory_order_relaxed);
+        closeConnection(connection);
+    }
+}
+
+bool StatusServer::receive(Connection &connection)
+{
+    if (connection.received == REQUEST_BYTES)
+    {
+        return true; // startResponse() refuses the oversized request
+    }
+    ssize_t got = recv(connection.socket, connection.request + connection.received,
+                       REQUEST_BYTES - connection.received, 0);
+    if (got > 0)
+    {
+        connection.received += got;
+        return true;
+    }
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        return true;
+    }
+    closeConnection(connection); // Closed by the client, or reset
+    return false;
+}
+
+bool StatusServer::startResponse(Connection &connection)
+{
+    size_t length = 0;
+    for (size_t i = 3; i < connection.received; i++)
+    {
+        if (memcmp(connection.request + i - 3, "\r\n\r\n", 4) == 0)
+        {
+            length = i + 1;
+            break;
+        }
+    }
+
+    HttpResponse *response;
+    bool keepAlive;
+    if (length > 0)
+    {
+        char next = connection.request[length];
+        connection.request[length] = '\0';
+        response = route(connection.request, length, keepAlive);
+        connection.request[length] = next;
+        memmove(connection.request, connection.request + length, connection.received - length);
+        connection.received -= length;
+    }
+    else if (connection.received == REQUEST_BYTES)
+    {
+        response = &badRequest;
+        keepAlive = false;
+        connection.received = 0;
+    }
+    else
+    {
+        return false;
+    }
+
+    connection.response = response;
+    connection.keepAlive = keepAlive;
+    connection.slot = response->acquire(connection.data, connection.length);
+    connection.sent = 0;
+    return true;
+}
+
+HttpResponse *StatusServer::route(const char *request, size_t length, bool &keepAlive)
+{
+    // request is terminated after its blank line
+    keepAlive = false;
+    if (length < 14 || strncmp(request, "GET /", 5) != 0)
+    {
+        return &badRequest;
+    }
+
+    const char *path = request + 4;
+    const char *pathEnd = path;
+    while (*pathEnd != ' ' && *pathEnd != '?' && *pathEnd != '\r' && *pathEnd != '\0')
+    {
+        pathEnd++;
+    }
+    const char *version = strchr(pathEnd, ' ');
+    if (version == nullptr)
+    {
+        return &badRequest;
+    }
+
+    // HTTP/1.1 keeps the connection unless the client asks to close it
+    keepAlive = strncmp(version, " HTTP/1.1\r\n", 11) == 0;
+    for (const char *line = strstr(version, "\r\n"); line != nullptr; line = strstr(line + 2, "\r\n"))
+    {
+        if (strncasecmp(line + 2, "connection:", 11) == 0)
+        {
+            const char *value = line + 13;
+            while (*value == ' ')
+            {
+                value++;
+            }
+            keepAlive = strncasecmp(value, "close", 5) != 0 && (keepAlive || strncasecmp(value, "keep-alive", 10) == 0);
+        }
+    }
+    // HTTP/1.0 keep-alive needs a response header the prebuilt responses do not carry
+    if (strncmp(version, " HTTP/1.0", 9) == 0)
+    {
+        keepAlive = false;
+    }
+
+    size_t pathLength = pathEnd - path;
+    for (uint8_t i = 0; i < routeCount; i++)
+    {
+        if (strlen(routes[i].path) == pathLength && strncmp(routes[i].path, path, pathLength) == 0)
+        {
+            return routes[i].response;
+        }
+    }
+    return &notFound;
+}
+
+bool StatusServer::sendPending(Connection &connection)
+{
+    while (connection.sent < connection.length)
+    {
+        ssize_t written = send(connection.socket, connection.data + connection.sent,
+                               connection.length - connection.sent, MSG_NOSIGNAL);
+        if (written > 0)
+        {
+            connection.sent += written;
+            continue;
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return true; // select() reports when there is room again
+        }
+        failed.fetch_add(1, std::memory_order_relaxed);
+        closeConnection(connection);
+        return false;
+    }
+
+    connection.response->release(connection.slot);
+    connection.response = nullptr;
+    served.fetch_add(1, std::memory_order_relaxed);
+    if (!connection.keepAlive || ++connection.requests == MAX_REQUESTS)
+    {
+        closeConnection(connection);
+        return false;
+    }
+    return true;
+}
+
+void StatusServer::closeConnection(Connection &connection)
+{
+    if (connection.response != nullptr)
+    {
+        connection.response->release(connection.slot);
+        connection.response = nullptr;
+    }
+    close(connection.socket);
+    connection.socket = -1;
+    connection.received = 0;
+}
+
+uint32_t StatusServer::nowMillis()
+{
+#if defined(ARDUINO_ARCH_ESP32)
+    return (uint32_t)(esp_timer_get_time() / 1000);
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+}
+
+uint16_t StatusServer::getPort() const
+{
+    return port;
+}
+
+uint8_t StatusServer::getOpenConnections() const
+{
+    uint8_t open = 0;
+    for (const Connection &connection : connections)
+    {
+        if (connection.socket >= 0)
+        {
+            open++;
+        }
+    }
+    return open;
+}
+
+uint32_t StatusServer::getAccepted() const
+{
+    return accepted.load(std::memory_order_relaxed);
+}
+
+uint32_t StatusServer::getServed() const
+{
+    return served.load(std::memory_order_relaxed);
+}
+
+uint32_t StatusServer::getTimedOut() const
+{
+    return timedOut.load(std::memory_order_relaxed);
+}
+
+uint32_t StatusServer::getFailed() const
+{
+    return failed.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,159 @@
+#ifndef STATUS_SERVER_H
+#define STATUS_SERVER_H
+
+/**
+ * @file StatusServer.h
+ * @brief Declares the StatusServer class.
+ *
+ * Small HTTP/1.1 server for status and metrics. It answers GET requests for a few fixed paths
+ * with HttpResponse objects the device renders ahead of time, so a request costs a parse and a
+ * send. A fixed pool of connections is kept open between requests (keep-alive); while the pool
+ * is full, new clients wait in the listen backlog until a connection closes, goes idle or has
+ * been answered MAX_REQUESTS times.
+ *
+ * Built on non-blocking BSD sockets, which lwIP provides on the ESP32, so the same server runs
+ * on Linux and can be measured over loopback.
+ */
+
+/*
+ * This file is part of the Moen Cia Steel Faucet project.
+ * Developed using the Modest IoT Nano-framework (C++ Edition).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "HttpResponse.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+/**
+ * @brief Called by the server task before each pass, to render responses whose data changed.
+ */
+typedef void (*ServerRefresh)(void *context);
+
+class StatusServer
+{
+public:
+    static const uint8_t MAX_CONNECTIONS = 4;
+    static const uint8_t MAX_ROUTES = 4;
+    static const size_t REQUEST_BYTES = 512;      ///< Request line and headers; larger requests are refused.
+    static const uint32_t IDLE_TIMEOUT_MS = 5000; ///< Keep-alive connections idle this long are closed.
+    static const uint16_t MAX_REQUESTS = 100;     ///< Answers per connection before it is closed, so waiting clients get a turn.
+    static const uint32_t WAIT_MS = 20;           ///< Longest wait for socket activity in the server task.
+    static const uint32_t STACK_BYTES = 4096;
+    static const int TASK_PRIORITY = 1; ///< Same as the I/O task.
+    static const int TASK_CORE = 0;     ///< PRO CPU, next to the WiFi stack.
+
+private:
+    struct Route
+    {
+        const char *path;
+        HttpResponse *response;
+    };
+
+    struct Connection
+    {
+        int socket; ///< -1 when the slot is free.
+        HttpResponse *response; ///< Being sent, or nullptr.
+        uint8_t slot;
+        const char *data;
+        size_t length;
+        size_t sent;
+        bool keepAlive;
+        uint16_t requests; ///< Answered on this connection.
+        uint32_t lastActivity;
+        size_t received;
+        char request[REQUEST_BYTES + 1]; ///< One spare byte to terminate the request while it is parsed.
+    };
+
+    uint16_t port;
+    int listener;
+    Route routes[MAX_ROUTES];
+    uint8_t routeCount;
+    Connection connections[MAX_CONNECTIONS];
+    HttpResponse notFound;
+    HttpResponse badRequest;
+
+    std::atomic<uint32_t> accepted;
+    std::atomic<uint32_t> served;
+    std::atomic<uint32_t> timedOut;
+    std::atomic<uint32_t> failed;
+
+    ServerRefresh refresh;
+    void *refreshContext;
+    std::atomic<bool> running;
+#if defined(ARDUINO_ARCH_ESP32)
+    TaskHandle_t task;
+    static void taskEntry(void *parameter);
+#else
+    std::thread thread;
+#endif
+    void runLoop();
+
+    void acceptPending(uint32_t nowMillis);
+    void serviceConnection(Connection &connection, uint32_t nowMillis);
+    bool receive(Connection &connection);
+    bool startResponse(Connection &connection);
+    bool sendPending(Connection &connection);
+    void closeConnection(Connection &connection);
+    HttpResponse *route(const char *request, size_t length, bool &keepAlive);
+    static uint32_t nowMillis();
+
+public:
+    /**
+     * @brief Constructs a stopped server.
+     * @param port TCP port; 0 picks a free one (see getPort()).
+     */
+    StatusServer(uint16_t port);
+    ~StatusServer();
+
+    /**
+     * @brief Serves a response for a path. Call before begin().
+     * @return False when the route table is full.
+     */
+    bool addRoute(const char *path, HttpResponse *response);
+
+    /**
+     * @brief Opens the listening socket.
+     * @return False when the socket cannot be opened or bound.
+     */
+    bool begin();
+
+    /**
+     * @brief Runs refresh and service() on a task of its own, so requests do not wait for a
+     * periodic loop. Responses are then rendered on that task only.
+     * @param refresh Renders changed responses; may be nullptr.
+     * @param context Passed to refresh.
+     * @return False when no task can be created; call service() from a loop instead.
+     */
+    bool start(ServerRefresh refresh, void *context);
+
+    /**
+     * @brief Stops the server task.
+     */
+    void stop();
+
+    bool isRunning() const;
+
+    /**
+     * @brief Accepts, reads and answers what is ready. Never blocks longer than waitMillis.
+     * @param nowMillis Current time in milliseconds, for idle timeouts.
+     * @param waitMillis How long to wait for activity when nothing is ready.
+     */
+    void service(uint32_t nowMillis, uint32_t waitMillis);
+
+    uint16_t getPort() const;
+    uint8_t getOpenConnections() const;
+    uint32_t getAccepted() const;
+    uint32_t getServed() const;
+    uint32_t getTimedOut() const;
+    uint32_t getFailed() const;
+};
+
+#endif // STATUS_SERVER_H
@@ -24,7 +24,8 @@ const Event UltrasoundSensor::PROXIMITY_LOST_EVENT = Event(PROXIMITY_LOST_EVENT_
 
 UltrasoundSensor::UltrasoundSensor(int trigPin, int echoPin, int thresholdCm, EventHandler *eventHandler)
     : Sensor(trigPin, eventHandler), trigPin(trigPin), echoPin(echoPin),
-      lastDistance(-1), threshold(thresholdCm)
+      lastDistance(-1), threshold(thresholdCm), inRange(false),
+      inRangeSince(0), distanceRollup("distance_cm"), activationRollup("activation_s")
 {
     pinMode(trigPin, OUTPUT);
     pinMode(echoPin, INPUT);
@@ -59,33 +60,58 @@ float UltrasoundSensor::measureDistance()
         return -1;
     }
 
-    lastDistance = distance;
+    // lastDistance is recorded by evaluateDistance(), so this may run on a sampling task
     return distance;
 }
 
 void UltrasoundSensor::checkProximity()
 {
-    static bool wasInRange = false;
+    evaluateDistance(measureDistance());
+}
 
-    float currentDistance = measureDistance();
+void UltrasoundSensor::evaluateDistance(float distanceCm)
+{
+    evaluateDistance(distanceCm, millis());
+}
 
-    if (currentDistance > 0)
+void UltrasoundSensor::evaluateDistance(float distanceCm, unsigned long nowMillis)
+{
+    uint32_t nowSeconds = rollupClock.seconds(nowMillis);
+    if (distanceCm > 0)
     { // Valid measurement
-        bool isInRange = (currentDistance <= threshold);
+        lastDistance = distanceCm;
+        distanceRollup.add(nowSeconds, distanceCm);
+        bool nowInRange = (distanceCm <= threshold);
 
-        if (isInRange && !wasInRange)
+        if (nowInRange && !inRange)
         {
             // Object entered proximity range
             on(PROXIMITY_DETECTED_EVENT);
-            wasInRange = true;
+            inRange = true;
+            inRangeSince = nowMillis;
         }
-        else if (!isInRange && wasInRange)
+        else if (!nowInRange && inRange)
         {
             // Object left proximity range
             on(PROXIMITY_LOST_EVENT);
-            wasInRange = false;
+            inRange = false;
+            activationRollup.add(nowSeconds, (nowMillis - inRangeSince) / 1000.0f);
         }
     }
+    // Quiet periods and lost echoes still close windows
+    distanceRollup.advance(nowSeconds);
+    activationRollup.advance(nowSeconds);
+}
+
+bool UltrasoundSensor::isInRange() const
+{
+    return inRange;
+}
+
+void UltrasoundSensor::restoreRange(bool inRange, unsigned long nowMillis)
+{
+    this->inRange = inRange;
+    inRangeSince = nowMillis;
 }
 
 float UltrasoundSensor::getLastDistance() const
@@ -93,6 +119,16 @@ float UltrasoundSensor::getLastDistance() const
     return lastDistance;
 }
 
+const RollupSeries &UltrasoundSensor::getDistanceRollup() const
+{
+    return distanceRollup;
+}
+
+const RollupSeries &UltrasoundSensor::getActivationRollup() const
+{
+    return activationRollup;
+}
+
 void UltrasoundSensor::setThreshold(int thresholdCm)
 {
     threshold = thresholdCm;
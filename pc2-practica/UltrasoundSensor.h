@@ -20,14 +20,21 @@
  */
 
 #include "Sensor.h"
+#include "RollupSeries.h"
 
 class UltrasoundSensor : public Sensor
 {
 private:
-    int trigPin;        ///< Trigger pin for ultrasound sensor
-    int echoPin;        ///< Echo pin for ultrasound sensor
-    float lastDistance; ///< Last measured distance in cm
-    int threshold;      ///< Proximity threshold in cm
+    int trigPin;                ///< Trigger pin for ultrasound sensor
+    int echoPin;                ///< Echo pin for ultrasound sensor
+    float lastDistance;         ///< Last measured distance in cm
+    int threshold;              ///< Proximity threshold in cm
+    bool inRange;               ///< Whether the last valid reading was within the threshold
+    unsigned long inRangeSince; ///< When the current activation started, in milliseconds
+
+    RollupClock rollupClock;       ///< Rollup seconds that survive the millis() wrap
+    RollupSeries distanceRollup;   ///< Every valid reading, in centimeters
+    RollupSeries activationRollup; ///< One sample per activation: seconds the hand stayed in range
 
 public:
     static const int PROXIMITY_DETECTED_EVENT_ID = 10; ///< Unique ID for proximity detected event
@@ -46,6 +53,7 @@ public:
 
     /**
      * @brief Measures the distance to an object in centimeters.
+     * Only drives the pins; sensor state is left to evaluateDistance().
      * @return Distance in centimeters, or -1 if measurement failed.
      */
     float measureDistance();
@@ -53,15 +61,65 @@ public:
     /**
      * @brief Checks for proximity events and triggers them if conditions are met.
      * Should be called periodically to monitor for proximity changes.
+     * Equivalent to evaluateDistance(measureDistance()).
      */
     void checkProximity();
 
+    /**
+     * @brief Evaluates a distance reading and raises proximity events on range changes.
+     *
+     * Does not touch any pin, so readings can come from the echo pin or from a test or
+     * simulation stimulus. Range state is kept per instance.
+     * @param distanceCm Distance in centimeters, or a negative value for no reading (ignored).
+     */
+    void evaluateDistance(float distanceCm);
+
+    /**
+     * @brief Same as evaluateDistance(float), at a time supplied by the caller.
+     *
+     * Sampled readings pass their slot time, so rollups use when the distance was measured.
+     * @param distanceCm Distance in centimeters, or a negative value for no reading (ignored).
+     * @param nowMillis Time of the reading in milliseconds.
+     */
+    void evaluateDistance(float distanceCm, unsigned long nowMillis);
+
+    /**
+     * @brief Checks whether an object is currently within the threshold.
+     * @return True if the last valid reading was within range.
+     */
+    bool isInRange() const;
+
+    /**
+     * @brief Restores the range state after a reset, without raising events.
+     *
+     * A hand still in range then does not open the valve a second time; one that left raises
+     * PROXIMITY_LOST on the next reading.
+     * @param inRange Whether a hand was in range.
+     * @param nowMillis Current time in milliseconds.
+     */
+    void restoreRange(bool inRange, unsigned long nowMillis);
+
     /**
      * @brief Gets the last measured distance.
      * @return Last distance measurement in centimeters.
      */
     float getLastDistance() const;
 
+    /**
+     * @brief Gets the minute/hour/day summaries of valid distance readings.
+     * @return Rollup written by whoever evaluates distances.
+     */
+    const RollupSeries &getDistanceRollup() const;
+
+    /**
+     * @brief Gets the minute/hour/day summaries of activations.
+     *
+     * Each activation adds its dwell time in seconds when the hand leaves, so a window's count
+     * is the number of activations that ended in it.
+     * @return Rollup written by whoever evaluates distances.
+     */
+    const RollupSeries &getActivationRollup() const;
+
     /**
      * @brief Sets the proximity threshold.
      * @param thresholdCm New threshold value in centimeters.
@@ -35,6 +35,9 @@
 #define WIFI_SSID "YourWiFiNetwork"  ///< Replace with your WiFi network name
 #define WIFI_PASSWORD "YourPassword" ///< Replace with your WiFi password
 
+// Execution model: true runs sensing/actuation and console I/O on separate cores
+#define RUN_DUAL_CORE true
+
 // Device instance
 CiaSteelFaucet faucetDevice(WIFI_SSID, WIFI_PASSWORD);
 
@@ -48,18 +51,28 @@ void setup()
 {
     // Initialize the Cia Steel Faucet device
     faucetDevice.initialize();
+
+    // Hand the device to its own real-time and I/O tasks when enabled
+    if (RUN_DUAL_CORE)
+    {
+        faucetDevice.startDualCore();
+    }
 }
 
 /**
  * @brief Arduino main loop - continuously monitors and updates device state.
  *
  * Handles proximity detection, water valve timing, status updates, and maintains
- * system responsiveness for touchless operation.
+ * system responsiveness for touchless operation. In dual-core mode the device runs
+ * in its own tasks and loop() only drives the manual test.
  */
 void loop()
 {
     // Update device state and process events
-    faucetDevice.update();
+    if (!faucetDevice.isDualCore())
+    {
+        faucetDevice.update();
+    }
 
     // Manual testing function (remove in production)
     testProximityDetection();
@@ -81,14 +94,14 @@ void testProximityDetection()
     if (!testTriggered && millis() > 10000)
     {
         Serial.println("=== MANUAL TEST: Simulating proximity detection ===");
-        faucetDevice.on(UltrasoundSensor::PROXIMITY_DETECTED_EVENT);
+        faucetDevice.submit(UltrasoundSensor::PROXIMITY_DETECTED_EVENT);
         testTriggered = true;
         lastTest = millis();
     }
     else if (testTriggered && millis() - lastTest > 20000)
     {
         Serial.println("=== MANUAL TEST: Simulating proximity detection ===");
-        faucetDevice.on(UltrasoundSensor::PROXIMITY_DETECTED_EVENT);
+        faucetDevice.submit(UltrasoundSensor::PROXIMITY_DETECTED_EVENT);
         lastTest = millis();
     }
 }